@@ -4,10 +4,21 @@
 
 #ifndef FINAL_SCENE_H
 #define FINAL_SCENE_H
+#include <array>
+#include <atomic>
 #include <memory>
+#include <thread>
 #include <GL/glew.h>
 
 #include "model_loader.h"
+#include "shadow_cache.h"
+#include "layered_shadow_renderer.h"
+#include "post_process_chain.h"
+#include "shader_program.h"
+#include "shader_permutations.h"
+#include "uniform_blocks.h"
+#include "frame_fences.h"
+#include "triple_buffer.h"
 #include "engine/renderer.h"
 #include "engine/system.h"
 
@@ -43,6 +54,7 @@ private:
         EFFECT_GAUSSIAN_BLUR,
         EFFECT_BLOOM, // Effet avancé: bloom
         EFFECT_NIGHT_VISION,
+        EFFECT_CUSTOM_KERNEL, // noyau utilisateur (disque) du ConvolutionEngine
         EFFECT_COUNT
     };
 
@@ -58,7 +70,8 @@ private:
         "Sobel",
         "Gaussian Blur",
         "Bloom",
-        "Vision Nocturne"
+        "Vision Nocturne",
+        "Flou disque"
     };
 
     enum RenderMode {
@@ -70,6 +83,33 @@ private:
         RENDER_MODE_COUNT
     };
 
+    // Groupement : Pipeline simulation / rendu
+    // Ce que la simulation lit de la frame (échantillonné par Update sur le thread principal)
+    struct SimulationInput {
+        float time = 0.0f;
+        float yaw = 0.0f;
+        float pitch = 0.0f;
+        float target[3] = {0.0f, 0.0f, 0.0f};
+        float orbitRadius = 0.0f;
+        float farPlane = 0.0f;
+        int width = 1;
+        int height = 1;
+        int modelInstanceCount = 0;
+        float lightPosition[3] = {0.0f, 0.0f, 0.0f};
+    };
+
+    // Tout ce que Draw lit de la scène : caméra, lumières et transformations d'une frame
+    struct RenderSnapshot {
+        ViewBlock view{};
+        FrameBlock frame{};
+        float lightSpaceMatrix[16] = {};
+        float pointLightPosition[3] = {};
+        // Recopiées seulement quand modelInstanceVersion change
+        std::vector<float> modelInstanceMatrices;
+        std::uint64_t modelInstanceVersion = 0;
+        std::uint64_t frameIndex = 0;
+    };
+
     // Groupement : Variables générales pour la caméra et l'interaction utilisateur
     bool mouseLookEnabled_ = true;
     bool firstMouse_ = true;
@@ -78,15 +118,19 @@ private:
     int width_ = 800;
     int height_ = 600;
     GLuint modelProgram_ = 0;
-    GLuint postProgram_ = 0;
+    ShaderProgram modelUniforms_;
+    SamplerLayout modelSamplers_;
     GLuint fbo_ = 0;
     GLuint colorTex_ = 0;
     GLuint rboDepthStencil_ = 0;
     GLuint quadVAO_ = 0;
     GLuint quadVBO_ = 0;
     std::unique_ptr<Model> model_;
-    GLuint modelInstanceVBO_ = 0;
+    // Une tranche de matrices par frame en vol : le draw la choisit avec baseInstance
+    FrameRingBuffer modelInstanceRing_;
     int modelInstanceCount_ = 5;
+    // Instances par tranche de JobSystem::parallelFor
+    static constexpr std::size_t INSTANCE_GRAIN_SIZE = 1024;
     float target_[3] = {0.0f, 0.0f, 0.0f};
     float orbitRadius_ = 20.0f;
     float yaw_ = -90.0f; // regarde vers -Z
@@ -100,28 +144,50 @@ private:
     float moveSpeed_ = 3.5f;
     float minPitch_ = -89.0f;
     float maxPitch_ = 89.0f;
-    float camPos_[3] = {0.0f, 0.0f, 3.0f};
     float time_ = 0.0f;
-    // Groupement : Variables liées au Bloom (effet post-processing avancé)
-    GLuint bloomFBO_[2] = {0, 0};
-    GLuint bloomTex_[2] = {0, 0};
-    GLuint pingpongFBO_[2] = {0, 0};
-    GLuint pingpongTex_[2] = {0, 0};
-    GLuint bloomExtractProgram_ = 0;
-    GLuint bloomBlurProgram_ = 0;
-    GLuint bloomCombineProgram_ = 0;
+    // Groupement : Thread de simulation (F6) : il prépare la frame N+1 pendant que Draw soumet la frame N.
+    // Update -> simulation par inputBuffer_, simulation -> Draw par snapshotBuffer_, sans verrou
+    bool pipelined_ = true;
+    std::jthread simulationThread_;
+    std::atomic<std::uint64_t> requestedFrame_{0};
+    TripleBuffer<SimulationInput> inputBuffer_;
+    TripleBuffer<RenderSnapshot> snapshotBuffer_;
+    // État propre à la simulation (thread de simulation, ou thread principal hors pipeline)
+    std::uint64_t simulatedFrame_ = 0;
+    int simulatedInstanceCount_ = -1;
+    std::uint64_t modelInstanceVersion_ = 0;
+    // Côté rendu : version des instances présente dans chaque tranche de modelInstanceRing_
+    std::array<std::uint64_t, FrameFences::MAX_FRAMES_IN_FLIGHT> uploadedInstanceVersions_{};
+    // Groupement : Frames en vol (F7 : 1 à 3 frames d'avance du CPU sur le GPU)
+    FrameFences frameFences_{2};
+    int frameSlot_ = 0;
+    // Groupement : Blocs uniformes partagés (caméra et lumière envoyées une fois par frame)
+    UniformBuffer<FrameBlock> frameBlock_;
+    UniformBuffer<ViewBlock> viewBlock_;
+    // Groupement : Post-processing (effet courant + bloom fusionnés par la chaîne)
+    PostProcessChain postChain_;
+    // Cible des passes d'éclairage : fbo_ quand la chaîne est active, sinon le backbuffer
+    GLuint sceneTarget_ = 0;
+    float bloomThreshold_ = 1.0f;
+    float bloomKnee_ = 0.5f;
+    float bloomIntensity_ = 0.8f;
+    // Rayon du flou gaussien (- / =) et du disque de EFFECT_CUSTOM_KERNEL (K)
+    int gaussianRadius_ = 2;
+    static constexpr int CUSTOM_KERNEL_RADIUS = 6;
     // Groupement : Variables liées au Skybox
     GLuint skyboxVAO_ = 0;
     GLuint skyboxVBO_ = 0;
     GLuint cubemapTex_ = 0;
     GLuint skyboxProgram_ = 0;
-
-    // Groupement : Variables liées aux noyaux de convolution (pour effets comme blur, sharpen, etc.)
-    std::vector<std::vector<float> > convolutionKernels_;
+    ShaderProgram skyboxUniforms_;
 
     // Groupement : Variables liées aux cubes et au rendu deferred
-    GLuint cubeProgram_ = 0;
-    GLuint deferredProgram_ = 0;
+    // Variantes compilées : USE_NORMAL_MAP pour les cubes, DEBUG_MODE / POINT_LIGHT_COUNT pour l'éclairage
+    ShaderPermutations cubeVariants_;
+    ShaderPermutations deferredVariants_;
+    bool useNormalMap_ = true;
+    int deferredDebugMode_ = 0; // 0=normal, 1=positions, 2=normales, 3=albedo, 4=UV
+    int pointLightCount_ = 1;
     GLsizei cubeIndexCount_ = 0;
     GLuint cubeVAO_ = 0, cubeVBO_ = 0, cubeEBO_ = 0;
     GLuint cubeDiffuseTex_ = 0;
@@ -130,7 +196,7 @@ private:
     GLuint rboDepth_ = 0;
     std::vector<core::Vec3F> cubeCenters_;
     GLuint cubeInstanceVBO_ = 0;
-    std::vector<float> modelInstanceMatrices_;
+    std::vector<float> modelInstanceMatrices_;  // écrites par la simulation
     std::vector<float> cubeInstanceMatrices_;
 
     // Groupement : Variables liées au Shadow Mapping
@@ -139,10 +205,19 @@ private:
     GLuint shadowDepthTex_ = 0;
     const int SHADOW_WIDTH = 2048;
     const int SHADOW_HEIGHT = 2048;
+    // Copie de la frame rendue (cache d'ombre et frustum de la lumière)
     float lightSpaceMatrix_[16] = {};
-    float lightProjection_[16] = {};
-    float lightView_[16] = {};
+    // Lumière des passes éclairées avec ombres (FrameBlock::lightPosition)
+    float lightPosition_[3] = {10.0f, 20.0f, 10.0f};
     float far = 500.f;
+    // Cache de la couche statique (cubes) : re-rendue seulement si la lumière ou les cubes changent
+    ShadowCache shadowCache_;
+    ShadowFrustum shadowFrustum_;
+    std::uint64_t staticCasterVersion_ = 0;
+    // Casters soumis une fois chacun (instancié) pour toutes les vues de la lumière
+    LayeredShadowRenderer layeredShadow_;
+    core::Vec3F cubeBoundsMin_{};
+    core::Vec3F cubeBoundsMax_{};
 
     // Groupement : Variables liées au SSAO (Screen Space Ambient Occlusion)
     int ssaoKernelSize_ = 64;
@@ -153,7 +228,9 @@ private:
     GLuint ssaoBlurFBO_ = 0;
     GLuint ssaoBlurBuffer_ = 0;
     GLuint ssaoProgram_ = 0;
+    ShaderProgram ssaoUniforms_;
     GLuint ssaoBlurProgram_ = 0;
+    ShaderProgram ssaoBlurUniforms_;
     float ssaoRadius_ = 0.5f;
     float ssaoBias_ = 0.025f;
 
@@ -162,29 +239,48 @@ private:
 
     void initGL();
 
-    static GLuint createModelShaderProgram();
+    // Soumission de tous les programmes au démarrage, attente groupée à la fin de Begin
+    void submitPrograms();
 
-    void initPostProcessingShaders();
+    void finalizePrograms();
 
-    static GLuint createProgram(const std::string &vertexSrc, const std::string &fragmentSrc);
+    [[nodiscard]] ShaderPermutations::Key getCubeKey() const;
 
-    static GLuint compileShader(GLenum type, const std::string &source);
+    [[nodiscard]] ShaderPermutations::Key getDeferredKey() const;
 
-    void createFramebuffer();
+    static GLuint createProgram(const std::string &vertexSrc, const std::string &fragmentSrc,
+                                const std::string &defines = "");
 
-    void createScreenQuad();
+    // Associe un programme aux blocs FrameBlock / ViewBlock
+    void attachSharedBlocks(const ShaderProgram &program) const;
+
+    // Caméra et lumière de la frame : un seul envoi partagé par tous les programmes
+    void updateSharedBlocks(const RenderSnapshot &snapshot);
+
+    // Groupement : Pipeline simulation / rendu
+    [[nodiscard]] SimulationInput makeSimulationInput() const;
+
+    // Construit la frame à partir de l'entrée ; ne touche que l'état propre à la simulation
+    void simulate(const SimulationInput &input, RenderSnapshot &snapshot);
+
+    void startSimulationThread();
+
+    void stopSimulationThread();
 
-    void createMultiPassFramebuffers();
+    void simulationLoop(const std::stop_token &stop);
 
-    void createBloomFramebuffers();
+    // Prend la dernière frame simulée et envoie ce qui a changé
+    const RenderSnapshot &acquireSnapshot();
+
+    void createFramebuffer();
+
+    void createScreenQuad();
 
     void createSkyboxRessources();
 
     static GLuint loadCubemap(const std::vector<std::string> &path);
 
-    void initBloomShaders();
-
-    void initConvolutionKernels();
+    void updatePostChain();
 
     void initCubeResources();
 
@@ -194,23 +290,16 @@ private:
 
     void cleanup();
 
-    void calculateCameraMatrices(float *view, float *proj);
-
-    static void lookAtMatrix(float *m, float eyeX, float eyeY, float eyeZ, float centerX, float centerY, float centerZ,
-                             float upX, float upY, float upZ);
+    static void calculateCameraMatrices(const SimulationInput &input, float *view, float *proj, float *cameraPosition);
 
-    static void perspectiveMatrix(float *m, float fov, float aspect, float near, float far);
-
-    static void multiplyMat4(float *out, const float *a, const float *b);
-
-    static void identityMatrix(float *m);
+    static void calculateLightMatrices(const SimulationInput &input, float *lightSpaceMatrix);
 
     // Groupement : Fonctions liées au rendu Deferred Shading
     void renderDeferred();
 
-    void renderGeometryPass(float *view, float *proj);
+    void renderGeometryPass();
 
-    void renderSkybox(float *view, float *proj);
+    void renderSkybox();
 
     // Groupement : Fonctions liées au Shadow Mapping
     void initShadowMapping();
@@ -221,6 +310,8 @@ private:
 
     void renderShadowMap();
 
+    int drawStaticShadowCasters();
+
     void renderDebugShadow();
 
     // Groupement : Fonctions liées au SSAO
@@ -230,9 +321,16 @@ private:
 
     void initCubeInstancing();
 
+    void updateCubeInstances();
+
+    void updateModelInstances(const SimulationInput &input);
+
+    // Première instance de la tranche de la frame courante dans modelInstanceRing_
+    [[nodiscard]] GLuint getModelInstanceBase() const;
+
     void renderSSAO();
 
-    void renderSSAOPass(float *proj);
+    void renderSSAOPass();
 
     void renderDebugSSAO();
 };
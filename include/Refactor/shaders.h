@@ -19,15 +19,16 @@ inline const char *ModelVertex = R"(
      layout(location=7) in vec4 iM2;
      layout(location=8) in vec4 iM3;
 
-     uniform mat4 uView;
-     uniform mat4 uProj;
+     // uView / uProj : ViewBlock (uniform_blocks.h)
+     // Nœud du mesh dans le modèle (Model::DrawInstanced)
+     uniform mat4 uNodeMatrix = mat4(1.0);
 
      out vec3 vWorldPos;
      out vec3 vWorldNormal;
      out vec2 vUV;
 
      void main() {
-         mat4 M = mat4(iM0, iM1, iM2, iM3);
+         mat4 M = mat4(iM0, iM1, iM2, iM3) * uNodeMatrix;
 
          vec4 worldPos = M * vec4(aPos, 1.0);
          vWorldPos = worldPos.xyz;
@@ -66,167 +67,6 @@ inline const char *ModelFragment = R"(
      }
 )";
 
-const char *PostVertex = R"(
-     #version 330 core
-     precision mediump float;
-
-     layout(location = 0) in vec2 aPos;
-     layout(location = 1) in vec2 aUV;
-
-     out vec2 vUV;
-
-     void main() {
-           vUV = aUV;
-           gl_Position = vec4(aPos, 0.0, 1.0);
-     }
-)";
-
-const char *PostFragment = R"(
-    #version 330 core
-    precision mediump float;
-
-    in vec2 vUV;
-    out vec4 FragColor;
-
-    uniform sampler2D uScene;
-    uniform int uEffect;
-    uniform vec2 uTexelSize;
-    uniform float uTime;
-    uniform float uBloomThreshold;
-    uniform float uBloomIntensity;
-
-    // Fonction pour convertir en grayscale
-    float luminance(vec3 color) {
-        return dot(color, vec3(0.299, 0.587, 0.114));
-    }
-
-    // Fonction de convolution 3x3
-    vec3 convolution3x3(sampler2D tex, vec2 uv, vec2 texelSize) {
-        vec3 sum = vec3(0.0);
-
-        // Kernel d'edge detection par défaut
-        float kernel[9] = float[](
-            -1.0, -1.0, -1.0,
-            -1.0,  8.0, -1.0,
-            -1.0, -1.0, -1.0
-        );
-
-        if (uEffect == 5) { // Flou
-            kernel = float[](
-                1.0/16.0, 2.0/16.0, 1.0/16.0,
-                2.0/16.0, 4.0/16.0, 2.0/16.0,
-                1.0/16.0, 2.0/16.0, 1.0/16.0
-            );
-        } else if (uEffect == 6) { // Renforcement
-            kernel = float[](
-                0.0, -1.0, 0.0,
-                -1.0, 5.0, -1.0,
-                0.0, -1.0, 0.0
-            );
-        }
-
-        int index = 0;
-        for (int y = -1; y <= 1; y++) {
-            for (int x = -1; x <= 1; x++) {
-                vec2 offset = vec2(float(x), float(y)) * texelSize;
-                vec3 color = texture(tex, uv + offset).rgb;
-                sum += color * kernel[index];
-                index++;
-            }
-        }
-        return sum;
-    }
-
-    void main() {
-        vec3 color = texture(uScene, vUV).rgb;
-        vec3 result = color;
-
-        if (uEffect == 1) { // Inversion
-            result = vec3(1.0) - color;
-        }
-        else if (uEffect == 2) { // Grayscale
-            float gray = luminance(color);
-            result = vec3(gray);
-        }
-        else if (uEffect == 3) { // Sepia
-            float gray = luminance(color);
-            result = vec3(gray * vec3(1.2, 1.0, 0.8));
-        }
-        else if (uEffect == 4) { // Edge Detection
-            result = convolution3x3(uScene, vUV, uTexelSize);
-            result = clamp(result, 0.0, 1.0);
-        }
-        else if (uEffect == 5) { // Flou
-            result = convolution3x3(uScene, vUV, uTexelSize);
-        }
-        else if (uEffect == 6) { // Renforcement
-            result = convolution3x3(uScene, vUV, uTexelSize);
-            result = clamp(result, 0.0, 1.0);
-        }
-        else if (uEffect == 7) { // Emboss
-            // Kernel emboss simplifié
-            result = vec3(0.5) + (color - texture(uScene, vUV - vec2(1.0, 1.0) * uTexelSize).rgb);
-        }
-        else if (uEffect == 8) { // Sobel simplifié
-            vec3 gx = vec3(0.0);
-            vec3 gy = vec3(0.0);
-
-            float sobelX[9] = float[](
-                -1.0, 0.0, 1.0,
-                -2.0, 0.0, 2.0,
-                -1.0, 0.0, 1.0
-            );
-
-            float sobelY[9] = float[](
-                -1.0, -2.0, -1.0,
-                0.0,  0.0,  0.0,
-                1.0,  2.0,  1.0
-            );
-
-            int index = 0;
-            for (int y = -1; y <= 1; y++) {
-                for (int x = -1; x <= 1; x++) {
-                    vec2 offset = vec2(float(x), float(y)) * uTexelSize;
-                    vec3 texColor = texture(uScene, vUV + offset).rgb;
-                    gx += texColor * sobelX[index];
-                    gy += texColor * sobelY[index];
-                    index++;
-                }
-            }
-
-            result = sqrt(gx * gx + gy * gy);
-            result = clamp(result, 0.0, 1.0);
-        }
-        else if (uEffect == 9) { // Gaussian Blur simplifié
-            vec3 sum = vec3(0.0);
-            float weight = 1.0 / 9.0;
-
-            for (int y = -1; y <= 1; y++) {
-                for (int x = -1; x <= 1; x++) {
-                    vec2 offset = vec2(float(x), float(y)) * uTexelSize;
-                    sum += texture(uScene, vUV + offset).rgb * weight;
-                }
-            }
-            result = sum;
-        }
-        else if (uEffect == 11) { // Vision Nocturne
-            float gray = luminance(color);
-            result = vec3(0.1, 0.8, 0.1) * gray;
-
-            // Ajouter du bruit
-            float noise = fract(sin(dot(vUV, vec2(12.9898, 78.233))) * 43758.5453);
-            result += noise * 0.05;
-
-            // Ajouter des scanlines
-            if (mod(gl_FragCoord.y, 3.0) < 1.0) {
-                result *= 0.9;
-            }
-        }
-
-        FragColor = vec4(result, 1.0);
-    }
-)";
-
 // 2) shaders skybox
 const std::string VertexSkyBox = R"(
     #version 300 es
@@ -234,8 +74,7 @@ const std::string VertexSkyBox = R"(
     layout (location = 0) in vec3 aPos;
     out vec3 TexCoords;
 
-    uniform mat4 uView;
-    uniform mat4 uProj;
+    // uView / uProj : ViewBlock (uniform_blocks.h)
 
     void main() {
         TexCoords = aPos;
@@ -263,108 +102,6 @@ const std::string FragmentSkybox = R"(
     }
 )";
 
-// Shader d'extraction des zones lumineuses
-const char *bloomExtractFS = R"(
-        #version 330 core
-        precision mediump float;
-
-        in vec2 vUV;
-        out vec4 FragColor;
-
-        uniform sampler2D uScene;
-        uniform float uThreshold;
-
-        float luminance(vec3 color) {
-            return dot(color, vec3(0.299, 0.587, 0.114));
-        }
-
-        void main() {
-            vec3 color = texture(uScene, vUV).rgb;
-            float brightness = luminance(color);
-
-            if (brightness > uThreshold) {
-                FragColor = vec4(color, 1.0);
-            } else {
-                FragColor = vec4(0.0, 0.0, 0.0, 1.0);
-            }
-        }
-    )";
-
-const char *bloomVertexShader = R"(
-        #version 330 core
-        precision mediump float;
-
-        layout(location = 0) in vec2 aPos;
-        layout(location = 1) in vec2 aUV;
-
-        out vec2 vUV;
-
-        void main() {
-            vUV = aUV;
-            gl_Position = vec4(aPos, 0.0, 1.0);
-        }
-    )";
-
-// Shader de flou gaussien - CORRIGÉ
-const char *bloomBlurFS = R"(
-        #version 330 core
-        precision mediump float;
-
-        in vec2 vUV;
-        out vec4 FragColor;
-
-        uniform sampler2D uImage;
-        uniform bool uHorizontal;
-        uniform vec2 uTexelSize;
-
-        void main() {
-            vec2 texelSize = uTexelSize;
-            vec3 result = vec3(0.0);
-
-            // Noyau gaussien 9x1
-            float weight[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
-
-            result = texture(uImage, vUV).rgb * weight[0];
-
-            if (uHorizontal) {
-                for (int i = 1; i < 5; i++) {
-                    result += texture(uImage, vUV + vec2(texelSize.x * float(i), 0.0)).rgb * weight[i];
-                    result += texture(uImage, vUV - vec2(texelSize.x * float(i), 0.0)).rgb * weight[i];
-                }
-            } else {
-                for (int i = 1; i < 5; i++) {
-                    result += texture(uImage, vUV + vec2(0.0, texelSize.y * float(i))).rgb * weight[i];
-                    result += texture(uImage, vUV - vec2(0.0, texelSize.y * float(i))).rgb * weight[i];
-                }
-            }
-
-            FragColor = vec4(result, 1.0);
-        }
-    )";
-
-// Shader de combinaison bloom - SIMPLIFIÉ POUR ÉVITER LES ERREURS
-const char *bloomCombineFS = R"(
-        #version 330 core
-        precision mediump float;
-
-        in vec2 vUV;
-        out vec4 FragColor;
-
-        uniform sampler2D uScene;
-        uniform sampler2D uBloomBlur;
-        uniform float uBloomIntensity;
-
-        void main() {
-            vec3 scene = texture(uScene, vUV).rgb;
-            vec3 bloom = texture(uBloomBlur, vUV).rgb;
-
-            // Combinaison additive
-            vec3 result = scene + bloom * uBloomIntensity;
-
-            FragColor = vec4(result, 1.0);
-        }
-    )";
-
 const std::string ModelCube = R"(
     #version 330 core
 
@@ -379,8 +116,7 @@ const std::string ModelCube = R"(
     layout(location=6) in vec4 iM2;
     layout(location=7) in vec4 iM3;
 
-    uniform mat4 uView;
-    uniform mat4 uProj;
+    // uView / uProj : ViewBlock (uniform_blocks.h)
 
     out vec2 vUV;
     out vec3 vPosWS;
@@ -420,7 +156,7 @@ in vec3 Normal;
 
 uniform sampler2D uDiffuse;
 uniform sampler2D uNormalMap;
-uniform bool useNormal;
+// USE_NORMAL_MAP : défini par la variante (ShaderPermutations)
 
 void main(){
 
@@ -429,12 +165,12 @@ void main(){
     // tangent -> world
     vec3 N = normalize(Normal);
 
-    if(useNormal){
-        // normal map (tangent space)
-        vec3 nTS = texture(uNormalMap, vUV).rgb;
-        nTS = normalize(nTS * 2.0 - 1.0); // [0,1] -> [-1,1]
-        N=normalize(vTBN * nTS);
-    }
+#if USE_NORMAL_MAP
+    // normal map (tangent space)
+    vec3 nTS = texture(uNormalMap, vUV).rgb;
+    nTS = normalize(nTS * 2.0 - 1.0); // [0,1] -> [-1,1]
+    N=normalize(vTBN * nTS);
+#endif
     gNormal=vec4(N*0.5+0.5, 1.0);
 
     vec4 diffuseTex = texture(uDiffuse, vUV);
@@ -467,24 +203,21 @@ uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 
-uniform vec3 viewPos;
+// Caméra (uCameraPos, uInvProj, uInvViewRot) : ViewBlock (uniform_blocks.h)
 uniform float specularPow;
 
 uniform samplerCube uSkybox;
-uniform float far;
-uniform mat4 invProj;
-uniform mat4 invViewRot;
 
 vec3 GetSkyDir(vec2 uv, vec3 viewPosition)
     {
         vec2 ndc = uv * 2.0 - 1.0;              // [-1,1]
         vec4 clip = vec4(ndc, 1.0, 1.0);
 
-        vec4 viewRay = invProj * clip;
+        vec4 viewRay = uInvProj * clip;
         viewRay = vec4(viewRay.xy, -1.0, 0.0);              // direction en view-space
 
         vec3 dirVS = normalize(viewRay.xyz);
-        vec3 dirWS = normalize((invViewRot * vec4(dirVS, 0.0)).xyz);
+        vec3 dirWS = normalize((uInvViewRot * vec4(dirVS, 0.0)).xyz);
         return dirWS;
     }
 
@@ -495,35 +228,32 @@ struct PointLight{
     float linear;
     float quadratic;
 };
-uniform int pointLightCount;
-uniform PointLight pointLights[1];
-
-uniform int debugMode;
+// POINT_LIGHT_COUNT et DEBUG_MODE : définis par la variante (ShaderPermutations)
+#if POINT_LIGHT_COUNT > 0
+uniform PointLight pointLights[POINT_LIGHT_COUNT];
+#endif
 
 void main(){
 
     // Mode debug: 0=normal, 1=positions, 2=normales, 3=albedo, 4=UV
-    if(debugMode == 1) {
-        // Afficher les positions (normalisées pour la visualisation)
-        vec3 pos = texture(gPosition, TexCoord).rgb;
-        FragColor = vec4(normalize(pos) * 0.5 + 0.5, 1.0);
-        return;
-    }
-    else if(debugMode == 2) {
-        // Afficher les normales (déjà en [0,1])
-        FragColor = texture(gNormal, TexCoord);
-        return;
-    }
-    else if(debugMode == 3) {
-        // Afficher l'albedo (couleur de la texture)
-        FragColor = texture(gAlbedoSpec, TexCoord);
-        return;
-    }
-    else if(debugMode == 4) {
-        // Afficher les coordonnées UV
-        FragColor = vec4(TexCoord, 0.0, 1.0);
-        return;
-    }
+#if DEBUG_MODE == 1
+    // Afficher les positions (normalisées pour la visualisation)
+    vec3 pos = texture(gPosition, TexCoord).rgb;
+    FragColor = vec4(normalize(pos) * 0.5 + 0.5, 1.0);
+    return;
+#elif DEBUG_MODE == 2
+    // Afficher les normales (déjà en [0,1])
+    FragColor = texture(gNormal, TexCoord);
+    return;
+#elif DEBUG_MODE == 3
+    // Afficher l'albedo (couleur de la texture)
+    FragColor = texture(gAlbedoSpec, TexCoord);
+    return;
+#elif DEBUG_MODE == 4
+    // Afficher les coordonnées UV
+    FragColor = vec4(TexCoord, 0.0, 1.0);
+    return;
+#endif
 
       // Lire les données du G-buffer
     vec4 positionData = texture(gPosition, TexCoord);
@@ -531,8 +261,8 @@ void main(){
 
     // SI c'est le fond (position ~ 0), afficher la skybox
     if(length(fragPos) < 0.001) {
-        // Utiliser viewPos pour un calcul correct
-        vec3 rayDir = GetSkyDir(TexCoord, viewPos);
+        // Utiliser la position caméra pour un calcul correct
+        vec3 rayDir = GetSkyDir(TexCoord, uCameraPos.xyz);
         vec3 skyColor = texture(uSkybox, rayDir).rgb;
         FragColor = vec4(skyColor, 1.0);
 
@@ -547,10 +277,11 @@ void main(){
     float specularStrength = texture(gAlbedoSpec, TexCoord).a;
 
     // Éclairage (votre code existant)...
-    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 viewDir = normalize(uCameraPos.xyz - fragPos);
     vec3 lighting = albedo * 0.1;
 
-    for(int i = 0; i < pointLightCount; i++){
+#if POINT_LIGHT_COUNT > 0
+    for(int i = 0; i < POINT_LIGHT_COUNT; i++){
         vec3 lightDir = normalize(pointLights[i].position - fragPos);
         float diff = max(dot(normal, lightDir), 0.0);
         vec3 diffuse = diff * albedo * pointLights[i].color;
@@ -566,9 +297,10 @@ void main(){
 
         lighting += (diffuse + specular) * attenuation;
     }
+#endif
 
     FragColor = vec4(lighting, 1.0);
-    gl_FragDepth = viewPos.z;
+    gl_FragDepth = uCameraPos.z;
 })";
 
 // SHADER SHADOW CORRECT - FRAGMENT SHADER DOIT ÉCRIRE LA PROFONDEUR
@@ -617,7 +349,7 @@ const std::string ssaoFS = R"(
             uniform sampler2D gNormal;
             uniform sampler2D texNoise;
 
-            uniform mat4 projection;
+            // uProj : ViewBlock (uniform_blocks.h)
 
             const int kernelSize = 16;
             uniform vec3 samples[16];
@@ -647,7 +379,7 @@ const std::string ssaoFS = R"(
 
                     // Project sample position
                     vec4 offset = vec4(samplePos, 1.0);
-                    offset = projection * offset;
+                    offset = uProj * offset;
                     offset.xyz /= offset.w;
                     offset.xyz = offset.xyz * 0.5 + 0.5;
 
@@ -730,9 +462,7 @@ const std::string shadowSimpleFS = R"(
         uniform sampler2D gNormal;
         uniform sampler2D gAlbedoSpec;
         uniform sampler2D shadowMap;
-        uniform mat4 lightSpaceMatrix;
-        uniform vec3 viewPos;
-        uniform vec3 lightPos;
+        // uLightSpaceMatrix / uLightPos : FrameBlock, uCameraPos : ViewBlock (uniform_blocks.h)
 
         float ShadowCalculation(vec4 fragPosLightSpace) {
             vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
@@ -762,7 +492,7 @@ const std::string shadowSimpleFS = R"(
             }
 
             // Lumière directionnelle
-            vec3 lightDir = normalize(lightPos - fragPos);
+            vec3 lightDir = normalize(uLightPos.xyz - fragPos);
             vec3 lightColor = vec3(1.0, 0.95, 0.9);
 
             // Ambient
@@ -773,13 +503,13 @@ const std::string shadowSimpleFS = R"(
             vec3 diffuse = diff * albedo * lightColor;
 
             // Specular (Blinn-Phong)
-            vec3 viewDir = normalize(viewPos - fragPos);
+            vec3 viewDir = normalize(uCameraPos.xyz - fragPos);
             vec3 halfwayDir = normalize(lightDir + viewDir);
             float spec = pow(max(dot(normal, halfwayDir), 0.0), 32.0);
             vec3 specularLight = specular * spec * lightColor;
 
             // Calcul ombre
-            vec4 fragPosLightSpace = lightSpaceMatrix * vec4(fragPos, 1.0);
+            vec4 fragPosLightSpace = uLightSpaceMatrix * vec4(fragPos, 1.0);
             float shadow = ShadowCalculation(fragPosLightSpace);
 
             // Résultat final avec ombres
@@ -839,7 +569,7 @@ const std::string ssaoFS2 = R"(
         uniform sampler2D gNormal;
         uniform sampler2D gAlbedoSpec;
         uniform sampler2D ssaoBuffer;
-        uniform vec3 viewPos;
+        // uCameraPos : ViewBlock (uniform_blocks.h)
 
         void main() {
             vec3 fragPos = texture(gPosition, TexCoord).rgb;
@@ -865,7 +595,7 @@ const std::string ssaoFS2 = R"(
             vec3 diffuse = diff * albedo * lightColor;
 
             // Specular (Blinn-Phong)
-            vec3 viewDir = normalize(viewPos - fragPos);
+            vec3 viewDir = normalize(uCameraPos.xyz - fragPos);
             vec3 halfwayDir = normalize(lightDir + viewDir);
             float spec = pow(max(dot(normal, halfwayDir), 0.0), 32.0);
             vec3 specularLight = specular * spec * lightColor;
@@ -0,0 +1,86 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef BLOOM_RENDERER_H
+#define BLOOM_RENDERER_H
+#include "third_party/gl_include.h"
+#include <string>
+
+// Bloom par chaîne de mips (dual filter) dans une seule texture HDR :
+//  - descente : downsample 13 taps niveau par niveau, le premier applique le seuil (genou doux)
+//    et une moyenne de Karis contre les lucioles,
+//  - remontée : filtre tente 3x3 ajouté (blending additif) au niveau inférieur.
+// Le coût est fixe (2 x MAX_MIP_COUNT passes de plus en plus petites) quelle que soit la largeur
+// du halo ; le niveau 0 (demi-résolution) contient le résultat.
+class BloomRenderer {
+public:
+    static constexpr int MAX_MIP_COUNT = 6;
+
+    // ==================== CONSTRUCTEURS ====================
+    BloomRenderer();
+    ~BloomRenderer();
+
+    BloomRenderer(const BloomRenderer&) = delete;
+    BloomRenderer& operator=(const BloomRenderer&) = delete;
+
+    // ==================== INITIALISATION ====================
+    // Taille de la scène source (la chaîne commence à la demi-résolution)
+    bool initialize(int width, int height);
+
+    // ==================== PARAMÈTRES ====================
+    // knee : largeur du genou relative au seuil (0 = coupure nette, 1 = transition dès 0)
+    void setThreshold(float threshold, float knee);
+    // Rayon du filtre tente de remontée, en texels du niveau lu
+    void setFilterRadius(float radius) { filterRadius_ = radius; }
+
+    // ==================== RENDU ====================
+    void render(GLuint sceneTexture);
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] GLuint getTexture() const { return bloomTex_; }
+    [[nodiscard]] int getMipCount() const { return mipCount_; }
+    [[nodiscard]] int getPassCount() const { return 2 * mipCount_ - 1; }
+    [[nodiscard]] float getThreshold() const { return threshold_; }
+    [[nodiscard]] float getKnee() const { return knee_; }
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+private:
+    // ==================== RESSOURCES OPENGL ====================
+    GLuint bloomTex_;
+    GLuint mipFBO_[MAX_MIP_COUNT];
+    GLuint fullscreenVAO_;
+    GLuint downsampleShader_;
+    GLuint upsampleShader_;
+
+    // ==================== UNIFORMS ====================
+    GLint downTexelSizeLoc_;
+    GLint downPrefilterLoc_;
+    GLint downThresholdLoc_;
+    GLint upTexelSizeLoc_;
+    GLint upFilterRadiusLoc_;
+
+    // ==================== PARAMÈTRES ====================
+    int mipWidth_[MAX_MIP_COUNT];
+    int mipHeight_[MAX_MIP_COUNT];
+    int mipCount_;
+    int sourceWidth_;
+    int sourceHeight_;
+    float threshold_;
+    float knee_;
+    float filterRadius_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    void setSourceLevel(int level) const;
+
+    static GLuint submitProgram(const std::string &fragmentSource);
+
+    // ==================== SHADERS ====================
+    static std::string getFullscreenVS();
+    static std::string getDownsampleFS();
+    static std::string getUpsampleFS();
+};
+
+#endif //BLOOM_RENDERER_H
@@ -31,8 +31,6 @@ public:
     // ==================== MATRICES (FORMAT TABLEAU) ====================
     void getViewMatrix(float* outView) const;
     void getProjectionMatrix(float* outProj) const;
-    static void lookAtMatrix(float* outMatrix, const core::Vec3F& eye, const core::Vec3F& center,const core::Vec3F& up);
-    static void perspectiveMatrix(float* outMatrix, float fov, float aspect, float near, float far);
 
     // ==================== GETTERS ====================
     [[nodiscard]] const core::Vec3F& getPosition() const { return position_; }
@@ -0,0 +1,142 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef COMMAND_LIST_H
+#define COMMAND_LIST_H
+#include "third_party/gl_include.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// ==================== MATÉRIAUX ====================
+// Samplers de matériau connus des shaders de modèle (numérotation de Mesh::Draw)
+static constexpr std::array<std::string_view, 7> MATERIAL_SAMPLER_NAMES = {
+    "texture_diffuse1", "texture_diffuse2", "texture_diffuse3",
+    "texture_specular1", "texture_specular2",
+    "texture_normal1", "texture_height1"
+};
+
+// Textures d'un mesh, résolues au chargement : unité i <- textures[i], sampler samplerSlots[i]
+struct DrawMaterial {
+    static constexpr int MAX_TEXTURES = 8;
+    static constexpr std::uint8_t NO_SAMPLER = 0xFF;
+
+    std::array<GLuint, MAX_TEXTURES> textures{};
+    std::array<std::uint8_t, MAX_TEXTURES> samplerSlots{};
+    std::uint8_t textureCount = 0;
+
+    // Indice dans MATERIAL_SAMPLER_NAMES, NO_SAMPLER si le nom n'y est pas
+    static std::uint8_t findSamplerSlot(std::string_view name);
+};
+
+// Locations des samplers de matériau dans un programme : résolues sur le thread GL,
+// une fois par programme, pour que le replay n'ait plus aucun nom à chercher
+struct SamplerLayout {
+    GLuint program = 0;
+    std::array<GLint, MATERIAL_SAMPLER_NAMES.size()> locations = [] {
+        std::array<GLint, MATERIAL_SAMPLER_NAMES.size()> none{};
+        none.fill(-1);
+        return none;
+    }();
+
+    static SamplerLayout resolve(GLuint program);
+};
+
+// ==================== PAQUETS ====================
+// Un draw entièrement résolu : le replay n'a plus besoin de la scène ni des modèles
+struct DrawPacket {
+    const DrawMaterial *material;   // nullptr : profondeur seule, aucune texture
+    GLuint program;
+    GLuint vao;
+    GLsizei indexCount;
+    std::uint32_t firstIndex;
+    std::uint32_t matrixOffset;     // premier float de la matrice modèle dans la liste
+};
+
+// Liste de draws enregistrée sans aucun appel GL : un worker la remplit, le thread du
+// contexte la rejoue. Les matrices sont stockées à part, une par nœud et non par draw,
+// et le replay ne change programme, VAO, matériau ou matrice que s'ils diffèrent du draw précédent.
+// Les paquets vivent dans la mémoire donnée à reset() (l'arène de frame du worker qui enregistre) :
+// la liste n'est valide que jusqu'au prochain reset de cette mémoire.
+class CommandList {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    CommandList() = default;
+    ~CommandList() = default;
+
+    CommandList(const CommandList&) = delete;
+    CommandList& operator=(const CommandList&) = delete;
+    CommandList(CommandList&&) = default;
+    CommandList& operator=(CommandList&&) = default;
+
+    // ==================== ENREGISTREMENT (tout thread) ====================
+    // Repart à vide dans resource, avec la taille de l'enregistrement précédent déjà réservée
+    void reset(std::pmr::memory_resource *resource);
+    // Retourne l'offset à donner aux draws qui utilisent cette matrice
+    std::uint32_t addMatrix(const float *matrix);
+    void draw(GLuint program, GLuint vao, GLsizei indexCount, std::uint32_t firstIndex,
+              std::uint32_t matrixOffset, const DrawMaterial *material);
+
+    [[nodiscard]] int getDrawCount() const { return storage_ ? static_cast<int>(storage_->packets.size()) : 0; }
+    [[nodiscard]] bool empty() const { return getDrawCount() == 0; }
+
+    // ==================== REPLAY (thread GL) ====================
+    // modelMatrixLocation : uniform de la matrice modèle du programme des paquets.
+    // instanceCount > 1 : chaque draw est instancié (rendu layered, une instance par couche)
+    void execute(GLint modelMatrixLocation, const SamplerLayout &samplers = {}, GLsizei instanceCount = 1) const;
+
+private:
+    struct Storage {
+        explicit Storage(std::pmr::memory_resource *resource) : packets(resource), matrices(resource) {}
+
+        std::pmr::vector<DrawPacket> packets;
+        std::pmr::vector<float> matrices;
+    };
+
+    // Reconstruit à chaque reset : une affectation garderait l'ancienne ressource
+    std::optional<Storage> storage_;
+    std::size_t packetHint_ = 0;
+    std::size_t matrixHint_ = 0;
+};
+
+// Enregistrement parallèle d'une passe : [0, count) est découpé en tranches, chaque tranche
+// remplit sa propre liste sur un worker du JobSystem, dans l'arène de frame de ce worker
+// (FrameArena::forThread), puis execute() les rejoue dans l'ordre des tranches (même ordre
+// de draws qu'une boucle séquentielle). Rejouer après FrameArena::resetThreadArenas() est
+// une erreur : il faut réenregistrer à chaque frame.
+class CommandListSet {
+public:
+    using RecordItem = std::function<void(CommandList &list, int index)>;
+
+    // ==================== CONSTRUCTEURS ====================
+    CommandListSet() = default;
+    ~CommandListSet() = default;
+
+    CommandListSet(const CommandListSet&) = delete;
+    CommandListSet& operator=(const CommandListSet&) = delete;
+
+    // ==================== ENREGISTREMENT ====================
+    void record(int count, const RecordItem &recordItem);
+
+    // ==================== REPLAY (thread GL) ====================
+    void execute(GLint modelMatrixLocation, const SamplerLayout &samplers = {}, GLsizei instanceCount = 1) const;
+
+    // Compté à l'enregistrement : reste lisible après la fin de frame
+    [[nodiscard]] int getDrawCount() const { return drawCount_; }
+
+private:
+    // Au-dessous, une seule tranche : le coût d'un job dépasse celui de l'enregistrement
+    static constexpr int ITEMS_PER_LIST = 64;
+
+    std::vector<CommandList> lists_;
+    int usedLists_ = 0;
+    int recordCount_ = 0;
+    int drawCount_ = 0;
+};
+
+#endif //COMMAND_LIST_H
@@ -0,0 +1,109 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef CONVOLUTION_ENGINE_H
+#define CONVOLUTION_ENGINE_H
+#include "third_party/gl_include.h"
+#include <string>
+#include <vector>
+
+// Noyau de convolution quelconque (largeur/hauteur impaires).
+// weights est rangé ligne par ligne, la ligne 0 correspondant au décalage y = -rayon.
+struct ConvolutionKernel {
+    int width = 1;
+    int height = 1;
+    std::vector<float> weights = {1.0f};
+    float bias = 0.0f;
+    bool clampResult = false;
+
+    static ConvolutionKernel gaussian(int radius, float sigma);
+    static ConvolutionKernel box(int radius);
+    // Disque uniforme (bokeh) : non séparable, passe par le chemin 2D par tuiles
+    static ConvolutionKernel disc(int radius);
+};
+
+// Convolution en compute shader :
+//  - noyaux séparables (rang 1 : gaussien, box, Sobel...) détectés automatiquement et
+//    décomposés en deux passes 1D : coût linéaire en rayon au lieu de quadratique,
+//  - sinon une passe 2D par tuiles ; chaque groupe charge sa tuile + la marge (apron)
+//    en mémoire partagée, donc une lecture de texture par texel au lieu d'une par tap.
+class ConvolutionEngine {
+public:
+    static constexpr int TILE_SIZE = 16;
+    static constexpr int MAX_RADIUS_2D = 8;
+    static constexpr int LINE_SIZE = 256;
+    static constexpr int MAX_RADIUS_SEPARABLE = 32;
+    static constexpr GLuint KERNEL_SSBO_BINDING = 2;
+
+    // ==================== CONSTRUCTEURS ====================
+    ConvolutionEngine();
+    ~ConvolutionEngine();
+
+    ConvolutionEngine(const ConvolutionEngine&) = delete;
+    ConvolutionEngine& operator=(const ConvolutionEngine&) = delete;
+
+    // ==================== INITIALISATION ====================
+    bool initialize();
+
+    // ==================== NOYAUX ====================
+    // Retourne un identifiant, -1 si le noyau est invalide ou trop grand
+    int createKernel(const ConvolutionKernel &kernel);
+    bool updateKernel(int id, const ConvolutionKernel &kernel);
+
+    // ==================== RENDU ====================
+    // input et output (RGBA16F) ont la même taille
+    void apply(int id, GLuint input, GLuint output, int width, int height);
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] bool isInitialized() const { return program2D_ != 0 && programSeparable_ != 0; }
+    [[nodiscard]] bool isSeparable(int id) const;
+
+    // Décomposition de rang 1 : kernel[y][x] == column[y] * row[x] (à epsilon près)
+    static bool decompose(const ConvolutionKernel &kernel, std::vector<float> &column, std::vector<float> &row);
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+private:
+    struct KernelEntry {
+        GLuint buffer;      // SSBO : 2D -> poids, séparable -> ligne puis colonne
+        int radiusX;
+        int radiusY;
+        bool separable;
+        float bias;
+        bool clampResult;
+    };
+
+    // ==================== RESSOURCES OPENGL ====================
+    GLuint program2D_;
+    GLuint programSeparable_;
+    GLuint scratchTex_;
+    int scratchWidth_;
+    int scratchHeight_;
+    std::vector<KernelEntry> kernels_;
+
+    // ==================== UNIFORMS ====================
+    GLint radius2DLoc_;
+    GLint bias2DLoc_;
+    GLint clamp2DLoc_;
+    GLint axisLoc_;
+    GLint radiusLoc_;
+    GLint weightOffsetLoc_;
+    GLint biasLoc_;
+    GLint clampLoc_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    bool fillEntry(KernelEntry &entry, const ConvolutionKernel &kernel) const;
+    void ensureScratch(int width, int height);
+    void dispatchSeparable(const KernelEntry &entry, int axis, GLuint input, GLuint output,
+                           int width, int height, bool finalPass) const;
+
+    static GLuint submitComputeProgram(const std::string &source);
+
+    // ==================== SHADERS ====================
+    static std::string getConvolution2DShader();
+    static std::string getSeparableShader();
+};
+
+#endif //CONVOLUTION_ENGINE_H
@@ -8,10 +8,22 @@
 #include <GL/glew.h>
 
 #include "maths/vec3.h"
+#include "frame_graph.h"
+#include "shader_permutations.h"
 
 
+// Le G-Buffer n'appartient plus au renderer : ses attachements sont des ressources transitoires
+// du FrameGraph (createGBuffer), dont la mémoire est réutilisée une fois l'éclairage passé.
 class DeferredRenderer {
 public:
+    // Attachements du G-Buffer, dans l'ordre des sorties du shader géométrique
+    struct GBufferTargets {
+        FrameGraphResource position = INVALID_FRAME_GRAPH_RESOURCE;
+        FrameGraphResource normal = INVALID_FRAME_GRAPH_RESOURCE;
+        FrameGraphResource albedo = INVALID_FRAME_GRAPH_RESOURCE;
+        FrameGraphResource depth = INVALID_FRAME_GRAPH_RESOURCE;
+    };
+
     // ==================== CONSTRUCTEURS ====================
     DeferredRenderer();
     ~DeferredRenderer();
@@ -28,14 +40,21 @@ public:
                      const std::string& lightingFS);
 
     // ==================== RENDU ====================
-    void beginGeometryPass() const;
+    // Dans le setup de la passe géométrique : déclare les attachements qu'elle écrit
+    GBufferTargets createGBuffer(FrameGraph::Builder &builder) const;
+    // Le framebuffer du G-Buffer est déjà lié par le graphe : état GL et clear seulement
+    static void beginGeometryPass();
 
     static void endGeometryPass();
-    void beginLightingPass() const;
+    // Textures du G-Buffer de la frame (FrameGraph::Resources::getTexture)
+    void beginLightingPass(GLuint gPosition, GLuint gNormal, GLuint gAlbedo) const;
 
     static void endLightingPass();
     void bindGeometryShader() const;
-    void bindLightingShader() const;
+    // Options de l'éclairage, compilées dans le shader (une variante par combinaison) :
+    // à fixer avant bindLightingShader. shadowMode : 0 = sans ombre, 1 = comparaison simple, 2 = VSM, 3 = EVSM
+    void setLightingFeatures(bool useSSAO, int shadowMode);
+    void bindLightingShader();
     static void unbindShader();
 
     // ==================== MATRICES ====================
@@ -46,68 +65,52 @@ public:
 
     // ==================== UNIFORMS DE LIGHTING ====================
     void setCameraPosition(const core::Vec3F& camPos) const;
-    void setPointLight(int index, const core::Vec3F& position,
-                      const core::Vec3F& color, float intensity, float radius);
+    // Point et spot lights : lues dans les SSBO de LightManager, liés par bindLightBuffers()
     void setDirectionalLight(const core::Vec3F& direction,
                            const core::Vec3F& color, float intensity) const;
-    void bindShadowMap(GLuint shadowMap) const;
-    void setPointLightCount(int count) const;
+    static void bindSSAO(GLuint ssaoTexture);
+    static void bindShadowMap(GLuint shadowMap);
+    static void bindShadowMoments(GLuint shadowMoments);
+    static void bindShadowAtlas(GLuint shadowAtlas);
+    void setShadowFilter(float lightBleedingReduction,
+                         float evsmPositiveExponent, float evsmNegativeExponent) const;
 
     // ==================== GETTERS ====================
-    [[nodiscard]] GLuint getPositionTexture() const { return gPosition_; }
-    [[nodiscard]] GLuint getNormalTexture() const { return gNormal_; }
-    [[nodiscard]] GLuint getAlbedoTexture() const { return gAlbedo_; }
     [[nodiscard]] GLuint getGeometryShader() const { return geometryShader_; }
-    [[nodiscard]] GLuint getLightingShader() const { return lightingShader_; }
+    // Pour le replay des listes de commandes (CommandList::execute)
+    [[nodiscard]] GLint getGeometryModelMatrixLocation() const { return geomModelLoc_; }
+    [[nodiscard]] GLuint getLightingShader() const { return lighting_ != nullptr ? lighting_->getId() : 0; }
+    [[nodiscard]] int getLightingVariantCount() const { return lightingVariants_.getVariantCount(); }
     [[nodiscard]] bool isInitialized() const { return initialized_; }
     // ==================== NETTOYAGE ====================
     void cleanup();
 private:
     // ==================== RESSOURCES OPENGL ====================
-    GLuint gBuffer_;
-    GLuint gPosition_;
-    GLuint gNormal_;
-    GLuint gAlbedo_;
-    GLuint gDepth_;
     GLuint geometryShader_;
-    GLuint lightingShader_;
+    // Variantes du programme d'éclairage (USE_SSAO, SHADOW_MODE) et variante liée
+    ShaderPermutations lightingVariants_;
+    ShaderPermutations::Key lightingKey_;
+    ShaderProgram *lighting_;
     // ==================== UNIFORMS ====================
     GLint geomModelLoc_;
     GLint geomViewLoc_;
     GLint geomProjLoc_;
 
-    GLint lightCamPosLoc_;
-    GLint lightDirLoc_;
-    GLint lightColorLoc_;
-    GLint lightIntensityLoc_;
-    GLint lightSpaceMatLoc_;
-    GLint lightPointCountLoc_;
-    GLint lightShadowMapLoc_;
-
-    // ==================== POSITIONS DE LUMIÈRES ====================
-    static constexpr int MAX_POINT_LIGHTS = 32;
-    GLint lightPointPosLoc_[MAX_POINT_LIGHTS]{};
-    GLint lightPointColorLoc_[MAX_POINT_LIGHTS]{};
-    GLint lightPointIntensityLoc_[MAX_POINT_LIGHTS]{};
-    GLint lightPointRadiusLoc_[MAX_POINT_LIGHTS]{};
-
     // ==================== PARAMÈTRES ====================
     int screenWidth_;
     int screenHeight_;
     bool initialized_;
 
     // ==================== MÉTHODES PRIVÉES ====================
-    void createGBuffers();
-    static GLuint compileShader(GLenum type, const std::string& source);
-    static GLuint createProgram(GLuint vs, GLuint fs);
     void initializeUniformLocations();
-    static void printShaderError(GLuint shader, GLenum type);
-    static void printProgramError(GLuint program);
+    // Unités de textures fixes d'une variante d'éclairage, appelé à sa création
+    static void configureLightingVariant(ShaderProgram &program);
     // ==================== SHADERS PAR DÉFAUT ====================
     static std::string getDefaultGeometryVS();
     static std::string getDefaultGeometryFS();
     static std::string getDefaultLightingVS();
     static std::string getDefaultLightingFS();
+    static std::string getShadowFilteringGLSL();
 
 
 };
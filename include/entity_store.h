@@ -0,0 +1,142 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "matrix_math.h"
+#include "slot_map.h"
+#include "transform_hierarchy.h"
+#include "maths/vec3.h"
+
+class Model;
+
+using EntityHandle = SlotHandle;
+
+// Stockage des instances de la scène en tableaux séparés (SoA) : les passes qui ne lisent
+// que les matrices ou les bounds parcourent de la mémoire contiguë, sans charger le reste.
+//
+// Les setters ne recalculent rien : ils marquent l'entité sale. updateTransforms() reconstruit
+// ensuite, par blocs de CHUNK_SIZE entités, la matrice monde et l'AABB monde des seules entités
+// sales ; les blocs sans entité sale sont sautés et les gros lots répartis sur le JobSystem.
+// Matrices et bounds monde ne sont donc valides qu'après updateTransforms().
+//
+// Chaque entité est désignée par un EntityHandle stable ; l'indice dense, qui sert à parcourir
+// les tableaux, change quand une suppression déplace la dernière entité dans le trou.
+//
+// Une entité peut avoir un parent : elle entre alors dans une TransformHierarchy, son TRS
+// devient local au parent et sa matrice monde est propagée (sous-arbres sales seulement).
+// Les entités hors hiérarchie, la grande majorité, n'en paient pas le coût.
+class EntityStore {
+public:
+    static constexpr std::size_t CHUNK_SIZE = 1024;
+    // En dessous, le coût de distribution des jobs dépasse le gain
+    static constexpr std::size_t PARALLEL_THRESHOLD = 8192;
+
+    // ==================== CONSTRUCTEURS ====================
+    EntityStore();
+    ~EntityStore() = default;
+
+    EntityStore(const EntityStore&) = delete;
+    EntityStore& operator=(const EntityStore&) = delete;
+
+    // ==================== ENTITÉS ====================
+    EntityHandle create(Model *model, SlotHandle modelHandle,
+                        const core::Vec3F &position,
+                        const core::Vec3F &rotation,
+                        const core::Vec3F &scale);
+    // O(1) : la dernière entité prend l'indice dense libéré
+    void remove(EntityHandle handle);
+    void clear();
+    void reserve(std::size_t capacity);
+
+    [[nodiscard]] int size() const { return static_cast<int>(positions_.size()); }
+    [[nodiscard]] bool isValid(int index) const { return index >= 0 && index < size(); }
+    // Indice dense, -1 si le handle est obsolète
+    [[nodiscard]] int indexOf(EntityHandle handle) const { return handles_.indexOf(handle); }
+    [[nodiscard]] EntityHandle handleAt(int index) const { return handles_.handleAt(index); }
+
+    // ==================== TRANSFORMS ====================
+    void setPosition(int index, const core::Vec3F &position);
+    void setRotation(int index, const core::Vec3F &rotation);
+    void setScale(int index, const core::Vec3F &scale);
+    void markDirty(int index);
+
+    [[nodiscard]] const core::Vec3F &getPosition(int index) const { return positions_[index]; }
+    [[nodiscard]] const core::Vec3F &getRotation(int index) const { return rotations_[index]; }
+    [[nodiscard]] const core::Vec3F &getScale(int index) const { return scales_[index]; }
+    [[nodiscard]] bool isDirty(int index) const { return (flags_[index] & FLAG_DIRTY) != 0; }
+
+    // Recalcule les entités sales ; retourne leur nombre
+    std::size_t updateTransforms();
+    [[nodiscard]] std::size_t getDirtyCount() const { return dirtyCount_; }
+
+    // ==================== HIÉRARCHIE ====================
+    // parent -1 : détache ; refuse (false) un parent qui descend de l'entité
+    bool setParent(int index, int parent);
+    [[nodiscard]] int getParent(int index) const;
+    // Entités statiques déplacées par leur parent lors du dernier updateTransforms()
+    [[nodiscard]] std::size_t getStaticHierarchyUpdates() const { return staticHierarchyUpdates_; }
+
+    // ==================== DONNÉES MONDE ====================
+    [[nodiscard]] const float *getWorldMatrix(int index) const { return worldMatrices_[index].data(); }
+    [[nodiscard]] const Aabb &getWorldBounds(int index) const { return worldBounds_[index]; }
+    [[nodiscard]] const Aabb &getLocalBounds(int index) const { return localBounds_[index]; }
+    // Tableaux complets, pour les traitements par lots
+    [[nodiscard]] const std::vector<std::array<float, 16>> &getWorldMatrices() const { return worldMatrices_; }
+    [[nodiscard]] const std::vector<Aabb> &getWorldBoundsArray() const { return worldBounds_; }
+
+    // ==================== ÉTAT ====================
+    void setVisible(int index, bool visible);
+    void setStatic(int index, bool isStatic);
+    [[nodiscard]] bool isVisible(int index) const { return (flags_[index] & FLAG_VISIBLE) != 0; }
+    [[nodiscard]] bool isStatic(int index) const { return (flags_[index] & FLAG_STATIC) != 0; }
+
+    // ==================== DONNÉES FROIDES ====================
+    [[nodiscard]] Model *getModel(int index) const { return models_[index]; }
+    [[nodiscard]] SlotHandle getModelHandle(int index) const { return modelHandles_[index]; }
+
+private:
+    static constexpr std::uint8_t FLAG_VISIBLE = 1 << 0;
+    static constexpr std::uint8_t FLAG_STATIC = 1 << 1;
+    static constexpr std::uint8_t FLAG_DIRTY = 1 << 2;
+    // TRS recalculé, à transmettre à la hiérarchie
+    static constexpr std::uint8_t FLAG_LOCAL_CHANGED = 1 << 3;
+
+    // ==================== DONNÉES CHAUDES ====================
+    std::vector<core::Vec3F> positions_;
+    std::vector<core::Vec3F> rotations_;
+    std::vector<core::Vec3F> scales_;
+    std::vector<std::array<float, 16>> worldMatrices_;
+    std::vector<Aabb> localBounds_;
+    std::vector<Aabb> worldBounds_;
+    std::vector<std::uint8_t> flags_;
+
+    // ==================== DONNÉES FROIDES ====================
+    std::vector<Model *> models_;
+    std::vector<SlotHandle> modelHandles_;
+    SlotIndex handles_;
+
+    // Nombre d'entités sales par bloc : un bloc à 0 n'est pas parcouru
+    std::vector<std::uint32_t> chunkDirtyCounts_;
+    std::size_t dirtyCount_;
+
+    // ==================== HIÉRARCHIE ====================
+    TransformHierarchy hierarchy_;
+    std::vector<int> nodes_;            // entité -> nœud, -1 hors hiérarchie
+    std::vector<int> nodeEntities_;     // nœud -> entité
+    int linkedCount_;
+    std::size_t staticHierarchyUpdates_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    void updateChunk(std::size_t chunk);
+    std::size_t updateHierarchy();
+    int ensureNode(int index);
+};
+
+#endif //ENTITY_STORE_H
@@ -0,0 +1,198 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Allocateur linéaire pour les données qui ne vivent qu'une frame : allouer avance un pointeur,
+// libérer ne fait rien, reset() rend tout d'un coup. C'est une std::pmr::memory_resource :
+// les conteneurs std::pmr (vector, string...) s'y branchent directement.
+//
+// Si une frame dépasse la capacité, les blocs supplémentaires viennent du tas ; au reset suivant
+// ils sont fusionnés en un seul bloc assez grand pour le pic observé. Une fois le régime établi,
+// l'arène ne touche plus au tas.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    // ==================== CONSTRUCTEURS ====================
+    explicit FrameArena(std::size_t initialCapacity = DEFAULT_CAPACITY);
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // ==================== FRAME ====================
+    // Tout ce qui a été alloué depuis le dernier reset devient invalide
+    void reset();
+    // Copie terminée par '\0' dans l'arène (noms de passes, de ressources...)
+    std::string_view copyString(std::string_view text);
+
+    // ==================== ARÈNES PAR THREAD ====================
+    // Arène du thread appelant (thread principal ou worker du JobSystem), créée au premier appel.
+    // Elle n'est rendue que par resetThreadArenas() : sans appel à chaque frame, elle ne fait que grandir.
+    static FrameArena &forThread();
+    // Fin de frame, sur le thread principal, aucun job en cours : remet à zéro toutes les arènes de thread
+    static void resetThreadArenas();
+
+    // ==================== STATISTIQUES ====================
+    [[nodiscard]] std::size_t getUsedBytes() const { return offset_ + overflowBytes_; }
+    [[nodiscard]] std::size_t getCapacity() const { return capacity_; }
+    [[nodiscard]] std::size_t getPeakBytes() const { return peakBytes_; }
+    // Resets qui ont dû agrandir l'arène
+    [[nodiscard]] std::uint64_t getGrowCount() const { return growCount_; }
+
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    // Rendu au reset
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct OverflowBlock {
+        void *memory;
+        std::size_t bytes;
+        std::size_t alignment;
+    };
+
+    std::unique_ptr<std::byte[]> buffer_;
+    std::size_t capacity_;
+    std::size_t offset_;
+    // Débordements de la frame en cours, libérés (et absorbés) au reset
+    std::vector<OverflowBlock> overflowBlocks_;
+    std::size_t overflowBytes_;
+    std::size_t peakBytes_;
+    std::uint64_t growCount_;
+
+    static void releaseOverflow(const OverflowBlock &block);
+};
+
+// Appelable stocké dans une FrameArena, pour les callbacks qui ne vivent qu'une frame :
+// std::function alloue sur le tas dès que la capture dépasse quelques octets. Le callable
+// est détruit avec l'objet, sa mémoire revient à l'arène au reset (l'objet doit donc
+// être détruit avant).
+template<typename Signature>
+class FrameFunction;
+
+template<typename R, typename... Args>
+class FrameFunction<R(Args...)> {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    FrameFunction() : callable_(nullptr), invoke_(nullptr), destroy_(nullptr) {}
+
+    template<typename F>
+    FrameFunction(FrameArena &arena, F &&function) {
+        using Callable = std::decay_t<F>;
+        void *storage = arena.allocate(sizeof(Callable), alignof(Callable));
+        callable_ = ::new(storage) Callable(std::forward<F>(function));
+        invoke_ = [](void *callable, Args... args) -> R {
+            return (*static_cast<Callable *>(callable))(std::forward<Args>(args)...);
+        };
+        destroy_ = [](void *callable) { static_cast<Callable *>(callable)->~Callable(); };
+    }
+
+    ~FrameFunction() { release(); }
+
+    FrameFunction(const FrameFunction&) = delete;
+    FrameFunction& operator=(const FrameFunction&) = delete;
+
+    FrameFunction(FrameFunction &&other) noexcept
+        : callable_(std::exchange(other.callable_, nullptr)),
+          invoke_(std::exchange(other.invoke_, nullptr)),
+          destroy_(std::exchange(other.destroy_, nullptr)) {
+    }
+
+    FrameFunction& operator=(FrameFunction &&other) noexcept {
+        if (this != &other) {
+            release();
+            callable_ = std::exchange(other.callable_, nullptr);
+            invoke_ = std::exchange(other.invoke_, nullptr);
+            destroy_ = std::exchange(other.destroy_, nullptr);
+        }
+        return *this;
+    }
+
+    // ==================== APPEL ====================
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+    R operator()(Args... args) const {
+        return invoke_(callable_, std::forward<Args>(args)...);
+    }
+
+private:
+    void *callable_;
+    R (*invoke_)(void *, Args...);
+    void (*destroy_)(void *);
+
+    void release() {
+        if (destroy_ != nullptr) {
+            destroy_(callable_);
+        }
+        callable_ = nullptr;
+        invoke_ = nullptr;
+        destroy_ = nullptr;
+    }
+};
+
+// Vérifie qu'une frame en régime établi ne fait aucune allocation sur le tas global
+// (operator new, tous threads confondus). Les premières frames (chargements, caches,
+// capacités des conteneurs) sont tolérées ; ensuite chaque frame qui alloue est signalée.
+// Le comptage remplace l'operator new global : il n'existe qu'avec FRAME_ALLOCATION_ASSERT
+// (option CMake COMPGRAPH_ALLOCATION_ASSERT), qui fait aussi d'une allocation en régime
+// établi une assertion. Sans l'option, le contrôle est inerte et ne compte rien.
+class FrameAllocationCheck {
+public:
+    static constexpr int DEFAULT_WARMUP_FRAMES = 120;
+#ifdef FRAME_ALLOCATION_ASSERT
+    static constexpr bool COUNTING_ENABLED = true;
+#else
+    static constexpr bool COUNTING_ENABLED = false;
+#endif
+
+    // ==================== CONSTRUCTEURS ====================
+    explicit FrameAllocationCheck(int warmupFrames = DEFAULT_WARMUP_FRAMES);
+
+    FrameAllocationCheck(const FrameAllocationCheck&) = delete;
+    FrameAllocationCheck& operator=(const FrameAllocationCheck&) = delete;
+
+    // ==================== FRAMES ====================
+    // Une fois par frame, au même point de la boucle : clôt la frame précédente et
+    // retourne le nombre d'allocations qu'elle a faites
+    std::uint64_t nextFrame();
+    // Changement volontaire (mode de rendu, résolution...) : les frames suivantes repassent en préchauffage
+    void rearm();
+
+    // Allocations globales depuis le démarrage du programme (0 sans FRAME_ALLOCATION_ASSERT)
+    [[nodiscard]] static std::uint64_t getHeapAllocationCount();
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] bool isSteady() const { return framesSinceArm_ > warmupFrames_; }
+    [[nodiscard]] std::uint64_t getLastFrameAllocations() const { return lastFrameAllocations_; }
+    // Frames en régime établi qui ont alloué
+    [[nodiscard]] std::uint64_t getFailedFrameCount() const { return failedFrames_; }
+
+private:
+    // Au-delà, les frames fautives sont comptées sans être écrites sur cerr
+    static constexpr std::uint64_t MAX_REPORTS = 8;
+
+    int warmupFrames_;
+    int framesSinceArm_;
+    std::uint64_t frameStartCount_;
+    std::uint64_t frameNumber_;
+    std::uint64_t lastFrameAllocations_;
+    std::uint64_t failedFrames_;
+};
+
+#endif //FRAME_ARENA_H
@@ -0,0 +1,100 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef FRAME_FENCES_H
+#define FRAME_FENCES_H
+#include "third_party/gl_include.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Frames en vol : le CPU prépare la frame N pendant que le GPU exécute encore les précédentes.
+// Chaque frame reçoit un slot (N % framesInFlight) et pose une fence à la fin de ses commandes ;
+// beginFrame() attend la fence de la dernière frame du même slot avant de le rendre. Les
+// ressources par frame (tranches de FrameRingBuffer) peuvent alors être réécrites sans que
+// le pilote ne bloque au hasard dans un glBufferSubData.
+//
+// framesInFlight borne l'avance du CPU : 1 = aucun recouvrement (latence minimale),
+// 3 = recouvrement maximal (une frame de latence en plus à chaque cran).
+class FrameFences {
+public:
+    static constexpr int MAX_FRAMES_IN_FLIGHT = 3;
+
+    // ==================== CONSTRUCTEURS ====================
+    explicit FrameFences(int framesInFlight = 2);
+    ~FrameFences();
+
+    FrameFences(const FrameFences&) = delete;
+    FrameFences& operator=(const FrameFences&) = delete;
+
+    // ==================== FRAMES ====================
+    // Attend que le GPU ait fini la frame qui utilisait ce slot ; retourne le slot de la frame qui commence
+    int beginFrame();
+    // Après la dernière commande qui lit les ressources du slot
+    void endFrame();
+    // Attend toutes les frames en vol (avant de détruire ou réallouer des ressources partagées)
+    void waitIdle();
+    void cleanup();
+
+    // Les slots changent de période : les frames en vol sont d'abord terminées
+    void setFramesInFlight(int count);
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] int getFramesInFlight() const { return framesInFlight_; }
+    [[nodiscard]] int getFrameSlot() const { return slot_; }
+    [[nodiscard]] std::uint64_t getFrameNumber() const { return frameNumber_; }
+    // Temps passé dans le dernier beginFrame() à attendre le GPU
+    [[nodiscard]] double getLastWaitMs() const { return lastWaitMs_; }
+    // Frames dont le slot n'était pas encore libre (CPU trop en avance)
+    [[nodiscard]] std::uint64_t getStallCount() const { return stallCount_; }
+
+private:
+    std::array<GLsync, MAX_FRAMES_IN_FLIGHT> fences_;
+    int framesInFlight_;
+    int slot_;
+    std::uint64_t frameNumber_;
+    double lastWaitMs_;
+    std::uint64_t stallCount_;
+
+    // false si l'attente a échoué (contexte perdu) : la fence est abandonnée
+    static bool waitFence(GLsync fence);
+};
+
+// Buffer GL découpé en une tranche par slot de FrameFences. write() n'écrit que la tranche
+// du slot courant, sans synchronisation implicite (GL_MAP_UNSYNCHRONIZED_BIT) : c'est la fence
+// du slot qui garantit que le GPU ne la lit plus. Avec une seule tranche, l'écriture reste
+// synchronisée par le pilote (glBufferSubData).
+class FrameRingBuffer {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    FrameRingBuffer();
+    ~FrameRingBuffer();
+
+    FrameRingBuffer(const FrameRingBuffer&) = delete;
+    FrameRingBuffer& operator=(const FrameRingBuffer&) = delete;
+
+    // ==================== CYCLE DE VIE ====================
+    // sliceSize est arrondie à l'alignement d'offset du target (UBO / SSBO)
+    void initialize(GLenum target, std::size_t sliceSize, int sliceCount = FrameFences::MAX_FRAMES_IN_FLIGHT);
+    void cleanup();
+
+    // ==================== ÉCRITURE ====================
+    void write(int slot, const void *data, std::size_t size, std::size_t offset = 0) const;
+    // UBO / SSBO : attache la tranche du slot au point de binding
+    void bindRange(GLuint binding, int slot, std::size_t size) const;
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] GLuint getBuffer() const { return buffer_; }
+    [[nodiscard]] int getSliceCount() const { return sliceCount_; }
+    [[nodiscard]] std::size_t getSliceStride() const { return sliceStride_; }
+    [[nodiscard]] std::size_t getSliceOffset(int slot) const { return static_cast<std::size_t>(slot) * sliceStride_; }
+
+private:
+    GLuint buffer_;
+    GLenum target_;
+    std::size_t sliceStride_;
+    int sliceCount_;
+};
+
+#endif //FRAME_FENCES_H
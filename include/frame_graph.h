@@ -0,0 +1,181 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef FRAME_GRAPH_H
+#define FRAME_GRAPH_H
+#include "frame_arena.h"
+#include "third_party/gl_include.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <vector>
+
+// Description d'une texture de rendu gérée par le graphe
+struct FrameGraphTextureDesc {
+    int width = 0;
+    int height = 0;
+    GLenum internalFormat = GL_RGBA8;
+    GLenum filter = GL_NEAREST;
+
+    bool operator==(const FrameGraphTextureDesc &) const = default;
+};
+
+using FrameGraphResource = int;
+inline constexpr FrameGraphResource INVALID_FRAME_GRAPH_RESOURCE = -1;
+
+// Graphe de frame reconstruit à chaque frame :
+//  - les passes déclarent leurs lectures / écritures dans un setup,
+//  - compile() élimine les passes dont aucune sortie n'est consommée, les ordonne,
+//    et attribue aux ressources transitoires des textures physiques partagées
+//    quand leurs durées de vie ne se chevauchent pas,
+//  - execute() lie un FBO (mis en cache) composé des écritures transitoires de la passe.
+// Les ressources importées (G-Buffer, historiques, backbuffer) restent gérées par leur
+// propriétaire : une passe qui n'écrit que des ressources importées lie son propre framebuffer.
+// Tout ce qui ne vit qu'une frame (noms, listes de lectures / écritures, exécutions, temporaires
+// de compile()) est pris dans l'arène du graphe : reconstruire le graphe n'alloue plus sur le tas.
+class FrameGraph {
+public:
+    class Builder {
+    public:
+        FrameGraphResource create(std::string_view name, const FrameGraphTextureDesc &desc);
+        FrameGraphResource read(FrameGraphResource resource);
+        FrameGraphResource write(FrameGraphResource resource);
+        // Passe conservée même si personne ne lit ses sorties (ombres, UI...)
+        void setSideEffect();
+
+    private:
+        friend class FrameGraph;
+        Builder(FrameGraph &graph, int passIndex) : graph_(graph), passIndex_(passIndex) {}
+
+        FrameGraph &graph_;
+        int passIndex_;
+    };
+
+    class Resources {
+    public:
+        [[nodiscard]] GLuint getTexture(FrameGraphResource resource) const;
+        [[nodiscard]] const FrameGraphTextureDesc &getDesc(FrameGraphResource resource) const;
+
+    private:
+        friend class FrameGraph;
+        explicit Resources(const FrameGraph &graph) : graph_(graph) {}
+
+        const FrameGraph &graph_;
+    };
+
+    using ExecuteFunc = FrameFunction<void(const Resources &)>;
+
+    // ==================== CONSTRUCTEURS ====================
+    FrameGraph();
+    ~FrameGraph();
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    // ==================== CONSTRUCTION ====================
+    // Début de frame : oublie les passes, garde le pool de textures et les FBOs
+    void reset();
+
+    FrameGraphResource importTexture(std::string_view name, GLuint texture, const FrameGraphTextureDesc &desc);
+    // Framebuffer par défaut : écrire dedans rend la passe obligatoire
+    FrameGraphResource importBackbuffer(std::string_view name, int width, int height);
+
+    // Le setup déclare les ressources puis retourne l'exécution (qui capture les handles obtenus)
+    template<typename Setup>
+    void addPass(std::string_view name, Setup &&setup) {
+        const int passIndex = beginPass(name);
+        Builder builder(*this, passIndex);
+        // passes_ peut être réalloué pendant le setup : accès par index
+        auto execute = setup(builder);
+        passes_[passIndex].execute = ExecuteFunc(arena_, std::move(execute));
+    }
+
+    // ==================== COMPILATION / EXÉCUTION ====================
+    bool compile();
+    void execute();
+
+    // ==================== STATISTIQUES ====================
+    [[nodiscard]] int getPassCount() const { return static_cast<int>(passes_.size()); }
+    [[nodiscard]] int getCulledPassCount() const { return culledPassCount_; }
+    [[nodiscard]] int getTransientResourceCount() const;
+    [[nodiscard]] int getPhysicalTextureCount() const { return static_cast<int>(pool_.size()); }
+    // Mémoire réellement allouée par le pool vs. une texture par ressource transitoire
+    [[nodiscard]] std::size_t getPhysicalMemoryBytes() const;
+    [[nodiscard]] std::size_t getVirtualMemoryBytes() const;
+    [[nodiscard]] const FrameArena &getArena() const { return arena_; }
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+private:
+    // Couleurs puis profondeur ; 0 pour les attachements absents
+    static constexpr int MAX_COLOR_ATTACHMENTS = 8;
+    using AttachmentKey = std::array<GLuint, MAX_COLOR_ATTACHMENTS + 1>;
+
+    struct ResourceNode {
+        std::string_view name;  // dans arena_
+        FrameGraphTextureDesc desc;
+        bool imported;
+        bool backbuffer;
+        GLuint importedTexture;
+        int physical;       // index dans pool_ (transitoire seulement)
+        int refCount;       // lecteurs non éliminés
+        int firstUse;       // positions dans order_
+        int lastUse;
+        std::pmr::vector<int> writers;
+    };
+
+    struct PassNode {
+        std::string_view name;
+        ExecuteFunc execute;
+        std::pmr::vector<FrameGraphResource> reads;
+        std::pmr::vector<FrameGraphResource> writes;
+        bool sideEffect;
+        bool culled;
+        int refCount;
+    };
+
+    struct PhysicalTexture {
+        FrameGraphTextureDesc desc;
+        GLuint texture;
+        std::uint64_t lastUsedFrame;
+    };
+
+    // ==================== DONNÉES ====================
+    // Déclaré en premier : détruit après les nœuds qui y pointent
+    FrameArena arena_;
+    // Les vecteurs gardent leur capacité d'une frame à l'autre, leurs éléments vivent dans arena_
+    std::vector<ResourceNode> resources_;
+    std::vector<PassNode> passes_;
+    std::vector<int> order_;
+    std::vector<PhysicalTexture> pool_;
+    std::map<AttachmentKey, GLuint> framebuffers_;
+    std::uint64_t frameIndex_;
+    int culledPassCount_;
+    bool compiled_;
+
+    // Textures du pool inutilisées depuis ce nombre de frames : libérées
+    static constexpr std::uint64_t POOL_EVICTION_FRAMES = 120;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    // Ajoute le nœud de la passe, retourne son index
+    int beginPass(std::string_view name);
+    void cullPasses();
+    bool sortPasses();
+    void computeLifetimes();
+    void assignPhysicalTextures();
+    void evictUnusedTextures();
+
+    int acquirePhysical(const FrameGraphTextureDesc &desc, std::pmr::vector<bool> &busy);
+    GLuint getFramebuffer(const AttachmentKey &attachments, int colorCount);
+    void bindPassTargets(const PassNode &pass);
+
+    static GLuint createTexture(const FrameGraphTextureDesc &desc);
+    static bool isDepthFormat(GLenum internalFormat);
+    static std::size_t bytesPerPixel(GLenum internalFormat);
+};
+
+#endif //FRAME_GRAPH_H
@@ -0,0 +1,77 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Compteur de jobs : incrémenté à la soumission, décrémenté à la fin de chaque job.
+// Un job peut soumettre ses enfants sur le compteur de son parent : le compteur ne revient
+// à 0 qu'une fois toute la descendance terminée.
+class JobCounter {
+public:
+    JobCounter() : pending_(0) {}
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    [[nodiscard]] bool isDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+    [[nodiscard]] std::uint32_t getPending() const { return pending_.load(std::memory_order_relaxed); }
+
+private:
+    friend class JobSystem;
+    std::atomic<std::uint32_t> pending_;
+};
+
+// Système de jobs du moteur : un worker par cœur, chacun avec sa file.
+// Le propriétaire d'une file prend ses jobs par la fin (LIFO, données encore chaudes en cache),
+// un worker inoccupé vole les autres par le début (FIFO, les plus gros morceaux restants).
+//
+// Le thread qui appelle initialize() devient le thread principal (celui du contexte GL) :
+// il a aussi sa file, et il est le seul à exécuter les tâches runOnMainThread().
+// Sans initialize(), tout s'exécute immédiatement sur le thread appelant.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+    using RangeJob = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // ==================== CYCLE DE VIE ====================
+    // workerCount 0 : un worker par cœur, moins le thread principal
+    static void initialize(unsigned workerCount = 0);
+    // Termine les jobs en attente puis arrête les workers
+    static void shutdown();
+
+    [[nodiscard]] static bool isInitialized();
+    [[nodiscard]] static unsigned getWorkerCount();
+    // 0 : thread principal, 1..N : workers, -1 : autre thread
+    [[nodiscard]] static int getThreadIndex();
+    [[nodiscard]] static bool isMainThread();
+
+    // ==================== JOBS ====================
+    // Une capture plus grande que le stockage interne de std::function (deux pointeurs
+    // en libstdc++) alloue sur le tas à chaque soumission
+    static void run(Job job, JobCounter *counter = nullptr);
+    // Attente active : exécute d'autres jobs (et, sur le thread principal, ses tâches)
+    // au lieu de bloquer le cœur
+    static void wait(const JobCounter &counter);
+    // Découpe [begin, end) en tranches d'au moins grainSize, la première sur le thread appelant ;
+    // retourne quand tout est traité
+    static void parallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const RangeJob &body);
+
+    // ==================== THREAD PRINCIPAL ====================
+    // Pour le travail GL : exécuté par executeMainThreadTasks() ou pendant un wait() du thread principal
+    static void runOnMainThread(Job job, JobCounter *counter = nullptr);
+    // À appeler chaque frame depuis le thread principal ; retourne le nombre de tâches exécutées
+    static std::size_t executeMainThreadTasks();
+
+private:
+    static bool tryExecuteOne(int threadIndex);
+    static void complete(JobCounter *counter);
+    static void workerLoop(int threadIndex);
+};
+
+#endif //JOB_SYSTEM_H
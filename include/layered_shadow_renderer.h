@@ -0,0 +1,110 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef LAYERED_SHADOW_RENDERER_H
+#define LAYERED_SHADOW_RENDERER_H
+#include "third_party/gl_include.h"
+#include <array>
+#include <string>
+#include <vector>
+
+// Rendu d'ombres en une seule soumission pour N vues (cascades ou faces de cube).
+// Chaque caster est soumis une fois, via son VBO d'instances existant ou avec sa matrice
+// modèle en uniform (listes de commandes) ; la couche cible est choisie :
+//  - dans le vertex shader (gl_Layer, ARB_shader_viewport_layer_array) : instances x N, divisor = N
+//  - sinon dans un geometry shader instancié (une invocation par couche)
+class LayeredShadowRenderer {
+public:
+    static constexpr int MAX_LAYERS = 6;
+
+    // ==================== CONSTRUCTEURS ====================
+    LayeredShadowRenderer();
+    ~LayeredShadowRenderer();
+
+    LayeredShadowRenderer(const LayeredShadowRenderer&) = delete;
+    LayeredShadowRenderer& operator=(const LayeredShadowRenderer&) = delete;
+
+    // ==================== INITIALISATION ====================
+    void initialize();
+
+    // Cible propre (texture array de profondeur, une couche par vue)
+    bool createTarget(int width, int height, int layerCount);
+
+    // ==================== RENDU ====================
+    void setLayerMatrices(const float *viewProjMatrices, int layerCount);
+
+    // Le viewport (depuis l'origine) vaut pour toutes les couches : une vue plus petite que la cible
+    // n'en utilise que le coin
+    void beginTargetPass(int viewportWidth, int viewportHeight) const;
+
+    void endTargetPass() const;
+
+    // Active le programme pour un VBO d'instances (mat4) à la location donnée.
+    // Retourne le multiplicateur d'instances à appliquer (N en mode vertex layer, 1 sinon).
+    int bindProgram(GLuint instanceLocation);
+
+    void drawInstanced(GLuint vao, GLsizei indexCount, GLsizei instanceCount, GLuint instanceLocation);
+
+    // Variante sans VBO d'instances : la matrice modèle est l'uniform "model", posé par draw.
+    // Retourne le nombre d'instances de chaque draw (N en mode vertex layer, 1 sinon), 0 en cas d'échec.
+    int bindModelProgram();
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] GLuint getDepthTextureArray() const { return depthTextureArray_; }
+    [[nodiscard]] int getLayerCount() const { return layerCount_; }
+    [[nodiscard]] int getWidth() const { return width_; }
+    [[nodiscard]] int getHeight() const { return height_; }
+    // Programme lié par le dernier bindProgram() / bindModelProgram()
+    [[nodiscard]] GLuint getBoundProgram() const { return boundProgram_; }
+    // Programme et uniform de bindModelProgram()
+    [[nodiscard]] GLuint getModelProgram() const { return modelProgram_; }
+    [[nodiscard]] GLint getModelMatrixLocation() const { return modelMatrixLocation_; }
+    [[nodiscard]] bool usesVertexLayer() const { return vertexLayerSupported_; }
+    [[nodiscard]] int getInstanceMultiplier() const { return vertexLayerSupported_ ? layerCount_ : 1; }
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+private:
+    // Clé du programme à matrice modèle en uniform (aucune location d'instances)
+    static constexpr GLuint UNIFORM_MODEL = ~0u;
+
+    struct LayeredProgram {
+        GLuint instanceLocation;
+        GLuint program;
+        GLint layerViewProjLoc;
+        GLint layerCountLoc;
+        GLint modelLoc;
+    };
+
+    // ==================== RESSOURCES OPENGL ====================
+    GLuint framebuffer_;
+    GLuint depthTextureArray_;
+    int width_;
+    int height_;
+    std::vector<LayeredProgram> programs_;
+    GLuint modelProgram_;
+    GLuint boundProgram_;
+    GLint modelMatrixLocation_;
+
+    // ==================== VUES ====================
+    std::array<float, 16 * MAX_LAYERS> layerMatrices_;
+    int layerCount_;
+    bool vertexLayerSupported_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    LayeredProgram *getProgram(GLuint instanceLocation);
+
+    [[nodiscard]] GLuint createProgram(GLuint instanceLocation) const;
+
+    static bool hasExtension(const char *name);
+
+    // ==================== SHADERS ====================
+    static std::string getVertexLayerShader();
+    static std::string getPassThroughVertexShader();
+    static std::string getLayerGeometryShader();
+    static std::string getFragmentShader();
+};
+
+#endif //LAYERED_SHADOW_RENDERER_H
@@ -0,0 +1,333 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef LIGHT_BUFFER_H
+#define LIGHT_BUFFER_H
+#include "third_party/gl_include.h"
+#include "slot_map.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// ==================== TYPES STD430 ====================
+// Chaque lumière est une suite de vec4 : en std430 un vec3 suivi d'un float occupe 16 octets,
+// la struct C++ a donc exactement le layout du tableau GLSL et part telle quelle dans le SSBO
+template<typename GpuLight>
+consteval bool isStd430Light() {
+    return std::is_standard_layout_v<GpuLight> &&
+           std::is_trivially_copyable_v<GpuLight> &&
+           alignof(GpuLight) == 16 &&
+           sizeof(GpuLight) % 16 == 0;
+}
+
+// Points de binding SSBO ; ConvolutionEngine utilise 2
+static constexpr GLuint DIRECTIONAL_LIGHT_BUFFER_BINDING = 4;
+static constexpr GLuint POINT_LIGHT_BUFFER_BINDING = 5;
+static constexpr GLuint SPOT_LIGHT_BUFFER_BINDING = 6;
+static constexpr GLuint SHADOW_FACE_BUFFER_BINDING = 7;
+
+// En-tête du SSBO : le nombre de lumières, puis le tableau à l'offset 16
+struct alignas(16) GpuLightHeader {
+    std::uint32_t count;
+    std::uint32_t padding[3];
+};
+
+struct alignas(16) GpuDirectionalLight {
+    float direction[3];
+    float intensity;
+    float color[3];
+    std::uint32_t enabled;
+
+    static constexpr GLuint BINDING = DIRECTIONAL_LIGHT_BUFFER_BINDING;
+    static constexpr const char *GLSL = R"(
+struct DirectionalLightData {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    uint enabled;
+};
+layout(std430, binding = 4) readonly buffer DirectionalLightBuffer {
+    uint uDirectionalLightCount;
+    DirectionalLightData uDirectionalLights[];
+};
+)";
+};
+
+struct alignas(16) GpuPointLight {
+    float position[3];
+    float radius;
+    float color[3];
+    float intensity;
+    float attenuation[3];           // constant, linear, quadratic
+    std::uint32_t enabled;
+    std::int32_t shadowFace;        // première des 6 faces dans uShadowFaces, -1 sans ombre
+    float padding[3];
+
+    static constexpr GLuint BINDING = POINT_LIGHT_BUFFER_BINDING;
+    static constexpr const char *GLSL = R"(
+struct PointLightData {
+    vec3 position;
+    float radius;
+    vec3 color;
+    float intensity;
+    vec3 attenuation;
+    uint enabled;
+    int shadowFace;
+};
+layout(std430, binding = 5) readonly buffer PointLightBuffer {
+    uint uPointLightCount;
+    PointLightData uPointLights[];
+};
+)";
+};
+
+struct alignas(16) GpuSpotLight {
+    float position[3];
+    float cosCutOff;                // cos de l'angle intérieur (déjà converti des degrés)
+    float direction[3];
+    float cosOuterCutOff;
+    float color[3];
+    float intensity;
+    float attenuation[3];           // constant, linear, quadratic
+    std::uint32_t enabled;
+    std::int32_t shadowFace;        // face dans uShadowFaces, -1 sans ombre
+    float padding[3];
+
+    static constexpr GLuint BINDING = SPOT_LIGHT_BUFFER_BINDING;
+    static constexpr const char *GLSL = R"(
+struct SpotLightData {
+    vec3 position;
+    float cosCutOff;
+    vec3 direction;
+    float cosOuterCutOff;
+    vec3 color;
+    float intensity;
+    vec3 attenuation;
+    uint enabled;
+    int shadowFace;
+};
+layout(std430, binding = 6) readonly buffer SpotLightBuffer {
+    uint uSpotLightCount;
+    SpotLightData uSpotLights[];
+};
+)";
+};
+
+// Une vue d'ombre d'une lumière locale dans l'atlas (face de cube ou tuile de spot)
+struct alignas(16) GpuShadowFace {
+    float viewProj[16];
+    float tileTransform[4];         // (scaleX, scaleY, offsetX, offsetY) : UV de la vue -> UV de l'atlas
+
+    static constexpr GLuint BINDING = SHADOW_FACE_BUFFER_BINDING;
+    static constexpr const char *GLSL = R"(
+struct ShadowFaceData {
+    mat4 viewProj;
+    vec4 tileTransform;
+};
+layout(std430, binding = 7) readonly buffer ShadowFaceBuffer {
+    uint uShadowFaceCount;
+    ShadowFaceData uShadowFaces[];
+};
+)";
+};
+
+static_assert(isStd430Light<GpuDirectionalLight>());
+static_assert(sizeof(GpuDirectionalLight) == 32);
+static_assert(isStd430Light<GpuPointLight>());
+static_assert(offsetof(GpuPointLight, color) == 16);
+static_assert(offsetof(GpuPointLight, attenuation) == 32);
+static_assert(offsetof(GpuPointLight, shadowFace) == 48);
+static_assert(sizeof(GpuPointLight) == 64);
+static_assert(isStd430Light<GpuSpotLight>());
+static_assert(offsetof(GpuSpotLight, direction) == 16);
+static_assert(offsetof(GpuSpotLight, color) == 32);
+static_assert(offsetof(GpuSpotLight, attenuation) == 48);
+static_assert(offsetof(GpuSpotLight, shadowFace) == 64);
+static_assert(sizeof(GpuSpotLight) == 80);
+static_assert(isStd430Light<GpuShadowFace>());
+static_assert(sizeof(GpuShadowFace) == 80);
+static_assert(sizeof(GpuLightHeader) == 16);
+
+// Déclarations GLSL des trois tableaux et des faces d'ombre (GLSL 4.30), à passer en "defines" à ProgramCache
+inline std::string getLightBuffersGLSL() {
+    return std::string(GpuDirectionalLight::GLSL) + GpuPointLight::GLSL + GpuSpotLight::GLSL +
+           GpuShadowFace::GLSL;
+}
+
+// ==================== TABLEAU ====================
+// Lumières d'un type, rangées de façon contiguë dans l'ordre exact du SSBO.
+// Chaque modification marque l'élément dans un masque de bits ; upload() n'envoie ensuite
+// que les plages modifiées (les mots nuls du masque sont sautés d'un coup).
+// Une suppression est un swap-and-pop : seul l'emplacement rempli par la dernière lumière change.
+template<typename GpuLight>
+class PackedLightArray {
+    static_assert(isStd430Light<GpuLight>(), "La lumière doit respecter le layout std430");
+
+public:
+    // ==================== CONSTRUCTEURS ====================
+    PackedLightArray() : buffer_(0), capacity_(0), countDirty_(true), lastUploadBytes_(0) {}
+    ~PackedLightArray() { cleanup(); }
+
+    PackedLightArray(const PackedLightArray&) = delete;
+    PackedLightArray& operator=(const PackedLightArray&) = delete;
+
+    // ==================== LUMIÈRES ====================
+    SlotHandle insert(const GpuLight &light) {
+        values_.push_back(light);
+        markDirty(values_.size() - 1);
+        countDirty_ = true;
+        return index_.insert();
+    }
+
+    bool update(SlotHandle handle, const GpuLight &light) {
+        const int index = index_.indexOf(handle);
+        if (index < 0) {
+            return false;
+        }
+        values_[index] = light;
+        markDirty(index);
+        return true;
+    }
+
+    bool erase(SlotHandle handle) {
+        const int index = index_.erase(handle);
+        if (index < 0) {
+            return false;
+        }
+        const std::size_t last = values_.size() - 1;
+        if (static_cast<std::size_t>(index) != last) {
+            values_[index] = values_[last];
+            markDirty(index);
+        }
+        values_.pop_back();
+        // Au-delà du compteur, le contenu du SSBO n'est plus lu
+        dirtyBits_[last / 64] &= ~(std::uint64_t{1} << (last % 64));
+        countDirty_ = true;
+        return true;
+    }
+
+    void reserve(std::size_t capacity) {
+        values_.reserve(capacity);
+        index_.reserve(capacity);
+        dirtyBits_.reserve((capacity + 63) / 64);
+    }
+
+    void clear() {
+        values_.clear();
+        index_.clear();
+        dirtyBits_.clear();
+        countDirty_ = true;
+    }
+
+    [[nodiscard]] const GpuLight *get(SlotHandle handle) const {
+        const int index = index_.indexOf(handle);
+        return index >= 0 ? &values_[index] : nullptr;
+    }
+
+    [[nodiscard]] int size() const { return static_cast<int>(values_.size()); }
+    [[nodiscard]] const GpuLight *data() const { return values_.data(); }
+
+    // ==================== GPU ====================
+    // Crée ou agrandit le SSBO si besoin (tout est alors renvoyé), sinon n'envoie que les plages sales
+    void upload() {
+        lastUploadBytes_ = 0;
+        if (buffer_ == 0) {
+            glGenBuffers(1, &buffer_);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_);
+
+        if (buffer_ != 0 && (capacity_ == 0 || values_.size() > capacity_)) {
+            capacity_ = std::max<std::size_t>({64, values_.size(), capacity_ * 2});
+            glBufferData(GL_SHADER_STORAGE_BUFFER,
+                         static_cast<GLsizeiptr>(sizeof(GpuLightHeader) + capacity_ * sizeof(GpuLight)),
+                         nullptr, GL_DYNAMIC_DRAW);
+            countDirty_ = true;
+            for (std::size_t i = 0; i < values_.size(); ++i) {
+                markDirty(i);
+            }
+        }
+
+        if (countDirty_) {
+            const GpuLightHeader header{static_cast<std::uint32_t>(values_.size()), {0, 0, 0}};
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), &header);
+            lastUploadBytes_ += sizeof(header);
+            countDirty_ = false;
+        }
+
+        const std::size_t count = values_.size();
+        for (std::size_t begin = nextDirty(0); begin < count;) {
+            std::size_t end = begin + 1;
+            while (end < count && isDirty(end)) {
+                ++end;
+            }
+            const std::size_t bytes = (end - begin) * sizeof(GpuLight);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                            static_cast<GLintptr>(sizeof(GpuLightHeader) + begin * sizeof(GpuLight)),
+                            static_cast<GLsizeiptr>(bytes), &values_[begin]);
+            lastUploadBytes_ += bytes;
+            begin = nextDirty(end);
+        }
+        std::fill(dirtyBits_.begin(), dirtyBits_.end(), 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    void bind() const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GpuLight::BINDING, buffer_);
+    }
+
+    void cleanup() {
+        if (buffer_ != 0) {
+            glDeleteBuffers(1, &buffer_);
+            buffer_ = 0;
+        }
+        capacity_ = 0;
+        countDirty_ = true;
+    }
+
+    [[nodiscard]] GLuint getBuffer() const { return buffer_; }
+    // Octets envoyés par le dernier upload()
+    [[nodiscard]] std::size_t getLastUploadBytes() const { return lastUploadBytes_; }
+
+private:
+    std::vector<GpuLight> values_;
+    SlotIndex index_;
+    std::vector<std::uint64_t> dirtyBits_;
+    GLuint buffer_;
+    std::size_t capacity_;
+    bool countDirty_;
+    std::size_t lastUploadBytes_;
+
+    void markDirty(std::size_t index) {
+        if (dirtyBits_.size() <= index / 64) {
+            dirtyBits_.resize(index / 64 + 1, 0);
+        }
+        dirtyBits_[index / 64] |= std::uint64_t{1} << (index % 64);
+    }
+
+    [[nodiscard]] bool isDirty(std::size_t index) const {
+        return (dirtyBits_[index / 64] >> (index % 64) & 1) != 0;
+    }
+
+    // Premier indice sale à partir de index (values_.size() si aucun)
+    [[nodiscard]] std::size_t nextDirty(std::size_t index) const {
+        std::size_t word = index / 64;
+        if (word >= dirtyBits_.size()) {
+            return values_.size();
+        }
+        std::uint64_t bits = dirtyBits_[word] & (~std::uint64_t{0} << (index % 64));
+        while (bits == 0) {
+            if (++word >= dirtyBits_.size()) {
+                return values_.size();
+            }
+            bits = dirtyBits_[word];
+        }
+        return std::min(values_.size(), word * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+    }
+};
+
+#endif //LIGHT_BUFFER_H
@@ -6,7 +6,11 @@
 #define LIGHT_MANAGER_H
 #include "maths/vec3.h"
 #include "third_party/gl_include.h"
+#include "light_buffer.h"
+#include "shadow_atlas.h"
+#include "slot_map.h"
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -17,6 +21,13 @@ enum class LightType {
     SPOT
 };
 
+// Filtrage des ombres : comparaison simple ou moments filtrables (variance / exponentielle)
+enum class ShadowFilterMode {
+    HARD,
+    VSM,
+    EVSM
+};
+
 struct Light {
     core::Vec3F position;
     core::Vec3F direction;
@@ -78,6 +89,16 @@ struct SpotLight : public Light {
     }
 };
 
+using LightHandle = SlotHandle;
+
+// Les lumières sont désignées par des handles générationnels : removeLight() est en O(1)
+// et un handle conservé ne désigne jamais une autre lumière. Les Light restent allouées
+// individuellement, leur adresse sert d'identité à l'atlas d'ombres.
+//
+// Chaque lumière a aussi sa copie GPU dans le tableau std430 de son type (PackedLightArray) ;
+// uploadLightBuffers() n'envoie que les lumières ajoutées ou modifiées depuis l'envoi précédent.
+// Les point/spot lights ombrées y portent l'indice de leur première vue dans le tableau des faces
+// d'ombre (matrice + tuile de l'atlas), tenu à jour par updateShadowAtlas().
 class LightManager {
 public:
     // ==================== CONSTRUCTEURS ====================
@@ -96,36 +117,70 @@ public:
     void initializeShadowMapping(int shadowMapWidth = 2048, int shadowMapHeight = 2048);
 
     // ==================== GESTION DES LUMIÈRES ====================
-    int addDirectionalLight(const DirectionalLight &light);
+    LightHandle addDirectionalLight(const DirectionalLight &light);
 
-    int addPointLight(const PointLight& light);
+    LightHandle addPointLight(const PointLight& light);
 
 
-    int addSpotLight(const SpotLight &light);
+    LightHandle addSpotLight(const SpotLight &light);
 
-    void removeLight(int index);
+    void removeLight(LightHandle handle);
 
-    void updateLight(int index, const Light &light) const;
+    // Champs communs (position, direction, couleur, intensité, état)
+    void updateLight(LightHandle handle, const Light &light);
 
-    Light *getLight(int index);
+    // À appeler après avoir modifié une lumière via getLight()
+    void markLightDirty(LightHandle handle);
 
-    [[nodiscard]] const Light *getLight(int index) const;
+    Light *getLight(LightHandle handle);
+
+    [[nodiscard]] const Light *getLight(LightHandle handle) const;
 
     [[nodiscard]] int getLightCount() const { return lights_.size(); }
 
+    // Parcours : index dans [0, getLightCount()), ordre non conservé après une suppression
+    [[nodiscard]] LightHandle getLightHandle(int index) const { return lights_.handleAt(index); }
+
+    // ==================== GESTION PAR LOTS ====================
+    // outHandles (optionnel) reçoit count handles
+    void addPointLights(const PointLight *lights, std::size_t count, LightHandle *outHandles = nullptr);
+
+    void addSpotLights(const SpotLight *lights, std::size_t count, LightHandle *outHandles = nullptr);
+
+    // Remplace entièrement les lumières désignées (handle d'un autre type ignoré)
+    void updatePointLights(const LightHandle *handles, const PointLight *lights, std::size_t count);
+
+    void updateSpotLights(const LightHandle *handles, const SpotLight *lights, std::size_t count);
+
+    void reserveLights(std::size_t pointCount, std::size_t spotCount);
+
+    // ==================== BUFFERS GPU (STD430) ====================
+    // Une fois par frame, avant les passes qui lisent les lumières
+    void uploadLightBuffers();
+
+    // Lumières et faces d'ombre (bindings 4 à 7)
+    void bindLightBuffers() const;
+
+    [[nodiscard]] const PackedLightArray<GpuPointLight> &getPointLightBuffer() const { return pointBuffer_; }
+    [[nodiscard]] const PackedLightArray<GpuSpotLight> &getSpotLightBuffer() const { return spotBuffer_; }
+    [[nodiscard]] const PackedLightArray<GpuDirectionalLight> &getDirectionalLightBuffer() const {
+        return directionalBuffer_;
+    }
+
     // ==================== LUMIÈRE DIRECTIONNELLE PRINCIPALE ====================
-    void setMainDirectionalLight(int index);
+    void setMainDirectionalLight(LightHandle handle);
 
-    [[nodiscard]] int getMainDirectionalLightIndex() const { return mainLightIndex_; }
+    [[nodiscard]] LightHandle getMainDirectionalLightHandle() const { return mainLight_; }
 
     Light *getMainDirectionalLight();
 
     [[nodiscard]] const Light *getMainDirectionalLight() const;
 
     // ==================== MATRICES DE LUMIÈRE ====================
+    // Handle nul : lumière principale
     void calculateLightMatrices(const core::Vec3F &sceneCenter,
                                 float sceneRadius,
-                                int lightIndex = -1);
+                                LightHandle handle = {});
 
     void getLightProjectionMatrix(float *out) const;
 
@@ -138,7 +193,7 @@ public:
     [[nodiscard]] const core::Vec3F &getMainLightDirection() const;
 
     // ==================== SHADOW MAPPING ====================
-    void bindShadowFramebuffer() const;
+    void bindShadowFramebuffer(bool clear = true) const;
 
     void unbindShadowFramebuffer() const;
 
@@ -152,13 +207,65 @@ public:
     void setShadowViewDistance(float distance) { shadowViewDistance_ = distance; }
     [[nodiscard]] float getShadowViewDistance() const { return shadowViewDistance_; }
 
+    // ==================== FILTRAGE DES OMBRES (VSM / EVSM) ====================
+    void setShadowFilterMode(ShadowFilterMode mode);
+    [[nodiscard]] ShadowFilterMode getShadowFilterMode() const { return shadowFilterMode_; }
+    // Coupe la queue de Chebyshev : 0 = aucune réduction, ~0.2-0.4 supprime la plupart des fuites
+    void setLightBleedingReduction(float amount) { lightBleedingReduction_ = amount; }
+    [[nodiscard]] float getLightBleedingReduction() const { return lightBleedingReduction_; }
+    void setEVSMExponents(float positive, float negative) {
+        evsmPositiveExponent_ = positive;
+        evsmNegativeExponent_ = negative;
+    }
+    [[nodiscard]] float getEVSMPositiveExponent() const { return evsmPositiveExponent_; }
+    [[nodiscard]] float getEVSMNegativeExponent() const { return evsmNegativeExponent_; }
+    void setShadowBlurRadius(int radius) { shadowBlurRadius_ = radius; }
+    [[nodiscard]] int getShadowBlurRadius() const { return shadowBlurRadius_; }
+
+    void bindShadowMomentsFramebuffer() const;
+
+    void bindShadowBlurFramebuffer() const;
+
+    [[nodiscard]] GLuint getShadowMomentsTexture() const { return shadowMomentsTexture_; }
+    [[nodiscard]] GLuint getShadowBlurTexture() const { return shadowBlurTexture_; }
+
+    // ==================== ATLAS D'OMBRES (POINT / SPOT) ====================
+    void initializeShadowAtlas(int atlasSize = 4096, int minTileSize = 128, int maxTileSize = 1024);
+
+    // Réattribue les tuiles puis renvoie les faces d'ombre et les lumières dont la face a changé
+    void updateShadowAtlas(const core::Vec3F &cameraPosition, float cameraFovY,
+                           int screenHeight, std::uint64_t sceneVersion);
+
+    [[nodiscard]] int getShadowFaceCount() const { return static_cast<int>(shadowFaces_.size()); }
+
+    ShadowAtlas &getShadowAtlas() { return shadowAtlas_; }
+    [[nodiscard]] const ShadowAtlas &getShadowAtlas() const { return shadowAtlas_; }
+
     // ==================== NETTOYAGE ====================
     void cleanup();
 
 private:
     // ==================== DONNÉES DES LUMIÈRES ====================
-    std::vector<std::unique_ptr<Light> > lights_;
-    int mainLightIndex_;
+    // packed : handle de la copie GPU dans le tableau du type de la lumière
+    // shadowFace : première face d'ombre dans shadowFaces_, -1 sans tuile
+    struct LightRecord {
+        std::unique_ptr<Light> light;
+        SlotHandle packed;
+        int shadowFace = -1;
+    };
+
+    SlotMap<LightRecord> lights_;
+    LightHandle mainLight_;
+
+    // ==================== COPIES GPU ====================
+    PackedLightArray<GpuDirectionalLight> directionalBuffer_;
+    PackedLightArray<GpuPointLight> pointBuffer_;
+    PackedLightArray<GpuSpotLight> spotBuffer_;
+    // Vues des entrées ombrées de l'atlas, dans l'ordre de l'atlas
+    std::vector<GpuShadowFace> shadowFaces_;
+    GLuint shadowFaceBuffer_;
+    std::size_t shadowFaceBufferBytes_;
+    bool shadowFacesDirty_;
 
     // ==================== MATRICES DE LUMIÈRE ====================
     std::array<float, 16> lightProjectionMatrix_;
@@ -172,6 +279,18 @@ private:
     int shadowMapHeight_;
     float shadowViewDistance_;
     bool shadowMappingEnabled_;
+    ShadowAtlas shadowAtlas_;
+
+    // ==================== RESSOURCES VSM / EVSM ====================
+    ShadowFilterMode shadowFilterMode_;
+    GLuint shadowMomentsFramebuffer_;
+    GLuint shadowMomentsTexture_;
+    GLuint shadowBlurFramebuffer_;
+    GLuint shadowBlurTexture_;
+    float lightBleedingReduction_;
+    float evsmPositiveExponent_;
+    float evsmNegativeExponent_;
+    int shadowBlurRadius_;
 
     // ==================== PARAMÈTRES D'ÉCRAN ====================
     int screenWidth_;
@@ -180,17 +299,15 @@ private:
     // ==================== MÉTHODES PRIVÉES ====================
     void createShadowResources();
 
-    static void multiplyMat4(float *out, const float *a, const float *b);
+    void createMomentsResources();
+
+    void deleteMomentsResources();
+
+    void repackLight(const LightRecord &record);
 
-    static void orthographicMatrix(float *out,
-                                   float left, float right,
-                                   float bottom, float top,
-                                   float near, float far);
+    void updateShadowFaces();
 
-    static void lookAtMatrix(float *out,
-                             const core::Vec3F &eye,
-                             const core::Vec3F &center,
-                             const core::Vec3F &up);
+    void uploadShadowFaces();
 };
 
 #endif //LIGHT_MANAGER_H
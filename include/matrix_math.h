@@ -0,0 +1,73 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef MATRIX_MATH_H
+#define MATRIX_MATH_H
+#include "maths/vec3.h"
+#include <cstddef>
+
+// Boîte englobante alignée sur les axes
+struct Aabb {
+    float min[3];
+    float max[3];
+};
+
+// Noyaux de calcul matriciel partagés par tous les renderers (remplacent les multiplyMat4 /
+// lookAtMatrix / perspectiveMatrix recopiés dans chaque classe).
+//
+// Convention : matrices 4x4 de float en column-major (OpenGL), m[colonne * 4 + ligne].
+// multiply(out, a, b) calcule out = a * b ; out peut désigner a ou b.
+//
+// Les noyaux SSE et AVX2 sont choisis à l'exécution selon le processeur (scalaire hors x86) ;
+// setInstructionSet() permet de forcer un niveau inférieur pour comparer.
+class MatrixMath {
+public:
+    enum class InstructionSet {
+        Scalar,
+        SSE,
+        AVX2
+    };
+
+    // ==================== DISPATCH ====================
+    [[nodiscard]] static InstructionSet getInstructionSet();
+    // Meilleur niveau supporté par le processeur
+    [[nodiscard]] static InstructionSet getSupportedInstructionSet();
+    // Ramené au niveau supporté si besoin
+    static void setInstructionSet(InstructionSet set);
+    [[nodiscard]] static const char *getInstructionSetName(InstructionSet set);
+
+    // ==================== CONSTRUCTION ====================
+    static void identity(float *out);
+    static void translation(float *out, float x, float y, float z);
+    static void scaling(float *out, float x, float y, float z);
+    // Forme fermée de T * Rz * Ry * Rx * S (angles en radians), sans aucun produit matriciel
+    static void composeTRS(float *out, const core::Vec3F &position, const core::Vec3F &rotation,
+                           const core::Vec3F &scale);
+
+    // ==================== CAMÉRA ====================
+    static void lookAt(float *out, const core::Vec3F &eye, const core::Vec3F &center, const core::Vec3F &up);
+    // fov vertical en degrés
+    static void perspective(float *out, float fov, float aspect, float near, float far);
+    static void orthographic(float *out, float left, float right, float bottom, float top, float near,
+                             float far);
+
+    // ==================== OPÉRATIONS ====================
+    static void multiply(float *out, const float *a, const float *b);
+    static void transpose(float *out, const float *m);
+    // Inverse générale ; retourne false (out = identité) si la matrice est singulière
+    static bool inverse(float *out, const float *m);
+    // transpose(inverse(m)) : matrice des normales pour un modèle avec échelle non uniforme
+    static bool inverseTranspose(float *out, const float *m);
+
+    // ==================== LOTS ====================
+    // out[i] = m * in[i] pour count matrices contiguës (16 floats chacune)
+    static void multiplyBatch(float *out, const float *m, const float *in, std::size_t count);
+    // Points xyz contigus (3 floats chacun), w = 1 ; out peut désigner in
+    static void transformPoints(float *out, const float *m, const float *in, std::size_t count);
+    // outBounds[i] = AABB monde de localBounds[i] transformée par matrices[i] (méthode d'Arvo)
+    static void transformAabbs(Aabb *outBounds, const float *matrices, const Aabb *localBounds,
+                               std::size_t count);
+};
+
+#endif //MATRIX_MATH_H
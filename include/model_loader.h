@@ -4,6 +4,8 @@
 #pragma once
 
 
+#include <array>
+#include <functional>
 #include <vector>
 #include <string>
 #include "third_party/gl_include.h"
@@ -11,6 +13,9 @@
 #include <assimp/scene.h>
 
 #include "maths/vec3.h"
+#include "matrix_math.h"
+#include "transform_hierarchy.h"
+#include "command_list.h"
 
 struct Vertex {
     float position[3];
@@ -29,11 +34,16 @@ struct Mesh {
     std::vector<unsigned int> indices;
     std::vector<Texture> textures;
     GLuint VAO=0, VBO=0, EBO=0;
+    // Textures et samplers résolus une fois (setupMesh) pour les listes de commandes
+    DrawMaterial material;
 
     void setupMesh();
-    void Draw(GLuint shaderProgram);
+    // Lie les textures de material ; locations des samplers résolues d'avance (aucune requête par draw)
+    void BindMaterial(const SamplerLayout& samplers) const;
+    void Draw(const SamplerLayout& samplers);
     void AttachInstancBuffer(GLuint instanceVBO);
-    void DrawInstanced(GLuint shaderProgram, int instanceCount);
+    void DrawInstanced(const SamplerLayout& samplers, int instanceCount, GLuint baseInstance = 0);
+    void DrawDepthInstanced(int instanceCount, GLuint instanceDivisor, GLuint baseInstance = 0);
 };
 
 class Model {
@@ -42,9 +52,29 @@ public:
         loadModel(path);
     }
 
+    // Transform des nœuds dans les chemins sans matrice modèle (Draw, DrawInstanced, DrawDepthInstanced) :
+    // envoyé une fois par nœud dans cet uniform, que le shader applique avant sa matrice modèle / d'instance.
+    // Un programme qui ne le déclare pas dessine les meshes dans l'espace de leur nœud.
+    static constexpr const char* NODE_MATRIX_UNIFORM = "uNodeMatrix";
+
+    // Les variantes GLuint résolvent les samplers de matériau une fois par programme (GetSamplerLayout)
+
+    // Tous les meshes avec la matrice modèle déjà envoyée ; le monde de chaque nœud va dans uNodeMatrix
     void Draw(GLuint shaderProgram);
+    void Draw(const SamplerLayout& samplers);
+    // Un mesh par nœud : setModelMatrix reçoit modelMatrix * monde du nœud avant chaque groupe
+    void DrawNodes(GLuint shaderProgram, const float* modelMatrix,
+                   const std::function<void(const float*)>& setModelMatrix);
+    // Comme DrawNodes, enregistré dans une liste (aucun appel GL) ; sans matériau pour la profondeur
+    void RecordNodes(CommandList& list, GLuint shaderProgram, const float* modelMatrix,
+                     bool withMaterials) const;
     void AttachInstanceBuffer(GLuint instanceVBO);
-    void DrawInstanced(GLuint shaderProgram, int instanceCount);
+    // baseInstance : première matrice lue dans le buffer d'instances (tranche de la frame)
+    void DrawInstanced(GLuint shaderProgram, int instanceCount, GLuint baseInstance = 0);
+    void DrawInstanced(const SamplerLayout& samplers, int instanceCount, GLuint baseInstance = 0);
+    // Profondeur seule (ombres) : pas de textures, divisor d'instances ajustable ; shaderProgram déjà lié
+    void DrawDepthInstanced(GLuint shaderProgram, int instanceCount, GLuint instanceDivisor = 1,
+                            GLuint baseInstance = 0);
 
 
     core::Vec3F aabbMin;
@@ -55,15 +85,44 @@ public:
 
     float GetMinY() const{return aabbMin.y;}
 
+    // ==================== NŒUDS ASSIMP ====================
+    // Hiérarchie aiNode conservée (mTransformation en local) ; les bounds du modèle en tiennent compte
+    [[nodiscard]] int FindNode(const std::string& name) const;
+    void SetNodeLocalMatrix(int node, const float* localMatrix);
+    // Propage les nœuds modifiés et recalcule les bounds ; false si rien n'a changé
+    bool UpdateNodes();
+    [[nodiscard]] const TransformHierarchy& GetNodes() const { return nodes_; }
+    [[nodiscard]] int GetMeshNode(int meshIndex) const { return meshNodes_[meshIndex]; }
+
 private:
     std::vector<Mesh> meshes;
     std::string directory;
     std::vector<Texture> textures_loaded;
     static GLuint gWhiteTex;
-
+    // Dernier programme dessiné : re-résolu seulement quand il change
+    SamplerLayout samplers_;
+    // Location de uNodeMatrix des derniers programmes (couleur, profondeur...) : pas de requête par draw
+    struct NodeMatrixBinding {
+        GLuint program = 0;
+        GLint location = -1;
+    };
+    std::array<NodeMatrixBinding, 4> nodeMatrixBindings_{};
+    std::size_t nextNodeMatrixBinding_ = 0;
+
+    TransformHierarchy nodes_;
+    std::vector<std::string> nodeNames_;    // par identifiant de nœud
+    std::vector<int> meshNodes_;            // nœud de chaque mesh
+    std::vector<Aabb> meshBounds_;          // bounds de chaque mesh dans l'espace de son nœud
+
+    const SamplerLayout& GetSamplerLayout(GLuint shaderProgram);
+    GLint GetNodeMatrixLocation(GLuint shaderProgram);
+    // drawMesh(mesh) pour chaque mesh, uNodeMatrix envoyée à chaque changement de nœud
+    template<typename DrawMesh>
+    void DrawByNode(GLuint shaderProgram, DrawMesh&& drawMesh);
     void loadModel(const std::string& path);
-    void processNode(aiNode* node, const aiScene* scene);
+    int processNode(aiNode* node, const aiScene* scene, int parentNode);
     Mesh processMesh(aiMesh* mesh, const aiScene* scene);
+    void updateBounds();
     std::vector<Texture> loadMaterialTextures(aiMaterial* mat,
                                              aiTextureType type,
                                              const std::string& typeName);
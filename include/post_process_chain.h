@@ -0,0 +1,141 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef POST_PROCESS_CHAIN_H
+#define POST_PROCESS_CHAIN_H
+#include "third_party/gl_include.h"
+#include "bloom_renderer.h"
+#include "convolution_engine.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Effets disponibles dans la chaîne (l'ordre de la liste active est l'ordre d'application)
+enum class PostChainEffect {
+    Invert,
+    Grayscale,
+    Sepia,
+    NightVision,
+    EdgeDetection,
+    Blur,
+    Sharpen,
+    Emboss,
+    Sobel,
+    GaussianBlur,
+    CustomKernel
+};
+
+// Chaîne de post-traitement fusionnée :
+//  - les effets par pixel (inversion, sepia...) sont concaténés dans le shader de l'étape courante,
+//  - un effet de voisinage (convolution) ouvre une nouvelle étape car il doit lire le résultat
+//    complet de la précédente ; c'est le seul cas qui coûte un aller-retour plein écran,
+//  - le flou gaussien et les noyaux utilisateur passent par le ConvolutionEngine (compute,
+//    séparé en deux passes 1D quand c'est possible) ; les noyaux 3x3 restent fusionnés car
+//    9 lectures en cache coûtent moins qu'un dispatch et un aller-retour supplémentaires,
+//  - le bloom (chaîne de mips du BloomRenderer) est ajouté directement aux lectures de la scène
+//    de la première étape : pas de passe de combinaison séparée.
+// Un programme est généré et mis en cache par combinaison d'étape ; toutes les étapes utilisent
+// le même triangle plein écran. Une combinaison nouvelle est compilée en arrière-plan : une
+// simple copie la remplace tant que le pilote n'a pas terminé.
+class PostProcessChain {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    PostProcessChain();
+    ~PostProcessChain();
+
+    PostProcessChain(const PostProcessChain&) = delete;
+    PostProcessChain& operator=(const PostProcessChain&) = delete;
+
+    // ==================== INITIALISATION ====================
+    bool initialize(int width, int height);
+
+    // ==================== CONFIGURATION ====================
+    void setEffects(const std::vector<PostChainEffect> &effects);
+    // knee : genou doux relatif au seuil (voir BloomRenderer::setThreshold)
+    void setBloom(bool enabled, float threshold, float knee, float intensity);
+    void setGaussianRadius(int radius);
+    // Noyau utilisé par PostChainEffect::CustomKernel
+    bool setCustomKernel(const ConvolutionKernel &kernel);
+
+    // ==================== RENDU ====================
+    // Applique la chaîne à sceneTexture et écrit le résultat final dans targetFramebuffer
+    void apply(GLuint sceneTexture, GLuint targetFramebuffer);
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] bool isActive() const { return !effects_.empty() || bloomEnabled_; }
+    [[nodiscard]] int getStageCount() const { return static_cast<int>(stages_.size()); }
+    // Passes plein écran de la dernière application (bloom compris)
+    [[nodiscard]] int getLastPassCount() const { return lastPassCount_; }
+    [[nodiscard]] int getProgramCount() const { return static_cast<int>(programs_.size()); }
+    [[nodiscard]] static bool needsNeighbourhood(PostChainEffect effect);
+    [[nodiscard]] static bool usesConvolutionEngine(PostChainEffect effect);
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+private:
+    // Clé de combinaison : bit 0 = bloom, puis 4 bits par effet (valeur + 1, 0 = fin)
+    static constexpr int STAGE_KEY_EFFECT_BITS = 4;
+    static constexpr int MAX_STAGE_EFFECTS = 15;
+
+    struct StageProgram {
+        GLuint program;
+        GLint texelSizeLoc;
+        GLint bloomIntensityLoc;
+        bool ready;     // linkage terminé et uniforms initialisés
+    };
+
+    // Une étape = un programme : [convolution compute ou effet de voisinage optionnel]
+    // puis effets par pixel. Clé et programme sont résolus à la configuration, pas à chaque image.
+    struct Stage {
+        bool bloomInput;
+        int kernel;     // noyau du ConvolutionEngine appliqué avant le shader, -1 sinon
+        std::vector<PostChainEffect> effects;
+        std::uint64_t key;
+        StageProgram *program;  // entrée de programs_, nullptr tant qu'elle n'est pas résolue
+    };
+
+    // ==================== RESSOURCES OPENGL ====================
+    GLuint fullscreenVAO_;
+    GLuint fallbackProgram_;
+    GLuint intermediateFBO_[2];
+    GLuint intermediateTex_[2];
+    BloomRenderer bloom_;
+    ConvolutionEngine convolution_;
+    GLuint convolvedTex_;
+    int gaussianKernel_;
+    int customKernel_;
+    std::map<std::uint64_t, StageProgram> programs_;
+
+    // ==================== PARAMÈTRES ====================
+    int width_;
+    int height_;
+    std::vector<PostChainEffect> effects_;
+    std::vector<Stage> stages_;
+    bool bloomEnabled_;
+    float bloomIntensity_;
+    int lastPassCount_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    void rebuildStages();
+    StageProgram *getStageProgram(const Stage &stage);
+    static bool prepareStageProgram(StageProgram &stageProgram);
+    bool ensureIntermediateTargets();
+    void ensureConvolvedTarget();
+
+    static std::uint64_t getStageKey(const Stage &stage);
+    static std::string generateStageShader(const Stage &stage);
+    static std::string getEffectFunction(PostChainEffect effect);
+    static std::string getEffectName(PostChainEffect effect);
+
+    static bool createColorTarget(GLuint &framebuffer, GLuint &texture, int width, int height);
+    static GLuint submitProgram(const std::string &fragmentSource);
+
+    // ==================== SHADERS ====================
+    static std::string getFullscreenVS();
+    static std::string getPassthroughFS();
+};
+
+#endif //POST_PROCESS_CHAIN_H
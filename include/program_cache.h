@@ -0,0 +1,100 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+#include "third_party/gl_include.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ShaderStageSource {
+    GLenum type;
+    std::string source;
+};
+
+// Cache disque des programmes liés (glGetProgramBinary / glProgramBinary), partagé par tous
+// les renderers. La clé hache les sources, les #define injectés et le pilote (vendor, renderer,
+// version) : un changement de l'un d'eux produit une autre clé. Un binaire refusé par le pilote
+// est supprimé et le programme recompilé de façon transparente.
+//
+// Les constructions sont asynchrones : submitProgram() lance compilation et édition de liens
+// sans interroger le pilote, qui peut alors travailler en parallèle (GL_KHR_parallel_shader_compile).
+// Le statut n'est lu qu'à la première utilisation (finalize / resolve) ; resolve() permet
+// d'afficher un programme de repli tant que le vrai n'est pas prêt.
+class ProgramCache {
+public:
+    // ==================== CONFIGURATION ====================
+    // Répertoire des binaires ; une chaîne vide désactive le cache disque
+    static void setDirectory(const std::string &directory);
+    [[nodiscard]] static const std::string &getDirectory() { return directory_; }
+
+    // ==================== CRÉATION ====================
+    // defines : lignes "#define ..." insérées après la directive #version de chaque étape.
+    // Équivaut à finalize(submitProgram(...)) : bloquant, retourne 0 (erreurs affichées) en cas d'échec.
+    static GLuint createProgram(const std::vector<ShaderStageSource> &stages, const std::string &defines = "");
+
+    static std::string injectDefines(const std::string &source, const std::string &defines);
+
+    // ==================== CONSTRUCTION ASYNCHRONE ====================
+    // Lance la construction et retourne immédiatement le nom du programme (jamais 0)
+    static GLuint submitProgram(const std::vector<ShaderStageSource> &stages, const std::string &defines = "");
+    // Non bloquant avec GL_KHR_parallel_shader_compile ; sans l'extension le pilote ne sait pas
+    // répondre sans attendre, le programme est donc considéré prêt (finalize bloquera)
+    [[nodiscard]] static bool isReady(GLuint program);
+    // Attend la fin de l'édition de liens ; retourne program, ou 0 (programme supprimé) si échec
+    static GLuint finalize(GLuint program);
+    static void finalizeAll();
+    // Programme à lier maintenant : program s'il est prêt (finalisé au passage), fallback sinon.
+    // program est remis à 0 si sa construction a échoué.
+    static GLuint resolve(GLuint &program, GLuint fallback);
+    // Abandonne une construction en cours (à appeler avant glDeleteProgram)
+    static void discard(GLuint program);
+
+    // ==================== STATISTIQUES ====================
+    [[nodiscard]] static int getHitCount() { return hitCount_; }
+    [[nodiscard]] static int getMissCount() { return missCount_; }
+    [[nodiscard]] static int getPendingCount() { return static_cast<int>(pending_.size()); }
+    static bool hasParallelCompile();
+
+private:
+    // En-tête des fichiers .bin
+    struct BinaryHeader {
+        char magic[4];
+        std::uint32_t binaryFormat;
+        std::uint64_t key;
+        std::uint32_t length;
+    };
+
+    // Construction lancée dont le statut n'a pas encore été lu
+    struct PendingProgram {
+        std::vector<ShaderStageSource> stages;
+        std::string defines;
+        std::vector<GLuint> shaders;
+        std::uint64_t key;
+        bool useCache;
+        bool fromBinary;
+    };
+
+    // ==================== DONNÉES ====================
+    static std::string directory_;
+    static int hitCount_;
+    static int missCount_;
+    static std::unordered_map<GLuint, PendingProgram> pending_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    static bool isSupported();
+    static const std::string &getDriverString();
+    static std::uint64_t computeKey(const std::vector<ShaderStageSource> &stages, const std::string &defines);
+    static std::string getBinaryPath(std::uint64_t key);
+
+    static bool loadBinary(GLuint program, std::uint64_t key);
+    static void storeBinary(GLuint program, std::uint64_t key);
+    static void attachAndLink(GLuint program, PendingProgram &pending);
+    static void printErrors(GLuint program, const PendingProgram &pending);
+    static void releaseShaders(GLuint program, PendingProgram &pending);
+};
+
+#endif //PROGRAM_CACHE_H
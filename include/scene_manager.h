@@ -4,37 +4,25 @@
 
 #ifndef SCENE_MANAGER_H
 #define SCENE_MANAGER_H
-#include <array>
+#include <cstdint>
+#include <functional>
 #include <memory>
 
+#include "command_list.h"
+#include "entity_store.h"
 #include "model_loader.h"
+#include "slot_map.h"
 #include "maths/vec3.h"
 
-// Déclaration anticipée
-class SceneManager;
-
-struct ModelInstance {
-    Model *model;
-    core::Vec3F position;
-    core::Vec3F rotation;
-    core::Vec3F scale;
-    std::array<float, 16> modelMatrix{};
-    bool visible;
-    int modelIndex;
-
-    ModelInstance()
-        : model(nullptr),
-          position(0.0f, 0.0f, 0.0f),
-          rotation(0.0f, 0.0f, 0.0f),
-          scale(1.0f, 1.0f, 1.0f),
-          visible(true),
-          modelIndex(-1) {
-        for (int i = 0; i < 16; ++i) {
-            modelMatrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
-        }
-    }
-    void updateModelMatrix();
-};
+using InstanceHandle = EntityHandle;
+using ModelHandle = SlotHandle;
+
+// Les instances vivent dans un EntityStore (tableaux séparés par attribut) ; les matrices
+// et bounds monde sont recalculés pour les seules instances modifiées par updateAllMatrices().
+//
+// Modèles et instances sont désignés par des handles générationnels : une suppression est en O(1)
+// et ne fait jamais pointer un handle existant vers un autre objet. Pour parcourir toutes les
+// instances, getInstanceHandle(i) avec i dans [0, getInstanceCount()) (ordre non conservé).
 class SceneManager {
 public:
     // ==================== CONSTRUCTEURS ====================
@@ -46,65 +34,77 @@ public:
     SceneManager& operator=(const SceneManager&) = delete;
 
     // ==================== GESTION DES MODÈLES ====================
-    int loadModel(const std::string& path);
-    Model* getModel(int modelIndex);
-    [[nodiscard]] const Model* getModel(int modelIndex) const;
+    ModelHandle loadModel(const std::string& path);
+    // Refusé tant que des instances utilisent le modèle
+    bool removeModel(ModelHandle model);
+    Model* getModel(ModelHandle model);
+    [[nodiscard]] const Model* getModel(ModelHandle model) const;
     [[nodiscard]] int getModelCount() const { return models_.size(); }
 
     // ==================== GESTION DES INSTANCES ====================
-    int addModelInstance(int modelIndex,
-                        const core::Vec3F& position = {0.0f, 0.0f, 0.0f},
-                        const core::Vec3F& rotation = {0.0f, 0.0f, 0.0f},
-                        const core::Vec3F& scale = {1.0f, 1.0f, 1.0f});
-    void removeModelInstance(int instanceIndex);
-    ModelInstance* getInstance(int instanceIndex);
-    [[nodiscard]] const ModelInstance* getInstance(int instanceIndex) const;
+    InstanceHandle addModelInstance(ModelHandle model,
+                                    const core::Vec3F& position = {0.0f, 0.0f, 0.0f},
+                                    const core::Vec3F& rotation = {0.0f, 0.0f, 0.0f},
+                                    const core::Vec3F& scale = {1.0f, 1.0f, 1.0f});
+    void removeModelInstance(InstanceHandle instance);
     [[nodiscard]] int getVisibleInstanceCount() const;
-    [[nodiscard]] int getInstanceCount() const { return instances_.size(); }
+    [[nodiscard]] int getInstanceCount() const { return entities_.size(); }
+    [[nodiscard]] InstanceHandle getInstanceHandle(int index) const { return entities_.handleAt(index); }
+    [[nodiscard]] bool isInstanceValid(InstanceHandle instance) const { return entities_.indexOf(instance) >= 0; }
+    [[nodiscard]] Model* getInstanceModel(InstanceHandle instance) const;
+    [[nodiscard]] bool isInstanceVisible(InstanceHandle instance) const;
+    [[nodiscard]] bool isInstanceStatic(InstanceHandle instance) const;
+    [[nodiscard]] const EntityStore& getEntities() const { return entities_; }
 
     // ==================== TRANSFORMATION DES INSTANCES ====================
-    void setInstancePosition(int instanceIndex, const core::Vec3F& position);
-    [[nodiscard]] const core::Vec3F& getInstancePosition(int instanceIndex) const;
-    void setInstanceRotation(int instanceIndex, const core::Vec3F& rotation);
-    void setInstanceScale(int instanceIndex, const core::Vec3F& scale);
-    void setInstanceVisible(int instanceIndex, bool visible);
+    void setInstancePosition(InstanceHandle instance, const core::Vec3F& position);
+    [[nodiscard]] const core::Vec3F& getInstancePosition(InstanceHandle instance) const;
+    void setInstanceRotation(InstanceHandle instance, const core::Vec3F& rotation);
+    void setInstanceScale(InstanceHandle instance, const core::Vec3F& scale);
+    void setInstanceVisible(InstanceHandle instance, bool visible);
+    void setInstanceStatic(InstanceHandle instance, bool isStatic);
+    // Le TRS de l'enfant devient relatif au parent (handle nul : détache) ; false si cycle
+    bool setInstanceParent(InstanceHandle instance, InstanceHandle parent);
+    [[nodiscard]] InstanceHandle getInstanceParent(InstanceHandle instance) const;
 
     // ==================== MATRICES DE TRANSFORMATION ====================
-    void getInstanceModelMatrix(int instanceIndex, float* outMatrix) const;
-    void updateAllMatrices();
+    void getInstanceModelMatrix(InstanceHandle instance, float* outMatrix) const;
+    // Recalcule les instances modifiées depuis le dernier appel (une fois par frame)
+    std::size_t updateAllMatrices();
 
     // ==================== RENDU ====================
-    void drawInstance(int instanceIndex, GLuint shaderProgram) const;
+    void drawInstance(InstanceHandle instance, GLuint shaderProgram) const;
+    // Respecte la hiérarchie de nœuds du modèle : setModelMatrix reçoit la matrice
+    // monde de chaque nœud avant ses meshes
+    void drawInstance(InstanceHandle instance, GLuint shaderProgram,
+                      const std::function<void(const float*)>& setModelMatrix) const;
     void drawAllInstances(GLuint shaderProgram) const;
-    void drawInstanceRaw(int instanceIndex, GLuint shaderProgram) const;
+    // Même parcours que drawInstance, sans appel GL : les draws vont dans la liste
+    // (sûr depuis un worker tant que la scène n'est pas modifiée)
+    void recordInstance(InstanceHandle instance, GLuint shaderProgram, CommandList& list,
+                        bool withMaterials) const;
+    void drawInstanceRaw(InstanceHandle instance, GLuint shaderProgram) const;
 
     // ==================== BOUNDS ====================
     [[nodiscard]] core::Vec3F getSceneCenter() const;
     [[nodiscard]] float getSceneRadius() const;
     void getSceneBounds(core::Vec3F& outMin, core::Vec3F& outMax) const;
+    bool getInstanceWorldBounds(InstanceHandle instance, core::Vec3F& outMin, core::Vec3F& outMax) const;
+
+    // Incrémentée à chaque modification d'une instance statique (invalide le cache d'ombres)
+    [[nodiscard]] std::uint64_t getStaticGeometryVersion() const { return staticGeometryVersion_; }
 
     // ==================== NETTOYAGE ====================
     void cleanup();
 
-    // ==================== MÉTHODES PUBLIQUES STATIQUES (pour ModelInstance) ====================
-    static void createTransformMatrix(const core::Vec3F& position,
-                                     const core::Vec3F& rotation,
-                                     const core::Vec3F& scale,
-                                     float* outMatrix);
-
 private:
     // ==================== DONNÉES ====================
-    std::vector<std::unique_ptr<Model>> models_;
-    std::vector<ModelInstance> instances_;
+    SlotMap<std::unique_ptr<Model>> models_;
+    EntityStore entities_;
+    std::uint64_t staticGeometryVersion_ = 0;
 
     // ==================== MÉTHODES PRIVÉES ====================
-    static void multiplyMat4(float* out, const float* a, const float* b);
-    static void translationMatrix(float* out, float x, float y, float z);
-    static void rotationMatrixX(float* out, float angle);
-    static void rotationMatrixY(float* out, float angle);
-    static void rotationMatrixZ(float* out, float angle);
-    static void scaleMatrix(float* out, float x, float y, float z);
-    static void identityMatrix(float* out);
+    void markStaticDirty(int instanceIndex);
 };
 
 
@@ -0,0 +1,95 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+#include "third_party/gl_include.h"
+#include "program_cache.h"
+#include "shader_program.h"
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Option de compilation d'un shader : #define NOM valeur, la valeur occupant bits bits dans la clé
+struct PermutationFeature {
+    std::string define;
+    int bits;
+};
+
+// Variantes d'un même programme spécialisées par des #define au lieu de branches sur des uniforms.
+// Une clé empaquette la valeur de chaque option ; chaque variante est construite une seule fois
+// (précompilée au chargement ou à la première demande) puis mise en cache, et son binaire passe
+// par ProgramCache (les defines font partie de la clé disque).
+//
+// Les sources peuvent contenir des directives #include "nom" résolues parmi les fragments
+// enregistrés avec registerInclude().
+class ShaderPermutations {
+public:
+    using Key = std::uint32_t;
+
+    // ==================== CONSTRUCTEURS ====================
+    ShaderPermutations();
+    ~ShaderPermutations();
+
+    ShaderPermutations(const ShaderPermutations&) = delete;
+    ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+
+    // ==================== CONFIGURATION ====================
+    // baseDefines : lignes communes à toutes les variantes (blocs partagés...)
+    void initialize(const std::vector<ShaderStageSource> &stages,
+                    const std::vector<PermutationFeature> &features,
+                    const std::string &baseDefines = "");
+    // Appelé une fois par variante après réflexion (unités de samplers, blocs, constantes)
+    void setOnCreated(std::function<void(ShaderProgram &)> callback);
+
+    // ==================== CLÉS ====================
+    // Valeurs dans l'ordre de déclaration des options ; une valeur hors limites est tronquée
+    [[nodiscard]] Key makeKey(std::initializer_list<int> values) const;
+    [[nodiscard]] std::string getDefines(Key key) const;
+
+    // ==================== VARIANTES ====================
+    // Lance la construction sans attendre (à appeler au chargement pour les variantes connues)
+    void precompile(Key key);
+    void precompileAll();
+    // Variante prête à l'emploi, construite à la demande si besoin ; nullptr si elle a échoué
+    ShaderProgram *get(Key key);
+    // get() + glUseProgram ; lie 0 si la variante a échoué
+    ShaderProgram *bind(Key key);
+
+    [[nodiscard]] int getVariantCount() const { return static_cast<int>(variants_.size()); }
+    [[nodiscard]] int getKeyBits() const;
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+    // ==================== INCLUDES ====================
+    static void registerInclude(const std::string &name, const std::string &source);
+    // Remplace récursivement les #include "nom" ; un nom inconnu est signalé et retiré
+    static std::string preprocess(const std::string &source);
+
+private:
+    struct Variant {
+        GLuint program = 0;
+        ShaderProgram uniforms;
+        bool ready = false;
+    };
+
+    // ==================== DONNÉES ====================
+    std::vector<ShaderStageSource> stages_;
+    std::vector<PermutationFeature> features_;
+    std::string baseDefines_;
+    std::function<void(ShaderProgram &)> onCreated_;
+    std::unordered_map<Key, Variant> variants_;
+
+    static std::unordered_map<std::string, std::string> includes_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    Variant &submit(Key key);
+    static std::string expandIncludes(const std::string &source, int depth);
+};
+
+#endif //SHADER_PERMUTATIONS_H
@@ -0,0 +1,131 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+#include "third_party/gl_include.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Nom d'uniform ou de bloc haché (FNV-1a 32 bits). Construit depuis un littéral, le hash est
+// calculé à la compilation ; les noms construits à l'exécution passent par runtime().
+struct UniformName {
+    std::uint32_t hash;
+    std::string_view text;
+
+    consteval UniformName(const char *name) : hash(hashName(name)), text(name) {}
+
+    static constexpr UniformName runtime(std::string_view name) { return UniformName(hashName(name), name); }
+
+    static constexpr std::uint32_t hashName(std::string_view name) {
+        std::uint32_t hash = 2166136261u;
+        for (char c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+private:
+    constexpr UniformName(std::uint32_t nameHash, std::string_view name) : hash(nameHash), text(name) {}
+};
+
+// Vue réfléchie d'un programme lié : uniforms actifs, samplers et blocs (uniform / storage) sont
+// énumérés une seule fois avec glGetProgramInterfaceiv. Les envois passent par glProgramUniform*
+// (le programme n'a pas besoin d'être lié) et sont ignorés quand la valeur n'a pas changé depuis
+// le dernier envoi : toutes les écritures d'un uniform doivent donc passer par cet objet. La valeur
+// mémorisée est indexée par location, partagée entre les alias d'un tableau ("tab", "tab[0]").
+// Le programme n'est pas possédé (sa destruction reste à la charge du créateur).
+class ShaderProgram {
+public:
+    static constexpr int MAX_CACHED_COMPONENTS = 16;
+
+    // ==================== CONSTRUCTEURS ====================
+    ShaderProgram();
+    ~ShaderProgram() = default;
+
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    // ==================== RÉFLEXION ====================
+    // À appeler après le linkage (et après chaque re-linkage) ; 0 vide la table
+    void reflect(GLuint program);
+    // Oublie les valeurs mémorisées (après une écriture faite hors de cet objet)
+    void invalidateCache();
+
+    void use() const;
+
+    // ==================== REQUÊTES ====================
+    [[nodiscard]] GLuint getId() const { return program_; }
+    [[nodiscard]] bool isValid() const { return program_ != 0; }
+    [[nodiscard]] bool hasUniform(UniformName name) const { return find(name) != nullptr; }
+    [[nodiscard]] GLint getLocation(UniformName name) const;
+    [[nodiscard]] bool isSampler(UniformName name) const;
+    // Index d'un bloc uniform ou storage, GL_INVALID_INDEX s'il n'est pas actif
+    [[nodiscard]] GLuint getBlockIndex(UniformName name) const;
+    // Taille en octets du bloc (GL_BUFFER_DATA_SIZE), 0 s'il n'est pas actif
+    [[nodiscard]] GLint getBlockDataSize(UniformName name) const;
+    void setBlockBinding(UniformName name, GLuint binding) const;
+
+    [[nodiscard]] int getUniformCount() const { return static_cast<int>(uniforms_.size()); }
+    [[nodiscard]] int getBlockCount() const { return static_cast<int>(blocks_.size()); }
+    [[nodiscard]] int getSkippedUploadCount() const { return skippedUploads_; }
+
+    // ==================== ENVOIS ====================
+    void setInt(UniformName name, int value);
+    void setFloat(UniformName name, float value);
+    void setVec2(UniformName name, float x, float y);
+    void setVec3(UniformName name, float x, float y, float z);
+    void setVec3(UniformName name, const float *value);
+    void setVec4(UniformName name, float x, float y, float z, float w);
+    void setMat4(UniformName name, const float *value);
+    // Tableaux : envoyés tels quels ; oublient les valeurs mémorisées des éléments écrits
+    void setFloatArray(UniformName name, const float *values, int count);
+    void setVec3Array(UniformName name, const float *values, int count);
+
+private:
+    // Dernière valeur envoyée à une location
+    struct CachedValue {
+        GLint location;
+        bool cached;
+        std::array<std::uint32_t, MAX_CACHED_COMPONENTS> value;
+    };
+
+    struct Uniform {
+        std::uint32_t hash;
+        GLint location;
+        GLenum type;
+        std::uint32_t valueIndex;   // dans values_
+    };
+
+    struct Block {
+        std::uint32_t hash;
+        GLenum interface;
+        GLuint index;
+        GLint dataSize;
+    };
+
+    // ==================== DONNÉES ====================
+    GLuint program_;
+    std::vector<Uniform> uniforms_;     // triés par hash
+    std::vector<Block> blocks_;         // triés par hash
+    std::vector<CachedValue> values_;   // une entrée par location
+    int skippedUploads_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    [[nodiscard]] const Uniform *find(UniformName name) const;
+    Uniform *findForUpload(UniformName name);
+    // Vrai si la valeur diffère de la dernière envoyée (et la mémorise)
+    bool changed(const Uniform &uniform, const void *value, int components);
+    // Oublie les valeurs des locations [location, location + count)
+    void invalidateLocations(GLint location, int count);
+
+    void addUniform(std::string_view name, GLint location, GLenum type);
+    void reflectBlocks(GLenum interface);
+    static bool isSamplerType(GLenum type);
+};
+
+#endif //SHADER_PROGRAM_H
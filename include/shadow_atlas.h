@@ -0,0 +1,162 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef SHADOW_ATLAS_H
+#define SHADOW_ATLAS_H
+#include "third_party/gl_include.h"
+#include "maths/vec3.h"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct Light;
+
+// Tuile carrée dans l'atlas (coordonnées en texels)
+struct ShadowAtlasTile {
+    int x = 0;
+    int y = 0;
+    int size = 0;
+    int node = -1;
+
+    [[nodiscard]] bool isValid() const { return node >= 0; }
+};
+
+// Allocateur quadtree : chaque noeud est libre, occupé ou découpé en 4 enfants.
+// Les tailles sont des puissances de deux ; quatre frères libres sont refusionnés à la libération.
+class ShadowAtlasAllocator {
+public:
+    void reset(int atlasSize, int minTileSize);
+
+    ShadowAtlasTile allocate(int size);
+
+    void release(const ShadowAtlasTile &tile);
+
+    [[nodiscard]] int getUsedArea() const { return usedArea_; }
+
+private:
+    struct Node {
+        int x;
+        int y;
+        int size;
+        int parent;
+        int firstChild;
+        bool occupied;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<int> freeChildBlocks_;
+    int minTileSize_ = 0;
+    int usedArea_ = 0;
+
+    int allocateInNode(int nodeIndex, int size);
+
+    void split(int nodeIndex);
+
+    [[nodiscard]] bool isFreeLeaf(int nodeIndex) const;
+};
+
+// Entrée d'une lumière locale : 1 tuile perspective (spot) ou 6 faces de cube (point)
+struct ShadowAtlasEntry {
+    const Light *light = nullptr;
+    int faceCount = 0;
+    int resolution = 0;
+    float range = 0.0f;             // rayon d'influence, pour le culling des casters
+    float priority = 0.0f;
+    std::array<ShadowAtlasTile, 6> tiles{};
+    std::array<std::array<float, 16>, 6> viewMatrices{};
+    std::array<std::array<float, 16>, 6> projMatrices{};
+    // Contiguës : les faceCount premières se passent en un seul tableau de mat4
+    std::array<std::array<float, 16>, 6> viewProjMatrices{};
+    std::uint64_t contentHash = 0;
+    bool needsRender = false;
+
+    [[nodiscard]] bool hasShadow() const { return resolution > 0; }
+};
+
+// Atlas d'ombres partagé par les point lights et spot lights.
+// La résolution de chaque lumière est choisie chaque frame selon sa couverture à l'écran,
+// sous un budget fixe (la surface de l'atlas) ; les tuiles des lumières inchangées sont réutilisées.
+// Les faces d'une lumière sont rendues en une passe layered (LayeredShadowRenderer) puis copiées dans leurs tuiles.
+class ShadowAtlas {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    ShadowAtlas();
+    ~ShadowAtlas();
+
+    ShadowAtlas(const ShadowAtlas&) = delete;
+    ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+    // ==================== INITIALISATION ====================
+    void initialize(int atlasSize = 4096, int minTileSize = 128, int maxTileSize = 1024);
+
+    // ==================== MISE À JOUR ====================
+    void update(std::span<const Light *const> lights,
+                const core::Vec3F &cameraPosition,
+                float cameraFovY,
+                int screenHeight,
+                std::uint64_t sceneVersion);
+
+    void releaseLight(const Light *light);
+
+    // Un caster dynamique a bougé dans cette boîte : seules les lumières dont la sphère
+    // d'influence la touche sont re-rendues, les tuiles des autres restent en cache
+    void invalidateBounds(const core::Vec3F &boundsMin, const core::Vec3F &boundsMax);
+
+    // ==================== RENDU ====================
+    // Couche f de depthTextureArray (coin resolution x resolution) -> tuile f de l'entrée
+    void copyFromLayers(const ShadowAtlasEntry &entry, GLuint depthTextureArray) const;
+
+    void markRendered();
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] const std::vector<ShadowAtlasEntry> &getEntries() const { return entries_; }
+    [[nodiscard]] const ShadowAtlasEntry *getEntry(const Light *light) const;
+    [[nodiscard]] bool hasPendingTiles() const;
+    [[nodiscard]] GLuint getDepthTexture() const { return atlasDepthTexture_; }
+    [[nodiscard]] int getAtlasSize() const { return atlasSize_; }
+    [[nodiscard]] int getMaxTileSize() const { return maxTileSize_; }
+    [[nodiscard]] int getUsedArea() const { return allocator_.getUsedArea(); }
+    [[nodiscard]] bool isInitialized() const { return atlasDepthTexture_ != 0; }
+
+    // (scaleX, scaleY, offsetX, offsetY) pour passer des UV de la tuile aux UV de l'atlas
+    void getTileUVTransform(const ShadowAtlasTile &tile, float *out) const;
+
+    [[nodiscard]] static bool sphereIntersectsBounds(const core::Vec3F &center, float radius,
+                                                     const core::Vec3F &boundsMin, const core::Vec3F &boundsMax);
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+private:
+    // ==================== RESSOURCES OPENGL ====================
+    GLuint atlasDepthTexture_;
+    int atlasSize_;
+    int minTileSize_;
+    int maxTileSize_;
+
+    // ==================== ALLOCATION ====================
+    ShadowAtlasAllocator allocator_;
+    std::vector<ShadowAtlasEntry> entries_;
+    std::uint64_t sceneVersion_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    [[nodiscard]] int resolutionForScreenSize(float screenSize) const;
+
+    static float computeScreenSize(const core::Vec3F &lightPosition, float range,
+                                   const core::Vec3F &cameraPosition,
+                                   float cameraFovY, int screenHeight);
+
+    bool allocateEntry(ShadowAtlasEntry &entry, int resolution);
+
+    void releaseEntry(ShadowAtlasEntry &entry);
+
+    static void computeMatrices(ShadowAtlasEntry &entry, float range);
+
+    static float computeRange(const Light &light);
+
+    static std::uint64_t hashLight(const Light &light);
+};
+
+#endif //SHADOW_ATLAS_H
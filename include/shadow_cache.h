@@ -0,0 +1,68 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef SHADOW_CACHE_H
+#define SHADOW_CACHE_H
+#include "third_party/gl_include.h"
+#include "maths/vec3.h"
+#include <array>
+#include <cstdint>
+
+// Frustum de la lumière (6 plans extraits de la matrice viewProj, méthode Gribb/Hartmann)
+struct ShadowFrustum {
+    std::array<std::array<float, 4>, 6> planes{};
+
+    void extract(const float *viewProj);
+
+    [[nodiscard]] bool intersectsAABB(const core::Vec3F &min, const core::Vec3F &max) const;
+};
+
+// Cache de la couche de profondeur des casters statiques.
+// La couche n'est re-rendue que si la lumière (matrice) ou la géométrie statique (version) change ;
+// chaque frame, elle est copiée dans la shadow map puis seuls les casters dynamiques sont dessinés.
+class ShadowCache {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    ShadowCache();
+    ~ShadowCache();
+
+    ShadowCache(const ShadowCache&) = delete;
+    ShadowCache& operator=(const ShadowCache&) = delete;
+
+    // ==================== INITIALISATION ====================
+    void initialize(int width, int height, GLenum internalFormat = GL_DEPTH_COMPONENT32F);
+
+    // ==================== CACHE ====================
+    [[nodiscard]] bool isValid(const float *lightSpaceMatrix, std::uint64_t staticVersion) const;
+    void invalidate() { valid_ = false; }
+
+    void beginStaticLayer() const;
+    void endStaticLayer(const float *lightSpaceMatrix, std::uint64_t staticVersion);
+
+    // Faux si le cache n'est pas valide : la shadow map n'a pas été écrite et doit être vidée
+    bool copyInto(GLuint shadowDepthTexture) const;
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] GLuint getCachedDepthTexture() const { return cacheDepthTexture_; }
+    [[nodiscard]] int getRebuildCount() const { return rebuildCount_; }
+    [[nodiscard]] bool isInitialized() const { return cacheFramebuffer_ != 0; }
+
+    // ==================== NETTOYAGE ====================
+    void cleanup();
+
+private:
+    // ==================== RESSOURCES OPENGL ====================
+    GLuint cacheFramebuffer_;
+    GLuint cacheDepthTexture_;
+    int width_;
+    int height_;
+
+    // ==================== CLÉ DU CACHE ====================
+    std::array<float, 16> cachedLightSpaceMatrix_;
+    std::uint64_t cachedStaticVersion_;
+    bool valid_;
+    int rebuildCount_;
+};
+
+#endif //SHADOW_CACHE_H
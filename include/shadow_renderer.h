@@ -6,6 +6,8 @@
 #define SHADOW_RENDERER_H
 #include "third_party/gl_include.h"
 #include "light_manager.h"
+#include "shadow_cache.h"
+#include <cstdint>
 #include <string>
 #include <memory>
 
@@ -30,6 +32,21 @@ public:
     // ==================== RENDU ====================
     void beginShadowPass();
     void endShadowPass();
+
+    // Moments VSM/EVSM : profondeur -> moments + flou séparable + mipmaps (sans effet en mode HARD)
+    void prefilterMoments();
+
+    // ==================== CACHE DES CASTERS STATIQUES ====================
+    bool beginStaticCasterPass(const float* lightSpaceMatrix, std::uint64_t staticVersion);
+    void endStaticCasterPass(const float* lightSpaceMatrix, std::uint64_t staticVersion);
+    void invalidateStaticCache() { staticCache_.invalidate(); }
+    [[nodiscard]] int getStaticCacheRebuildCount() const { return staticCache_.getRebuildCount(); }
+
+    // ==================== CULLING DES CASTERS ====================
+    void setLightFrustum(const float* lightSpaceMatrix) { lightFrustum_.extract(lightSpaceMatrix); }
+    [[nodiscard]] bool isCasterVisible(const core::Vec3F& min, const core::Vec3F& max) const {
+        return lightFrustum_.intersectsAABB(min, max);
+    }
     void bindShader() const;
 
     static void unbindShader();
@@ -40,6 +57,8 @@ public:
 
     // ==================== GETTERS ====================
     [[nodiscard]] GLuint getShaderProgram() const { return shaderProgram_; }
+    // Pour le replay des listes de commandes (CommandList::execute)
+    [[nodiscard]] GLint getModelMatrixLocation() const { return modelMatrixLoc_; }
     [[nodiscard]] bool isInitialized() const { return initialized_; }
     [[nodiscard]] bool hasShaders() const { return shaderProgram_ != 0; }
 
@@ -54,20 +73,36 @@ private:
     GLint viewMatrixLoc_;
     GLint lightSpaceMatrixLoc_;
 
+    // ==================== PRÉFILTRAGE DES MOMENTS ====================
+    GLuint momentsProgram_;
+    GLuint momentsBlurProgram_;
+    GLuint fullscreenVAO_;
+    GLint momentsDepthLoc_;
+    GLint momentsRadiusLoc_;
+    GLint momentsModeLoc_;
+    GLint momentsExponentsLoc_;
+    GLint blurMomentsLoc_;
+    GLint blurRadiusLoc_;
+
     // ==================== RÉFÉRENCES ====================
     LightManager* lightManager_;
     bool initialized_;
 
+    // ==================== CACHE / CULLING ====================
+    ShadowCache staticCache_;
+    ShadowFrustum lightFrustum_;
+
     // ==================== MÉTHODES PRIVÉES ====================
-    static GLuint compileShader(GLenum type, const std::string& source);
-    static GLuint createProgram(GLuint vertexShader, GLuint fragmentShader);
+    static GLuint submitProgram(const std::string& vertexSource, const std::string& fragmentSource);
     void initializeUniformLocations();
-    static void printShaderError(GLuint shader, GLenum type);
-    static void printProgramError(GLuint program);
+    bool loadMomentsShaders();
 
     // ==================== SHADERS PAR DÉFAUT ====================
     static std::string getDefaultVertexShader();
     static std::string getDefaultFragmentShader();
+    static std::string getFullscreenVertexShader();
+    static std::string getMomentsFragmentShader();
+    static std::string getMomentsBlurFragmentShader();
 };
 
 
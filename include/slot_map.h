@@ -0,0 +1,127 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Référence stable vers un élément d'un SlotMap / SlotIndex : l'emplacement ne change pas
+// quand d'autres éléments sont supprimés, et la génération rend obsolète un handle dont
+// l'élément a été retiré (même si l'emplacement est réutilisé depuis).
+struct SlotHandle {
+    static constexpr std::uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    std::uint32_t index = INVALID_INDEX;
+    std::uint32_t generation = 0;
+
+    [[nodiscard]] bool isNull() const { return index == INVALID_INDEX; }
+    bool operator==(const SlotHandle&) const = default;
+};
+
+// Table handle -> indice dense, sans les données : le propriétaire garde ses propres
+// tableaux denses (un ou plusieurs, cf. EntityStore) et applique le même déplacement.
+//
+// Une suppression est un swap-and-pop : le dernier élément dense prend la place du supprimé.
+class SlotIndex {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    SlotIndex();
+    ~SlotIndex() = default;
+
+    // ==================== ÉLÉMENTS ====================
+    // L'élément correspondant doit être ajouté en fin des tableaux denses (indice size() - 1)
+    SlotHandle insert();
+    // Retourne l'indice dense libéré (-1 si handle obsolète) : le propriétaire y déplace
+    // son dernier élément puis retire la fin de ses tableaux
+    int erase(SlotHandle handle);
+    void clear();
+    void reserve(std::size_t capacity);
+
+    // ==================== ACCÈS ====================
+    // -1 si le handle est obsolète
+    [[nodiscard]] int indexOf(SlotHandle handle) const;
+    [[nodiscard]] bool contains(SlotHandle handle) const { return indexOf(handle) >= 0; }
+    [[nodiscard]] SlotHandle handleAt(int index) const;
+    [[nodiscard]] int size() const { return static_cast<int>(denseToSlot_.size()); }
+
+private:
+    struct Slot {
+        std::uint32_t denseIndex;   // suivant de la liste libre si l'emplacement est libre
+        std::uint32_t generation;
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> denseToSlot_;
+    std::uint32_t freeHead_;
+};
+
+// Conteneur à handles stables : les valeurs restent contiguës (parcours direct sur
+// begin()/end()), l'accès par handle et la suppression sont en O(1).
+// L'ordre des valeurs n'est pas conservé après une suppression.
+template<typename T>
+class SlotMap {
+public:
+    // ==================== ÉLÉMENTS ====================
+    SlotHandle insert(T value) {
+        values_.push_back(std::move(value));
+        return index_.insert();
+    }
+
+    bool erase(SlotHandle handle) {
+        const int index = index_.erase(handle);
+        if (index < 0) {
+            return false;
+        }
+        if (index != static_cast<int>(values_.size()) - 1) {
+            values_[index] = std::move(values_.back());
+        }
+        values_.pop_back();
+        return true;
+    }
+
+    void clear() {
+        values_.clear();
+        index_.clear();
+    }
+
+    void reserve(std::size_t capacity) {
+        values_.reserve(capacity);
+        index_.reserve(capacity);
+    }
+
+    // ==================== ACCÈS ====================
+    // nullptr si le handle est obsolète
+    T *get(SlotHandle handle) {
+        const int index = index_.indexOf(handle);
+        return index >= 0 ? &values_[index] : nullptr;
+    }
+
+    [[nodiscard]] const T *get(SlotHandle handle) const {
+        const int index = index_.indexOf(handle);
+        return index >= 0 ? &values_[index] : nullptr;
+    }
+
+    [[nodiscard]] bool contains(SlotHandle handle) const { return index_.contains(handle); }
+    [[nodiscard]] int indexOf(SlotHandle handle) const { return index_.indexOf(handle); }
+    [[nodiscard]] SlotHandle handleAt(int index) const { return index_.handleAt(index); }
+    [[nodiscard]] int size() const { return static_cast<int>(values_.size()); }
+    [[nodiscard]] bool empty() const { return values_.empty(); }
+
+    // ==================== PARCOURS DENSE ====================
+    T &operator[](int index) { return values_[index]; }
+    const T &operator[](int index) const { return values_[index]; }
+    auto begin() { return values_.begin(); }
+    auto end() { return values_.end(); }
+    [[nodiscard]] auto begin() const { return values_.begin(); }
+    [[nodiscard]] auto end() const { return values_.end(); }
+
+private:
+    std::vector<T> values_;
+    SlotIndex index_;
+};
+
+#endif //SLOT_MAP_H
@@ -6,12 +6,19 @@
 #define SSAO_RENDERER_H
 #include "third_party/gl_include.h"
 #include "maths/vec3.h"
+#include "frame_graph.h"
 #include <vector>
 #include <string>
 
 
 class SSAORenderer {
 public:
+    // Point de binding du UBO contenant le kernel (std140, vec4 samples[128])
+    static constexpr GLuint KERNEL_UBO_BINDING = 1;
+    static constexpr int MAX_KERNEL_SIZE = 128;
+    // Mode temporel : frames accumulées au maximum quand la caméra est immobile
+    static constexpr int MAX_HISTORY_FRAMES = 32;
+
     // ==================== CONSTRUCTEURS ====================
     SSAORenderer();
     ~SSAORenderer();
@@ -20,38 +27,53 @@ public:
     SSAORenderer& operator=(const SSAORenderer&) = delete;
 
     // ==================== INITIALISATION ====================
+    // resolutionDivisor : 1 = pleine résolution, 2 = demi, 4 = quart
     void initialize(int screenWidth, int screenHeight,
-                   int kernelSize = 64, float radius = 0.5f, float bias = 0.025f);
+                   int kernelSize = 64, float radius = 0.5f, float bias = 0.025f,
+                   int resolutionDivisor = 2);
     bool loadDefaultShaders();
     bool loadShaders(const std::string& ssaoVS,
                     const std::string& ssaoFS,
                     const std::string& blurVS,
                     const std::string& blurFS);
     // ==================== RENDU ====================
-    void compute(GLuint gPositionTex, GLuint gNormalTex, const float* projMatrix, GLuint quadVAO,GLuint quadVBO);
-    void blur(GLuint quadVAO,GLuint quadVBO) const;
-    [[nodiscard]] GLuint getSSAOTexture() const { return ssaoColorBuffer_; }
-    [[nodiscard]] GLuint getBlurredSSAOTexture() const { return ssaoBlur_; }
+    // Matrice projection * vue de la frame courante (reprojection de l'historique)
+    void setViewProjection(const float* viewProjMatrix);
+    // Déclare les passes SSAO (basse résolution, accumulation temporelle, flou séparable
+    // sensible à la géométrie, upsample bilatéral) et retourne l'occlusion en pleine résolution.
+    // Les cibles intermédiaires sont transitoires : allouées et partagées par le graphe.
+    FrameGraphResource addToFrameGraph(FrameGraph& graph, FrameGraphResource gPosition,
+                                       FrameGraphResource gNormal, const float* projMatrix);
     // ==================== PARAMÈTRES ====================
     void setRadius(float radius);
     void setBias(float bias);
     void setKernelSize(int size);
+    void setResolutionDivisor(int divisor);
+    void setTemporalEnabled(bool enabled);
+    void setTemporalSampleCount(int count);
+    void resetHistory() { historyValid_ = false; }
 
     [[nodiscard]] float getRadius() const { return radius_; }
     [[nodiscard]] float getBias() const { return bias_; }
     [[nodiscard]] int getKernelSize() const { return kernelSize_; }
+    [[nodiscard]] int getResolutionDivisor() const { return resolutionDivisor_; }
+    [[nodiscard]] bool isTemporalEnabled() const { return temporalEnabled_; }
+    [[nodiscard]] int getTemporalSampleCount() const { return temporalSampleCount_; }
 
     // ==================== NETTOYAGE ====================
     void cleanup();
 private:
     // ==================== RESSOURCES OPENGL ====================
-    GLuint ssaoFBO_;
-    GLuint ssaoColorBuffer_;
-    GLuint blurFBO_;
-    GLuint ssaoBlur_;
     GLuint noiseTex_;
+    GLuint kernelUBO_;
+    GLuint fullscreenVAO_;
+    GLuint historyFBO_[2];
+    GLuint historyAO_[2];      // r = AO accumulé, gba = position monde
+    GLuint historyNormal_[2];  // xyz = normale, w = frames accumulées
     GLuint ssaoShader_;
     GLuint blurShader_;
+    GLuint upsampleShader_;
+    GLuint temporalShader_;
 
     // ==================== UNIFORMS ====================
     GLint ssaoProjLoc_;
@@ -59,36 +81,69 @@ private:
     GLint ssaoBiasLoc_;
     GLint ssaoKernelSizeLoc_;
     GLint ssaoNoiseLoc_;
+    GLint ssaoNoiseScaleLoc_;
+    GLint ssaoSampleCountLoc_;
+    GLint ssaoSampleStrideLoc_;
+    GLint ssaoSampleOffsetLoc_;
+    GLint ssaoFrameRotationLoc_;
 
     GLint blurTexLoc_;
+    GLint blurDirectionLoc_;
+    GLint blurSigmaLoc_;
+
+    GLint upsampleSigmaLoc_;
+
+    GLint temporalPrevViewProjLoc_;
+    GLint temporalHistoryValidLoc_;
+    GLint temporalMaxHistoryLoc_;
+    GLint temporalRejectDistanceLoc_;
 
     // ==================== PARAMÈTRES ====================
     int screenWidth_;
     int screenHeight_;
+    int resolutionDivisor_;
+    int lowResWidth_;
+    int lowResHeight_;
     int kernelSize_;
     float radius_;
     float bias_;
     bool initialized_;
 
+    // ==================== TEMPOREL ====================
+    bool temporalEnabled_;
+    int temporalSampleCount_;
+    int historyIndex_;
+    bool historyValid_;
+    unsigned int frameIndex_;
+    float viewProj_[16];
+    float prevViewProj_[16];
+    float projection_[16];
+
     std::vector<core::Vec3F> ssaoKernel_;
 
     // ==================== MÉTHODES PRIVÉES ====================
     void generateSSAOKernel();
+    void uploadKernel();
     void generateNoiseTexture();
-    void createFramebuffers();
+    void createHistoryTargets();
+    void deleteHistoryTargets();
 
-    static GLuint compileShader(GLenum type, const std::string& source);
-    static GLuint createProgram(GLuint vs, GLuint fs);
-    void initializeUniformLocations();
+    void renderOcclusion(GLuint gPositionTex, GLuint gNormalTex);
+    void accumulateTemporal(GLuint rawOcclusion, GLuint gPositionTex, GLuint gNormalTex);
+    void blurPass(GLuint input, GLuint gPositionTex, GLuint gNormalTex,
+                  float directionX, float directionY) const;
+    void upsamplePass(GLuint input, GLuint gPositionTex, GLuint gNormalTex) const;
 
-    static void printShaderError(GLuint shader, GLenum type);
-    static void printProgramError(GLuint program);
+    static GLuint submitProgram(const std::string& vs, const std::string& fs);
+    void initializeUniformLocations();
 
     // ==================== SHADERS PAR DÉFAUT ====================
     static std::string getDefaultSSAOVS();
     static std::string getDefaultSSAOFS();
     static std::string getDefaultBlurVS();
     static std::string getDefaultBlurFS();
+    static std::string getDefaultUpsampleFS();
+    static std::string getDefaultTemporalFS();
 
 };
 
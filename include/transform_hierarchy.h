@@ -0,0 +1,80 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hiérarchie de transforms aplatie : les nœuds sont rangés en largeur d'abord, un parent
+// toujours avant ses enfants, et chacun ne garde que la position de son parent.
+// update() calcule donc toutes les matrices monde en un seul parcours linéaire, qui démarre
+// au premier nœud modifié et ne recalcule que les sous-arbres sales.
+//
+// Les nœuds sont désignés par un identifiant stable ; leur position dans les tableaux peut
+// changer quand un re-parentage ou une suppression impose de réordonner (au update suivant).
+class TransformHierarchy {
+public:
+    static constexpr int INVALID_NODE = -1;
+
+    // ==================== CONSTRUCTEURS ====================
+    TransformHierarchy();
+    ~TransformHierarchy() = default;
+
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+    TransformHierarchy(TransformHierarchy&&) = default;
+    TransformHierarchy& operator=(TransformHierarchy&&) = default;
+
+    // ==================== NŒUDS ====================
+    // localMatrix nullptr : identité
+    int createNode(int parent = INVALID_NODE, const float *localMatrix = nullptr);
+    // Les enfants deviennent des racines
+    void removeNode(int node);
+    // Refuse (false) un parent qui est un descendant du nœud
+    bool setParent(int node, int parent);
+    void clear();
+
+    [[nodiscard]] bool isValid(int node) const;
+    [[nodiscard]] int getParent(int node) const;
+    [[nodiscard]] int size() const { return aliveCount_; }
+
+    // ==================== MATRICES ====================
+    void setLocalMatrix(int node, const float *localMatrix);
+    [[nodiscard]] const float *getLocalMatrix(int node) const;
+    // Valide après update()
+    [[nodiscard]] const float *getWorldMatrix(int node) const;
+
+    // Propage les matrices monde ; retourne le nombre de nœuds recalculés
+    std::size_t update();
+    // Nœud recalculé par le dernier update()
+    [[nodiscard]] bool wasUpdated(int node) const;
+    [[nodiscard]] bool isDirty() const { return orderDirty_ || firstDirty_ < parents_.size(); }
+
+private:
+    // ==================== DONNÉES (PAR POSITION) ====================
+    std::vector<int> parents_;              // position du parent, -1 pour une racine
+    std::vector<int> ids_;                  // identifiant du nœud, -1 si supprimé
+    std::vector<std::array<float, 16>> localMatrices_;
+    std::vector<std::array<float, 16>> worldMatrices_;
+    std::vector<std::uint8_t> dirty_;
+    std::vector<std::uint32_t> updatedSweeps_;
+
+    // ==================== IDENTIFIANTS ====================
+    std::vector<int> positions_;            // identifiant -> position, -1 si libre
+    std::vector<int> freeIds_;
+
+    std::size_t firstDirty_;
+    std::uint32_t sweep_;
+    int aliveCount_;
+    bool orderDirty_;
+
+    // ==================== MÉTHODES PRIVÉES ====================
+    void markDirty(std::size_t position);
+    void rebuildOrder();
+};
+
+#endif //TRANSFORM_HIERARCHY_H
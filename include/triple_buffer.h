@@ -0,0 +1,62 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Passage d'état entre un écrivain et un lecteur (deux threads distincts), sans verrou.
+// Trois exemplaires : celui en cours d'écriture, celui en cours de lecture, et le dernier publié.
+// Publier et acquérir ne font qu'échanger un indice avec le dernier publié : aucun des deux
+// côtés n'attend l'autre. Le lecteur voit toujours l'état publié le plus récent ; les
+// publications intermédiaires qu'il n'a pas eu le temps de lire sont sautées.
+//
+// Les exemplaires sont réutilisés tels quels : l'écrivain doit réécrire tout ce qu'il publie
+// (un vector garde sa capacité, donc plus d'allocation une fois le régime établi).
+template<typename T>
+class TripleBuffer {
+public:
+    // ==================== CONSTRUCTEURS ====================
+    TripleBuffer() : state_(1), writeIndex_(0), readIndex_(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // ==================== ÉCRIVAIN ====================
+    [[nodiscard]] T &getWriteBuffer() { return slots_[writeIndex_]; }
+
+    // L'exemplaire écrit devient le dernier publié ; l'écrivain récupère l'ancien
+    void publish() {
+        const std::uint8_t previous = state_.exchange(static_cast<std::uint8_t>(writeIndex_ | FRESH_BIT),
+                                                      std::memory_order_acq_rel);
+        writeIndex_ = previous & INDEX_MASK;
+    }
+
+    // ==================== LECTEUR ====================
+    // false si rien n'a été publié depuis la dernière acquisition (l'exemplaire lu reste valide)
+    bool acquire() {
+        if ((state_.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+            return false;
+        }
+        const std::uint8_t previous = state_.exchange(readIndex_, std::memory_order_acq_rel);
+        readIndex_ = previous & INDEX_MASK;
+        return true;
+    }
+
+    [[nodiscard]] const T &getReadBuffer() const { return slots_[readIndex_]; }
+
+private:
+    static constexpr std::uint8_t INDEX_MASK = 0x3;
+    static constexpr std::uint8_t FRESH_BIT = 0x4;
+
+    std::array<T, 3> slots_;
+    // Indice du dernier publié, plus FRESH_BIT tant que le lecteur ne l'a pas pris
+    std::atomic<std::uint8_t> state_;
+    std::uint8_t writeIndex_;   // propre à l'écrivain
+    std::uint8_t readIndex_;    // propre au lecteur
+};
+
+#endif //TRIPLE_BUFFER_H
@@ -0,0 +1,178 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+#include "third_party/gl_include.h"
+#include "shader_program.h"
+#include "frame_fences.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+// ==================== TYPES STD140 ====================
+// Un membre std140 de type vec4 / mat4 est aligné sur 16 octets : les types C++ reproduisent
+// cet alignement pour que offsetof() donne directement l'offset GLSL
+struct alignas(16) Std140Vec4 {
+    float x, y, z, w;
+};
+
+struct alignas(16) Std140Mat4 {
+    float m[16];
+};
+
+// Un bloc est envoyé tel quel avec glBufferSubData : mémoire contiguë, aucun padding implicite
+// en fin de bloc (std140 arrondit la taille au multiple de 16)
+template<typename Block>
+consteval bool isStd140Block() {
+    return std::is_standard_layout_v<Block> &&
+           std::is_trivially_copyable_v<Block> &&
+           alignof(Block) == 16 &&
+           sizeof(Block) % 16 == 0;
+}
+
+// ==================== BLOCS PARTAGÉS ====================
+// Points de binding fixes ; les renderers gardent 0-7 pour leurs propres blocs
+static constexpr GLuint FRAME_BLOCK_BINDING = 8;
+static constexpr GLuint VIEW_BLOCK_BINDING = 9;
+
+// Données valables pour toute la frame : lumière principale et temps
+struct FrameBlock {
+    Std140Mat4 lightSpaceMatrix;    // uLightSpaceMatrix
+    Std140Vec4 lightPosition;       // uLightPos (xyz)
+    float time;                     // uTime
+    float padding[3];
+
+    static constexpr const char *NAME = "FrameBlock";
+    static constexpr GLuint BINDING = FRAME_BLOCK_BINDING;
+    // Précision explicite : requise par les shaders "#version 300 es" (sans effet en GLSL desktop)
+    static constexpr const char *GLSL = R"(
+layout(std140) uniform FrameBlock {
+    highp mat4 uLightSpaceMatrix;
+    highp vec4 uLightPos;
+    highp float uTime;
+};
+)";
+};
+
+static_assert(isStd140Block<FrameBlock>());
+static_assert(offsetof(FrameBlock, lightSpaceMatrix) == 0);
+static_assert(offsetof(FrameBlock, lightPosition) == 64);
+static_assert(offsetof(FrameBlock, time) == 80);
+static_assert(sizeof(FrameBlock) == 96);
+
+// Données de la caméra courante
+struct ViewBlock {
+    Std140Mat4 view;                // uView
+    Std140Mat4 projection;          // uProj
+    Std140Mat4 invProjection;       // uInvProj
+    Std140Mat4 invViewRotation;     // uInvViewRot (rotation seule)
+    Std140Vec4 cameraPosition;      // uCameraPos (xyz, w = plan far)
+
+    static constexpr const char *NAME = "ViewBlock";
+    static constexpr GLuint BINDING = VIEW_BLOCK_BINDING;
+    static constexpr const char *GLSL = R"(
+layout(std140) uniform ViewBlock {
+    highp mat4 uView;
+    highp mat4 uProj;
+    highp mat4 uInvProj;
+    highp mat4 uInvViewRot;
+    highp vec4 uCameraPos;
+};
+)";
+};
+
+static_assert(isStd140Block<ViewBlock>());
+static_assert(offsetof(ViewBlock, view) == 0);
+static_assert(offsetof(ViewBlock, projection) == 64);
+static_assert(offsetof(ViewBlock, invProjection) == 128);
+static_assert(offsetof(ViewBlock, invViewRotation) == 192);
+static_assert(offsetof(ViewBlock, cameraPosition) == 256);
+static_assert(sizeof(ViewBlock) == 272);
+
+// Déclarations GLSL des blocs partagés, à passer en "defines" à ProgramCache
+inline std::string getSharedBlocksGLSL() {
+    return std::string(FrameBlock::GLSL) + ViewBlock::GLSL;
+}
+
+// ==================== BUFFER ====================
+// UBO d'un bloc partagé, attaché à son point de binding. upload() ignore une valeur
+// identique à la précédente : la caméra immobile ne coûte aucun transfert.
+//
+// Avec plusieurs tranches (une par slot de FrameFences), chaque frame écrit et attache la
+// tranche de son slot : le GPU peut encore lire celle des frames en vol. Chaque tranche garde
+// sa copie, une tranche déjà à jour est seulement rattachée.
+template<typename Block>
+class UniformBuffer {
+    static_assert(isStd140Block<Block>(), "Le bloc doit respecter le layout std140");
+
+public:
+    // ==================== CONSTRUCTEURS ====================
+    UniformBuffer() : data_{}, slices_{}, uploaded_{} {}
+    ~UniformBuffer() { cleanup(); }
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // ==================== CYCLE DE VIE ====================
+    void initialize(int sliceCount = 1) {
+        if (ring_.getBuffer() != 0) return;
+        ring_.initialize(GL_UNIFORM_BUFFER, sizeof(Block),
+                         std::min(sliceCount, FrameFences::MAX_FRAMES_IN_FLIGHT));
+        ring_.bindRange(Block::BINDING, 0, sizeof(Block));
+        uploaded_.fill(false);
+    }
+
+    void cleanup() {
+        ring_.cleanup();
+        uploaded_.fill(false);
+    }
+
+    // ==================== ENVOIS ====================
+    // frameSlot : FrameFences::beginFrame() (toujours 0 avec une seule tranche)
+    void upload(const Block &data, int frameSlot = 0) {
+        if (frameSlot < 0 || frameSlot >= ring_.getSliceCount()) frameSlot = 0;
+        data_ = data;
+        Block &slice = slices_[frameSlot];
+        if (!uploaded_[frameSlot] || std::memcmp(&slice, &data, sizeof(Block)) != 0) {
+            slice = data;
+            uploaded_[frameSlot] = true;
+            ring_.write(frameSlot, &slice, sizeof(Block));
+        }
+        if (ring_.getSliceCount() > 1) {
+            ring_.bindRange(Block::BINDING, frameSlot, sizeof(Block));
+        }
+    }
+
+    // Associe le bloc du programme au binding partagé et vérifie que le GLSL lié ne lit pas
+    // au-delà de la struct C++ (un miroir désynchronisé est signalé au lieu de lire n'importe quoi)
+    void attach(const ShaderProgram &program) const {
+        const UniformName name = UniformName::runtime(Block::NAME);
+        if (program.getBlockIndex(name) == GL_INVALID_INDEX) return;
+        program.setBlockBinding(name, Block::BINDING);
+
+        const GLint size = program.getBlockDataSize(name);
+        if (size > static_cast<GLint>(sizeof(Block))) {
+            std::cerr << "ERROR: " << Block::NAME << " layout mismatch in program " << program.getId()
+                    << " (GLSL " << size << " bytes, C++ " << sizeof(Block) << " bytes)" << std::endl;
+        }
+    }
+
+    // ==================== GETTERS ====================
+    [[nodiscard]] GLuint getId() const { return ring_.getBuffer(); }
+    [[nodiscard]] const Block &getData() const { return data_; }
+
+private:
+    // ==================== DONNÉES ====================
+    FrameRingBuffer ring_;
+    Block data_;
+    std::array<Block, FrameFences::MAX_FRAMES_IN_FLIGHT> slices_;
+    std::array<bool, FrameFences::MAX_FRAMES_IN_FLIGHT> uploaded_;
+};
+
+#endif //UNIFORM_BLOCKS_H
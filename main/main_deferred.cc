@@ -10,6 +10,7 @@
 #include <SDL3/SDL.h>
 
 #include "model_loader.h"
+#include "shader_permutations.h"
 #include "engine/engine.h"
 #include "engine/window.h"
 #include "engine/renderer.h"
@@ -284,13 +285,17 @@ private:
     GLuint cubemapTex_ = 0;
 
     // CUBES
-    GLuint cubeProgram_ = 0;
+    // Variantes : options de shader en #define plutôt qu'en branches sur des uniforms
+    ShaderPermutations cubeVariants_;
+    bool useNormalMap_ = true;
     GLuint cubeVAO_ = 0, cubeVBO_ = 0, cubeEBO_ = 0;
     GLsizei cubeIndexCount_ = 0;
     GLuint cubeInstanceVBO_ = 0;
     GLuint cubeDiffuseTex_ = 0;
     GLuint cubeNormalTex_ = 0;
-    GLuint deferredProgram_ = 0;
+    ShaderPermutations deferredVariants_;
+    int deferredDebugMode_ = 0; // 0=normal, 1=positions, 2=normales, 3=albedo, 4=UV
+    int pointLightCount_ = 1;
     GLuint gBuffer_ = 0, gPosition_ = 0, gNormal_ = 0, gAlbedoSpec_ = 0;
     GLuint rboDepth_ = 0;
     std::vector<core::Vec3F> cubeCenters_;
@@ -426,7 +431,7 @@ in vec3 Normal;
 
 uniform sampler2D uDiffuse;
 uniform sampler2D uNormalMap;
-uniform bool useNormal;
+// USE_NORMAL_MAP : défini par la variante (ShaderPermutations)
 
 void main(){
 
@@ -435,12 +440,12 @@ void main(){
     // tangent -> world
     vec3 N = normalize(Normal);
 
-    if(useNormal){
-        // normal map (tangent space)
-        vec3 nTS = texture(uNormalMap, vUV).rgb;
-        nTS = normalize(nTS * 2.0 - 1.0); // [0,1] -> [-1,1]
-        N=normalize(vTBN * nTS);
-    }
+#if USE_NORMAL_MAP
+    // normal map (tangent space)
+    vec3 nTS = texture(uNormalMap, vUV).rgb;
+    nTS = normalize(nTS * 2.0 - 1.0); // [0,1] -> [-1,1]
+    N=normalize(vTBN * nTS);
+#endif
     gNormal=vec4(N*0.5+0.5, 1.0);
 
     vec4 diffuseTex = texture(uDiffuse, vUV);
@@ -483,34 +488,31 @@ struct PointLight{
     float linear;
     float quadratic;
 };
-uniform int pointLightCount;
-uniform PointLight pointLights[1];
-
-uniform int debugMode;
+// POINT_LIGHT_COUNT et DEBUG_MODE : définis par la variante (ShaderPermutations)
+#if POINT_LIGHT_COUNT > 0
+uniform PointLight pointLights[POINT_LIGHT_COUNT];
+#endif
 
 void main(){
     // Mode debug: 0=normal, 1=positions, 2=normales, 3=albedo, 4=UV
-    if(debugMode == 1) {
-        // Afficher les positions (normalisées pour la visualisation)
-        vec3 pos = texture(gPosition, TexCoord).rgb;
-        FragColor = vec4(normalize(pos) * 0.5 + 0.5, 1.0);
-        return;
-    }
-    else if(debugMode == 2) {
-        // Afficher les normales (déjà en [0,1])
-        FragColor = texture(gNormal, TexCoord);
-        return;
-    }
-    else if(debugMode == 3) {
-        // Afficher l'albedo (couleur de la texture)
-        FragColor = texture(gAlbedoSpec, TexCoord);
-        return;
-    }
-    else if(debugMode == 4) {
-        // Afficher les coordonnées UV
-        FragColor = vec4(TexCoord, 0.0, 1.0);
-        return;
-    }
+#if DEBUG_MODE == 1
+    // Afficher les positions (normalisées pour la visualisation)
+    vec3 pos = texture(gPosition, TexCoord).rgb;
+    FragColor = vec4(normalize(pos) * 0.5 + 0.5, 1.0);
+    return;
+#elif DEBUG_MODE == 2
+    // Afficher les normales (déjà en [0,1])
+    FragColor = texture(gNormal, TexCoord);
+    return;
+#elif DEBUG_MODE == 3
+    // Afficher l'albedo (couleur de la texture)
+    FragColor = texture(gAlbedoSpec, TexCoord);
+    return;
+#elif DEBUG_MODE == 4
+    // Afficher les coordonnées UV
+    FragColor = vec4(TexCoord, 0.0, 1.0);
+    return;
+#endif
 
     // Lire les données du G-buffer
     vec4 positionData = texture(gPosition, TexCoord);
@@ -545,7 +547,8 @@ void main(){
     vec3 viewDir = normalize(viewPos - fragPos);
     vec3 lighting = albedo * 0.1; // Ambient
 
-    for(int i = 0; i < pointLightCount; i++){
+#if POINT_LIGHT_COUNT > 0
+    for(int i = 0; i < POINT_LIGHT_COUNT; i++){
         vec3 lightDir = normalize(pointLights[i].position - fragPos);
 
         // Diffuse
@@ -565,12 +568,26 @@ void main(){
 
         lighting += (diffuse + specular) * attenuation;
     }
+#endif
 
     FragColor = vec4(lighting, 1.0);
 })";
 
-        cubeProgram_ = createProgram(vs, fs);
-        deferredProgram_ = createProgram(drv, drf);
+        cubeVariants_.initialize({{GL_VERTEX_SHADER, vs}, {GL_FRAGMENT_SHADER, fs}}, {{"USE_NORMAL_MAP", 1}});
+        cubeVariants_.setOnCreated([](ShaderProgram &program) {
+            program.setInt("uDiffuse", 0);
+            program.setInt("uNormalMap", 1);
+        });
+        deferredVariants_.initialize({{GL_VERTEX_SHADER, drv}, {GL_FRAGMENT_SHADER, drf}},
+                                     {{"DEBUG_MODE", 3}, {"POINT_LIGHT_COUNT", 3}});
+        deferredVariants_.setOnCreated([](ShaderProgram &program) {
+            program.setInt("gPosition", 0);
+            program.setInt("gNormal", 1);
+            program.setInt("gAlbedoSpec", 2);
+        });
+        if (cubeVariants_.get(getCubeKey()) == nullptr || deferredVariants_.get(getDeferredKey()) == nullptr) {
+            throw std::runtime_error("Erreur création program (voir log ci-dessus)");
+        }
         static constexpr float vertices[] = {
             // +X
             +0.5f, -0.5f, -0.5f, 1, 0, 0, 0, 0, 0, 0, -1,
@@ -1279,21 +1296,18 @@ void main(){
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
 
-        glUseProgram(cubeProgram_);
+        // Variante avec ou sans normal map (unités des samplers fixées à sa création)
+        ShaderProgram *cube = cubeVariants_.bind(getCubeKey());
+        if (cube == nullptr) return;
 
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uView"), 1, GL_FALSE, view);
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uProj"), 1, GL_FALSE, proj);
+        cube->setMat4("uView", view);
+        cube->setMat4("uProj", proj);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, cubeDiffuseTex_);
-        glUniform1i(glGetUniformLocation(cubeProgram_, "uDiffuse"), 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, cubeNormalTex_);
-        glUniform1i(glGetUniformLocation(cubeProgram_, "uNormalMap"), 1);
-
-        // Optionnel : activer la normal map (si uniform existe)
-        glUniform1i(glGetUniformLocation(cubeProgram_, "useNormal"), 1);
 
         // Mise à jour des instances
         cubeInstanceMatrices_.clear();
@@ -1327,27 +1341,23 @@ void main(){
         // Désactiver le test de profondeur pour le quad plein écran
         glDisable(GL_DEPTH_TEST);
 
-        glUseProgram(deferredProgram_);
+        // Variante du mode debug et du nombre de lumières courants
+        ShaderProgram *deferred = deferredVariants_.bind(getDeferredKey());
+        if (deferred == nullptr) return;
 
         // Activer les textures du G-buffer
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gPosition_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gPosition"), 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, gNormal_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gNormal"), 1);
 
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gAlbedoSpec"), 2);
 
         // Uniforms critiques – noms exacts du shader
-        glUniform3f(glGetUniformLocation(deferredProgram_, "viewPos"), camX, camY, camZ);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "specularPow"), 32.0f);
-
-        // Lumière
-        glUniform1i(glGetUniformLocation(deferredProgram_, "pointLightCount"), 1);
+        deferred->setVec3("viewPos", camX, camY, camZ);
+        deferred->setFloat("specularPow", 32.0f);
 
         // Position de la lumière qui suit la caméra
         // float lightX = camX + 5.0f;
@@ -1359,14 +1369,11 @@ void main(){
         float lightY = target_[1] + 8.0f; // Hauteur fixe
         float lightZ = target_[2] + sin(lightAngle) * lightOrbitRadius;
 
-        glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].position"),
-                    lightX, lightY, lightZ);
-
-        glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].color"),
-                    1.2f, 1.1f, 1.0f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].constant"), 1.0f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].linear"), 0.09f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].quadratic"), 0.032f);
+        deferred->setVec3("pointLights[0].position", lightX, lightY, lightZ);
+        deferred->setVec3("pointLights[0].color", 1.2f, 1.1f, 1.0f);
+        deferred->setFloat("pointLights[0].constant", 1.0f);
+        deferred->setFloat("pointLights[0].linear", 0.09f);
+        deferred->setFloat("pointLights[0].quadratic", 0.032f);
 
         // Rendu du quad plein écran
         glBindVertexArray(quadVAO_);
@@ -1797,6 +1804,14 @@ void main(){
         return shader;
     }
 
+    [[nodiscard]] ShaderPermutations::Key getCubeKey() const {
+        return cubeVariants_.makeKey({useNormalMap_ ? 1 : 0});
+    }
+
+    [[nodiscard]] ShaderPermutations::Key getDeferredKey() const {
+        return deferredVariants_.makeKey({deferredDebugMode_, pointLightCount_});
+    }
+
     static GLuint createProgram(const std::string &vertexSrc, const std::string &fragmentSrc) {
         GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSrc);
         GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSrc);
@@ -1916,8 +1931,8 @@ void main(){
         if (skyboxVAO_)
             glDeleteVertexArrays(1, &skyboxVAO_);
 
-        if (cubeProgram_)
-            glDeleteProgram(cubeProgram_);
+        cubeVariants_.cleanup();
+        deferredVariants_.cleanup();
         if (cubeVBO_)
             glDeleteBuffers(1, &cubeVBO_);
         if (cubeEBO_)
@@ -1925,7 +1940,7 @@ void main(){
         if (cubeVAO_)
             glDeleteVertexArrays(1, &cubeVAO_);
 
-        cubeProgram_ = cubeVAO_ = cubeVBO_ = cubeEBO_ = 0;
+        cubeVAO_ = cubeVBO_ = cubeEBO_ = 0;
 
         if (postProgram_)
             glDeleteProgram(postProgram_);
@@ -8,6 +8,7 @@
 #include <imgui.h>
 #include <SDL3/SDL.h>
 
+#include "bloom_renderer.h"
 #include "model_loader.h"
 #include "engine/engine.h"
 #include "engine/window.h"
@@ -65,7 +66,7 @@ public:
         pitch_ = 10.0f;
         // Créer des framebuffers supplémentaires pour les effets
         createMultiPassFramebuffers();
-        createBloomFramebuffers();
+        bloom_.initialize(width_, height_);
         createSkyboxRessources();
 
         initPostProcessingShaders();
@@ -209,8 +210,8 @@ private:
     PostEffect currentEffect_ = EFFECT_NONE;
     bool useBloom_ = false;
     float bloomThreshold_ = 0.7f;
+    float bloomKnee_ = 0.5f;
     float bloomIntensity_ = 1.0f;
-    int blurIterations_ = 4;
 
     // Noms des effets pour l'affichage
     std::vector<std::string> effectNames_ = {
@@ -238,8 +239,6 @@ private:
     GLuint modelProgram_ = 0;
     GLuint skyboxProgram_ = 0;
     GLuint postProgram_ = 0;
-    GLuint bloomExtractProgram_ = 0;
-    GLuint bloomBlurProgram_ = 0;
     GLuint bloomCombineProgram_ = 0;
 
     // Textures et FBOs
@@ -256,9 +255,8 @@ private:
     GLuint pingpongFBO_[2] = {0, 0};
     GLuint pingpongTex_[2] = {0, 0};
 
-    // FBOs pour le bloom
-    GLuint bloomFBO_[2] = {0, 0};
-    GLuint bloomTex_[2] = {0, 0};
+    // Bloom par chaîne de mips (une seule texture HDR)
+    BloomRenderer bloom_;
 
     // Géométrie
     GLuint quadVAO_ = 0;
@@ -429,31 +427,6 @@ private:
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
-    // Création des framebuffers pour le bloom
-    void createBloomFramebuffers() {
-        for (int i = 0; i < 2; i++) {
-            glGenFramebuffers(1, &bloomFBO_[i]);
-            glGenTextures(1, &bloomTex_[i]);
-
-            glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO_[i]);
-            glBindTexture(GL_TEXTURE_2D, bloomTex_[i]);
-
-            // Textures plus petites pour le bloom (downsampling)
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width_/2, height_/2, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, bloomTex_[i], 0);
-
-            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-                std::cerr << "[Bloom FBO " << i << "] incomplet!" << std::endl;
-            }
-        }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    }
-
     // Création du quad écran pour post-processing
     void createScreenQuad() {
         const float quad[] = {
@@ -649,33 +622,6 @@ private:
 
     // Initialisation des shaders pour le bloom
     void initBloomShaders() {
-    // Shader d'extraction des zones lumineuses
-    const char* bloomExtractFS = R"(
-        #version 300 es
-        precision mediump float;
-
-        in vec2 vUV;
-        out vec4 FragColor;
-
-        uniform sampler2D uScene;
-        uniform float uThreshold;
-
-        float luminance(vec3 color) {
-            return dot(color, vec3(0.299, 0.587, 0.114));
-        }
-
-        void main() {
-            vec3 color = texture(uScene, vUV).rgb;
-            float brightness = luminance(color);
-
-            if (brightness > uThreshold) {
-                FragColor = vec4(color, 1.0);
-            } else {
-                FragColor = vec4(0.0, 0.0, 0.0, 1.0);
-            }
-        }
-    )";
-
     const char* bloomVertexShader = R"(
         #version 300 es
         precision mediump float;
@@ -691,43 +637,6 @@ private:
         }
     )";
 
-    // Shader de flou gaussien - CORRIGÉ
-    const char* bloomBlurFS = R"(
-        #version 300 es
-        precision mediump float;
-
-        in vec2 vUV;
-        out vec4 FragColor;
-
-        uniform sampler2D uImage;
-        uniform bool uHorizontal;
-        uniform vec2 uTexelSize;
-
-        void main() {
-            vec2 texelSize = uTexelSize;
-            vec3 result = vec3(0.0);
-
-            // Noyau gaussien 9x1
-            float weight[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
-
-            result = texture(uImage, vUV).rgb * weight[0];
-
-            if (uHorizontal) {
-                for (int i = 1; i < 5; i++) {
-                    result += texture(uImage, vUV + vec2(texelSize.x * float(i), 0.0)).rgb * weight[i];
-                    result += texture(uImage, vUV - vec2(texelSize.x * float(i), 0.0)).rgb * weight[i];
-                }
-            } else {
-                for (int i = 1; i < 5; i++) {
-                    result += texture(uImage, vUV + vec2(0.0, texelSize.y * float(i))).rgb * weight[i];
-                    result += texture(uImage, vUV - vec2(0.0, texelSize.y * float(i))).rgb * weight[i];
-                }
-            }
-
-            FragColor = vec4(result, 1.0);
-        }
-    )";
-
     // Shader de combinaison bloom - SIMPLIFIÉ POUR ÉVITER LES ERREURS
     const char* bloomCombineFS = R"(
         #version 300 es
@@ -751,8 +660,6 @@ private:
         }
     )";
 
-    bloomExtractProgram_ = createProgram(bloomVertexShader, bloomExtractFS);
-    bloomBlurProgram_ = createProgram(bloomVertexShader, bloomBlurFS);
     bloomCombineProgram_ = createProgram(bloomVertexShader, bloomCombineFS);
 }
 
@@ -854,40 +761,9 @@ private:
 
     // Rendu avec effet de bloom
     void renderWithBloom() {
-        // Étape 1: Extraire les zones lumineuses
-        glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO_[0]);
-        glViewport(0, 0, width_/2, height_/2);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(bloomExtractProgram_);
-        glUniform1f(glGetUniformLocation(bloomExtractProgram_, "uThreshold"), bloomThreshold_);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, colorTex_);
-
-        glBindVertexArray(quadVAO_);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        // Étape 2: Flou gaussien (ping-pong)
-        bool horizontal = true;
-        bool first_iteration = true;
-
-        glUseProgram(bloomBlurProgram_);
-        glUniform2f(glGetUniformLocation(bloomBlurProgram_, "uTexelSize"),
-                   1.0f / (width_/2), 1.0f / (height_/2));
-
-        for (int i = 0; i < blurIterations_ * 2; i++) {
-            glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO_[horizontal ? 1 : 0]);
-            glUniform1i(glGetUniformLocation(bloomBlurProgram_, "uHorizontal"), horizontal);
-
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, first_iteration ? bloomTex_[0] : bloomTex_[horizontal ? 0 : 1]);
-
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-
-            horizontal = !horizontal;
-            if (first_iteration) first_iteration = false;
-        }
+        // Étapes 1-2: seuil + descente/remontée de la chaîne de mips
+        bloom_.setThreshold(bloomThreshold_, bloomKnee_);
+        bloom_.render(colorTex_);
 
         // Étape 3: Combiner bloom avec la scène
         glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO_[0]);
@@ -901,9 +777,10 @@ private:
         glBindTexture(GL_TEXTURE_2D, colorTex_);
 
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, bloomTex_[1]);
+        glBindTexture(GL_TEXTURE_2D, bloom_.getTexture());
         glUniform1i(glGetUniformLocation(bloomCombineProgram_, "uBloomBlur"), 1);
 
+        glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
         // Étape 4: Appliquer l'effet de post-processing final
@@ -969,14 +846,16 @@ private:
     out vec2 TexCoord;
 
     uniform mat4 uModel;
+    uniform mat4 uNodeMatrix; // Model::Draw, par nœud
     uniform mat4 uView;
     uniform mat4 uProj;
 
     void main() {
-        FragPos = vec3(uModel * vec4(aPosition, 1.0));
+        mat4 model = uModel * uNodeMatrix;
+        FragPos = vec3(model * vec4(aPosition, 1.0));
 
         // SIMPLIFIÉ: pas de transformation inverse/transpose
-        Normal = normalize(mat3(uModel) * aNormal);
+        Normal = normalize(mat3(model) * aNormal);
 
         // OU: utiliser directement les normales du modèle
         Normal = normalize(aNormal);
@@ -1387,8 +1266,6 @@ private:
         if (skyboxVAO_) glDeleteVertexArrays(1, &skyboxVAO_);
 
         if (postProgram_) glDeleteProgram(postProgram_);
-        if (bloomExtractProgram_) glDeleteProgram(bloomExtractProgram_);
-        if (bloomBlurProgram_) glDeleteProgram(bloomBlurProgram_);
         if (bloomCombineProgram_) glDeleteProgram(bloomCombineProgram_);
 
         if (fbo_) glDeleteFramebuffers(1, &fbo_);
@@ -1398,10 +1275,10 @@ private:
         for (int i = 0; i < 2; i++) {
             if (pingpongFBO_[i]) glDeleteFramebuffers(1, &pingpongFBO_[i]);
             if (pingpongTex_[i]) glDeleteTextures(1, &pingpongTex_[i]);
-            if (bloomFBO_[i]) glDeleteFramebuffers(1, &bloomFBO_[i]);
-            if (bloomTex_[i]) glDeleteTextures(1, &bloomTex_[i]);
         }
 
+        bloom_.cleanup();
+
         if (quadVAO_) glDeleteVertexArrays(1, &quadVAO_);
         if (quadVBO_) glDeleteBuffers(1, &quadVBO_);
 
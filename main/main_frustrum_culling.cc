@@ -1342,14 +1342,16 @@ void main(){
     out vec2 TexCoord;
 
     uniform mat4 uModel;
+    uniform mat4 uNodeMatrix = mat4(1.0); // Model::Draw, par nœud
     uniform mat4 uView;
     uniform mat4 uProj;
 
     void main() {
-        FragPos = vec3(uModel * vec4(aPosition, 1.0));
+        mat4 model = uModel * uNodeMatrix;
+        FragPos = vec3(model * vec4(aPosition, 1.0));
 
         // SIMPLIFIÉ: pas de transformation inverse/transpose
-        Normal = normalize(mat3(uModel) * aNormal);
+        Normal = normalize(mat3(model) * aNormal);
 
         // OU: utiliser directement les normales du modèle
         Normal = normalize(aNormal);
@@ -0,0 +1,271 @@
+//
+// Created by forna on 18.10.2026.
+//
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "matrix_math.h"
+
+// Microbenchmark des noyaux MatrixMath contre les anciennes versions scalaires
+// (boucles triples de SceneManager / LightManager, createTransformMatrix à quatre produits).
+// Application console : aucune fenêtre ni contexte OpenGL.
+namespace {
+    constexpr std::size_t kCount = 4096;
+    constexpr int kRepetitions = 200;
+
+    // ==================== RÉFÉRENCES (ANCIEN CODE) ====================
+    void legacyMultiply(float *out, const float *a, const float *b) {
+        // Column-major (OpenGL) : out = a * b
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                out[c * 4 + r] = 0.0f;
+                for (int k = 0; k < 4; ++k) {
+                    out[c * 4 + r] += a[k * 4 + r] * b[c * 4 + k];
+                }
+            }
+        }
+    }
+
+    void legacyRotation(float *out, int axis, float angle) {
+        MatrixMath::identity(out);
+        const float c = std::cos(angle);
+        const float s = std::sin(angle);
+        const int i = (axis + 1) % 3;
+        const int j = (axis + 2) % 3;
+        out[i * 5] = c;
+        out[i * 4 + j] = s;
+        out[j * 4 + i] = -s;
+        out[j * 5] = c;
+    }
+
+    void legacyComposeTRS(float *out, const core::Vec3F &position, const core::Vec3F &rotation,
+                          const core::Vec3F &scale) {
+        float translationMat[16], rotX[16], rotY[16], rotZ[16], scaleMat[16], temp[16], rot[16];
+        MatrixMath::translation(translationMat, position.x, position.y, position.z);
+        legacyRotation(rotX, 0, rotation.x);
+        legacyRotation(rotY, 1, rotation.y);
+        legacyRotation(rotZ, 2, rotation.z);
+        MatrixMath::scaling(scaleMat, scale.x, scale.y, scale.z);
+        legacyMultiply(temp, rotY, rotX);
+        legacyMultiply(rot, rotZ, temp);
+        legacyMultiply(temp, rot, scaleMat);
+        legacyMultiply(out, translationMat, temp);
+    }
+
+    void legacyTransformAabbs(Aabb *out, const float *matrices, const Aabb *local, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *m = matrices + i * 16;
+            for (int r = 0; r < 3; ++r) {
+                const float c0 = (local[i].min[0] + local[i].max[0]) * 0.5f;
+                const float c1 = (local[i].min[1] + local[i].max[1]) * 0.5f;
+                const float c2 = (local[i].min[2] + local[i].max[2]) * 0.5f;
+                const float e0 = (local[i].max[0] - local[i].min[0]) * 0.5f;
+                const float e1 = (local[i].max[1] - local[i].min[1]) * 0.5f;
+                const float e2 = (local[i].max[2] - local[i].min[2]) * 0.5f;
+                const float center = m[r] * c0 + m[4 + r] * c1 + m[8 + r] * c2 + m[12 + r];
+                const float extent = std::abs(m[r]) * e0 + std::abs(m[4 + r]) * e1 + std::abs(m[8 + r]) * e2;
+                out[i].min[r] = center - extent;
+                out[i].max[r] = center + extent;
+            }
+        }
+    }
+
+    void legacyTranspose(float *out, const float *m) {
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                out[c * 4 + r] = m[r * 4 + c];
+            }
+        }
+    }
+
+    // ==================== VÉRIFICATION ====================
+    float maxDifference(const float *a, const float *b) {
+        float error = 0.0f;
+        for (int k = 0; k < 16; ++k) {
+            error = std::fmax(error, std::abs(a[k] - b[k]));
+        }
+        return error;
+    }
+
+    // Écarts max du noyau actif contre l'ancien code ; inverse : m * inverse(m) contre l'identité
+    struct KernelErrors {
+        float multiply = 0.0f;
+        float composeTRS = 0.0f;
+        float inverse = 0.0f;
+        float inverseTranspose = 0.0f;
+    };
+
+    KernelErrors measureErrors(const std::vector<float> &matricesA, const std::vector<float> &matricesB,
+                               const std::vector<core::Vec3F> &positions, const std::vector<core::Vec3F> &rotations,
+                               const std::vector<core::Vec3F> &scales) {
+        KernelErrors errors;
+        float identity[16];
+        MatrixMath::identity(identity);
+        for (std::size_t i = 0; i < kCount; ++i) {
+            float legacy[16], kernel[16], temp[16];
+            legacyMultiply(legacy, &matricesA[i * 16], &matricesB[i * 16]);
+            MatrixMath::multiply(kernel, &matricesA[i * 16], &matricesB[i * 16]);
+            errors.multiply = std::fmax(errors.multiply, maxDifference(legacy, kernel));
+
+            legacyComposeTRS(legacy, positions[i], rotations[i], scales[i]);
+            MatrixMath::composeTRS(kernel, positions[i], rotations[i], scales[i]);
+            errors.composeTRS = std::fmax(errors.composeTRS, maxDifference(legacy, kernel));
+
+            // matricesB : TRS à échelle >= 1, toujours inversibles
+            const float *m = &matricesB[i * 16];
+            if (MatrixMath::inverse(kernel, m)) {
+                legacyMultiply(temp, m, kernel);
+                errors.inverse = std::fmax(errors.inverse, maxDifference(temp, identity));
+            }
+            if (MatrixMath::inverseTranspose(kernel, m)) {
+                legacyTranspose(temp, kernel);
+                legacyMultiply(legacy, m, temp);
+                errors.inverseTranspose = std::fmax(errors.inverseTranspose, maxDifference(legacy, identity));
+            }
+        }
+        return errors;
+    }
+
+    // ==================== MESURE ====================
+    volatile float g_sink = 0.0f;
+
+    template<typename Function>
+    double measureNs(Function &&function) {
+        function();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kRepetitions; ++i) {
+            function();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        return ns / (static_cast<double>(kRepetitions) * kCount);
+    }
+
+    void printRow(const char *name, double legacyNs, double ns) {
+        std::printf("  %-22s %8.2f ns  (ancien %8.2f ns, x%.2f)\n", name, ns, legacyNs, legacyNs / ns);
+    }
+}
+
+int main() {
+    std::mt19937 rng(924);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+
+    std::vector<float> matricesA(kCount * 16), matricesB(kCount * 16), result(kCount * 16);
+    std::vector<core::Vec3F> positions(kCount), rotations(kCount), scales(kCount);
+    std::vector<float> points(kCount * 3), transformed(kCount * 3);
+    std::vector<Aabb> localBounds(kCount), worldBounds(kCount);
+
+    for (float &v : matricesA) v = dist(rng);
+    for (float &v : matricesB) v = dist(rng);
+    for (float &v : points) v = dist(rng);
+    for (std::size_t i = 0; i < kCount; ++i) {
+        positions[i] = {dist(rng), dist(rng), dist(rng)};
+        rotations[i] = {dist(rng), dist(rng), dist(rng)};
+        scales[i] = {dist(rng) + 3.0f, dist(rng) + 3.0f, dist(rng) + 3.0f};
+        for (int k = 0; k < 3; ++k) {
+            localBounds[i].min[k] = -std::abs(dist(rng));
+            localBounds[i].max[k] = std::abs(dist(rng));
+        }
+    }
+    // Matrices de modèle réalistes pour les AABB
+    for (std::size_t i = 0; i < kCount; ++i) {
+        MatrixMath::composeTRS(&matricesB[i * 16], positions[i], rotations[i], scales[i]);
+    }
+
+    // ==================== ANCIEN CODE ====================
+    const double legacyMultiplyNs = measureNs([&] {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            legacyMultiply(&result[i * 16], &matricesA[i * 16], &matricesB[i * 16]);
+        }
+        g_sink = result[0];
+    });
+    const double legacyComposeNs = measureNs([&] {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            legacyComposeTRS(&result[i * 16], positions[i], rotations[i], scales[i]);
+        }
+        g_sink = result[0];
+    });
+    const double legacyBatchNs = measureNs([&] {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            legacyMultiply(&result[i * 16], &matricesA[0], &matricesB[i * 16]);
+        }
+        g_sink = result[0];
+    });
+    const double legacyPointsNs = measureNs([&] {
+        const float *m = &matricesA[0];
+        for (std::size_t i = 0; i < kCount; ++i) {
+            for (int r = 0; r < 3; ++r) {
+                transformed[i * 3 + r] = m[r] * points[i * 3] + m[4 + r] * points[i * 3 + 1] +
+                                         m[8 + r] * points[i * 3 + 2] + m[12 + r];
+            }
+        }
+        g_sink = transformed[0];
+    });
+    const double legacyAabbNs = measureNs([&] {
+        legacyTransformAabbs(worldBounds.data(), matricesB.data(), localBounds.data(), kCount);
+        g_sink = worldBounds[0].min[0];
+    });
+
+    std::printf("MatrixMath : %zu elements, %d repetitions, temps par element\n", kCount, kRepetitions);
+
+    // ==================== NOYAUX ====================
+    const MatrixMath::InstructionSet supported = MatrixMath::getSupportedInstructionSet();
+    for (MatrixMath::InstructionSet set : {MatrixMath::InstructionSet::Scalar,
+                                           MatrixMath::InstructionSet::SSE,
+                                           MatrixMath::InstructionSet::AVX2}) {
+        if (static_cast<int>(set) > static_cast<int>(supported)) {
+            std::printf("%s : non supporte par ce processeur\n", MatrixMath::getInstructionSetName(set));
+            continue;
+        }
+        MatrixMath::setInstructionSet(set);
+        std::printf("%s\n", MatrixMath::getInstructionSetName(set));
+
+        // Vérification : chaque noyau doit reproduire l'ancien code (le TRS fermé, T * Rz * Ry * Rx * S)
+        const KernelErrors errors = measureErrors(matricesA, matricesB, positions, rotations, scales);
+        std::printf("  Ecart max : multiply %g, composeTRS %g, inverse %g, inverseTranspose %g\n",
+                    errors.multiply, errors.composeTRS, errors.inverse, errors.inverseTranspose);
+
+        printRow("multiply", legacyMultiplyNs, measureNs([&] {
+            for (std::size_t i = 0; i < kCount; ++i) {
+                MatrixMath::multiply(&result[i * 16], &matricesA[i * 16], &matricesB[i * 16]);
+            }
+            g_sink = result[0];
+        }));
+        printRow("composeTRS", legacyComposeNs, measureNs([&] {
+            for (std::size_t i = 0; i < kCount; ++i) {
+                MatrixMath::composeTRS(&result[i * 16], positions[i], rotations[i], scales[i]);
+            }
+            g_sink = result[0];
+        }));
+        printRow("multiplyBatch", legacyBatchNs, measureNs([&] {
+            MatrixMath::multiplyBatch(result.data(), matricesA.data(), matricesB.data(), kCount);
+            g_sink = result[0];
+        }));
+        printRow("transformPoints", legacyPointsNs, measureNs([&] {
+            MatrixMath::transformPoints(transformed.data(), matricesA.data(), points.data(), kCount);
+            g_sink = transformed[0];
+        }));
+        printRow("transformAabbs", legacyAabbNs, measureNs([&] {
+            MatrixMath::transformAabbs(worldBounds.data(), matricesB.data(), localBounds.data(), kCount);
+            g_sink = worldBounds[0].min[0];
+        }));
+        std::printf("  %-22s %8.2f ns\n", "inverse", measureNs([&] {
+            for (std::size_t i = 0; i < kCount; ++i) {
+                MatrixMath::inverse(&result[i * 16], &matricesB[i * 16]);
+            }
+            g_sink = result[0];
+        }));
+        std::printf("  %-22s %8.2f ns\n", "inverseTranspose", measureNs([&] {
+            for (std::size_t i = 0; i < kCount; ++i) {
+                MatrixMath::inverseTranspose(&result[i * 16], &matricesB[i * 16]);
+            }
+            g_sink = result[0];
+        }));
+    }
+
+    MatrixMath::setInstructionSet(supported);
+    return 0;
+}
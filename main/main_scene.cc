@@ -1,21 +1,31 @@
 //
 // Created by forna on 07.02.2026.
 //
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <vector>
 #include <cmath>
 #include <random>
 #include <ctime>
+#include <cstdint>
 #include <corecrt_math_defines.h>
 #include <imgui.h>
 #include <SDL3/SDL.h>
 #include <filesystem>
 #include "camera.h"
+#include "command_list.h"
 #include "deferred_renderer.h"
+#include "frame_arena.h"
+#include "frame_graph.h"
+#include "job_system.h"
+#include "layered_shadow_renderer.h"
 #include "light_manager.h"
+#include "matrix_math.h"
 #include "model_loader.h"
+#include "program_cache.h"
 #include "scene_manager.h"
+#include "shader_program.h"
 #include "shadow_renderer.h"
 #include "ssao_renderer.h"
 #include "engine/engine.h"
@@ -40,15 +50,6 @@ struct RenderSettings {
     RenderMode mode = RenderMode::DEFERRED_SHADOWS;
 };
 
-class RenderPipeline {
-public:
-    void render(float dt);
-private:
-    void shadowPass();
-    void geometryPass();
-    void ssaoPass(const float* proj);
-    void lightingPass();
-};
 // ==================== CLASSE PRINCIPALE ====================
 class MainScene : public common::DrawInterface, public common::SystemInterface {
 public:
@@ -88,7 +89,10 @@ private:
     LightManager g_lightManager;
     DeferredRenderer g_deferredRenderer;
     ShadowRenderer g_shadowRenderer;
+    // Faces des lumières locales en une soumission, avant copie dans l'atlas
+    LayeredShadowRenderer g_localShadowRenderer;
     SSAORenderer g_ssaoRenderer;
+    FrameGraph g_frameGraph;
     SceneManager g_sceneManager;
 
     // Paramètres de rendu
@@ -98,6 +102,21 @@ private:
     float ssaoRadius = 0.5f;
     float ssaoBias = 0.025f;
     float deltaTimeAccum = 0.0f;
+    // Boîte de chaque caster dynamique (par index d'instance) au dernier rendu des tuiles locales
+    struct CasterBounds {
+        core::Vec3F min;
+        core::Vec3F max;
+        bool valid = false;
+    };
+    std::vector<CasterBounds> dynamicCasterBounds_;
+    // Passes enregistrées en parallèle par les workers, rejouées ensuite sur le thread GL
+    CommandListSet shadowCommands_;
+    CommandListSet geometryCommands_;
+    CommandListSet forwardCommands_;
+    SamplerLayout geometrySamplers_;
+    SamplerLayout forwardSamplers_;
+    // Une frame établie ne doit plus allouer sur le tas (voir FrameArena)
+    FrameAllocationCheck allocationCheck_;
     const int W = 1600;
     const int H = 1024;
 
@@ -114,6 +133,11 @@ private:
         g_lightManager.initialize(W, H);
         g_lightManager.initializeShadowMapping(2048, 2048);
         g_lightManager.setShadowViewDistance(50.0f);
+        g_lightManager.initializeShadowAtlas(4096, 128, 1024);
+        g_localShadowRenderer.initialize();
+        const int maxTileSize = g_lightManager.getShadowAtlas().getMaxTileSize();
+        g_localShadowRenderer.createTarget(maxTileSize, maxTileSize, LayeredShadowRenderer::MAX_LAYERS);
+        g_lightManager.setShadowFilterMode(ShadowFilterMode::VSM);
 
         // Ajouter une lumière directionnelle
         DirectionalLight sunLight;
@@ -123,15 +147,34 @@ private:
         sunLight.color = {1.0f, 1.0f, 1.0f};
         sunLight.intensity = 1.0f;
 
-        int mainLightIndex = g_lightManager.addDirectionalLight(sunLight);
-        g_lightManager.setMainDirectionalLight(mainLightIndex);
+        const LightHandle mainLight = g_lightManager.addDirectionalLight(sunLight);
+        g_lightManager.setMainDirectionalLight(mainLight);
+
+        // Lumières locales ombrées : leurs faces vont dans l'atlas (renderLocalLightShadows)
+        PointLight fillLight;
+        fillLight.position = {2.0f, 3.0f, 2.0f};
+        fillLight.color = {1.0f, 0.8f, 0.6f};
+        fillLight.intensity = 2.0f;
+        fillLight.radius = 12.0f;
+        g_lightManager.addPointLight(fillLight);
+
+        SpotLight keyLight;
+        keyLight.position = {-2.0f, 5.0f, 3.0f};
+        keyLight.direction = core::Vec3F{2.0f, -4.0f, -3.0f}.Normalize();
+        keyLight.color = {0.6f, 0.7f, 1.0f};
+        keyLight.intensity = 3.0f;
+        keyLight.cutOff = 20.0f;
+        keyLight.outerCutOff = 28.0f;
+        g_lightManager.addSpotLight(keyLight);
 
         // Initialiser le deferred renderer
         g_deferredRenderer.initialize(W, H);
         g_deferredRenderer.loadDefaultShaders();
 
         // Initialiser le SSAO renderer
-        g_ssaoRenderer.initialize(W, H, 64, 0.5f, 0.025f);
+        g_ssaoRenderer.initialize(W, H, 64, 0.5f, 0.025f, 2);
+        g_ssaoRenderer.setTemporalEnabled(true);
+        g_ssaoRenderer.setTemporalSampleCount(12);
         g_ssaoRenderer.loadDefaultShaders();
 
         // Initialiser le renderer d'ombres
@@ -149,20 +192,20 @@ private:
 
         checkModelLoading();
 
-        int modelIndex = g_sceneManager.loadModel(modelPath);
-        std::cout << "loadModel returned = " << modelIndex << std::endl;
+        const ModelHandle modelHandle = g_sceneManager.loadModel(modelPath);
+        std::cout << "loadModel returned = " << modelHandle.index << std::endl;
 
-        if (modelIndex >= 0) {
-            g_sceneManager.addModelInstance(modelIndex, {0.0f, 0.0f, 0.0f});
+        if (!modelHandle.isNull()) {
+            g_sceneManager.addModelInstance(modelHandle, {0.0f, 0.0f, 0.0f});
             std::cout << "Model instance added successfully!" << std::endl;
 
             // Vérifier les détails du modèle
-            const Model* model = g_sceneManager.getModel(modelIndex);
+            const Model* model = g_sceneManager.getModel(modelHandle);
             if (model) {
                 std::cout << "Model loaded with " << model << " meshes" << std::endl;
             }
         } else {
-            std::cerr << "ERROR: Failed to load model! Model index: " << modelIndex << std::endl;
+            std::cerr << "ERROR: Failed to load model! Model path: " << modelPath << std::endl;
         std::cout << "Scene initialized successfully!" << std::endl;
             // Alternative: créer un cube de test
             createTestCube();
@@ -236,42 +279,10 @@ private:
             }
         )";
 
-        GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vs);
-        GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fs);
-
-        modelProgram_ = glCreateProgram();
-        glAttachShader(modelProgram_, vertexShader);
-        glAttachShader(modelProgram_, fragmentShader);
-        glLinkProgram(modelProgram_);
-
-        // Vérifier les erreurs
-        GLint success;
-        glGetProgramiv(modelProgram_, GL_LINK_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetProgramInfoLog(modelProgram_, 512, nullptr, infoLog);
-            std::cerr << "ERROR: Model program linking failed:\n" << infoLog << std::endl;
-        }
-
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-    }
-
-    static GLuint compileShader(const GLenum type, const std::string &source) {
-        GLuint shader = glCreateShader(type);
-        const char *src = source.c_str();
-        glShaderSource(shader, 1, &src, nullptr);
-        glCompileShader(shader);
-
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-            std::cerr << "ERROR: Shader compilation failed:\n" << infoLog << std::endl;
-            return 0;
+        modelProgram_ = ProgramCache::createProgram({{GL_VERTEX_SHADER, vs}, {GL_FRAGMENT_SHADER, fs}});
+        if (modelProgram_ == 0) {
+            std::cerr << "ERROR: Model program creation failed" << std::endl;
         }
-        return shader;
     }
 
     // ==================== RENDU SHADOW PASS ====================
@@ -285,39 +296,162 @@ private:
         float sceneRadius = g_sceneManager.getSceneRadius();
         g_lightManager.calculateLightMatrices(sceneCenter, sceneRadius);
 
-        // Commencer le rendu de la carte d'ombres
-        g_shadowRenderer.beginShadowPass();
-        g_shadowRenderer.bindShader();
-
         // Obtenir les matrices de lumière
-        float lightProj[16], lightView[16];
+        float lightProj[16], lightView[16], lightSpace[16];
         g_lightManager.getLightProjectionMatrix(lightProj);
         g_lightManager.getLightViewMatrix(lightView);
+        g_lightManager.getLightSpaceMatrix(lightSpace);
+
+        // Frustum de la lumière pour le culling des casters
+        g_shadowRenderer.setLightFrustum(lightSpace);
+
+        g_shadowRenderer.bindShader();
 
         // Envoyer les matrices au shader
         g_shadowRenderer.setProjectionMatrix(lightProj);
         g_shadowRenderer.setViewMatrix(lightView);
 
-        // Rendu de la géométrie depuis la vue de la lumière
-        for (int i = 0; i < g_sceneManager.getInstanceCount(); ++i) {
-            const ModelInstance *instance = g_sceneManager.getInstance(i);
-            if (instance != nullptr && instance->visible && instance->model != nullptr) {
-                float modelMatrix[16];
-                g_sceneManager.getInstanceModelMatrix(i, modelMatrix);
-
-                g_shadowRenderer.setModelMatrix(modelMatrix);
-                g_sceneManager.drawInstance(i, g_shadowRenderer.getShaderProgram());
-            }
+        // Couche statique : re-rendue seulement si la lumière ou la géométrie statique a changé
+        const std::uint64_t staticVersion = g_sceneManager.getStaticGeometryVersion();
+        if (g_shadowRenderer.beginStaticCasterPass(lightSpace, staticVersion)) {
+            drawShadowCasters(true);
+            g_shadowRenderer.endStaticCasterPass(lightSpace, staticVersion);
         }
 
+        // Copie de la couche en cache puis casters dynamiques par-dessus
+        g_shadowRenderer.beginShadowPass();
+        drawShadowCasters(false);
+
         ShadowRenderer::unbindShader();
         g_shadowRenderer.endShadowPass();
+
+        // VSM/EVSM : moments floutés + mipmaps pour un seul fetch filtré au lighting
+        g_shadowRenderer.prefilterMoments();
+
+        renderLocalLightShadows(staticVersion);
+    }
+
+    // Ombres des point/spot lights dans l'atlas partagé : seules les tuiles modifiées sont re-rendues.
+    // Toutes les faces d'une lumière en une soumission layered (une couche par face), puis copie dans les tuiles
+    void renderLocalLightShadows(std::uint64_t staticVersion) {
+        // La géométrie statique invalide tout l'atlas ; un caster dynamique seulement les lumières qu'il touche
+        g_lightManager.updateShadowAtlas(g_camera.getPosition(), g_camera.getFOV(), H, staticVersion);
+        ShadowAtlas &atlas = g_lightManager.getShadowAtlas();
+        invalidateMovedCasters(atlas);
+        if (!atlas.hasPendingTiles()) {
+            return;
+        }
+
+        // Programme pas encore prêt : les tuiles restent en attente pour la frame suivante
+        bool allRendered = true;
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_FRONT);
+        for (const ShadowAtlasEntry &entry: atlas.getEntries()) {
+            if (!entry.needsRender || !entry.hasShadow()) {
+                continue;
+            }
+
+            g_localShadowRenderer.setLayerMatrices(entry.viewProjMatrices[0].data(), entry.faceCount);
+            const int instanceCount = g_localShadowRenderer.bindModelProgram();
+            if (instanceCount == 0) {
+                allRendered = false;
+                break;
+            }
+            g_localShadowRenderer.beginTargetPass(entry.resolution, entry.resolution);
+            drawLocalShadowCasters(entry, instanceCount);
+            g_localShadowRenderer.endTargetPass();
+            atlas.copyFromLayers(entry, g_localShadowRenderer.getDepthTextureArray());
+        }
+        glCullFace(GL_BACK);
+        glDisable(GL_CULL_FACE);
+        glUseProgram(0);
+        glViewport(0, 0, W, H);
+        if (allRendered) {
+            atlas.markRendered();
+        }
+    }
+
+    // Ancienne et nouvelle boîte d'un caster dynamique qui a bougé (ou apparu / disparu) :
+    // son ombre quitte l'une et arrive dans l'autre
+    void invalidateMovedCasters(ShadowAtlas &atlas) {
+        const int instanceCount = g_sceneManager.getInstanceCount();
+        if (static_cast<int>(dynamicCasterBounds_.size()) != instanceCount) {
+            dynamicCasterBounds_.resize(instanceCount);
+        }
+
+        for (int i = 0; i < instanceCount; ++i) {
+            const InstanceHandle instance = g_sceneManager.getInstanceHandle(i);
+            CasterBounds current;
+            current.valid = g_sceneManager.isInstanceVisible(instance) &&
+                            !g_sceneManager.isInstanceStatic(instance) &&
+                            g_sceneManager.getInstanceWorldBounds(instance, current.min, current.max);
+
+            CasterBounds &previous = dynamicCasterBounds_[i];
+            if (current.valid == previous.valid && (!current.valid || sameBounds(current, previous))) {
+                continue;
+            }
+            if (previous.valid) {
+                atlas.invalidateBounds(previous.min, previous.max);
+            }
+            if (current.valid) {
+                atlas.invalidateBounds(current.min, current.max);
+            }
+            previous = current;
+        }
+    }
+
+    static bool sameBounds(const CasterBounds &a, const CasterBounds &b) {
+        return a.min.x == b.min.x && a.min.y == b.min.y && a.min.z == b.min.z &&
+               a.max.x == b.max.x && a.max.y == b.max.y && a.max.z == b.max.z;
+    }
+
+    // Casters statiques et dynamiques d'une lumière locale, chacun soumis une fois pour toutes ses faces
+    void drawLocalShadowCasters(const ShadowAtlasEntry &entry, int instanceCount) {
+        shadowCommands_.record(g_sceneManager.getInstanceCount(), [this, &entry](CommandList &list, int i) {
+            const InstanceHandle instance = g_sceneManager.getInstanceHandle(i);
+            if (!g_sceneManager.isInstanceVisible(instance) || g_sceneManager.getInstanceModel(instance) == nullptr) {
+                return;
+            }
+
+            // Culling contre la sphère d'influence : elle couvre toutes les faces
+            core::Vec3F boundsMin, boundsMax;
+            if (g_sceneManager.getInstanceWorldBounds(instance, boundsMin, boundsMax) &&
+                !ShadowAtlas::sphereIntersectsBounds(entry.light->position, entry.range, boundsMin, boundsMax)) {
+                return;
+            }
+
+            g_sceneManager.recordInstance(instance, g_localShadowRenderer.getModelProgram(), list, false);
+        });
+        shadowCommands_.execute(g_localShadowRenderer.getModelMatrixLocation(), {}, instanceCount);
+    }
+
+    void drawShadowCasters(bool staticCasters) {
+        // Rendu de la géométrie depuis la vue de la lumière : culling et matrices sur les workers
+        const GLuint shadowProgram = g_shadowRenderer.getShaderProgram();
+        shadowCommands_.record(g_sceneManager.getInstanceCount(),
+                               [this, staticCasters, shadowProgram](CommandList &list, int i) {
+            const InstanceHandle instance = g_sceneManager.getInstanceHandle(i);
+            if (!g_sceneManager.isInstanceVisible(instance) || g_sceneManager.getInstanceModel(instance) == nullptr ||
+                g_sceneManager.isInstanceStatic(instance) != staticCasters) {
+                return;
+            }
+
+            core::Vec3F boundsMin, boundsMax;
+            if (g_sceneManager.getInstanceWorldBounds(instance, boundsMin, boundsMax) &&
+                !g_shadowRenderer.isCasterVisible(boundsMin, boundsMax)) {
+                return;
+            }
+
+            // Une matrice par nœud du modèle, profondeur seule
+            g_sceneManager.recordInstance(instance, shadowProgram, list, false);
+        });
+        shadowCommands_.execute(g_shadowRenderer.getModelMatrixLocation());
     }
 
     // ==================== RENDU GEOMETRY PASS (DEFERRED) ====================
     void renderGeometryPass() {
-        // Passe géométrique : remplir les G-Buffers
-        g_deferredRenderer.beginGeometryPass();
+        // Passe géométrique : remplir les G-Buffers (framebuffer lié par le graphe)
+        DeferredRenderer::beginGeometryPass();
         g_deferredRenderer.bindGeometryShader();
 
         float view[16], proj[16];
@@ -333,60 +467,113 @@ private:
         glCullFace(GL_BACK);
         glFrontFace(GL_CCW);
 
-        for (int i = 0; i < g_sceneManager.getInstanceCount(); ++i) {
-            const ModelInstance* instance = g_sceneManager.getInstance(i);
-            if (instance != nullptr && instance->visible && instance->model != nullptr) {
-                float modelMatrix[16];
-                g_sceneManager.getInstanceModelMatrix(i, modelMatrix);
-
-                g_deferredRenderer.setModelMatrix(modelMatrix);
-                g_sceneManager.drawInstance(i, g_deferredRenderer.getGeometryShader());
-            }
+        const GLuint geometryShader = g_deferredRenderer.getGeometryShader();
+        if (geometrySamplers_.program != geometryShader) {
+            geometrySamplers_ = SamplerLayout::resolve(geometryShader);
         }
+        geometryCommands_.record(g_sceneManager.getInstanceCount(), [this, geometryShader](CommandList &list, int i) {
+            g_sceneManager.recordInstance(g_sceneManager.getInstanceHandle(i), geometryShader, list, true);
+        });
+        geometryCommands_.execute(g_deferredRenderer.getGeometryModelMatrixLocation(), geometrySamplers_);
 
         DeferredRenderer::unbindShader();
-        g_deferredRenderer.endGeometryPass(); // FIX: instance
+        DeferredRenderer::endGeometryPass();
     }
 
-    // ==================== RENDU SSAO ====================
-    void renderSSAO(const float *projMatrix) {
-        if (!enableSSAO) {
-            return;
+    // ==================== FRAME GRAPH (DEFERRED) ====================
+    // Les passes déclarent leurs entrées/sorties ; le graphe élimine celles qui ne
+    // contribuent pas à l'image, les ordonne et partage les cibles transitoires.
+    void renderDeferredFrame(bool withSSAO, bool withShadows) {
+        g_frameGraph.reset();
+
+        FrameGraphTextureDesc shadowDesc;
+        shadowDesc.width = g_lightManager.getShadowMapWidth();
+        shadowDesc.height = g_lightManager.getShadowMapHeight();
+        shadowDesc.internalFormat = GL_DEPTH_COMPONENT32F;
+        const FrameGraphResource shadowMap =
+                g_frameGraph.importTexture("Shadow map", g_lightManager.getShadowDepthTexture(), shadowDesc);
+        const FrameGraphResource backbuffer = g_frameGraph.importBackbuffer("Backbuffer", W, H);
+
+        g_frameGraph.addPass("Shadows", [&](FrameGraph::Builder &builder) {
+            builder.write(shadowMap);
+            return [this](const FrameGraph::Resources &) { renderShadowPass(); };
+        });
+
+        // G-Buffer transitoire : ses textures retournent au pool après l'éclairage
+        DeferredRenderer::GBufferTargets gBuffer;
+        g_frameGraph.addPass("GBuffer", [&](FrameGraph::Builder &builder) {
+            gBuffer = g_deferredRenderer.createGBuffer(builder);
+            return [this](const FrameGraph::Resources &) { renderGeometryPass(); };
+        });
+
+        FrameGraphResource ssao = INVALID_FRAME_GRAPH_RESOURCE;
+        if (withSSAO) {
+            float view[16], proj[16], viewProj[16];
+            g_camera.getViewMatrix(view);
+            g_camera.getProjectionMatrix(proj);
+            MatrixMath::multiply(viewProj, proj, view);
+
+            // Vue-projection courante : reprojection de l'historique en mode temporel
+            g_ssaoRenderer.setViewProjection(viewProj);
+            ssao = g_ssaoRenderer.addToFrameGraph(g_frameGraph, gBuffer.position, gBuffer.normal, proj);
         }
 
-        // Calculer le SSAO
-        g_ssaoRenderer.compute(g_deferredRenderer.getPositionTexture(),
-                               g_deferredRenderer.getNormalTexture(),
-                               projMatrix, quadVAO, quadVBO);
+        g_frameGraph.addPass("Lighting", [&](FrameGraph::Builder &builder) {
+            builder.read(gBuffer.position);
+            builder.read(gBuffer.normal);
+            builder.read(gBuffer.albedo);
+            builder.read(ssao);
+            if (withShadows) {
+                builder.read(shadowMap);
+            }
+            builder.write(backbuffer);
+            return [this, gBuffer, ssao](const FrameGraph::Resources &resources) {
+                renderLightingPass(resources.getTexture(gBuffer.position), resources.getTexture(gBuffer.normal),
+                                   resources.getTexture(gBuffer.albedo), resources.getTexture(ssao));
+            };
+        });
 
-        // Appliquer le blur
-        g_ssaoRenderer.blur(quadVAO, quadVBO);
+        if (g_frameGraph.compile()) {
+            g_frameGraph.execute();
+        }
     }
 
     // ==================== RENDU LIGHTING PASS (DEFERRED) ====================
-    void renderLightingPass() {
-        g_deferredRenderer.beginLightingPass();
+    void renderLightingPass(GLuint gPosition, GLuint gNormal, GLuint gAlbedo, GLuint ssaoTexture) {
+        // Ombres de la lumière principale (hard / VSM / EVSM)
+        const bool useShadows = enableShadows && g_renderMode == RenderMode::DEFERRED_SHADOWS;
+        const int shadowMode = useShadows ? 1 + static_cast<int>(g_lightManager.getShadowFilterMode()) : 0;
+
+        // Variante spécialisée pour les options actives (SSAO, filtre d'ombre)
+        g_deferredRenderer.beginLightingPass(gPosition, gNormal, gAlbedo);
+        g_deferredRenderer.setLightingFeatures(ssaoTexture != 0, shadowMode);
         g_deferredRenderer.bindLightingShader();
 
         g_deferredRenderer.setCameraPosition(g_camera.getPosition());
+        // Point et spot lights : bouclées par le shader dans les tableaux std430
+        g_lightManager.bindLightBuffers();
 
         const Light* mainLight = g_lightManager.getMainDirectionalLight();
         if (mainLight != nullptr) {
             g_deferredRenderer.setDirectionalLight(mainLight->direction, mainLight->color, mainLight->intensity);
         }
 
-        // --- CHANGED (FIX): SSAO optionnel (unit 3 + uniform uUseSSAO) ---
-        const GLuint sh = g_deferredRenderer.getLightingShader();
-        const bool useSSAO = enableSSAO && (g_renderMode == RenderMode::DEFERRED_SSAO || g_renderMode == RenderMode::DEFERRED_SHADOWS);
-
-        GLint useLoc = glGetUniformLocation(sh, "uUseSSAO");
-        if (useLoc >= 0) glUniform1i(useLoc, useSSAO ? 1 : 0);
+        // SSAO optionnel (unit 3)
+        if (ssaoTexture != 0) {
+            DeferredRenderer::bindSSAO(ssaoTexture);
+        }
 
-        if (useSSAO) {
-            glActiveTexture(GL_TEXTURE3);
-            glBindTexture(GL_TEXTURE_2D, g_ssaoRenderer.getBlurredSSAOTexture());
-            GLint ssaoLoc = glGetUniformLocation(sh, "gSSAO");
-            if (ssaoLoc >= 0) glUniform1i(ssaoLoc, 3);
+        if (useShadows) {
+            float lightSpace[16];
+            g_lightManager.getLightSpaceMatrix(lightSpace);
+            g_deferredRenderer.setLightSpaceMatrix(lightSpace);
+            DeferredRenderer::bindShadowMap(g_lightManager.getShadowDepthTexture());
+            DeferredRenderer::bindShadowMoments(g_lightManager.getShadowMomentsTexture());
+            // Point/spot lights : tuiles rendues par renderLocalLightShadows
+            DeferredRenderer::bindShadowAtlas(g_lightManager.getShadowAtlas().getDepthTexture());
+            g_deferredRenderer.setShadowFilter(g_lightManager.getLightBleedingReduction(),
+                                               g_lightManager.getEVSMPositiveExponent(),
+                                               g_lightManager.getEVSMNegativeExponent());
         }
 
         initFullscreenQuad();
@@ -415,6 +602,7 @@ private:
         glCullFace(GL_BACK);
 
         static GLuint forwardShader = 0;
+        static ShaderProgram forwardUniforms;
         if (forwardShader == 0) {
             // Créer un shader forward simple
             const std::string vsSource = R"(
@@ -435,26 +623,12 @@ private:
                 FragColor = vec4(0.7, 0.7, 0.7, 1.0); // Couleur grise par défaut
             }
         )";
-            GLuint vs = compileShader(GL_VERTEX_SHADER, vsSource);
-            GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSource);
-
-            forwardShader = glCreateProgram();
-            glAttachShader(forwardShader, vs);
-            glAttachShader(forwardShader, fs);
-            glLinkProgram(forwardShader);
-
-            GLint success;
-            glGetProgramiv(forwardShader, GL_LINK_STATUS, &success);
-            if (!success) {
-                char infoLog[512];
-                glGetProgramInfoLog(forwardShader, 512, nullptr, infoLog);
-                std::cerr << "ERROR: Forward shader link failed:\n" << infoLog << std::endl;
-                glDeleteProgram(forwardShader);
-                forwardShader = 0;
+            forwardShader = ProgramCache::createProgram({{GL_VERTEX_SHADER, vsSource},
+                                                         {GL_FRAGMENT_SHADER, fsSource}});
+            if (forwardShader == 0) {
+                std::cerr << "ERROR: Forward shader link failed" << std::endl;
             }
-
-            glDeleteShader(vs);
-            glDeleteShader(fs);
+            forwardUniforms.reflect(forwardShader);
         }
 
         if (forwardShader == 0) {
@@ -462,19 +636,17 @@ private:
         }
 
         glUseProgram(forwardShader);
-        glUniformMatrix4fv(glGetUniformLocation(forwardShader, "uView"), 1, GL_FALSE, view);
-        glUniformMatrix4fv(glGetUniformLocation(forwardShader, "uProjection"), 1, GL_FALSE, proj);
-
-        for (int i = 0; i < g_sceneManager.getInstanceCount(); ++i) {
-            const ModelInstance* instance = g_sceneManager.getInstance(i);
-            if (instance != nullptr && instance->visible && instance->model != nullptr) {
-                float modelMatrix[16];
-                g_sceneManager.getInstanceModelMatrix(i, modelMatrix);
-                glUniformMatrix4fv(glGetUniformLocation(forwardShader, "uModel"), 1, GL_FALSE, modelMatrix);
+        forwardUniforms.setMat4("uView", view);
+        forwardUniforms.setMat4("uProjection", proj);
 
-                g_sceneManager.drawInstance(i, forwardShader);
-            }
+        if (forwardSamplers_.program != forwardShader) {
+            forwardSamplers_ = SamplerLayout::resolve(forwardShader);
         }
+        forwardCommands_.record(g_sceneManager.getInstanceCount(), [this](CommandList &list, int i) {
+            g_sceneManager.recordInstance(g_sceneManager.getInstanceHandle(i), forwardShader, list, true);
+        });
+        // uModel est écrit par le replay, hors du cache de forwardUniforms
+        forwardCommands_.execute(forwardUniforms.getLocation("uModel"), forwardSamplers_);
 
         glUseProgram(0);
     }
@@ -525,7 +697,10 @@ private:
     // ==================== MISE À JOUR ====================
     void update(float deltaTime) {
         g_camera.update(deltaTime);
+        JobSystem::executeMainThreadTasks();
         g_sceneManager.updateAllMatrices();
+        // Seules les lumières modifiées depuis la frame précédente partent vers les SSBO
+        g_lightManager.uploadLightBuffers();
     }
 
 
@@ -534,23 +709,6 @@ private:
     // ==================== RENDU PRINCIPAL ====================
     void render(float deltaTime);
 
-    static void identityMatrix(float *m) {
-        for (int i = 0; i < 16; i++) m[i] = 0.0f;
-        m[0] = m[5] = m[10] = m[15] = 1.0f;
-    }
-
-    static void multiplyMat4(float* out, const float* a, const float* b) {
-        for (int c = 0; c < 4; c++) {
-            for (int r = 0; r < 4; r++) {
-                out[c * 4 + r] =
-                    a[0 * 4 + r] * b[c * 4 + 0] +
-                    a[1 * 4 + r] * b[c * 4 + 1] +
-                    a[2 * 4 + r] * b[c * 4 + 2] +
-                    a[3 * 4 + r] * b[c * 4 + 3];
-            }
-        }
-    }
-
     // void renderDebugSimple() {
     //     std::cout << "=== DEBUG SIMPLE RENDER ===" << std::endl;
     //
@@ -804,8 +962,9 @@ void main() {
         const char *vs = R"(#version 330 core
 layout(location = 0) in vec3 aPos;
 uniform mat4 uMVP;
+uniform mat4 uNodeMatrix = mat4(1.0);
 void main() {
-    gl_Position = uMVP * vec4(aPos, 1.0);
+    gl_Position = uMVP * uNodeMatrix * vec4(aPos, 1.0);
 })";
 
         const char *fs = R"(#version 330 core
@@ -880,34 +1039,29 @@ void main() {
 glDisable(GL_DEPTH_TEST);
         // Pour chaque instance
         for (int i = 0; i < g_sceneManager.getInstanceCount(); ++i) {
-            const ModelInstance *instance = g_sceneManager.getInstance(i);
-            if (instance && instance->model) {
+            const InstanceHandle instance = g_sceneManager.getInstanceHandle(i);
+            Model *instanceModel = g_sceneManager.getInstanceModel(instance);
+            if (instanceModel) {
                 std::cout << "Drawing model instance " << i << std::endl;
-                std::cout << "Model pointer: " << instance->model << std::endl;
+                std::cout << "Model pointer: " << instanceModel << std::endl;
 
                 float model[16];
-                identityMatrix(model);
-                // Translation
-                model[12] = 0.0f; // X
-                model[13] = 0.0f; // Y
-                model[14] = -2.0f; // Z - déplacer vers la caméra
+                // Translation : Z - déplacer vers la caméra
+                MatrixMath::translation(model, 0.0f, 0.0f, -2.0f);
 
                 float scale = 0.1f; // Réduire l'échelle
                 float scaledModel[16];
-                identityMatrix(scaledModel);
-                scaledModel[0] = scale;  // X scale
-                scaledModel[5] = scale;  // Y scale
-                scaledModel[10] = scale; // Z scale
+                MatrixMath::scaling(scaledModel, scale, scale, scale);
 
                 // Multiplier avec la matrice de position
-                multiplyMat4(model, scaledModel, model); // model = scale * position
-                g_sceneManager.getInstanceModelMatrix(i, model);
+                MatrixMath::multiply(model, scaledModel, model); // model = scale * position
+                g_sceneManager.getInstanceModelMatrix(instance, model);
 
 
                 // Calculer MVP
                 float viewProj[16], mvp[16];
-                multiplyMat4(viewProj, proj, view);
-                multiplyMat4(mvp, viewProj, model);
+                MatrixMath::multiply(viewProj, proj, view);
+                MatrixMath::multiply(mvp, viewProj, model);
 
                 // Passer la matrice au shader
                 GLint mvpLoc = glGetUniformLocation(modelShader, "uMVP");
@@ -924,7 +1078,7 @@ glDisable(GL_DEPTH_TEST);
 
                 // Dessiner le modèle
                 std::cout << "Calling model->Draw()..." << std::endl;
-                instance->model->Draw(modelShader);
+                instanceModel->Draw(modelShader);
                 std::cout << "Model drawn" << std::endl;
 
                 // Restaurer
@@ -990,7 +1144,9 @@ glDisable(GL_DEPTH_TEST);
     void cleanup() {
         g_deferredRenderer.cleanup();
         g_ssaoRenderer.cleanup();
+        g_frameGraph.cleanup();
         g_shadowRenderer.cleanup();
+        g_localShadowRenderer.cleanup();
         g_lightManager.cleanup();
         g_sceneManager.cleanup();
     }
@@ -1001,25 +1157,33 @@ void MainScene::setImGUI() {
     ImGui::SetNextWindowSize(ImVec2(350, 400), ImGuiCond_FirstUseEver);
     ImGui::Begin("Scene Renderer Settings");
 
+    // Les changements de configuration créent des cibles et des caches : nouveau préchauffage
+    bool settingsChanged = false;
+
     // Mode de rendu
     ImGui::Text("Render Mode");
     int renderModeInt = static_cast<int>(g_renderMode);
     if (ImGui::RadioButton("Forward Rendering", &renderModeInt, static_cast<int>(RenderMode::FORWARD))) {
         g_renderMode = static_cast<RenderMode>(renderModeInt);
+        settingsChanged = true;
     }
     if (ImGui::RadioButton("Deferred Rendering", &renderModeInt, static_cast<int>(RenderMode::DEFERRED))) {
         g_renderMode = static_cast<RenderMode>(renderModeInt);
+        settingsChanged = true;
     }
     if (ImGui::RadioButton("Deferred + SSAO", &renderModeInt, static_cast<int>(RenderMode::DEFERRED_SSAO))) {
         g_renderMode = static_cast<RenderMode>(renderModeInt);
+        settingsChanged = true;
     }
     if (ImGui::RadioButton("Shadow Mapping (Debug)", &renderModeInt,
                            static_cast<int>(RenderMode::SHADOW_MAPPING))) {
         g_renderMode = static_cast<RenderMode>(renderModeInt);
+        settingsChanged = true;
     }
     if (ImGui::RadioButton("Deferred + Shadows + SSAO", &renderModeInt,
                            static_cast<int>(RenderMode::DEFERRED_SHADOWS))) {
         g_renderMode = static_cast<RenderMode>(renderModeInt);
+        settingsChanged = true;
     }
 
 
@@ -1027,14 +1191,34 @@ void MainScene::setImGUI() {
 
     // Paramètres de shadow mapping
     ImGui::Text("Shadow Mapping");
-    ImGui::Checkbox("Enable Shadows", &enableShadows);
+    settingsChanged |= ImGui::Checkbox("Enable Shadows", &enableShadows);
+    if (enableShadows) {
+        int filterMode = static_cast<int>(g_lightManager.getShadowFilterMode());
+        if (ImGui::Combo("Shadow Filter", &filterMode, "Hard\0VSM\0EVSM\0")) {
+            g_lightManager.setShadowFilterMode(static_cast<ShadowFilterMode>(filterMode));
+            settingsChanged = true;
+        }
+        if (filterMode != static_cast<int>(ShadowFilterMode::HARD)) {
+            float bleeding = g_lightManager.getLightBleedingReduction();
+            if (ImGui::SliderFloat("Light Bleeding Reduction", &bleeding, 0.0f, 0.9f)) {
+                g_lightManager.setLightBleedingReduction(bleeding);
+            }
+            int blurRadius = g_lightManager.getShadowBlurRadius();
+            if (ImGui::SliderInt("Shadow Blur Radius", &blurRadius, 0, 8)) {
+                g_lightManager.setShadowBlurRadius(blurRadius);
+            }
+        }
+    }
 
     ImGui::Separator();
 
     // Paramètres SSAO
     if (g_renderMode == RenderMode::DEFERRED_SSAO || g_renderMode == RenderMode::DEFERRED_SHADOWS) {
         ImGui::Text("SSAO Settings");
-        ImGui::Checkbox("Enable SSAO##ssao", &enableSSAO);
+        if (ImGui::Checkbox("Enable SSAO##ssao", &enableSSAO)) {
+            g_ssaoRenderer.resetHistory();
+            settingsChanged = true;
+        }
 
         if (enableSSAO) {
             ImGui::SliderFloat("SSAO Radius", &ssaoRadius, 0.0f, 2.0f);
@@ -1042,11 +1226,59 @@ void MainScene::setImGUI() {
 
             g_ssaoRenderer.setRadius(ssaoRadius);
             g_ssaoRenderer.setBias(ssaoBias);
+
+            const char* resolutions[] = {"Full", "Half", "Quarter"};
+            const int divisors[] = {1, 2, 4};
+            int current = g_ssaoRenderer.getResolutionDivisor() == 1 ? 0
+                        : g_ssaoRenderer.getResolutionDivisor() == 2 ? 1 : 2;
+            if (ImGui::Combo("SSAO Resolution", &current, resolutions, 3)) {
+                g_ssaoRenderer.setResolutionDivisor(divisors[current]);
+                settingsChanged = true;
+            }
+
+            bool temporal = g_ssaoRenderer.isTemporalEnabled();
+            if (ImGui::Checkbox("Temporal SSAO", &temporal)) {
+                g_ssaoRenderer.setTemporalEnabled(temporal);
+                settingsChanged = true;
+            }
+            if (temporal) {
+                int samples = g_ssaoRenderer.getTemporalSampleCount();
+                if (ImGui::SliderInt("Samples / Frame", &samples, 8, 16)) {
+                    g_ssaoRenderer.setTemporalSampleCount(samples);
+                }
+            }
         }
 
         ImGui::Separator();
     }
 
+    // Frame graph : passes éliminées et mémoire des cibles transitoires
+    ImGui::Text("Frame Graph");
+    ImGui::Text("Passes: %d (culled %d)", g_frameGraph.getPassCount(), g_frameGraph.getCulledPassCount());
+    ImGui::Text("Transient targets: %d -> %d textures", g_frameGraph.getTransientResourceCount(),
+                g_frameGraph.getPhysicalTextureCount());
+    ImGui::Text("Target memory: %.1f MB (%.1f MB without aliasing)",
+                static_cast<double>(g_frameGraph.getPhysicalMemoryBytes()) / (1024.0 * 1024.0),
+                static_cast<double>(g_frameGraph.getVirtualMemoryBytes()) / (1024.0 * 1024.0));
+
+    ImGui::Text("Recorded draws: shadow %d, geometry %d, forward %d", shadowCommands_.getDrawCount(),
+                geometryCommands_.getDrawCount(), forwardCommands_.getDrawCount());
+
+    if constexpr (FrameAllocationCheck::COUNTING_ENABLED) {
+        ImGui::Text("Heap allocations last frame: %llu (%s)",
+                    static_cast<unsigned long long>(allocationCheck_.getLastFrameAllocations()),
+                    allocationCheck_.isSteady() ? "steady" : "warming up");
+        ImGui::Text("Steady frames that allocated: %llu",
+                    static_cast<unsigned long long>(allocationCheck_.getFailedFrameCount()));
+    } else {
+        ImGui::Text("Heap allocation check: off (COMPGRAPH_ALLOCATION_ASSERT)");
+    }
+    ImGui::Text("Frame arenas: graph %.1f KB, main thread %.1f KB (peak)",
+                static_cast<double>(g_frameGraph.getArena().getPeakBytes()) / 1024.0,
+                static_cast<double>(FrameArena::forThread().getPeakBytes()) / 1024.0);
+
+    ImGui::Separator();
+
     // Informations de caméra
     ImGui::Text("Camera");
     ImGui::Text("Position: (%.2f, %.2f, %.2f)", g_camera.getPosition().x, g_camera.getPosition().y,
@@ -1082,12 +1314,22 @@ void MainScene::setImGUI() {
 
     if (ImGui::Button("Reload Model")) {
         g_sceneManager.cleanup();
+        settingsChanged = true;
         //initModels(); // Fonction à créer pour recharger
     }
     ImGui::End();
+
+    if (settingsChanged) {
+        allocationCheck_.rearm();
+    }
 }
 
 void MainScene::render(float deltaTime) {
+    // Frontière de frame : les arènes de la frame précédente sont rendues (aucun job en cours)
+    // et ses allocations sur le tas sont contrôlées
+    FrameArena::resetThreadArenas();
+    allocationCheck_.nextFrame();
+
     update(deltaTime);
     // DEBUG: Vérifier l'état
     std::cout << "Render Mode: " << static_cast<int>(g_renderMode) << std::endl;
@@ -1103,11 +1345,9 @@ void MainScene::render(float deltaTime) {
     glEnable(GL_DEPTH_TEST);
 
     if (g_sceneManager.getInstanceCount() > 0) {
-        const ModelInstance *inst = g_sceneManager.getInstance(0);
-        if (inst) {
-            std::cout << "First instance visible: " << inst->visible << std::endl;
-            std::cout << "First instance model ptr: " << inst->model << std::endl;
-        }
+        const InstanceHandle firstInstance = g_sceneManager.getInstanceHandle(0);
+        std::cout << "First instance visible: " << g_sceneManager.isInstanceVisible(firstInstance) << std::endl;
+        std::cout << "First instance model ptr: " << g_sceneManager.getInstanceModel(firstInstance) << std::endl;
     }
     switch (g_renderMode) {
         case RenderMode::FORWARD: {
@@ -1118,24 +1358,13 @@ void MainScene::render(float deltaTime) {
 
         case RenderMode::DEFERRED: {
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            renderGeometryPass();
-
-            float proj[16];
-            g_camera.getProjectionMatrix(proj);
-
-            renderLightingPass();
+            renderDeferredFrame(false, false);
             break;
         }
 
         case RenderMode::DEFERRED_SSAO: {
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            renderGeometryPass();
-
-            float proj[16];
-            g_camera.getProjectionMatrix(proj);
-            renderSSAO(proj);
-
-            renderLightingPass();
+            renderDeferredFrame(enableSSAO, false);
             break;
         }
 
@@ -1147,17 +1376,8 @@ void MainScene::render(float deltaTime) {
         }
 
         case RenderMode::DEFERRED_SHADOWS: {
-            if (enableShadows) {
-                renderShadowPass();
-            }
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            renderGeometryPass();
-
-            float proj[16];
-            g_camera.getProjectionMatrix(proj);
-            renderSSAO(proj);
-
-            renderLightingPass();
+            renderDeferredFrame(enableSSAO, enableShadows);
             break;
         }
 
@@ -1189,6 +1409,9 @@ int main() {
         config.fixed_dt = 1.0f / 60.0f;
         common::SetWindowConfig(config);
 
+        // Le thread de la boucle moteur (contexte GL) devient le thread principal des jobs
+        JobSystem::initialize();
+
         // Création de la scène
         g_mainScene = std::make_unique<MainScene>();
 
@@ -1203,6 +1426,7 @@ int main() {
         common::SystemObserverSubject::RemoveObserver(g_mainScene.get());
         common::DrawObserverSubject::RemoveObserver(g_mainScene.get());
         g_mainScene.reset();
+        JobSystem::shutdown();
 
         std::cout << "\n✓ Application terminated successfully!" << std::endl;
     } catch (const std::exception &e) {
@@ -1213,6 +1437,7 @@ int main() {
             common::DrawObserverSubject::RemoveObserver(g_mainScene.get());
             g_mainScene.reset();
         }
+        JobSystem::shutdown();
         return -1;
     }
 
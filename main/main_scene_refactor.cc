@@ -3,6 +3,7 @@
 
 #include "engine/engine.h"
 #include "engine/window.h"
+#include "job_system.h"
 #include "Refactor/final_scene.h"
 //
 // Created by forna on 10.02.2026.
@@ -33,6 +34,9 @@ int main() {
         config.fixed_dt = 1.0f / 60.0f;
         common::SetWindowConfig(config);
 
+        // Le thread de la boucle moteur (contexte GL) devient le thread principal des jobs
+        JobSystem::initialize();
+
         scene_final = std::make_unique<FinalScene>();
         common::SystemObserverSubject::AddObserver(scene_final.get());
         common::DrawObserverSubject::AddObserver(scene_final.get());
@@ -42,6 +46,7 @@ int main() {
         common::SystemObserverSubject::RemoveObserver(scene_final.get());
         common::DrawObserverSubject::RemoveObserver(scene_final.get());
         scene_final.reset();
+        JobSystem::shutdown();
 
         std::cout << "\n✓ Démonstration terminée avec succès!" << std::endl;
     } catch (const std::exception &e) {
@@ -52,6 +57,7 @@ int main() {
             common::DrawObserverSubject::RemoveObserver(scene_final.get());
             scene_final.reset();
         }
+        JobSystem::shutdown();
         return -1;
     }
     return 0;
@@ -17,6 +17,8 @@
 #include "engine/renderer.h"
 #include "engine/system.h"
 #include "third_party/gl_include.h"
+#include "shader_permutations.h"
+#include "shader_program.h"
 
 #include "stb_image.h"
 
@@ -347,11 +349,17 @@ private:
 
     // Shaders
     GLuint modelProgram_ = 0;
+    ShaderProgram modelUniforms_;
     GLuint skyboxProgram_ = 0;
+    ShaderProgram skyboxUniforms_;
     GLuint postProgram_ = 0;
+    ShaderProgram postUniforms_;
     GLuint bloomExtractProgram_ = 0;
+    ShaderProgram bloomExtractUniforms_;
     GLuint bloomBlurProgram_ = 0;
+    ShaderProgram bloomBlurUniforms_;
     GLuint bloomCombineProgram_ = 0;
+    ShaderProgram bloomCombineUniforms_;
 
     //Shadow Mapping
     GLuint shadowProgram_ = 0;
@@ -365,7 +373,9 @@ private:
 
     //SSAO
     GLuint ssaoProgram_ = 0;
+    ShaderProgram ssaoUniforms_;
     GLuint ssaoBlurProgram_ = 0;
+    ShaderProgram ssaoBlurUniforms_;
     GLuint ssaoFBO_ = 0;
     GLuint ssaoColorBuffer_ = 0;
     GLuint ssaoBlurFBO_ = 0;
@@ -403,13 +413,17 @@ private:
     GLuint cubemapTex_ = 0;
 
     // CUBES
-    GLuint cubeProgram_ = 0;
+    // Variantes : options de shader en #define plutôt qu'en branches sur des uniforms
+    ShaderPermutations cubeVariants_;
+    bool useNormalMap_ = true;
     GLuint cubeVAO_ = 0, cubeVBO_ = 0, cubeEBO_ = 0;
     GLsizei cubeIndexCount_ = 0;
     GLuint cubeInstanceVBO_ = 0;
     GLuint cubeDiffuseTex_ = 0;
     GLuint cubeNormalTex_ = 0;
-    GLuint deferredProgram_ = 0;
+    ShaderPermutations deferredVariants_;
+    int deferredDebugMode_ = 0; // 0=normal, 1=positions, 2=normales, 3=albedo, 4=UV
+    int pointLightCount_ = 1;
     GLuint gBuffer_ = 0, gPosition_ = 0, gNormal_ = 0, gAlbedoSpec_ = 0;
     GLuint rboDepth_ = 0;
     std::vector<core::Vec3F> cubeCenters_;
@@ -571,17 +585,18 @@ private:
     )";
 
         static GLuint simpleShadowProgram = 0;
+        static ShaderProgram simpleShadowUniforms;
         if (simpleShadowProgram == 0) {
             simpleShadowProgram = createProgram(simpleShadowVS, simpleShadowFS);
+            simpleShadowUniforms.reflect(simpleShadowProgram);
             std::cout << "Simple shadow program created: " << simpleShadowProgram << std::endl;
         }
 
         glUseProgram(simpleShadowProgram);
 
         // Passer la matrice
-        GLuint loc = glGetUniformLocation(simpleShadowProgram, "uLightSpaceMatrix");
-        if (loc != -1) {
-            glUniformMatrix4fv(loc, 1, GL_FALSE, lightSpaceMatrix_);
+        if (simpleShadowUniforms.hasUniform("uLightSpaceMatrix")) {
+            simpleShadowUniforms.setMat4("uLightSpaceMatrix", lightSpaceMatrix_);
         } else {
             std::cerr << "ERROR: uLightSpaceMatrix uniform not found!" << std::endl;
         }
@@ -596,10 +611,7 @@ private:
         modelMatrix[13] = target_[1];
         modelMatrix[14] = target_[2];
 
-        loc = glGetUniformLocation(simpleShadowProgram, "uModel");
-        if (loc != -1) {
-            glUniformMatrix4fv(loc, 1, GL_FALSE, modelMatrix);
-        }
+        simpleShadowUniforms.setMat4("uModel", modelMatrix);
 
         glDrawElements(GL_TRIANGLES, cubeIndexCount_, GL_UNSIGNED_INT, 0);
 
@@ -610,9 +622,7 @@ private:
             modelMatrix[13] = cubeCenters_[i].y;
             modelMatrix[14] = cubeCenters_[i].z;
 
-            if (loc != -1) {
-                glUniformMatrix4fv(loc, 1, GL_FALSE, modelMatrix);
-            }
+            simpleShadowUniforms.setMat4("uModel", modelMatrix);
 
             glDrawElements(GL_TRIANGLES, cubeIndexCount_, GL_UNSIGNED_INT, 0);
         }
@@ -798,7 +808,16 @@ private:
         )";
 
         ssaoProgram_ = createProgram(ssaoVS, ssaoFS);
+        ssaoUniforms_.reflect(ssaoProgram_);
+        // Le kernel est constant : envoyé une seule fois
+        const int samplesToUse = std::min(64, ssaoKernelSize_);
+        for (int i = 0; i < samplesToUse; ++i) {
+            const std::string name = "samples[" + std::to_string(i) + "]";
+            ssaoUniforms_.setVec3(UniformName::runtime(name),
+                                  ssaoKernel_[i].x, ssaoKernel_[i].y, ssaoKernel_[i].z);
+        }
         ssaoBlurProgram_ = createProgram(ssaoVS, ssaoBlurFS);
+        ssaoBlurUniforms_.reflect(ssaoBlurProgram_);
 
         std::cout << "[INFO] SSAO initialisé (kernel size: " << ssaoKernelSize_ << ")" << std::endl;
     }
@@ -813,29 +832,20 @@ private:
         // Passer les textures du G-buffer
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gPosition_);
-        glUniform1i(glGetUniformLocation(ssaoProgram_, "gPosition"), 0);
+        ssaoUniforms_.setInt("gPosition", 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, gNormal_);
-        glUniform1i(glGetUniformLocation(ssaoProgram_, "gNormal"), 1);
+        ssaoUniforms_.setInt("gNormal", 1);
 
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, noiseTexture_);
-        glUniform1i(glGetUniformLocation(ssaoProgram_, "texNoise"), 2);
+        ssaoUniforms_.setInt("texNoise", 2);
         glEnable(GL_DEPTH_TEST);
-        // Passer le kernel SSAO (16 premiers samples)
-        int samplesToUse = std::min(64, ssaoKernelSize_);
-        for (int i = 0; i < samplesToUse; ++i) {
-            std::string name = "samples[" + std::to_string(i) + "]";
-            glUniform3f(glGetUniformLocation(ssaoProgram_, name.c_str()),
-                        ssaoKernel_[i].x, ssaoKernel_[i].y, ssaoKernel_[i].z);
-        }
-
         // Autres uniforms
-        glUniformMatrix4fv(glGetUniformLocation(ssaoProgram_, "projection"),
-                           1, GL_FALSE, proj);
-        glUniform1f(glGetUniformLocation(ssaoProgram_, "radius"), ssaoRadius_);
-        glUniform1f(glGetUniformLocation(ssaoProgram_, "bias"), ssaoBias_);
+        ssaoUniforms_.setMat4("projection", proj);
+        ssaoUniforms_.setFloat("radius", ssaoRadius_);
+        ssaoUniforms_.setFloat("bias", ssaoBias_);
 
         glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -849,7 +859,7 @@ private:
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer_);
-        glUniform1i(glGetUniformLocation(ssaoBlurProgram_, "ssaoInput"), 0);
+        ssaoBlurUniforms_.setInt("ssaoInput", 0);
 
         glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -925,28 +935,23 @@ private:
         }
 
         // UTILISEZ LE VRAI SHADER DEFERRED (celui qui affiche la skybox)
-        glUseProgram(deferredProgram_);
+        // Variante du mode debug et du nombre de lumières courants (unités des samplers fixées à sa création)
+        ShaderProgram *deferred = deferredVariants_.bind(getDeferredKey());
+        if (deferred == nullptr) return;
 
         // Textures du G-buffer
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gPosition_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gPosition"), 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, gNormal_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gNormal"), 1);
 
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gAlbedoSpec"), 2);
 
         // Uniforms pour la skybox
-        glUniform3f(glGetUniformLocation(deferredProgram_, "viewPos"),
-                    camPos_[0], camPos_[1], camPos_[2]);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "specularPow"), 32.0f);
-
-        // Lumière (comme dans votre ancien projet)
-        glUniform1i(glGetUniformLocation(deferredProgram_, "pointLightCount"), 1);
+        deferred->setVec3("viewPos", camPos_[0], camPos_[1], camPos_[2]);
+        deferred->setFloat("specularPow", 32.0f);
 
         // Position de la lumière (animation)
         float lightAngle = time_ * 0.5f;
@@ -954,34 +959,28 @@ private:
         float lightY = target_[1] + 8.0f;
         float lightZ = target_[2] + sin(lightAngle) * 15.0f;
 
-        glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].position"),
-                    lightX, lightY, lightZ);
-        glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].color"),
-                    1.2f, 1.1f, 1.0f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].constant"), 1.0f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].linear"), 0.09f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].quadratic"), 0.032f);
+        deferred->setVec3("pointLights[0].position", lightX, lightY, lightZ);
+        deferred->setVec3("pointLights[0].color", 1.2f, 1.1f, 1.0f);
+        deferred->setFloat("pointLights[0].constant", 1.0f);
+        deferred->setFloat("pointLights[0].linear", 0.09f);
+        deferred->setFloat("pointLights[0].quadratic", 0.032f);
 
         // Skybox texture
         glActiveTexture(GL_TEXTURE5);
         glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "uSkybox"), 5);
-
-        // Mode normal (pas debug)
-        glUniform1i(glGetUniformLocation(deferredProgram_, "debugMode"), 0);
 
         // Matrices inverses pour le ray marching de la skybox
         float invProj[16], invView[16];
 
-        glUniformMatrix4fv(glGetUniformLocation(deferredProgram_, "invProj"), 1, GL_FALSE, invProj);
-        glUniformMatrix4fv(glGetUniformLocation(deferredProgram_, "invViewRot"), 1, GL_FALSE, invView);
+        deferred->setMat4("invProj", invProj);
+        deferred->setMat4("invViewRot", invView);
 
 
         // Rendu du quad plein écran
         glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
         glBindVertexArray(0);
-        glUniform1f(glGetUniformLocation(deferredProgram_,"far"),far );
+        deferred->setFloat("far", far);
         renderSkybox(view, proj);
         glDisable(GL_DEPTH_TEST);
     }
@@ -1082,6 +1081,7 @@ private:
     )";
 
         static GLuint shadowSimpleProgram = 0;
+        static ShaderProgram shadowSimpleUniforms;
         if (shadowSimpleProgram == 0) {
             const std::string vs = R"(
             #version 330 core
@@ -1094,6 +1094,7 @@ private:
             }
         )";
             shadowSimpleProgram = createProgram(vs, shadowSimpleFS);
+            shadowSimpleUniforms.reflect(shadowSimpleProgram);
             std::cout << "Shadow simple program créé: " << shadowSimpleProgram << std::endl;
         }
 
@@ -1102,31 +1103,28 @@ private:
         // Textures du G-buffer
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gPosition_);
-        glUniform1i(glGetUniformLocation(shadowSimpleProgram, "gPosition"), 0);
+        shadowSimpleUniforms.setInt("gPosition", 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, gNormal_);
-        glUniform1i(glGetUniformLocation(shadowSimpleProgram, "gNormal"), 1);
+        shadowSimpleUniforms.setInt("gNormal", 1);
 
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-        glUniform1i(glGetUniformLocation(shadowSimpleProgram, "gAlbedoSpec"), 2);
+        shadowSimpleUniforms.setInt("gAlbedoSpec", 2);
 
         // Shadow map
         glActiveTexture(GL_TEXTURE3);
         glBindTexture(GL_TEXTURE_2D, shadowDepthTex_);
-        glUniform1i(glGetUniformLocation(shadowSimpleProgram, "shadowMap"), 3);
+        shadowSimpleUniforms.setInt("shadowMap", 3);
 
         // Uniforms
-        glUniform3f(glGetUniformLocation(shadowSimpleProgram, "viewPos"),
-                    camPos_[0], camPos_[1], camPos_[2]);
+        shadowSimpleUniforms.setVec3("viewPos", camPos_[0], camPos_[1], camPos_[2]);
 
-        glUniformMatrix4fv(glGetUniformLocation(shadowSimpleProgram, "lightSpaceMatrix"),
-                           1, GL_FALSE, lightSpaceMatrix_);
+        shadowSimpleUniforms.setMat4("lightSpaceMatrix", lightSpaceMatrix_);
 
         float lightPos[3] = {10.0f, 20.0f, 10.0f};
-        glUniform3f(glGetUniformLocation(shadowSimpleProgram, "lightPos"),
-                    lightPos[0], lightPos[1], lightPos[2]);
+        shadowSimpleUniforms.setVec3("lightPos", lightPos[0], lightPos[1], lightPos[2]);
 
         // Rendu du quad plein écran
         glBindVertexArray(quadVAO_);
@@ -1209,6 +1207,7 @@ private:
     )";
 
         static GLuint ssaoProgram = 0;
+        static ShaderProgram ssaoUniforms;
         if (ssaoProgram == 0) {
             const std::string vs = R"(
             #version 330 core
@@ -1221,6 +1220,7 @@ private:
             }
         )";
             ssaoProgram = createProgram(vs, ssaoFS);
+            ssaoUniforms.reflect(ssaoProgram);
             std::cout << "SSAO program créé: " << ssaoProgram << std::endl;
         }
 
@@ -1229,23 +1229,22 @@ private:
         // Textures
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gPosition_);
-        glUniform1i(glGetUniformLocation(ssaoProgram, "gPosition"), 0);
+        ssaoUniforms.setInt("gPosition", 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, gNormal_);
-        glUniform1i(glGetUniformLocation(ssaoProgram, "gNormal"), 1);
+        ssaoUniforms.setInt("gNormal", 1);
 
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-        glUniform1i(glGetUniformLocation(ssaoProgram, "gAlbedoSpec"), 2);
+        ssaoUniforms.setInt("gAlbedoSpec", 2);
 
         glActiveTexture(GL_TEXTURE3);
         glBindTexture(GL_TEXTURE_2D, ssaoBlurBuffer_); // Utiliser le buffer SSAO blurré
-        glUniform1i(glGetUniformLocation(ssaoProgram, "ssaoBuffer"), 3);
+        ssaoUniforms.setInt("ssaoBuffer", 3);
 
         // View position
-        glUniform3f(glGetUniformLocation(ssaoProgram, "viewPos"),
-                    camPos_[0], camPos_[1], camPos_[2]);
+        ssaoUniforms.setVec3("viewPos", camPos_[0], camPos_[1], camPos_[2]);
 
         glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -1330,6 +1329,7 @@ private:
     )";
 
         static GLuint debugProgram = 0;
+        static ShaderProgram debugUniforms;
         if (debugProgram == 0) {
             const std::string vs = R"(
             #version 330 core
@@ -1342,6 +1342,7 @@ private:
             }
         )";
             debugProgram = createProgram(vs, debugFS);
+            debugUniforms.reflect(debugProgram);
             std::cout << "Debug shadow program created: " << debugProgram << std::endl;
         }
 
@@ -1354,7 +1355,7 @@ private:
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        glUniform1i(glGetUniformLocation(debugProgram, "depthMap"), 0);
+        debugUniforms.setInt("depthMap", 0);
 
         glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -1400,6 +1401,7 @@ private:
         )";
 
         static GLuint debugProgram = 0;
+        static ShaderProgram debugUniforms;
         if (debugProgram == 0) {
             const std::string vs = R"(
                 #version 330 core
@@ -1412,13 +1414,14 @@ private:
                 }
             )";
             debugProgram = createProgram(vs, debugFS);
+            debugUniforms.reflect(debugProgram);
         }
 
         glUseProgram(debugProgram);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, ssaoBlurBuffer_);
-        glUniform1i(glGetUniformLocation(debugProgram, "ssaoBuffer"), 0);
+        debugUniforms.setInt("ssaoBuffer", 0);
 
         glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -1441,21 +1444,18 @@ private:
     void renderModelInstance(float *view, float *proj, float *modelMatrix) {
         if (!model_)return;
         // Vous avez besoin d'un shader spécifique pour le modèle
-        // Soit vous utilisez le cubeProgram_ si compatible,
+        // Soit vous utilisez une variante de cubeVariants_ si compatible,
         // soit vous créez un nouveau shader
 
 
         glUseProgram(modelProgram_);
 
         // Passer les matrices
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uView"), 1, GL_FALSE, view);
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uProj"), 1, GL_FALSE, proj);
+        modelUniforms_.setMat4("uView", view);
+        modelUniforms_.setMat4("uProj", proj);
 
         // Passer la matrice modèle
-        GLuint modelLoc = glGetUniformLocation(cubeProgram_, "uModel");
-        if (modelLoc != -1) {
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, modelMatrix);
-        }
+        modelUniforms_.setMat4("uModel", modelMatrix);
 
         // Utiliser les textures du modèle (à adapter selon votre modèle)
         model_->Draw(modelProgram_); // Supposant que votre modèle a une méthode Draw()
@@ -1463,21 +1463,18 @@ private:
 
     void renderGeometryPass(float *view, float *proj) {
         //Rendu des cubes
-        glUseProgram(cubeProgram_);
+        // Variante avec ou sans normal map (unités des samplers fixées à sa création)
+        ShaderProgram *cube = cubeVariants_.bind(getCubeKey());
+        if (cube == nullptr) return;
 
-
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uView"), 1, GL_FALSE, view);
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uProj"), 1, GL_FALSE, proj);
+        cube->setMat4("uView", view);
+        cube->setMat4("uProj", proj);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, cubeDiffuseTex_);
-        glUniform1i(glGetUniformLocation(cubeProgram_, "uDiffuse"), 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, cubeNormalTex_);
-        glUniform1i(glGetUniformLocation(cubeProgram_, "uNormalMap"), 1);
-
-        glUniform1i(glGetUniformLocation(cubeProgram_, "useNormal"), 1);
 
         // Mise à jour des instances des cubes
         cubeInstanceMatrices_.clear();
@@ -1538,8 +1535,8 @@ private:
 
             // draw instanced dans le GBuffer
             glUseProgram(modelProgram_);
-            glUniformMatrix4fv(glGetUniformLocation(modelProgram_, "uView"), 1, GL_FALSE, view);
-            glUniformMatrix4fv(glGetUniformLocation(modelProgram_, "uProj"), 1, GL_FALSE, proj);
+            modelUniforms_.setMat4("uView", view);
+            modelUniforms_.setMat4("uProj", proj);
 
             model_->DrawInstanced(modelProgram_, modelInstanceCount_);
         }
@@ -1688,7 +1685,7 @@ in vec3 Normal;
 
 uniform sampler2D uDiffuse;
 uniform sampler2D uNormalMap;
-uniform bool useNormal;
+// USE_NORMAL_MAP : défini par la variante (ShaderPermutations)
 
 void main(){
 
@@ -1697,12 +1694,12 @@ void main(){
     // tangent -> world
     vec3 N = normalize(Normal);
 
-    if(useNormal){
-        // normal map (tangent space)
-        vec3 nTS = texture(uNormalMap, vUV).rgb;
-        nTS = normalize(nTS * 2.0 - 1.0); // [0,1] -> [-1,1]
-        N=normalize(vTBN * nTS);
-    }
+#if USE_NORMAL_MAP
+    // normal map (tangent space)
+    vec3 nTS = texture(uNormalMap, vUV).rgb;
+    nTS = normalize(nTS * 2.0 - 1.0); // [0,1] -> [-1,1]
+    N=normalize(vTBN * nTS);
+#endif
     gNormal=vec4(N*0.5+0.5, 1.0);
 
     vec4 diffuseTex = texture(uDiffuse, vUV);
@@ -1763,35 +1760,32 @@ struct PointLight{
     float linear;
     float quadratic;
 };
-uniform int pointLightCount;
-uniform PointLight pointLights[1];
-
-uniform int debugMode;
+// POINT_LIGHT_COUNT et DEBUG_MODE : définis par la variante (ShaderPermutations)
+#if POINT_LIGHT_COUNT > 0
+uniform PointLight pointLights[POINT_LIGHT_COUNT];
+#endif
 
 void main(){
 
     // Mode debug: 0=normal, 1=positions, 2=normales, 3=albedo, 4=UV
-    if(debugMode == 1) {
-        // Afficher les positions (normalisées pour la visualisation)
-        vec3 pos = texture(gPosition, TexCoord).rgb;
-        FragColor = vec4(normalize(pos) * 0.5 + 0.5, 1.0);
-        return;
-    }
-    else if(debugMode == 2) {
-        // Afficher les normales (déjà en [0,1])
-        FragColor = texture(gNormal, TexCoord);
-        return;
-    }
-    else if(debugMode == 3) {
-        // Afficher l'albedo (couleur de la texture)
-        FragColor = texture(gAlbedoSpec, TexCoord);
-        return;
-    }
-    else if(debugMode == 4) {
-        // Afficher les coordonnées UV
-        FragColor = vec4(TexCoord, 0.0, 1.0);
-        return;
-    }
+#if DEBUG_MODE == 1
+    // Afficher les positions (normalisées pour la visualisation)
+    vec3 pos = texture(gPosition, TexCoord).rgb;
+    FragColor = vec4(normalize(pos) * 0.5 + 0.5, 1.0);
+    return;
+#elif DEBUG_MODE == 2
+    // Afficher les normales (déjà en [0,1])
+    FragColor = texture(gNormal, TexCoord);
+    return;
+#elif DEBUG_MODE == 3
+    // Afficher l'albedo (couleur de la texture)
+    FragColor = texture(gAlbedoSpec, TexCoord);
+    return;
+#elif DEBUG_MODE == 4
+    // Afficher les coordonnées UV
+    FragColor = vec4(TexCoord, 0.0, 1.0);
+    return;
+#endif
 
       // Lire les données du G-buffer
     vec4 positionData = texture(gPosition, TexCoord);
@@ -1818,7 +1812,8 @@ void main(){
     vec3 viewDir = normalize(viewPos - fragPos);
     vec3 lighting = albedo * 0.1;
 
-    for(int i = 0; i < pointLightCount; i++){
+#if POINT_LIGHT_COUNT > 0
+    for(int i = 0; i < POINT_LIGHT_COUNT; i++){
         vec3 lightDir = normalize(pointLights[i].position - fragPos);
         float diff = max(dot(normal, lightDir), 0.0);
         vec3 diffuse = diff * albedo * pointLights[i].color;
@@ -1834,13 +1829,28 @@ void main(){
 
         lighting += (diffuse + specular) * attenuation;
     }
+#endif
 
     FragColor = vec4(lighting, 1.0);
     gl_FragDepth = viewPos.z;
 })";
 
-        cubeProgram_ = createProgram(vs, fs);
-        deferredProgram_ = createProgram(drv, drf);
+        cubeVariants_.initialize({{GL_VERTEX_SHADER, vs}, {GL_FRAGMENT_SHADER, fs}}, {{"USE_NORMAL_MAP", 1}});
+        cubeVariants_.setOnCreated([](ShaderProgram &program) {
+            program.setInt("uDiffuse", 0);
+            program.setInt("uNormalMap", 1);
+        });
+        deferredVariants_.initialize({{GL_VERTEX_SHADER, drv}, {GL_FRAGMENT_SHADER, drf}},
+                                     {{"DEBUG_MODE", 3}, {"POINT_LIGHT_COUNT", 3}});
+        deferredVariants_.setOnCreated([](ShaderProgram &program) {
+            program.setInt("gPosition", 0);
+            program.setInt("gNormal", 1);
+            program.setInt("gAlbedoSpec", 2);
+            program.setInt("uSkybox", 5);
+        });
+        if (cubeVariants_.get(getCubeKey()) == nullptr || deferredVariants_.get(getDeferredKey()) == nullptr) {
+            throw std::runtime_error("Erreur création program (voir log ci-dessus)");
+        }
         static constexpr float vertices[] = {
             // +X
             +0.5f, -0.5f, -0.5f, 1, 0, 0, 0, 0, 0, 0, -1,
@@ -2413,6 +2423,8 @@ void main(){
 )";
 
         postProgram_ = createProgram(postVertexShader, postFragmentShader);
+
+        postUniforms_.reflect(postProgram_);
     }
 
     // Initialisation des shaders pour le bloom
@@ -2520,8 +2532,12 @@ void main(){
     )";
 
         bloomExtractProgram_ = createProgram(bloomVertexShader, bloomExtractFS);
+
+        bloomExtractUniforms_.reflect(bloomExtractProgram_);
         bloomBlurProgram_ = createProgram(bloomVertexShader, bloomBlurFS);
+        bloomBlurUniforms_.reflect(bloomBlurProgram_);
         bloomCombineProgram_ = createProgram(bloomVertexShader, bloomCombineFS);
+        bloomCombineUniforms_.reflect(bloomCombineProgram_);
     }
 
     GLfloat lightX = 0;
@@ -2550,21 +2566,17 @@ void main(){
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
 
-        glUseProgram(cubeProgram_);
+        ShaderProgram *cube = cubeVariants_.bind(getCubeKey());
+        if (cube == nullptr) return;
 
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uView"), 1, GL_FALSE, view);
-        glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uProj"), 1, GL_FALSE, proj);
+        cube->setMat4("uView", view);
+        cube->setMat4("uProj", proj);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, cubeDiffuseTex_);
-        glUniform1i(glGetUniformLocation(cubeProgram_, "uDiffuse"), 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, cubeNormalTex_);
-        glUniform1i(glGetUniformLocation(cubeProgram_, "uNormalMap"), 1);
-
-        // Optionnel : activer la normal map (si uniform existe)
-        glUniform1i(glGetUniformLocation(cubeProgram_, "useNormal"), 1);
 
         // Mise à jour des instances
         cubeInstanceMatrices_.clear();
@@ -2598,27 +2610,24 @@ void main(){
         // Désactiver le test de profondeur pour le quad plein écran
         glDisable(GL_DEPTH_TEST);
 
-        glUseProgram(deferredProgram_);
+        ShaderProgram *deferred = deferredVariants_.bind(getDeferredKey());
+        if (deferred == nullptr) return;
 
         // Activer les textures du G-buffer
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gPosition_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gPosition"), 0);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, gNormal_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gNormal"), 1);
 
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "gAlbedoSpec"), 2);
 
         // Uniforms critiques – noms exacts du shader
-        glUniform3f(glGetUniformLocation(deferredProgram_, "viewPos"), camX, camY, camZ);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "specularPow"), 32.0f);
+        deferred->setVec3("viewPos", camX, camY, camZ);
+        deferred->setFloat("specularPow", 32.0f);
 
         // Lumière
-        glUniform1i(glGetUniformLocation(deferredProgram_, "debugMode"), 0);
 
         // Position de la lumière qui suit la caméra
         // float lightX = camX + 5.0f;
@@ -2630,19 +2639,15 @@ void main(){
         float lightY = target_[1] + 8.0f; // Hauteur fixe
         float lightZ = target_[2] + sin(lightAngle) * lightOrbitRadius;
 
-        glUniform1i(glGetUniformLocation(deferredProgram_, "pointLightCount"), 1);
-        glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].position"),
-                    lightX, lightY, lightZ);
+        deferred->setVec3("pointLights[0].position", lightX, lightY, lightZ);
 
-        glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].color"),
-                    1.2f, 1.1f, 1.0f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].constant"), 1.0f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].linear"), 0.09f);
-        glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].quadratic"), 0.032f);
+        deferred->setVec3("pointLights[0].color", 1.2f, 1.1f, 1.0f);
+        deferred->setFloat("pointLights[0].constant", 1.0f);
+        deferred->setFloat("pointLights[0].linear", 0.09f);
+        deferred->setFloat("pointLights[0].quadratic", 0.032f);
 
         glActiveTexture(GL_TEXTURE5);
         glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex_);
-        glUniform1i(glGetUniformLocation(deferredProgram_, "uSkybox"), 5);
 
         // Rendu du quad plein écran
         glBindVertexArray(quadVAO_);
@@ -2660,7 +2665,7 @@ void main(){
         glClear(GL_COLOR_BUFFER_BIT);
 
         glUseProgram(bloomExtractProgram_);
-        glUniform1f(glGetUniformLocation(bloomExtractProgram_, "uThreshold"), bloomThreshold_);
+        bloomExtractUniforms_.setFloat("uThreshold", bloomThreshold_);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, colorTex_);
@@ -2673,12 +2678,11 @@ void main(){
         bool first_iteration = true;
 
         glUseProgram(bloomBlurProgram_);
-        glUniform2f(glGetUniformLocation(bloomBlurProgram_, "uTexelSize"),
-                    1.0f / (width_ / 2), 1.0f / (height_ / 2));
+        bloomBlurUniforms_.setVec2("uTexelSize", 1.0f / (width_ / 2), 1.0f / (height_ / 2));
 
         for (int i = 0; i < blurIterations_ * 2; i++) {
             glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO_[horizontal ? 1 : 0]);
-            glUniform1i(glGetUniformLocation(bloomBlurProgram_, "uHorizontal"), horizontal);
+            bloomBlurUniforms_.setInt("uHorizontal", horizontal);
 
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, first_iteration ? bloomTex_[0] : bloomTex_[horizontal ? 0 : 1]);
@@ -2695,14 +2699,14 @@ void main(){
         glClear(GL_COLOR_BUFFER_BIT);
 
         glUseProgram(bloomCombineProgram_);
-        glUniform1f(glGetUniformLocation(bloomCombineProgram_, "uBloomIntensity"), bloomIntensity_);
+        bloomCombineUniforms_.setFloat("uBloomIntensity", bloomIntensity_);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, colorTex_);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, bloomTex_[1]);
-        glUniform1i(glGetUniformLocation(bloomCombineProgram_, "uBloomBlur"), 1);
+        bloomCombineUniforms_.setInt("uBloomBlur", 1);
 
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
@@ -2727,24 +2731,22 @@ void main(){
         glUseProgram(postProgram_);
 
         // Passer les uniformes
-        glUniform1i(glGetUniformLocation(postProgram_, "uEffect"), currentEffect_);
-        glUniform2f(glGetUniformLocation(postProgram_, "uTexelSize"),
-                    1.0f / width_, 1.0f / height_);
-        glUniform1f(glGetUniformLocation(postProgram_, "uTime"), time_);
-        glUniform1f(glGetUniformLocation(postProgram_, "uBloomThreshold"), bloomThreshold_);
-        glUniform1f(glGetUniformLocation(postProgram_, "uBloomIntensity"), bloomIntensity_);
+        postUniforms_.setInt("uEffect", currentEffect_);
+        postUniforms_.setVec2("uTexelSize", 1.0f / width_, 1.0f / height_);
+        postUniforms_.setFloat("uTime", time_);
+        postUniforms_.setFloat("uBloomThreshold", bloomThreshold_);
+        postUniforms_.setFloat("uBloomIntensity", bloomIntensity_);
 
         // Passer le kernel de convolution si nécessaire
         if (currentEffect_ == EFFECT_GAUSSIAN_BLUR &&
             currentEffect_ < convolutionKernels_.size()) {
             const auto &kernel = convolutionKernels_[currentEffect_];
-            glUniform1fv(glGetUniformLocation(postProgram_, "uKernel"),
-                         kernel.size(), kernel.data());
+            postUniforms_.setFloatArray("uKernel", kernel.data(), static_cast<int>(kernel.size()));
         }
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, sourceTexture);
-        glUniform1i(glGetUniformLocation(postProgram_, "uScene"), 0);
+        postUniforms_.setInt("uScene", 0);
 
         glBindVertexArray(quadVAO_);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -2772,13 +2774,15 @@ void main(){
 
         uniform mat4 uView;
         uniform mat4 uProj;
+        // Nœud du mesh dans le modèle (Model::Draw / DrawInstanced)
+        uniform mat4 uNodeMatrix = mat4(1.0);
 
         out vec3 vWorldPos;
         out vec3 vWorldNormal;
         out vec2 vUV;
 
         void main() {
-            mat4 M = mat4(iM0, iM1, iM2, iM3);
+            mat4 M = mat4(iM0, iM1, iM2, iM3) * uNodeMatrix;
 
             vec4 worldPos = M * vec4(aPos, 1.0);
             vWorldPos = worldPos.xyz;
@@ -2844,12 +2848,13 @@ void main(){
     void initGL() {
         // 1) créer shader modèle
         modelProgram_ = createModelShaderProgram();
+        modelUniforms_.reflect(modelProgram_);
 
         // 2) binder et set les samplers (IMPORTANT: tant que le program est actif)
         glUseProgram(modelProgram_);
-        glUniform1i(glGetUniformLocation(modelProgram_, "texture_diffuse1"), 0);
+        modelUniforms_.setInt("texture_diffuse1", 0);
         // Si ton FS n'utilise pas texture_specular1, tu peux enlever.
-        // glUniform1i(glGetUniformLocation(modelProgram_, "texture_specular1"), 1);
+        // modelUniforms_.setInt("texture_specular1", 1);
         glUseProgram(0);
 
         // 3) post-processing
@@ -2922,13 +2927,15 @@ void main(){
 
         skyboxProgram_ = createProgram(vs, fs);
 
+        skyboxUniforms_.reflect(skyboxProgram_);
+
         if (skyboxProgram_ == 0) {
             std::cerr << "[ERROR] Skybox program creation failed!\n";
             return;
         }
 
         glUseProgram(skyboxProgram_);
-        glUniform1i(glGetUniformLocation(skyboxProgram_, "uSkybox"), 0);
+        skyboxUniforms_.setInt("uSkybox", 0);
         glUseProgram(0);
 
         // 3) chargement cubemap - VÉRIFIER LES CHEMINS !
@@ -2965,10 +2972,10 @@ void main(){
         viewNoTranslation[13] = 0;
         viewNoTranslation[14] = 0;
 
-        glUniformMatrix4fv(glGetUniformLocation(skyboxProgram_, "uView"), 1, GL_FALSE, viewNoTranslation);
-        glUniformMatrix4fv(glGetUniformLocation(skyboxProgram_, "uProj"), 1, GL_FALSE, proj);
+        skyboxUniforms_.setMat4("uView", viewNoTranslation);
+        skyboxUniforms_.setMat4("uProj", proj);
 
-        //glUniform1f(glGetUniformLocation(skyboxProgram_, "uBrightness"), 2.f); // 1.5 = 50% plus clair
+        //skyboxUniforms_.setFloat("uBrightness", 2.f); // 1.5 = 50% plus clair
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex_);
@@ -3048,6 +3055,14 @@ void main(){
         return shader;
     }
 
+    [[nodiscard]] ShaderPermutations::Key getCubeKey() const {
+        return cubeVariants_.makeKey({useNormalMap_ ? 1 : 0});
+    }
+
+    [[nodiscard]] ShaderPermutations::Key getDeferredKey() const {
+        return deferredVariants_.makeKey({deferredDebugMode_, pointLightCount_});
+    }
+
     static GLuint createProgram(const std::string &vertexSrc, const std::string &fragmentSrc) {
         GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSrc);
         GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSrc);
@@ -3167,8 +3182,8 @@ void main(){
         if (skyboxVAO_)
             glDeleteVertexArrays(1, &skyboxVAO_);
 
-        if (cubeProgram_)
-            glDeleteProgram(cubeProgram_);
+        cubeVariants_.cleanup();
+        deferredVariants_.cleanup();
         if (cubeVBO_)
             glDeleteBuffers(1, &cubeVBO_);
         if (cubeEBO_)
@@ -3176,7 +3191,7 @@ void main(){
         if (cubeVAO_)
             glDeleteVertexArrays(1, &cubeVAO_);
 
-        cubeProgram_ = cubeVAO_ = cubeVBO_ = cubeEBO_ = 0;
+        cubeVAO_ = cubeVBO_ = cubeEBO_ = 0;
 
         if (postProgram_)
             glDeleteProgram(postProgram_);
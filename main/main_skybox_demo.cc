@@ -295,12 +295,14 @@ private:
             out vec2 TexCoord;
 
             uniform mat4 uModel;
+            uniform mat4 uNodeMatrix; // Model::Draw, par nœud
             uniform mat4 uView;
             uniform mat4 uProj;
 
             void main() {
-                FragPos = vec3(uModel * vec4(aPosition, 1.0));
-                Normal = mat3(transpose(inverse(uModel))) * aNormal;
+                mat4 model = uModel * uNodeMatrix;
+                FragPos = vec3(model * vec4(aPosition, 1.0));
+                Normal = mat3(transpose(inverse(model))) * aNormal;
                 TexCoord = aTexCoord;
 
                 gl_Position = uProj* uView * vec4(FragPos, 1.0);
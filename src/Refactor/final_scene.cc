@@ -5,12 +5,16 @@
 #include "../../include/Refactor/final_scene.h"
 
 #include <corecrt_math_defines.h>
+#include <algorithm>
 #include <iostream>
 #include <random>
 
 #include "stb_image.h"
 #include "engine/window.h"
 #include "Refactor/shaders.h"
+#include "program_cache.h"
+#include "job_system.h"
+#include "matrix_math.h"
 
 void FinalScene::Begin() {
     std::cout << "SkyboxRenderer::Begin() - Initialisation framebuffer" << std::endl;
@@ -23,21 +27,19 @@ void FinalScene::Begin() {
     SDL_GetWindowSize(window, &screenWidth_, &screenHeight_);
     width_ = screenWidth_;
     height_ = screenHeight_;
+    // Toutes les compilations partent maintenant : le pilote les traite pendant le chargement
+    // du modèle et des textures ci-dessous
+    submitPrograms();
     initGL();
     createFramebuffer();
     createScreenQuad();
     // load model
     model_ = std::make_unique<Model>("data/model/nanosuit2/nanosuit.obj");
-    glGenBuffers(1, &modelInstanceVBO_);
-    glBindBuffer(GL_ARRAY_BUFFER, modelInstanceVBO_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 modelInstanceCount_ * 16 * sizeof(float),
-                 nullptr,
-                 GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // Une tranche par frame en vol : réécrite seulement quand la fence de son slot est passée
+    modelInstanceRing_.initialize(GL_ARRAY_BUFFER, modelInstanceCount_ * 16 * sizeof(float));
 
     //Attacher aux VAO de tous les meshes du modèle
-    model_->AttachInstanceBuffer(modelInstanceVBO_);
+    model_->AttachInstanceBuffer(modelInstanceRing_.getBuffer());
 
     core::Vec3F c = model_->GetCenter();
     float offsetY = -model_->GetMinY();
@@ -53,16 +55,15 @@ void FinalScene::Begin() {
     yaw_ = 90.0f;
     pitch_ = 10.0f;
 
-    // Créer des framebuffers supplémentaires pour les effets
-    createMultiPassFramebuffers();
-    createBloomFramebuffers();
     createSkyboxRessources();
 
-    initPostProcessingShaders();
-    initBloomShaders();
+    // Chaîne de post-processing (effet courant + bloom) appliquée sur colorTex_
+    postChain_.initialize(width_, height_);
+    if (!postChain_.setCustomKernel(ConvolutionKernel::disc(CUSTOM_KERNEL_RADIUS))) {
+        std::cerr << "ERROR: Custom post-process kernel rejected" << std::endl;
+    }
+    updatePostChain();
 
-    // Initialiser les matrices de convolution
-    initConvolutionKernels();
     initCubeResources();
     cubeDiffuseTex_ = loadTexture2D("data/textures/brickwall.jpg", true);
     cubeNormalTex_ = loadTexture2D("data/textures/brickwall_normal.jpg", true);
@@ -75,6 +76,14 @@ void FinalScene::Begin() {
 
     createCubeLine();
     initCubeInstancing();
+    finalizePrograms();
+
+    // Première frame simulée ici : Draw a toujours une frame prête
+    simulate(makeSimulationInput(), snapshotBuffer_.getWriteBuffer());
+    snapshotBuffer_.publish();
+    if (pipelined_) {
+        startSimulationThread();
+    }
 
 #ifdef IMGUI_ENABLED
     initImGui();
@@ -83,6 +92,7 @@ void FinalScene::Begin() {
 
 void FinalScene::Update(float dt) {
     time_ += dt;
+    JobSystem::executeMainThreadTasks();
 
     // --- clavier ---
     const bool *keys = SDL_GetKeyboardState(nullptr);
@@ -118,6 +128,25 @@ void FinalScene::Update(float dt) {
     }
     keyWasDown_[SDL_SCANCODE_SPACE] = keys[SDL_SCANCODE_SPACE];
 
+    // K: flou disque (noyau utilisateur, chemin 2D par tuiles)
+    if (keys[SDL_SCANCODE_K] && !keyWasDown_[SDL_SCANCODE_K]) {
+        currentEffect_ = currentEffect_ == EFFECT_CUSTOM_KERNEL ? EFFECT_NONE : EFFECT_CUSTOM_KERNEL;
+        std::cout << "Effet changé: " << effectNames_[currentEffect_] << std::endl;
+    }
+    keyWasDown_[SDL_SCANCODE_K] = keys[SDL_SCANCODE_K];
+
+    // - / = : rayon du flou gaussien (séparé en deux passes 1D au-delà du 3x3)
+    const int radiusStep = (keys[SDL_SCANCODE_EQUALS] && !keyWasDown_[SDL_SCANCODE_EQUALS] ? 1 : 0)
+                           - (keys[SDL_SCANCODE_MINUS] && !keyWasDown_[SDL_SCANCODE_MINUS] ? 1 : 0);
+    keyWasDown_[SDL_SCANCODE_EQUALS] = keys[SDL_SCANCODE_EQUALS];
+    keyWasDown_[SDL_SCANCODE_MINUS] = keys[SDL_SCANCODE_MINUS];
+    if (radiusStep != 0) {
+        gaussianRadius_ = std::clamp(gaussianRadius_ + radiusStep, 1, ConvolutionEngine::MAX_RADIUS_SEPARABLE);
+        postChain_.setGaussianRadius(gaussianRadius_);
+        std::cout << "Rayon du flou gaussien: " << gaussianRadius_ << std::endl;
+    }
+    updatePostChain();
+
     // F1-F4: Changer le mode de rendu
     if (keys[SDL_SCANCODE_F1] && !keyWasDown_[SDL_SCANCODE_F1]) {
         currentRenderMode_ = RENDER_DEFERRED;
@@ -151,28 +180,61 @@ void FinalScene::Update(float dt) {
     }
     keyWasDown_[SDL_SCANCODE_F5] = keys[SDL_SCANCODE_F5];
 
-    // ---- si la caméra est désactivée, on ne bouge pas ----
-    if (!mouseLookEnabled_) return;
+    // F6: simulation sur son thread (pipeline) ou juste avant le rendu
+    if (keys[SDL_SCANCODE_F6] && !keyWasDown_[SDL_SCANCODE_F6]) {
+        pipelined_ = !pipelined_;
+        if (pipelined_) {
+            startSimulationThread();
+        } else {
+            stopSimulationThread();
+        }
+        std::cout << "Simulation: " << (pipelined_ ? "thread dédié" : "thread principal") << std::endl;
+    }
+    keyWasDown_[SDL_SCANCODE_F6] = keys[SDL_SCANCODE_F6];
 
+    // F7: avance maximale du CPU sur le GPU (1 à 3 frames)
+    if (keys[SDL_SCANCODE_F7] && !keyWasDown_[SDL_SCANCODE_F7]) {
+        frameFences_.setFramesInFlight(frameFences_.getFramesInFlight() % FrameFences::MAX_FRAMES_IN_FLIGHT + 1);
+        std::cout << "Frames en vol: " << frameFences_.getFramesInFlight() << std::endl;
+    }
+    keyWasDown_[SDL_SCANCODE_F7] = keys[SDL_SCANCODE_F7];
+
+    // ---- si la caméra est désactivée, on ne bouge pas ----
+    if (mouseLookEnabled_) {
+        // --- souris (relative) ---
+        float mdx = 0.0f, mdy = 0.0f;
+        SDL_GetRelativeMouseState(&mdx, &mdy);
 
-    // --- souris (relative) ---
-    float mdx = 0.0f, mdy = 0.0f;
-    SDL_GetRelativeMouseState(&mdx, &mdy);
+        mdx *= mouseSensitivity_;
+        mdy *= mouseSensitivity_;
 
-    mdx *= mouseSensitivity_;
-    mdy *= mouseSensitivity_;
+        yaw_ += mdx;
+        pitch_ -= mdy;
 
-    yaw_ += mdx;
-    pitch_ -= mdy;
+        if (pitch_ > maxPitch_) pitch_ = maxPitch_;
+        if (pitch_ < minPitch_) pitch_ = minPitch_;
+    }
 
-    if (pitch_ > maxPitch_) pitch_ = maxPitch_;
-    if (pitch_ < minPitch_) pitch_ = minPitch_;
+    // Entrée de la frame suivante : en pipeline, elle est simulée pendant que Draw soumet
+    // la dernière frame prête
+    if (pipelined_) {
+        inputBuffer_.getWriteBuffer() = makeSimulationInput();
+        inputBuffer_.publish();
+        requestedFrame_.fetch_add(1, std::memory_order_release);
+        requestedFrame_.notify_one();
+    } else {
+        simulate(makeSimulationInput(), snapshotBuffer_.getWriteBuffer());
+        snapshotBuffer_.publish();
+    }
 }
 
 void FinalScene::FixedUpdate() {
 }
 
 void FinalScene::End() {
+    stopSimulationThread();
+    // Plus aucune frame en vol avant de détruire ce qu'elles lisent
+    frameFences_.cleanup();
     SetMouseLook(false);
 
 
@@ -190,6 +252,11 @@ void FinalScene::End() {
     if (shadowDepthTex_) glDeleteTextures(1, &shadowDepthTex_);
     if (shadowProgram_)
         glDeleteProgram(shadowProgram_);
+    shadowCache_.cleanup();
+    layeredShadow_.cleanup();
+    modelInstanceRing_.cleanup();
+    frameBlock_.cleanup();
+    viewBlock_.cleanup();
 
     // Nettoyer les ressources SSAO
     if (ssaoFBO_)
@@ -209,6 +276,20 @@ void FinalScene::PreDraw() {
 }
 
 void FinalScene::Draw() {
+    // Slot de la frame : ses tranches ne sont réécrites qu'une fois le GPU sorti de la frame
+    // qui l'occupait (au plus getFramesInFlight() frames d'avance)
+    frameSlot_ = frameFences_.beginFrame();
+
+    // Les modes éclairés rendent dans fbo_ quand un effet ou le bloom est actif ;
+    // les vues de debug restent brutes
+    const bool litMode = currentRenderMode_ == RENDER_DEFERRED ||
+                         currentRenderMode_ == RENDER_SHADOW_MAPPING ||
+                         currentRenderMode_ == RENDER_SSAO;
+    const bool usePostChain = litMode && postChain_.isActive();
+    sceneTarget_ = usePostChain ? fbo_ : 0;
+
+    updateSharedBlocks(acquireSnapshot());
+
     switch (currentRenderMode_) {
         case RENDER_DEFERRED:
             renderDeferred();
@@ -227,16 +308,42 @@ void FinalScene::Draw() {
             break;
     }
 
+    if (usePostChain) {
+        postChain_.apply(colorTex_, 0);
+    }
+
     // RENDER PASS 3: Interface utilisateur
 #ifdef IMGUI_ENABLED
 	renderImGui();
 #endif
+
+    frameFences_.endFrame();
 }
 
 void FinalScene::PostDraw() {
     DrawInterface::PostDraw();
 }
 
+void FinalScene::updatePostChain() {
+    std::vector<PostChainEffect> effects;
+    switch (currentEffect_) {
+        case EFFECT_INVERT: effects.push_back(PostChainEffect::Invert); break;
+        case EFFECT_GRAYSCALE: effects.push_back(PostChainEffect::Grayscale); break;
+        case EFFECT_SEPIA: effects.push_back(PostChainEffect::Sepia); break;
+        case EFFECT_EDGE_DETECTION: effects.push_back(PostChainEffect::EdgeDetection); break;
+        case EFFECT_BLUR: effects.push_back(PostChainEffect::Blur); break;
+        case EFFECT_SHARPEN: effects.push_back(PostChainEffect::Sharpen); break;
+        case EFFECT_EMBOSS: effects.push_back(PostChainEffect::Emboss); break;
+        case EFFECT_SOBEL: effects.push_back(PostChainEffect::Sobel); break;
+        case EFFECT_GAUSSIAN_BLUR: effects.push_back(PostChainEffect::GaussianBlur); break;
+        case EFFECT_NIGHT_VISION: effects.push_back(PostChainEffect::NightVision); break;
+        case EFFECT_CUSTOM_KERNEL: effects.push_back(PostChainEffect::CustomKernel); break;
+        default: break;
+    }
+    postChain_.setEffects(effects);
+    postChain_.setBloom(useBloom_ || currentEffect_ == EFFECT_BLOOM, bloomThreshold_, bloomKnee_, bloomIntensity_);
+}
+
 void FinalScene::SetMouseLook(bool enabled) {
     mouseLookEnabled_ = enabled;
     SDL_Window *window = common::GetWindow();
@@ -248,20 +355,7 @@ void FinalScene::SetMouseLook(bool enabled) {
 }
 
 void FinalScene::initGL() {
-    // 1) créer shader modèle
-    modelProgram_ = createModelShaderProgram();
-
-    // 2) binder et set les samplers (IMPORTANT: tant que le program est actif)
-    glUseProgram(modelProgram_);
-    glUniform1i(glGetUniformLocation(modelProgram_, "texture_diffuse1"), 0);
-    // Si ton FS n'utilise pas texture_specular1, tu peux enlever.
-    // glUniform1i(glGetUniformLocation(modelProgram_, "texture_specular1"), 1);
-    glUseProgram(0);
-
-    // 3) post-processing
-    initPostProcessingShaders();
-
-    // 4) état GL de base
+    // état GL de base (le shader modèle est soumis par submitPrograms)
     glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
@@ -269,75 +363,243 @@ void FinalScene::initGL() {
     glFrontFace(GL_CCW);
     glCullFace(GL_BACK);
     glEnable(GL_CULL_FACE);
+
+    // Blocs partagés attachés une fois à leurs points de binding fixes
+    frameBlock_.initialize(FrameFences::MAX_FRAMES_IN_FLIGHT);
+    viewBlock_.initialize(FrameFences::MAX_FRAMES_IN_FLIGHT);
 }
 
-GLuint FinalScene::createModelShaderProgram() {
-    return createProgram(ModelVertex, ModelFragment);
+void FinalScene::submitPrograms() {
+    // Les programmes qui lisent caméra / lumière reçoivent les déclarations des blocs partagés
+    const std::string blocks = getSharedBlocksGLSL();
+    modelProgram_ = ProgramCache::submitProgram({{GL_VERTEX_SHADER, ModelVertex}, {GL_FRAGMENT_SHADER, ModelFragment}}, blocks);
+    skyboxProgram_ = ProgramCache::submitProgram({{GL_VERTEX_SHADER, VertexSkyBox}, {GL_FRAGMENT_SHADER, FragmentSkybox}}, blocks);
+    shadowProgram_ = ProgramCache::submitProgram({{GL_VERTEX_SHADER, shadowVS}, {GL_FRAGMENT_SHADER, shadowFS}});
+    ssaoProgram_ = ProgramCache::submitProgram({{GL_VERTEX_SHADER, ssaoVS}, {GL_FRAGMENT_SHADER, ssaoFS}}, blocks);
+    ssaoBlurProgram_ = ProgramCache::submitProgram({{GL_VERTEX_SHADER, ssaoVS}, {GL_FRAGMENT_SHADER, ssaoBlurFS}});
+
+    // Variantes : seules les combinaisons actives au démarrage sont précompilées,
+    // les autres sont construites (puis gardées en cache) à leur premier usage
+    cubeVariants_.initialize({{GL_VERTEX_SHADER, ModelCube}, {GL_FRAGMENT_SHADER, ModulFragment}},
+                             {{"USE_NORMAL_MAP", 1}}, blocks);
+    cubeVariants_.setOnCreated([this](ShaderProgram &program) {
+        attachSharedBlocks(program);
+        program.setInt("uDiffuse", 0);
+        program.setInt("uNormalMap", 1);
+    });
+    cubeVariants_.precompile(getCubeKey());
+
+    deferredVariants_.initialize({{GL_VERTEX_SHADER, drv}, {GL_FRAGMENT_SHADER, drf}},
+                                 {{"DEBUG_MODE", 3}, {"POINT_LIGHT_COUNT", 3}}, blocks);
+    deferredVariants_.setOnCreated([this](ShaderProgram &program) {
+        attachSharedBlocks(program);
+        program.setInt("gPosition", 0);
+        program.setInt("gNormal", 1);
+        program.setInt("gAlbedoSpec", 2);
+        program.setInt("uSkybox", 5);
+    });
+    deferredVariants_.precompile(getDeferredKey());
+}
+
+void FinalScene::finalizePrograms() {
+    for (GLuint *program: {&modelProgram_, &skyboxProgram_,
+                           &shadowProgram_, &ssaoProgram_, &ssaoBlurProgram_}) {
+        *program = ProgramCache::finalize(*program);
+        if (*program == 0) {
+            throw std::runtime_error("Erreur création program (voir log ci-dessus)");
+        }
+    }
+
+    // Réflexion unique : plus aucun glGetUniformLocation pendant le rendu
+    modelUniforms_.reflect(modelProgram_);
+    modelSamplers_ = SamplerLayout::resolve(modelProgram_);
+    skyboxUniforms_.reflect(skyboxProgram_);
+    ssaoUniforms_.reflect(ssaoProgram_);
+    ssaoBlurUniforms_.reflect(ssaoBlurProgram_);
 
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, ModelVertex);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, ModelFragment);
+    for (const ShaderProgram *program: {&modelUniforms_, &skyboxUniforms_, &ssaoUniforms_}) {
+        attachSharedBlocks(*program);
+    }
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
+    if (cubeVariants_.get(getCubeKey()) == nullptr || deferredVariants_.get(getDeferredKey()) == nullptr) {
+        throw std::runtime_error("Erreur création program (voir log ci-dessus)");
+    }
 
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        throw std::runtime_error(std::string("Erreur linkage shader: ") + infoLog);
+    // Samplers fixes
+    modelUniforms_.setInt("texture_diffuse1", 0);
+    skyboxUniforms_.setInt("uSkybox", 0);
+
+    // Kernel SSAO (64 samples max)
+    const int samplesToUse = std::min(64, static_cast<int>(ssaoKernel_.size()));
+    for (int i = 0; i < samplesToUse; ++i) {
+        const std::string name = "samples[" + std::to_string(i) + "]";
+        ssaoUniforms_.setVec3(UniformName::runtime(name), ssaoKernel_[i].x, ssaoKernel_[i].y, ssaoKernel_[i].z);
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    std::cout << "[INFO] Programs prêts (cache: " << ProgramCache::getHitCount() << " hits, "
+            << ProgramCache::getMissCount() << " misses)" << std::endl;
+}
+
+ShaderPermutations::Key FinalScene::getCubeKey() const {
+    return cubeVariants_.makeKey({useNormalMap_ ? 1 : 0});
+}
+
+ShaderPermutations::Key FinalScene::getDeferredKey() const {
+    return deferredVariants_.makeKey({deferredDebugMode_, pointLightCount_});
+}
 
-    std::cout << "✓ Shader debug créé" << std::endl;
+GLuint FinalScene::createProgram(const std::string &vertexSrc, const std::string &fragmentSrc,
+                                 const std::string &defines) {
+    // Le cache affiche déjà le log de compilation / linkage
+    GLuint program = ProgramCache::createProgram({{GL_VERTEX_SHADER, vertexSrc},
+                                                  {GL_FRAGMENT_SHADER, fragmentSrc}}, defines);
+    if (program == 0) {
+        throw std::runtime_error("Erreur création program (voir log ci-dessus)");
+    }
     return program;
 }
 
-void FinalScene::initPostProcessingShaders() {
-    postProgram_ = createProgram(PostVertex, PostFragment);
+void FinalScene::attachSharedBlocks(const ShaderProgram &program) const {
+    frameBlock_.attach(program);
+    viewBlock_.attach(program);
+}
+
+void FinalScene::updateSharedBlocks(const RenderSnapshot &snapshot) {
+    viewBlock_.upload(snapshot.view, frameSlot_);
+    frameBlock_.upload(snapshot.frame, frameSlot_);
 }
 
-GLuint FinalScene::createProgram(const std::string &vertexSrc, const std::string &fragmentSrc) {
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSrc);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSrc);
-
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        throw std::runtime_error("Erreur link program:\n" + std::string(infoLog));
+// ==================== PIPELINE SIMULATION / RENDU ====================
+FinalScene::SimulationInput FinalScene::makeSimulationInput() const {
+    SimulationInput input;
+    input.time = time_;
+    input.yaw = yaw_;
+    input.pitch = pitch_;
+    std::copy(std::begin(target_), std::end(target_), input.target);
+    input.orbitRadius = orbitRadius_;
+    input.farPlane = far;
+    input.width = width_;
+    input.height = height_;
+    input.modelInstanceCount = modelInstanceCount_;
+    std::copy(std::begin(lightPosition_), std::end(lightPosition_), input.lightPosition);
+    return input;
+}
+
+void FinalScene::simulate(const SimulationInput &input, RenderSnapshot &snapshot) {
+    float view[16], proj[16], cameraPosition[3];
+    calculateCameraMatrices(input, view, proj, cameraPosition);
+
+    ViewBlock &viewData = snapshot.view;
+    viewData = {};
+    std::memcpy(viewData.view.m, view, sizeof(view));
+    std::memcpy(viewData.projection.m, proj, sizeof(proj));
+
+    // Inverse de la perspective (forme fermée, colonne-major)
+    float *invProj = viewData.invProjection.m;
+    invProj[0] = 1.0f / proj[0];
+    invProj[5] = 1.0f / proj[5];
+    invProj[11] = 1.0f / proj[14];
+    invProj[14] = -1.0f;
+    invProj[15] = proj[10] / proj[14];
+
+    // Inverse de la rotation de la vue : transposée du bloc 3x3
+    float *invViewRot = viewData.invViewRotation.m;
+    for (int c = 0; c < 3; c++) {
+        for (int r = 0; r < 3; r++) {
+            invViewRot[c * 4 + r] = view[r * 4 + c];
+        }
+    }
+    invViewRot[15] = 1.0f;
+
+    viewData.cameraPosition = {cameraPosition[0], cameraPosition[1], cameraPosition[2], input.farPlane};
+
+    calculateLightMatrices(input, snapshot.lightSpaceMatrix);
+
+    FrameBlock &frameData = snapshot.frame;
+    frameData = {};
+    std::memcpy(frameData.lightSpaceMatrix.m, snapshot.lightSpaceMatrix, sizeof(snapshot.lightSpaceMatrix));
+    frameData.lightPosition = {input.lightPosition[0], input.lightPosition[1], input.lightPosition[2], 1.0f};
+    frameData.time = input.time;
+
+    // Lumière ponctuelle animée de la passe deferred
+    const float lightAngle = input.time * 0.5f;
+    snapshot.pointLightPosition[0] = input.target[0] + std::cos(lightAngle) * 15.0f;
+    snapshot.pointLightPosition[1] = input.target[1] + 8.0f;
+    snapshot.pointLightPosition[2] = input.target[2] + std::sin(lightAngle) * 15.0f;
+
+    // Instances du modèle : recalculées seulement quand leur nombre change,
+    // puis recopiées une fois dans chacun des trois exemplaires
+    if (input.modelInstanceCount != simulatedInstanceCount_) {
+        updateModelInstances(input);
+        simulatedInstanceCount_ = input.modelInstanceCount;
+        modelInstanceVersion_++;
+    }
+    if (snapshot.modelInstanceVersion != modelInstanceVersion_) {
+        snapshot.modelInstanceMatrices = modelInstanceMatrices_;
+        snapshot.modelInstanceVersion = modelInstanceVersion_;
     }
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-    return program;
+    snapshot.frameIndex = ++simulatedFrame_;
 }
 
-GLuint FinalScene::compileShader(GLenum type, const std::string &source) {
-    GLuint shader = glCreateShader(type);
-    const char *src = source.c_str();
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
-
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::string shaderType = (type == GL_VERTEX_SHADER) ? "VERTEX" : "FRAGMENT";
-        throw std::runtime_error("Erreur compilation " + shaderType + ":\n" + std::string(infoLog));
+void FinalScene::startSimulationThread() {
+    if (simulationThread_.joinable()) {
+        return;
     }
-    return shader;
+    simulationThread_ = std::jthread([this](const std::stop_token &stop) { simulationLoop(stop); });
+}
+
+void FinalScene::stopSimulationThread() {
+    if (!simulationThread_.joinable()) {
+        return;
+    }
+    simulationThread_.request_stop();
+    simulationThread_.join();
+
+    // Une entrée restée en attente ne doit pas écraser, au prochain démarrage, une frame plus récente
+    inputBuffer_.acquire();
+}
+
+void FinalScene::simulationLoop(const std::stop_token &stop) {
+    // L'arrêt réveille le thread s'il attend une frame
+    std::stop_callback wakeOnStop(stop, [this] {
+        requestedFrame_.fetch_add(1, std::memory_order_release);
+        requestedFrame_.notify_one();
+    });
+
+    std::uint64_t handledFrame = 0;
+    while (!stop.stop_requested()) {
+        requestedFrame_.wait(handledFrame, std::memory_order_acquire);
+        handledFrame = requestedFrame_.load(std::memory_order_acquire);
+
+        if (!stop.stop_requested() && inputBuffer_.acquire()) {
+            simulate(inputBuffer_.getReadBuffer(), snapshotBuffer_.getWriteBuffer());
+            snapshotBuffer_.publish();
+        }
+    }
+}
+
+const FinalScene::RenderSnapshot &FinalScene::acquireSnapshot() {
+    // Rien de nouveau : la frame précédente est rendue de nouveau
+    snapshotBuffer_.acquire();
+    const RenderSnapshot &snapshot = snapshotBuffer_.getReadBuffer();
+
+    // Lumière de la frame rendue, pour le cache d'ombre et le culling
+    std::memcpy(lightSpaceMatrix_, snapshot.lightSpaceMatrix, sizeof(lightSpaceMatrix_));
+    shadowFrustum_.extract(lightSpaceMatrix_);
+
+    // Chaque tranche est mise à jour à son tour, quand son slot revient
+    std::uint64_t &sliceVersion = uploadedInstanceVersions_[frameSlot_];
+    if (model_ && snapshot.modelInstanceVersion != sliceVersion) {
+        modelInstanceRing_.write(frameSlot_, snapshot.modelInstanceMatrices.data(),
+                                 snapshot.modelInstanceMatrices.size() * sizeof(float));
+        sliceVersion = snapshot.modelInstanceVersion;
+    }
+    return snapshot;
+}
+
+GLuint FinalScene::getModelInstanceBase() const {
+    return static_cast<GLuint>(modelInstanceRing_.getSliceOffset(frameSlot_) / (16 * sizeof(float)));
 }
 
 void FinalScene::createFramebuffer() {
@@ -395,54 +657,6 @@ void FinalScene::createScreenQuad() {
     glBindVertexArray(0);
 }
 
-void FinalScene::createMultiPassFramebuffers() {
-    for (int i = 0; i < 2; i++) {
-        glGenFramebuffers(1, &pingpongFBO_[i]);
-        glGenTextures(1, &pingpongTex_[i]);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO_[i]);
-        glBindTexture(GL_TEXTURE_2D, pingpongTex_[i]);
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width_, height_, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pingpongTex_[i], 0);
-
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-            std::cerr << "[PingPong FBO " << i << "] incomplet!" << std::endl;
-        }
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
-
-// Création des framebuffers pour le bloom
-void FinalScene::createBloomFramebuffers() {
-    for (int i = 0; i < 2; i++) {
-        glGenFramebuffers(1, &bloomFBO_[i]);
-        glGenTextures(1, &bloomTex_[i]);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO_[i]);
-        glBindTexture(GL_TEXTURE_2D, bloomTex_[i]);
-
-        // Textures plus petites pour le bloom (downsampling)
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width_ / 2, height_ / 2, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, bloomTex_[i], 0);
-
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-            std::cerr << "[Bloom FBO " << i << "] incomplet!" << std::endl;
-        }
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
-
 void FinalScene::createSkyboxRessources() {
     // 1) géométrie cube skybox (positions uniquement)
     constexpr float skyboxVertices[] = {
@@ -463,17 +677,6 @@ void FinalScene::createSkyboxRessources() {
     glBindVertexArray(0);
 
 
-    skyboxProgram_ = createProgram(VertexSkyBox, FragmentSkybox);
-
-    if (skyboxProgram_ == 0) {
-        std::cerr << "[ERROR] Skybox program creation failed!\n";
-        return;
-    }
-
-    glUseProgram(skyboxProgram_);
-    glUniform1i(glGetUniformLocation(skyboxProgram_, "uSkybox"), 0);
-    glUseProgram(0);
-
     // 3) chargement cubemap - VÉRIFIER LES CHEMINS !
     std::cout << "[Skybox] Attempting to load cubemap textures...\n";
     cubemapTex_ = loadCubemap({
@@ -544,69 +747,7 @@ GLuint FinalScene::loadCubemap(const std::vector<std::string> &path) {
     return texID;
 }
 
-void FinalScene::initBloomShaders() {
-    bloomExtractProgram_ = createProgram(bloomVertexShader, bloomExtractFS);
-    bloomBlurProgram_ = createProgram(bloomVertexShader, bloomBlurFS);
-    bloomCombineProgram_ = createProgram(bloomVertexShader, bloomCombineFS);
-}
-
-void FinalScene::initConvolutionKernels() {
-    convolutionKernels_.resize(EFFECT_COUNT);
-
-    // Aucun effet (identité)
-    convolutionKernels_[EFFECT_NONE] = {
-        0, 0, 0,
-        0, 1, 0,
-        0, 0, 0
-    };
-    // Edge Detection
-    convolutionKernels_[EFFECT_EDGE_DETECTION] = {
-        -1, -1, -1,
-        -1, 8, -1,
-        -1, -1, -1
-    };
-
-    // Flou
-    convolutionKernels_[EFFECT_BLUR] = {
-        1 / 16.0f, 2 / 16.0f, 1 / 16.0f,
-        2 / 16.0f, 4 / 16.0f, 2 / 16.0f,
-        1 / 16.0f, 2 / 16.0f, 1 / 16.0f
-    };
-
-    // Renforcement
-    convolutionKernels_[EFFECT_SHARPEN] = {
-        0, -1, 0,
-        -1, 5, -1,
-        0, -1, 0
-    };
-
-    // Emboss
-    convolutionKernels_[EFFECT_EMBOSS] = {
-        -2, -1, 0,
-        -1, 1, 1,
-        0, 1, 2
-    };
-
-    // Sobel (horizontal)
-    convolutionKernels_[EFFECT_SOBEL] = {
-        -1, 0, 1,
-        -2, 0, 2,
-        -1, 0, 1
-    };
-
-    // Gaussian Blur 5x5 (simplifié)
-    convolutionKernels_[EFFECT_GAUSSIAN_BLUR] = {
-        1 / 256.0f, 4 / 256.0f, 6 / 256.0f, 4 / 256.0f, 1 / 256.0f,
-        4 / 256.0f, 16 / 256.0f, 24 / 256.0f, 16 / 256.0f, 4 / 256.0f,
-        6 / 256.0f, 24 / 256.0f, 36 / 256.0f, 24 / 256.0f, 6 / 256.0f,
-        4 / 256.0f, 16 / 256.0f, 24 / 256.0f, 16 / 256.0f, 4 / 256.0f,
-        1 / 256.0f, 4 / 256.0f, 6 / 256.0f, 4 / 256.0f, 1 / 256.0f
-    };
-}
-
 void FinalScene::initCubeResources() {
-    cubeProgram_ = createProgram(ModelCube, ModulFragment);
-    deferredProgram_ = createProgram(drv, drf);
     static constexpr float vertices[] = {
         // +X
         +0.5f, -0.5f, -0.5f, 1, 0, 0, 0, 0, 0, 0, -1,
@@ -825,16 +966,11 @@ void FinalScene::initShadowMapping() {
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    shadowCache_.initialize(SHADOW_WIDTH, SHADOW_HEIGHT, GL_DEPTH_COMPONENT32F);
+    layeredShadow_.initialize();
 
-    shadowProgram_ = createProgram(shadowVS, shadowFS);
-
-    // DEBUG: Vérifier que le shader est créé
-    if (shadowProgram_ == 0) {
-        std::cerr << "ERROR: Failed to create shadow program!" << std::endl;
-    } else {
-        std::cout << "[INFO] Shadow Mapping initialisé ("
-                << SHADOW_WIDTH << "x" << SHADOW_HEIGHT << ")" << std::endl;
-    }
+    std::cout << "[INFO] Shadow Mapping initialisé ("
+            << SHADOW_WIDTH << "x" << SHADOW_HEIGHT << ")" << std::endl;
 }
 
 void FinalScene::checkShadowFBO() const {
@@ -949,9 +1085,6 @@ void FinalScene::initSSAO() {
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoBlurBuffer_, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    ssaoProgram_ = createProgram(ssaoVS, ssaoFS);
-    ssaoBlurProgram_ = createProgram(ssaoVS, ssaoBlurFS);
-
     std::cout << "[INFO] SSAO initialisé (kernel size: " << ssaoKernelSize_ << ")" << std::endl;
 }
 
@@ -967,6 +1100,13 @@ void FinalScene::createCubeLine() {
         });
     }
 
+    // Boîte englobante de la ligne (cubes unitaires), pour le culling contre la lumière
+    cubeBoundsMin_ = cubeCenters_.front() - core::Vec3F{0.5f, 0.5f, 0.5f};
+    cubeBoundsMax_ = cubeCenters_.back() + core::Vec3F{0.5f, 0.5f, 0.5f};
+
+    // Les cubes sont des casters statiques : la couche d'ombre en cache doit être refaite
+    staticCasterVersion_++;
+
     std::cout << "Created " << cubeCenters_.size() << " cubes" << std::endl;
 }
 
@@ -987,6 +1127,45 @@ void FinalScene::initCubeInstancing() {
         glVertexAttribDivisor(4 + i, 1);
     }
     glBindVertexArray(0);
+
+    updateCubeInstances();
+}
+
+void FinalScene::updateCubeInstances() {
+    // Cubes statiques : le VBO d'instances est rempli une fois et partagé par le G-buffer et les ombres
+    cubeInstanceMatrices_.resize(cubeCenters_.size() * 16);
+    JobSystem::parallelFor(0, cubeCenters_.size(), INSTANCE_GRAIN_SIZE, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto &c = cubeCenters_[i];
+            MatrixMath::translation(&cubeInstanceMatrices_[i * 16], c.x, c.y, c.z);
+        }
+    });
+
+    glBindBuffer(GL_ARRAY_BUFFER, cubeInstanceVBO_);
+    glBufferSubData(GL_ARRAY_BUFFER, 0,
+                    cubeInstanceMatrices_.size() * sizeof(float),
+                    cubeInstanceMatrices_.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void FinalScene::updateModelInstances(const SimulationInput &input) {
+    // Appelée par simulate() : le VBO est rempli côté rendu (acquireSnapshot)
+    const auto count = static_cast<std::size_t>(input.modelInstanceCount);
+    modelInstanceMatrices_.resize(count * 16);
+    JobSystem::parallelFor(0, count, INSTANCE_GRAIN_SIZE, [this, &input, count](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            float angle = (2.0f * M_PI / float(count)) * float(i);
+            float radius = 10.0f;
+
+            const core::Vec3F position{
+                input.target[0] + std::cos(angle) * radius,
+                input.target[1] + 0.5f,
+                input.target[2] + std::sin(angle) * radius
+            };
+            MatrixMath::composeTRS(&modelInstanceMatrices_[i * 16], position,
+                                   {0.0f, 0.0f, 0.0f}, {0.5f, 0.5f, 0.5f});
+        }
+    });
 }
 
 void FinalScene::cleanup() {
@@ -999,8 +1178,8 @@ void FinalScene::cleanup() {
     if (skyboxVAO_)
         glDeleteVertexArrays(1, &skyboxVAO_);
 
-    if (cubeProgram_)
-        glDeleteProgram(cubeProgram_);
+    cubeVariants_.cleanup();
+    deferredVariants_.cleanup();
     if (cubeVBO_)
         glDeleteBuffers(1, &cubeVBO_);
     if (cubeEBO_)
@@ -1008,16 +1187,9 @@ void FinalScene::cleanup() {
     if (cubeVAO_)
         glDeleteVertexArrays(1, &cubeVAO_);
 
-    cubeProgram_ = cubeVAO_ = cubeVBO_ = cubeEBO_ = 0;
+    cubeVAO_ = cubeVBO_ = cubeEBO_ = 0;
 
-    if (postProgram_)
-        glDeleteProgram(postProgram_);
-    if (bloomExtractProgram_)
-        glDeleteProgram(bloomExtractProgram_);
-    if (bloomBlurProgram_)
-        glDeleteProgram(bloomBlurProgram_);
-    if (bloomCombineProgram_)
-        glDeleteProgram(bloomCombineProgram_);
+    postChain_.cleanup();
 
     if (fbo_)
         glDeleteFramebuffers(1, &fbo_);
@@ -1025,15 +1197,6 @@ void FinalScene::cleanup() {
     if (rboDepthStencil_)
         glDeleteRenderbuffers(1, &rboDepthStencil_);
 
-    for (int i = 0; i < 2; i++) {
-        if (pingpongFBO_[i])
-            glDeleteFramebuffers(1, &pingpongFBO_[i]);
-        if (pingpongTex_[i]) glDeleteTextures(1, &pingpongTex_[i]);
-        if (bloomFBO_[i])
-            glDeleteFramebuffers(1, &bloomFBO_[i]);
-        if (bloomTex_[i]) glDeleteTextures(1, &bloomTex_[i]);
-    }
-
     if (quadVAO_)
         glDeleteVertexArrays(1, &quadVAO_);
     if (quadVBO_)
@@ -1053,8 +1216,6 @@ void FinalScene::renderDeferred() {
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
-    float view[16], proj[16];
-    calculateCameraMatrices(view, proj);
 
     // Étape 1: Geometry Pass (identique)
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer_);
@@ -1069,10 +1230,10 @@ void FinalScene::renderDeferred() {
     // glCullFace(GL_BACK);
     // glFrontFace(GL_CCW);
 
-    renderGeometryPass(view, proj);
+    renderGeometryPass();
 
     // Étape 2: Lighting pass AVEC skybox
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget_);
     glViewport(0, 0, screenWidth_, screenHeight_);
     glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1084,114 +1245,70 @@ void FinalScene::renderDeferred() {
     }
 
     // UTILISEZ LE VRAI SHADER DEFERRED (celui qui affiche la skybox)
-    glUseProgram(deferredProgram_);
+    // Variante du mode debug et du nombre de lumières courants (unités des samplers fixées à sa création)
+    ShaderProgram *deferred = deferredVariants_.bind(getDeferredKey());
+    if (deferred == nullptr) return;
 
     // Textures du G-buffer
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, gPosition_);
-    glUniform1i(glGetUniformLocation(deferredProgram_, "gPosition"), 0);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormal_);
-    glUniform1i(glGetUniformLocation(deferredProgram_, "gNormal"), 1);
 
     glActiveTexture(GL_TEXTURE2);
     glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-    glUniform1i(glGetUniformLocation(deferredProgram_, "gAlbedoSpec"), 2);
 
-    // Uniforms pour la skybox
-    glUniform3f(glGetUniformLocation(deferredProgram_, "viewPos"),
-                camPos_[0], camPos_[1], camPos_[2]);
-    glUniform1f(glGetUniformLocation(deferredProgram_, "specularPow"), 32.0f);
+    // Caméra et matrices inverses (ray marching de la skybox) : ViewBlock
+    deferred->setFloat("specularPow", 32.0f);
 
     // Lumière (comme dans votre ancien projet)
-    glUniform1i(glGetUniformLocation(deferredProgram_, "pointLightCount"), 1);
-
     // Position de la lumière (animation)
-    float lightAngle = time_ * 0.5f;
-    float lightX = target_[0] + cos(lightAngle) * 15.0f;
-    float lightY = target_[1] + 8.0f;
-    float lightZ = target_[2] + sin(lightAngle) * 15.0f;
-
-    glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].position"),
-                lightX, lightY, lightZ);
-    glUniform3f(glGetUniformLocation(deferredProgram_, "pointLights[0].color"),
-                1.2f, 1.1f, 1.0f);
-    glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].constant"), 1.0f);
-    glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].linear"), 0.09f);
-    glUniform1f(glGetUniformLocation(deferredProgram_, "pointLights[0].quadratic"), 0.032f);
+    const float *lightPosition = snapshotBuffer_.getReadBuffer().pointLightPosition;
+    deferred->setVec3("pointLights[0].position", lightPosition[0], lightPosition[1], lightPosition[2]);
+    deferred->setVec3("pointLights[0].color", 1.2f, 1.1f, 1.0f);
+    deferred->setFloat("pointLights[0].constant", 1.0f);
+    deferred->setFloat("pointLights[0].linear", 0.09f);
+    deferred->setFloat("pointLights[0].quadratic", 0.032f);
 
     // Skybox texture
     glActiveTexture(GL_TEXTURE5);
     glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex_);
-    glUniform1i(glGetUniformLocation(deferredProgram_, "uSkybox"), 5);
-
-    // Mode normal (pas debug)
-    glUniform1i(glGetUniformLocation(deferredProgram_, "debugMode"), 0);
-
-    // Matrices inverses pour le ray marching de la skybox
-    float invProj[16], invView[16];
-
-    glUniformMatrix4fv(glGetUniformLocation(deferredProgram_, "invProj"), 1, GL_FALSE, invProj);
-    glUniformMatrix4fv(glGetUniformLocation(deferredProgram_, "invViewRot"), 1, GL_FALSE, invView);
-
 
     // Rendu du quad plein écran
     glBindVertexArray(quadVAO_);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
-    glUniform1f(glGetUniformLocation(deferredProgram_, "far"), far);
-    renderSkybox(view, proj);
+    renderSkybox();
     //glDisable(GL_DEPTH_TEST);
 }
 
-void FinalScene::calculateCameraMatrices(float *view, float *proj) {
-    float camX = target_[0] + orbitRadius_ * std::cos(pitch_ * M_PI / 180) * std::cos(yaw_ * M_PI / 180);
-    float camY = target_[1] + orbitRadius_ * std::sin(pitch_ * M_PI / 180);
-    float camZ = target_[2] + orbitRadius_ * std::cos(pitch_ * M_PI / 180) * std::sin(yaw_ * M_PI / 180);
+void FinalScene::calculateCameraMatrices(const SimulationInput &input, float *view, float *proj,
+                                         float *cameraPosition) {
+    const float *target = input.target;
+    float camX = target[0] + input.orbitRadius * std::cos(input.pitch * M_PI / 180) * std::cos(input.yaw * M_PI / 180);
+    float camY = target[1] + input.orbitRadius * std::sin(input.pitch * M_PI / 180);
+    float camZ = target[2] + input.orbitRadius * std::cos(input.pitch * M_PI / 180) * std::sin(input.yaw * M_PI / 180);
 
-    camPos_[0] = camX;
-    camPos_[1] = camY;
-    camPos_[2] = camZ;
+    cameraPosition[0] = camX;
+    cameraPosition[1] = camY;
+    cameraPosition[2] = camZ;
 
-    lookAtMatrix(view, camX, camY, camZ, target_[0], target_[1], target_[2], 0, 1, 0);
-    perspectiveMatrix(proj, 60.0f, (float) width_ / height_, 0.1f, far);
+    MatrixMath::lookAt(view, {camX, camY, camZ}, {target[0], target[1], target[2]}, {0.0f, 1.0f, 0.0f});
+    MatrixMath::perspective(proj, 60.0f, (float) input.width / input.height, 0.1f, input.farPlane);
 }
 
-void FinalScene::renderGeometryPass(float *view, float *proj) {
-    //Rendu des cubes
-    glUseProgram(cubeProgram_);
-
-
-    glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uView"), 1, GL_FALSE, view);
-    glUniformMatrix4fv(glGetUniformLocation(cubeProgram_, "uProj"), 1, GL_FALSE, proj);
+void FinalScene::renderGeometryPass() {
+    //Rendu des cubes (uView / uProj : ViewBlock, normal map selon la variante)
+    cubeVariants_.bind(getCubeKey());
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, cubeDiffuseTex_);
-    glUniform1i(glGetUniformLocation(cubeProgram_, "uDiffuse"), 0);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, cubeNormalTex_);
-    glUniform1i(glGetUniformLocation(cubeProgram_, "uNormalMap"), 1);
-
-    glUniform1i(glGetUniformLocation(cubeProgram_, "useNormal"), 1);
-
-    // Mise à jour des instances des cubes
-    cubeInstanceMatrices_.clear();
-    for (const auto &c: cubeCenters_) {
-        float m[16];
-        identityMatrix(m);
-        m[12] = c.x;
-        m[13] = c.y;
-        m[14] = c.z;
-        cubeInstanceMatrices_.insert(cubeInstanceMatrices_.end(), m, m + 16);
-    }
-
-    glBindBuffer(GL_ARRAY_BUFFER, cubeInstanceVBO_);
-    glBufferSubData(GL_ARRAY_BUFFER, 0,
-                    cubeInstanceMatrices_.size() * sizeof(float),
-                    cubeInstanceMatrices_.data());
 
+    // Instances des cubes déjà dans le VBO (updateCubeInstances)
     glBindVertexArray(cubeVAO_);
     glDrawElementsInstanced(GL_TRIANGLES, cubeIndexCount_, GL_UNSIGNED_INT, 0,
                             (GLsizei) (cubeInstanceMatrices_.size() / 16));
@@ -1202,64 +1319,21 @@ void FinalScene::renderGeometryPass(float *view, float *proj) {
 
     // ===== Model instanced (nanosuit) =====
     if (model_) {
-        modelInstanceMatrices_.clear();
-        modelInstanceMatrices_.reserve(modelInstanceCount_ * 16);
-
-        for (int i = 0; i < modelInstanceCount_; ++i) {
-            float M[16];
-            identityMatrix(M);
-
-            float angle = (2.0f * M_PI / float(modelInstanceCount_)) * float(i);
-            float radius = 10.0f;
-
-            // scale
-            float s = 0.5f;
-            M[0] = s;
-            M[5] = s;
-            M[10] = s;
-
-            // translation (col-major)
-            M[12] = target_[0] + std::cos(angle) * radius;
-            M[13] = target_[1] + 0.5f;
-            M[14] = target_[2] + std::sin(angle) * radius;
-
-            modelInstanceMatrices_.insert(modelInstanceMatrices_.end(), M, M + 16);
-        }
-
-        // upload vers le VBO
-        glBindBuffer(GL_ARRAY_BUFFER, modelInstanceVBO_);
-        glBufferSubData(GL_ARRAY_BUFFER, 0,
-                        modelInstanceMatrices_.size() * sizeof(float),
-                        modelInstanceMatrices_.data());
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
         // draw instanced dans le GBuffer
         glUseProgram(modelProgram_);
-        glUniformMatrix4fv(glGetUniformLocation(modelProgram_, "uView"), 1, GL_FALSE, view);
-        glUniformMatrix4fv(glGetUniformLocation(modelProgram_, "uProj"), 1, GL_FALSE, proj);
-
-        model_->DrawInstanced(modelProgram_, modelInstanceCount_);
+        model_->DrawInstanced(modelSamplers_, modelInstanceCount_, getModelInstanceBase());
     }
 }
 
-void FinalScene::renderSkybox(float *view, float *proj) {
+void FinalScene::renderSkybox() {
     if (!skyboxProgram_ || !cubemapTex_) return;
     //glDisable(GL_CULL_FACE);
     glDepthFunc(GL_LEQUAL); // Permettre à la skybox d'être au fond
 
+    // Le vertex shader retire lui-même la translation de uView (ViewBlock)
     glUseProgram(skyboxProgram_);
 
-    // Passer les matrices sans translation
-    float viewNoTranslation[16];
-    memcpy(viewNoTranslation, view, 16 * sizeof(float));
-    viewNoTranslation[12] = 0;
-    viewNoTranslation[13] = 0;
-    viewNoTranslation[14] = 0;
-
-    glUniformMatrix4fv(glGetUniformLocation(skyboxProgram_, "uView"), 1, GL_FALSE, viewNoTranslation);
-    glUniformMatrix4fv(glGetUniformLocation(skyboxProgram_, "uProj"), 1, GL_FALSE, proj);
-
-    //glUniform1f(glGetUniformLocation(skyboxProgram_, "uBrightness"), 2.f); // 1.5 = 50% plus clair
+    //skyboxUniforms_.setFloat("uBrightness", 2.f); // 1.5 = 50% plus clair
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex_);
@@ -1270,104 +1344,11 @@ void FinalScene::renderSkybox(float *view, float *proj) {
     //glEnable(GL_CULL_FACE);
 }
 
-void FinalScene::lookAtMatrix(float *m,
-                              float eyeX, float eyeY, float eyeZ,
-                              float centerX, float centerY, float centerZ,
-                              float upX, float upY, float upZ) {
-    float fx = centerX - eyeX;
-    float fy = centerY - eyeY;
-    float fz = centerZ - eyeZ;
-    float fl = std::sqrt(fx * fx + fy * fy + fz * fz);
-    fx /= fl;
-    fy /= fl;
-    fz /= fl;
-
-    float ux = upX, uy = upY, uz = upZ;
-    float ul = std::sqrt(ux * ux + uy * uy + uz * uz);
-    ux /= ul;
-    uy /= ul;
-    uz /= ul;
-
-    float rx = fy * uz - fz * uy;
-    float ry = fz * ux - fx * uz;
-    float rz = fx * uy - fy * ux;
-
-    float rl = std::sqrt(rx * rx + ry * ry + rz * rz);
-    rx /= rl;
-    ry /= rl;
-    rz /= rl;
-
-    float ux2 = ry * fz - rz * fy;
-    float uy2 = rz * fx - rx * fz;
-    float uz2 = rx * fy - ry * fx;
-
-    // colonne-major (OpenGL)
-    m[0] = rx;
-    m[4] = ux2;
-    m[8] = -fx;
-    m[12] = 0.0f;
-    m[1] = ry;
-    m[5] = uy2;
-    m[9] = -fy;
-    m[13] = 0.0f;
-    m[2] = rz;
-    m[6] = uz2;
-    m[10] = -fz;
-    m[14] = 0.0f;
-    m[3] = 0;
-    m[7] = 0;
-    m[11] = 0;
-    m[15] = 1.0f;
-
-    // translation
-    float t[16] = {
-        1, 0, 0, 0,
-        0, 1, 0, 0,
-        0, 0, 1, 0,
-        -eyeX, -eyeY, -eyeZ, 1
-    };
-
-    float out[16];
-    multiplyMat4(out, m, t);
-    for (int i = 0; i < 16; i++) m[i] = out[i];
-}
-
-void FinalScene::perspectiveMatrix(float *m, float fov, float aspect, float near, float far) {
-    float rad = fov * 3.1415926535f / 180.0f;
-    float f = 1.0f / std::tan(rad * 0.5f);
-
-    for (int i = 0; i < 16; i++) m[i] = 0.0f;
-    m[0] = f / aspect;
-    m[5] = f;
-    m[10] = (far + near) / (near - far);
-    m[11] = -1.0f;
-    m[14] = (2.0f * far * near) / (near - far);
-}
-
-void FinalScene::multiplyMat4(float *out, const float *a, const float *b) {
-    for (int c = 0; c < 4; c++) {
-        for (int r = 0; r < 4; r++) {
-            out[c * 4 + r] =
-                    a[0 * 4 + r] * b[c * 4 + 0] +
-                    a[1 * 4 + r] * b[c * 4 + 1] +
-                    a[2 * 4 + r] * b[c * 4 + 2] +
-                    a[3 * 4 + r] * b[c * 4 + 3];
-        }
-    }
-}
-
-void FinalScene::identityMatrix(float *m) {
-    for (int i = 0; i < 16; i++) m[i] = 0.0f;
-    m[0] = m[5] = m[10] = m[15] = 1.0f;
-}
-
 void FinalScene::renderShadowMapping() {
     // 1. Créer la shadow map
     renderShadowMap();
 
     // 2. Rendu normal avec ombres
-    float view[16], proj[16];
-    calculateCameraMatrices(view, proj);
 
     // Geometry pass (RENDRE les géométries dans le G-buffer)
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer_);
@@ -1377,53 +1358,45 @@ void FinalScene::renderShadowMapping() {
 
     glEnable(GL_DEPTH_TEST);
     // Rendu de la skybox
-    renderSkybox(view, proj);
+    renderSkybox();
     // Rendu de la géométrie
-    renderGeometryPass(view, proj);
+    renderGeometryPass();
 
     // Lighting pass avec ombres
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget_);
     glViewport(0, 0, screenWidth_, screenHeight_);
     glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glDisable(GL_DEPTH_TEST);
 
-    static GLuint shadowSimpleProgram = 0;
-    if (shadowSimpleProgram == 0) {
-        shadowSimpleProgram = createProgram(SSAOvs, shadowSimpleFS);
-        std::cout << "Shadow simple program créé: " << shadowSimpleProgram << std::endl;
+    static ShaderProgram shadowSimpleProgram;
+    if (!shadowSimpleProgram.isValid()) {
+        shadowSimpleProgram.reflect(createProgram(SSAOvs, shadowSimpleFS, getSharedBlocksGLSL()));
+        attachSharedBlocks(shadowSimpleProgram);
+        std::cout << "Shadow simple program créé: " << shadowSimpleProgram.getId() << std::endl;
     }
 
-    glUseProgram(shadowSimpleProgram);
+    shadowSimpleProgram.use();
 
     // Textures du G-buffer
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, gPosition_);
-    glUniform1i(glGetUniformLocation(shadowSimpleProgram, "gPosition"), 0);
+    shadowSimpleProgram.setInt("gPosition", 0);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormal_);
-    glUniform1i(glGetUniformLocation(shadowSimpleProgram, "gNormal"), 1);
+    shadowSimpleProgram.setInt("gNormal", 1);
 
     glActiveTexture(GL_TEXTURE2);
     glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-    glUniform1i(glGetUniformLocation(shadowSimpleProgram, "gAlbedoSpec"), 2);
+    shadowSimpleProgram.setInt("gAlbedoSpec", 2);
 
     // Shadow map
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, shadowDepthTex_);
-    glUniform1i(glGetUniformLocation(shadowSimpleProgram, "shadowMap"), 3);
-
-    // Uniforms
-    glUniform3f(glGetUniformLocation(shadowSimpleProgram, "viewPos"),
-                camPos_[0], camPos_[1], camPos_[2]);
+    shadowSimpleProgram.setInt("shadowMap", 3);
 
-    glUniformMatrix4fv(glGetUniformLocation(shadowSimpleProgram, "lightSpaceMatrix"),
-                       1, GL_FALSE, lightSpaceMatrix_);
-
-    float lightPos[3] = {10.0f, 20.0f, 10.0f};
-    glUniform3f(glGetUniformLocation(shadowSimpleProgram, "lightPos"),
-                lightPos[0], lightPos[1], lightPos[2]);
+    // Caméra, lumière et lightSpaceMatrix : FrameBlock / ViewBlock
 
     // Rendu du quad plein écran
     glBindVertexArray(quadVAO_);
@@ -1433,114 +1406,91 @@ void FinalScene::renderShadowMapping() {
     glEnable(GL_DEPTH_TEST);
 }
 
-void FinalScene::renderShadowMap() {
+void FinalScene::calculateLightMatrices(const SimulationInput &input, float *lightSpaceMatrix) {
     // Configuration lumière - AUGMENTEZ la taille et ajustez la position
     float lightPos[3] = {15.0f, 25.0f, 15.0f}; // Plus haut, plus loin
-    float lightTarget[3] = {target_[0], target_[1], target_[2]}; // Cibler le centre de la scène
+    float lightTarget[3] = {input.target[0], input.target[1], input.target[2]}; // Cibler le centre de la scène
 
     // Projection orthographique PLUS GRANDE pour couvrir toute la scène
     float size = 100.0f; // Augmentez considérablement la taille
     float near_plane = 1.0f, far_plane = 100.0f;
 
     // Matrice projection
-    identityMatrix(lightProjection_);
-    lightProjection_[0] = 2.0f / size;
-    lightProjection_[5] = 2.0f / size;
-    lightProjection_[10] = -2.0f / (far_plane - near_plane);
-    lightProjection_[14] = -(far_plane + near_plane) / (far_plane - near_plane);
+    const float half = size * 0.5f;
+    float lightProjection[16];
+    MatrixMath::orthographic(lightProjection, -half, half, -half, half, near_plane, far_plane);
 
     // Matrice vue - vérifiez que la lumière regarde bien vers le bas
-    lookAtMatrix(lightView_, lightPos[0], lightPos[1], lightPos[2],
-                 lightTarget[0], lightTarget[1], lightTarget[2],
-                 0.0f, 1.0f, 0.0f);
-
-    // DEBUG: Afficher les matrices pour vérification
-    std::cout << "Light Position: " << lightPos[0] << ", " << lightPos[1] << ", " << lightPos[2] << std::endl;
-    std::cout << "Light Target: " << lightTarget[0] << ", " << lightTarget[1] << ", " << lightTarget[2] <<
-            std::endl;
-    std::cout << "Ortho Size: " << size << ", Near: " << near_plane << ", Far: " << far_plane << std::endl;
+    float lightView[16];
+    MatrixMath::lookAt(lightView, {lightPos[0], lightPos[1], lightPos[2]},
+                       {lightTarget[0], lightTarget[1], lightTarget[2]}, {0.0f, 1.0f, 0.0f});
 
     // Matrice espace lumière
-    multiplyMat4(lightSpaceMatrix_, lightProjection_, lightView_);
-
-    // Rendu shadow map
-    glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
+    MatrixMath::multiply(lightSpaceMatrix, lightProjection, lightView);
+}
 
-    // Effacer avec 1.0 (profondeur maximale)
-    glClearDepth(1.0f);
-    glClear(GL_DEPTH_BUFFER_BIT);
+void FinalScene::renderShadowMap() {
+    // lightSpaceMatrix_ vient de la frame simulée (acquireSnapshot() en début de Draw)
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    // Couche statique : seulement si la lumière ou les casters ont changé
+    if (!shadowCache_.isValid(lightSpaceMatrix_, staticCasterVersion_)) {
+        shadowCache_.beginStaticLayer();
 
-    // IMPORTANT: Désactiver le culling pour voir toutes les faces
-    glDisable(GL_CULL_FACE);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        // IMPORTANT: Désactiver le culling pour voir toutes les faces
+        glDisable(GL_CULL_FACE);
 
-    // Utiliser un shader shadow SIMPLIFIÉ mais qui fonctionne
+        // Une seule vue ici (lumière directionnelle) ; des cascades passeraient N matrices sans autre draw
+        layeredShadow_.setLayerMatrices(lightSpaceMatrix_, 1);
+        int submissions = drawStaticShadowCasters();
+        shadowCache_.endStaticLayer(lightSpaceMatrix_, staticCasterVersion_);
 
-    static GLuint simpleShadowProgram = 0;
-    if (simpleShadowProgram == 0) {
-        simpleShadowProgram = createProgram(simpleShadowVS, simpleShadowFS);
-        std::cout << "Simple shadow program created: " << simpleShadowProgram << std::endl;
+        std::cout << "Shadow cache rebuilt: " << submissions << " instanced submissions" << std::endl;
     }
 
-    glUseProgram(simpleShadowProgram);
-
-    // Passer la matrice
-    GLuint loc = glGetUniformLocation(simpleShadowProgram, "uLightSpaceMatrix");
-    if (loc != -1) {
-        glUniformMatrix4fv(loc, 1, GL_FALSE, lightSpaceMatrix_);
-    } else {
-        std::cerr << "ERROR: uLightSpaceMatrix uniform not found!" << std::endl;
+    // Rendu shadow map : copie de la couche en cache (remplace le clear)
+    glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
+    if (!shadowCache_.copyInto(shadowDepthTex_)) {
+        glClear(GL_DEPTH_BUFFER_BIT);
     }
 
-    // DEBUG: Dessiner TOUS les cubes
-    glBindVertexArray(cubeVAO_);
+    // Aucun caster dynamique dans cette scène pour l'instant : ils seraient dessinés ici
 
-    // Cube au centre
-    float modelMatrix[16];
-    identityMatrix(modelMatrix);
-    modelMatrix[12] = target_[0];
-    modelMatrix[13] = target_[1];
-    modelMatrix[14] = target_[2];
+    glUseProgram(0);
 
-    loc = glGetUniformLocation(simpleShadowProgram, "uModel");
-    if (loc != -1) {
-        glUniformMatrix4fv(loc, 1, GL_FALSE, modelMatrix);
-    }
+    // Restaurer
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-    glDrawElements(GL_TRIANGLES, cubeIndexCount_, GL_UNSIGNED_INT, 0);
+int FinalScene::drawStaticShadowCasters() {
+    int submissions = 0;
 
-    // Tous les cubes de la ligne
-    for (int i = 0; i < cubeCenters_.size(); ++i) {
-        identityMatrix(modelMatrix);
-        modelMatrix[12] = cubeCenters_[i].x;
-        modelMatrix[13] = cubeCenters_[i].y;
-        modelMatrix[14] = cubeCenters_[i].z;
+    // Tous les cubes en une soumission, si la ligne touche le frustum de la lumière
+    if (!cubeCenters_.empty() && shadowFrustum_.intersectsAABB(cubeBoundsMin_, cubeBoundsMax_)) {
+        layeredShadow_.drawInstanced(cubeVAO_, cubeIndexCount_,
+                                     static_cast<GLsizei>(cubeCenters_.size()), 4);
+        submissions++;
+    }
 
-        if (loc != -1) {
-            glUniformMatrix4fv(loc, 1, GL_FALSE, modelMatrix);
+    // Modèles instanciés (matrices aux locations 5-8)
+    if (model_) {
+        int multiplier = layeredShadow_.bindProgram(5);
+        if (multiplier > 0) {
+            model_->DrawDepthInstanced(layeredShadow_.getBoundProgram(), modelInstanceCount_ * multiplier, multiplier,
+                                       getModelInstanceBase());
+            submissions++;
         }
-
-        glDrawElements(GL_TRIANGLES, cubeIndexCount_, GL_UNSIGNED_INT, 0);
     }
 
-    glBindVertexArray(0);
     glUseProgram(0);
-
-    // Restaurer
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    std::cout << "DEBUG: Shadow map rendered with " << (cubeCenters_.size() + 1) << " objects" << std::endl;
+    return submissions;
 }
 
 void FinalScene::renderSSAO() {
-    float view[16], proj[16];
-    calculateCameraMatrices(view, proj);
-
     // 1. Geometry pass
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer_);
     glViewport(0, 0, width_, height_);
@@ -1548,15 +1498,15 @@ void FinalScene::renderSSAO() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glEnable(GL_DEPTH_TEST);
 
-    renderSkybox(view, proj);
+    renderSkybox();
 
-    renderGeometryPass(view, proj);
+    renderGeometryPass();
 
     // 2. SSAO pass - DÉCOMMENTER cette ligne !
-    renderSSAOPass(proj);
+    renderSSAOPass();
 
     // 3. Lighting pass avec SSAO
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget_);
     glViewport(0, 0, screenWidth_, screenHeight_);
     glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1566,34 +1516,33 @@ void FinalScene::renderSSAO() {
     // Shader SSAO avec occlusion réelle
 
 
-    static GLuint ssaoProgram = 0;
-    if (ssaoProgram == 0) {
-        ssaoProgram = createProgram(SSAOvs2, ssaoFS2);
-        std::cout << "SSAO program créé: " << ssaoProgram << std::endl;
+    static ShaderProgram ssaoProgram;
+    if (!ssaoProgram.isValid()) {
+        ssaoProgram.reflect(createProgram(SSAOvs2, ssaoFS2, getSharedBlocksGLSL()));
+        attachSharedBlocks(ssaoProgram);
+        std::cout << "SSAO program créé: " << ssaoProgram.getId() << std::endl;
     }
 
-    glUseProgram(ssaoProgram);
+    ssaoProgram.use();
 
     // Textures
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, gPosition_);
-    glUniform1i(glGetUniformLocation(ssaoProgram, "gPosition"), 0);
+    ssaoProgram.setInt("gPosition", 0);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormal_);
-    glUniform1i(glGetUniformLocation(ssaoProgram, "gNormal"), 1);
+    ssaoProgram.setInt("gNormal", 1);
 
     glActiveTexture(GL_TEXTURE2);
     glBindTexture(GL_TEXTURE_2D, gAlbedoSpec_);
-    glUniform1i(glGetUniformLocation(ssaoProgram, "gAlbedoSpec"), 2);
+    ssaoProgram.setInt("gAlbedoSpec", 2);
 
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, ssaoBlurBuffer_); // Utiliser le buffer SSAO blurré
-    glUniform1i(glGetUniformLocation(ssaoProgram, "ssaoBuffer"), 3);
+    ssaoProgram.setInt("ssaoBuffer", 3);
 
-    // View position
-    glUniform3f(glGetUniformLocation(ssaoProgram, "viewPos"),
-                camPos_[0], camPos_[1], camPos_[2]);
+    // Position caméra : ViewBlock
 
     glBindVertexArray(quadVAO_);
     glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -1602,7 +1551,7 @@ void FinalScene::renderSSAO() {
     glEnable(GL_DEPTH_TEST);
 }
 
-void FinalScene::renderSSAOPass(float *proj) {
+void FinalScene::renderSSAOPass() {
     // Pass SSAO
     glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO_);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -1612,29 +1561,21 @@ void FinalScene::renderSSAOPass(float *proj) {
     // Passer les textures du G-buffer
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, gPosition_);
-    glUniform1i(glGetUniformLocation(ssaoProgram_, "gPosition"), 0);
+    ssaoUniforms_.setInt("gPosition", 0);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormal_);
-    glUniform1i(glGetUniformLocation(ssaoProgram_, "gNormal"), 1);
+    ssaoUniforms_.setInt("gNormal", 1);
 
     glActiveTexture(GL_TEXTURE2);
     glBindTexture(GL_TEXTURE_2D, noiseTexture_);
-    glUniform1i(glGetUniformLocation(ssaoProgram_, "texNoise"), 2);
+    ssaoUniforms_.setInt("texNoise", 2);
     glEnable(GL_DEPTH_TEST);
-    // Passer le kernel SSAO (16 premiers samples)
-    int samplesToUse = std::min(64, ssaoKernelSize_);
-    for (int i = 0; i < samplesToUse; ++i) {
-        std::string name = "samples[" + std::to_string(i) + "]";
-        glUniform3f(glGetUniformLocation(ssaoProgram_, name.c_str()),
-                    ssaoKernel_[i].x, ssaoKernel_[i].y, ssaoKernel_[i].z);
-    }
+    // Le kernel SSAO est constant : envoyé une fois dans finalizePrograms()
 
-    // Autres uniforms
-    glUniformMatrix4fv(glGetUniformLocation(ssaoProgram_, "projection"),
-                       1, GL_FALSE, proj);
-    glUniform1f(glGetUniformLocation(ssaoProgram_, "radius"), ssaoRadius_);
-    glUniform1f(glGetUniformLocation(ssaoProgram_, "bias"), ssaoBias_);
+    // Autres uniforms (la projection vient du ViewBlock)
+    ssaoUniforms_.setFloat("radius", ssaoRadius_);
+    ssaoUniforms_.setFloat("bias", ssaoBias_);
 
     glBindVertexArray(quadVAO_);
     glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -1648,7 +1589,7 @@ void FinalScene::renderSSAOPass(float *proj) {
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer_);
-    glUniform1i(glGetUniformLocation(ssaoBlurProgram_, "ssaoInput"), 0);
+    ssaoBlurUniforms_.setInt("ssaoInput", 0);
 
     glBindVertexArray(quadVAO_);
     glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -1702,13 +1643,13 @@ void FinalScene::renderDebugShadow() {
     // Shader debug amélioré
 
 
-    static GLuint debugProgram = 0;
-    if (debugProgram == 0) {
-        debugProgram = createProgram(debugVS2, debugFS2);
-        std::cout << "Debug shadow program created: " << debugProgram << std::endl;
+    static ShaderProgram debugProgram;
+    if (!debugProgram.isValid()) {
+        debugProgram.reflect(createProgram(debugVS2, debugFS2));
+        std::cout << "Debug shadow program created: " << debugProgram.getId() << std::endl;
     }
 
-    glUseProgram(debugProgram);
+    debugProgram.use();
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, shadowDepthTex_);
@@ -1717,7 +1658,7 @@ void FinalScene::renderDebugShadow() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glUniform1i(glGetUniformLocation(debugProgram, "depthMap"), 0);
+    debugProgram.setInt("depthMap", 0);
 
     glBindVertexArray(quadVAO_);
     glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -1727,9 +1668,6 @@ void FinalScene::renderDebugShadow() {
 }
 
 void FinalScene::renderDebugSSAO() {
-    float view[16], proj[16];
-    calculateCameraMatrices(view, proj);
-
     // Geometry Pass
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer_);
     glViewport(0, 0, width_, height_);
@@ -1737,10 +1675,10 @@ void FinalScene::renderDebugSSAO() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     glEnable(GL_DEPTH_TEST);
-    renderGeometryPass(view, proj);
+    renderGeometryPass();
 
     // SSAO Pass
-    renderSSAOPass(proj);
+    renderSSAOPass();
 
     // Afficher le buffer SSAO
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -1751,16 +1689,16 @@ void FinalScene::renderDebugSSAO() {
     glDisable(GL_DEPTH_TEST);
 
 
-    static GLuint debugProgram = 0;
-    if (debugProgram == 0) {
-        debugProgram = createProgram(debugVS3, debugFS3);
+    static ShaderProgram debugProgram;
+    if (!debugProgram.isValid()) {
+        debugProgram.reflect(createProgram(debugVS3, debugFS3));
     }
 
-    glUseProgram(debugProgram);
+    debugProgram.use();
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, ssaoBlurBuffer_);
-    glUniform1i(glGetUniformLocation(debugProgram, "ssaoBuffer"), 0);
+    debugProgram.setInt("ssaoBuffer", 0);
 
     glBindVertexArray(quadVAO_);
     glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -0,0 +1,306 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "bloom_renderer.h"
+#include "program_cache.h"
+#include <algorithm>
+#include <iostream>
+
+// ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
+BloomRenderer::BloomRenderer()
+    : bloomTex_(0),
+      mipFBO_{},
+      fullscreenVAO_(0),
+      downsampleShader_(0),
+      upsampleShader_(0),
+      downTexelSizeLoc_(-1),
+      downPrefilterLoc_(-1),
+      downThresholdLoc_(-1),
+      upTexelSizeLoc_(-1),
+      upFilterRadiusLoc_(-1),
+      mipWidth_{},
+      mipHeight_{},
+      mipCount_(0),
+      sourceWidth_(0),
+      sourceHeight_(0),
+      threshold_(1.0f),
+      knee_(0.5f),
+      filterRadius_(1.0f) {
+}
+
+BloomRenderer::~BloomRenderer() {
+    cleanup();
+}
+
+// ==================== INITIALISATION ====================
+bool BloomRenderer::initialize(int width, int height) {
+    sourceWidth_ = width;
+    sourceHeight_ = height;
+
+    // Niveaux à partir de la demi-résolution, arrêtés avant de descendre sous 8 pixels
+    mipCount_ = 0;
+    int mipWidth = std::max(width / 2, 1);
+    int mipHeight = std::max(height / 2, 1);
+    while (mipCount_ < MAX_MIP_COUNT && (mipCount_ == 0 || std::min(mipWidth, mipHeight) >= 8)) {
+        mipWidth_[mipCount_] = mipWidth;
+        mipHeight_[mipCount_] = mipHeight;
+        ++mipCount_;
+        mipWidth = std::max(mipWidth / 2, 1);
+        mipHeight = std::max(mipHeight / 2, 1);
+    }
+
+    glGenTextures(1, &bloomTex_);
+    glBindTexture(GL_TEXTURE_2D, bloomTex_);
+    glTexStorage2D(GL_TEXTURE_2D, mipCount_, GL_RGBA16F, mipWidth_[0], mipHeight_[0]);
+    // Pas de filtrage entre mips : chaque passe lit un seul niveau (BASE_LEVEL)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    bool complete = true;
+    glGenFramebuffers(mipCount_, mipFBO_);
+    for (int i = 0; i < mipCount_; ++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, mipFBO_[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, bloomTex_, i);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "ERROR: Bloom mip framebuffer " << i << " is not complete!" << std::endl;
+            complete = false;
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &fullscreenVAO_);
+
+    // Soumis ensemble pour que les deux compilations se recouvrent
+    downsampleShader_ = submitProgram(getDownsampleFS());
+    upsampleShader_ = submitProgram(getUpsampleFS());
+    downsampleShader_ = ProgramCache::finalize(downsampleShader_);
+    upsampleShader_ = ProgramCache::finalize(upsampleShader_);
+    if (downsampleShader_ == 0 || upsampleShader_ == 0) {
+        return false;
+    }
+
+    glUseProgram(downsampleShader_);
+    glUniform1i(glGetUniformLocation(downsampleShader_, "uSource"), 0);
+    downTexelSizeLoc_ = glGetUniformLocation(downsampleShader_, "uSourceTexelSize");
+    downPrefilterLoc_ = glGetUniformLocation(downsampleShader_, "uPrefilter");
+    downThresholdLoc_ = glGetUniformLocation(downsampleShader_, "uThreshold");
+
+    glUseProgram(upsampleShader_);
+    glUniform1i(glGetUniformLocation(upsampleShader_, "uSource"), 0);
+    upTexelSizeLoc_ = glGetUniformLocation(upsampleShader_, "uSourceTexelSize");
+    upFilterRadiusLoc_ = glGetUniformLocation(upsampleShader_, "uFilterRadius");
+    glUseProgram(0);
+
+    return complete;
+}
+
+// ==================== PARAMÈTRES ====================
+void BloomRenderer::setThreshold(float threshold, float knee) {
+    threshold_ = std::max(threshold, 0.0f);
+    knee_ = std::clamp(knee, 0.0f, 1.0f);
+}
+
+// ==================== RENDU ====================
+void BloomRenderer::render(GLuint sceneTexture) {
+    if (bloomTex_ == 0 || downsampleShader_ == 0 || upsampleShader_ == 0) {
+        return;
+    }
+
+    glBindVertexArray(fullscreenVAO_);
+    glDisable(GL_BLEND);
+    glActiveTexture(GL_TEXTURE0);
+
+    // ---- Descente : scène -> niveau 0 (seuil), puis niveau i -> i + 1 ----
+    glUseProgram(downsampleShader_);
+    // (seuil, seuil - genou, 2 * genou, 0.25 / genou) : courbe quadratique du genou doux
+    const float knee = threshold_ * knee_;
+    glUniform4f(downThresholdLoc_, threshold_, threshold_ - knee, 2.0f * knee, 0.25f / (knee + 1e-5f));
+    for (int i = 0; i < mipCount_; ++i) {
+        const bool fromScene = i == 0;
+        if (fromScene) {
+            glBindTexture(GL_TEXTURE_2D, sceneTexture);
+            glUniform2f(downTexelSizeLoc_, 1.0f / static_cast<float>(sourceWidth_),
+                        1.0f / static_cast<float>(sourceHeight_));
+        } else {
+            glBindTexture(GL_TEXTURE_2D, bloomTex_);
+            setSourceLevel(i - 1);
+            glUniform2f(downTexelSizeLoc_, 1.0f / static_cast<float>(mipWidth_[i - 1]),
+                        1.0f / static_cast<float>(mipHeight_[i - 1]));
+        }
+        glUniform1i(downPrefilterLoc_, fromScene ? 1 : 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, mipFBO_[i]);
+        glViewport(0, 0, mipWidth_[i], mipHeight_[i]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // ---- Remontée : tente 3x3 du niveau i ajoutée au niveau i - 1 ----
+    glUseProgram(upsampleShader_);
+    glUniform1f(upFilterRadiusLoc_, filterRadius_);
+    glBindTexture(GL_TEXTURE_2D, bloomTex_);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glBlendEquation(GL_FUNC_ADD);
+    for (int i = mipCount_ - 1; i > 0; --i) {
+        setSourceLevel(i);
+        glUniform2f(upTexelSizeLoc_, 1.0f / static_cast<float>(mipWidth_[i]),
+                    1.0f / static_cast<float>(mipHeight_[i]));
+
+        glBindFramebuffer(GL_FRAMEBUFFER, mipFBO_[i - 1]);
+        glViewport(0, 0, mipWidth_[i - 1], mipHeight_[i - 1]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glDisable(GL_BLEND);
+
+    // Le résultat est lu au niveau 0
+    setSourceLevel(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+// Restreint l'échantillonnage à un niveau : le niveau écrit n'est jamais lisible (pas de boucle)
+void BloomRenderer::setSourceLevel(int level) const {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+}
+
+// ==================== UTILITAIRES OPENGL ====================
+GLuint BloomRenderer::submitProgram(const std::string &fragmentSource) {
+    return ProgramCache::submitProgram({{GL_VERTEX_SHADER, getFullscreenVS()},
+                                        {GL_FRAGMENT_SHADER, fragmentSource}});
+}
+
+// ==================== NETTOYAGE ====================
+void BloomRenderer::cleanup() {
+    if (mipCount_ > 0 && mipFBO_[0]) glDeleteFramebuffers(mipCount_, mipFBO_);
+    for (GLuint &fbo : mipFBO_) {
+        fbo = 0;
+    }
+    if (bloomTex_) glDeleteTextures(1, &bloomTex_);
+    if (fullscreenVAO_) glDeleteVertexArrays(1, &fullscreenVAO_);
+    if (downsampleShader_) glDeleteProgram(downsampleShader_);
+    if (upsampleShader_) glDeleteProgram(upsampleShader_);
+    bloomTex_ = fullscreenVAO_ = downsampleShader_ = upsampleShader_ = 0;
+    mipCount_ = 0;
+}
+
+// ==================== SHADERS ====================
+std::string BloomRenderer::getFullscreenVS() {
+    return R"(
+#version 430 core
+out vec2 vUV;
+
+void main() {
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vUV = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+}
+
+std::string BloomRenderer::getDownsampleFS() {
+    return R"(
+#version 430 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uSourceTexelSize;
+uniform bool uPrefilter;
+uniform vec4 uThreshold;    // seuil, seuil - genou, 2 * genou, 0.25 / genou
+
+vec3 sampleAt(vec2 offset) {
+    return textureLod(uSource, vUV + offset * uSourceTexelSize, 0.0).rgb;
+}
+
+vec3 prefilter(vec3 color) {
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - uThreshold.y, 0.0, uThreshold.z);
+    soft = soft * soft * uThreshold.w;
+    float contribution = max(soft, brightness - uThreshold.x) / max(brightness, 1e-5);
+    return color * contribution;
+}
+
+// Moyenne de Karis : pondère chaque groupe par 1 / (1 + luminance) contre les lucioles
+float karisWeight(vec3 color) {
+    return 1.0 / (1.0 + dot(color, vec3(0.2126, 0.7152, 0.0722)));
+}
+
+void main() {
+    // 13 taps : a b c / j k / d e f / l m / g h i
+    vec3 a = sampleAt(vec2(-2.0,  2.0));
+    vec3 b = sampleAt(vec2( 0.0,  2.0));
+    vec3 c = sampleAt(vec2( 2.0,  2.0));
+    vec3 d = sampleAt(vec2(-2.0,  0.0));
+    vec3 e = sampleAt(vec2( 0.0,  0.0));
+    vec3 f = sampleAt(vec2( 2.0,  0.0));
+    vec3 g = sampleAt(vec2(-2.0, -2.0));
+    vec3 h = sampleAt(vec2( 0.0, -2.0));
+    vec3 i = sampleAt(vec2( 2.0, -2.0));
+    vec3 j = sampleAt(vec2(-1.0,  1.0));
+    vec3 k = sampleAt(vec2( 1.0,  1.0));
+    vec3 l = sampleAt(vec2(-1.0, -1.0));
+    vec3 m = sampleAt(vec2( 1.0, -1.0));
+
+    vec3 result;
+    if (uPrefilter) {
+        vec3 groups[5] = vec3[](
+            (j + k + l + m) * 0.25,
+            (a + b + d + e) * 0.25,
+            (b + c + e + f) * 0.25,
+            (d + e + g + h) * 0.25,
+            (e + f + h + i) * 0.25
+        );
+        float groupWeights[5] = float[](0.5, 0.125, 0.125, 0.125, 0.125);
+        vec3 sum = vec3(0.0);
+        float weightSum = 0.0;
+        for (int n = 0; n < 5; n++) {
+            vec3 filtered = prefilter(groups[n]);
+            float weight = groupWeights[n] * karisWeight(filtered);
+            sum += filtered * weight;
+            weightSum += weight;
+        }
+        result = sum / max(weightSum, 1e-5);
+    } else {
+        result = e * 0.125
+               + (a + c + g + i) * 0.03125
+               + (b + d + f + h) * 0.0625
+               + (j + k + l + m) * 0.125;
+    }
+
+    FragColor = vec4(max(result, vec3(0.0)), 1.0);
+}
+)";
+}
+
+std::string BloomRenderer::getUpsampleFS() {
+    return R"(
+#version 430 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uSourceTexelSize;
+uniform float uFilterRadius;
+
+void main() {
+    // Filtre tente 3x3 : 1 2 1 / 2 4 2 / 1 2 1
+    vec2 r = uSourceTexelSize * uFilterRadius;
+    vec3 result = textureLod(uSource, vUV, 0.0).rgb * 4.0;
+    result += (textureLod(uSource, vUV + vec2(-r.x, 0.0), 0.0).rgb +
+               textureLod(uSource, vUV + vec2( r.x, 0.0), 0.0).rgb +
+               textureLod(uSource, vUV + vec2(0.0, -r.y), 0.0).rgb +
+               textureLod(uSource, vUV + vec2(0.0,  r.y), 0.0).rgb) * 2.0;
+    result += textureLod(uSource, vUV + vec2(-r.x, -r.y), 0.0).rgb +
+              textureLod(uSource, vUV + vec2( r.x, -r.y), 0.0).rgb +
+              textureLod(uSource, vUV + vec2(-r.x,  r.y), 0.0).rgb +
+              textureLod(uSource, vUV + vec2( r.x,  r.y), 0.0).rgb;
+    FragColor = vec4(result / 16.0, 1.0);
+}
+)";
+}
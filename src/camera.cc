@@ -3,6 +3,7 @@
 //
 
 #include "../include/camera.h"
+#include "../include/matrix_math.h"
 #include <cmath>
 #include <algorithm>
 // ==================== CONSTRUCTEUR ====================
@@ -111,67 +112,11 @@ void Camera::setPitch(float pitch) {
 // ==================== MATRICES ====================
 void Camera::getViewMatrix(float* outView) const {
     core::Vec3F center = position_ + front_;
-    lookAtMatrix(outView, position_, center, up_);
+    MatrixMath::lookAt(outView, position_, center, up_);
 }
 
 void Camera::getProjectionMatrix(float* outProj) const {
-    perspectiveMatrix(outProj, fov_, getAspectRatio(), nearPlane_, farPlane_);
-}
-
-void Camera::lookAtMatrix(float* outMatrix,
-                          const core::Vec3F& eye,
-                          const core::Vec3F& center,
-                          const core::Vec3F& up) {
-    // Calculer les vecteurs de la base
-    core::Vec3F f = center - eye;
-    f = f.Normalize();
-
-    core::Vec3F s = f.Cross(up);
-    s = s.Normalize();
-
-    core::Vec3F u = s.Cross(f);
-    u = u.Normalize();
-
-
-    // Initialiser la matrice identité
-    for (int i = 0; i < 16; ++i) {
-        outMatrix[i] = 0.0f;
-    }
-    outMatrix[0] = s.x;
-    outMatrix[4] = s.y;
-    outMatrix[8] = s.z;
-    outMatrix[1] = u.x;
-    outMatrix[5] = u.y;
-    outMatrix[9] = u.z;
-    outMatrix[2] = -f.x;
-    outMatrix[6] = -f.y;
-    outMatrix[10] = -f.z;
-    outMatrix[15] = 1.0f;
-
-    // Appliquer la translation
-    outMatrix[12] = -(s.x * eye.x + s.y * eye.y + s.z * eye.z);
-    outMatrix[13] = -(u.x * eye.x + u.y * eye.y + u.z * eye.z);
-    outMatrix[14] = f.x * eye.x + f.y * eye.y + f.z * eye.z;
-}
-
-void Camera::perspectiveMatrix(float* outMatrix,
-                               float fov,
-                               float aspect,
-                               float near,
-                               float far) {
-    // Initialiser à zéro
-    for (int i = 0; i < 16; ++i) {
-        outMatrix[i] = 0.0f;
-    }
-
-    float f = 1.0f / std::tan(fov * PI / 360.0f);
-    float nf = 1.0f / (near - far);
-
-    outMatrix[0] = f / aspect;
-    outMatrix[5] = f;
-    outMatrix[10] = (far + near) * nf;
-    outMatrix[14] = 2.0f * far * near * nf;
-    outMatrix[11] = -1.0f;
+    MatrixMath::perspective(outProj, fov_, getAspectRatio(), nearPlane_, farPlane_);
 }
 
 float Camera::getAspectRatio() const {
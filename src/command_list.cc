@@ -0,0 +1,147 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/command_list.h"
+#include "../include/frame_arena.h"
+#include "../include/job_system.h"
+#include <algorithm>
+
+// ==================== MATÉRIAUX ====================
+std::uint8_t DrawMaterial::findSamplerSlot(std::string_view name) {
+    for (std::size_t i = 0; i < MATERIAL_SAMPLER_NAMES.size(); ++i) {
+        if (MATERIAL_SAMPLER_NAMES[i] == name) {
+            return static_cast<std::uint8_t>(i);
+        }
+    }
+    return NO_SAMPLER;
+}
+
+SamplerLayout SamplerLayout::resolve(GLuint program) {
+    SamplerLayout layout;
+    layout.program = program;
+    if (program == 0) {
+        return layout;
+    }
+    for (std::size_t i = 0; i < MATERIAL_SAMPLER_NAMES.size(); ++i) {
+        // Les noms sont des littéraux : string_view terminée par '\0'
+        layout.locations[i] = glGetUniformLocation(program, MATERIAL_SAMPLER_NAMES[i].data());
+    }
+    return layout;
+}
+
+// ==================== ENREGISTREMENT ====================
+void CommandList::reset(std::pmr::memory_resource *resource) {
+    if (storage_) {
+        packetHint_ = std::max(packetHint_, storage_->packets.size());
+        matrixHint_ = std::max(matrixHint_, storage_->matrices.size());
+    }
+    // L'ancienne mémoire peut déjà avoir été rendue (arène remise à zéro) : rien n'y est relu
+    storage_.emplace(resource);
+    storage_->packets.reserve(packetHint_);
+    storage_->matrices.reserve(matrixHint_);
+}
+
+std::uint32_t CommandList::addMatrix(const float *matrix) {
+    std::pmr::vector<float> &matrices = storage_->matrices;
+    const auto offset = static_cast<std::uint32_t>(matrices.size());
+    matrices.insert(matrices.end(), matrix, matrix + 16);
+    return offset;
+}
+
+void CommandList::draw(GLuint program, GLuint vao, GLsizei indexCount, std::uint32_t firstIndex,
+                       std::uint32_t matrixOffset, const DrawMaterial *material) {
+    storage_->packets.push_back({material, program, vao, indexCount, firstIndex, matrixOffset});
+}
+
+// ==================== REPLAY ====================
+void CommandList::execute(GLint modelMatrixLocation, const SamplerLayout &samplers, GLsizei instanceCount) const {
+    if (empty()) {
+        return;
+    }
+    const Storage &storage = *storage_;
+
+    GLuint currentProgram = 0;
+    GLuint currentVao = 0;
+    const DrawMaterial *currentMaterial = nullptr;
+    auto currentMatrix = static_cast<std::uint32_t>(-1);
+
+    for (const DrawPacket &packet : storage.packets) {
+        if (packet.program != currentProgram) {
+            currentProgram = packet.program;
+            glUseProgram(currentProgram);
+        }
+        if (packet.matrixOffset != currentMatrix && modelMatrixLocation >= 0) {
+            currentMatrix = packet.matrixOffset;
+            glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &storage.matrices[currentMatrix]);
+        }
+        if (packet.material != nullptr && packet.material != currentMaterial) {
+            currentMaterial = packet.material;
+            for (std::uint8_t i = 0; i < currentMaterial->textureCount; ++i) {
+                glActiveTexture(GL_TEXTURE0 + i);
+                const std::uint8_t slot = currentMaterial->samplerSlots[i];
+                if (slot != DrawMaterial::NO_SAMPLER && samplers.locations[slot] >= 0) {
+                    glUniform1i(samplers.locations[slot], i);
+                }
+                glBindTexture(GL_TEXTURE_2D, currentMaterial->textures[i]);
+            }
+            // Comme Mesh::Draw : rien ne reste lié au-delà des deux premières unités
+            for (int unit = 2; unit < DrawMaterial::MAX_TEXTURES; ++unit) {
+                glActiveTexture(GL_TEXTURE0 + unit);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+            glActiveTexture(GL_TEXTURE0);
+        }
+        if (packet.vao != currentVao) {
+            currentVao = packet.vao;
+            glBindVertexArray(currentVao);
+        }
+        const auto *indices = reinterpret_cast<const void *>(static_cast<std::uintptr_t>(packet.firstIndex) * sizeof(GLuint));
+        if (instanceCount > 1) {
+            glDrawElementsInstanced(GL_TRIANGLES, packet.indexCount, GL_UNSIGNED_INT, indices, instanceCount);
+        } else {
+            glDrawElements(GL_TRIANGLES, packet.indexCount, GL_UNSIGNED_INT, indices);
+        }
+    }
+    glBindVertexArray(0);
+}
+
+// ==================== ENSEMBLE DE LISTES ====================
+void CommandListSet::record(int count, const RecordItem &recordItem) {
+    usedLists_ = 0;
+    recordCount_ = count;
+    drawCount_ = 0;
+    if (count <= 0) {
+        return;
+    }
+
+    const int maxLists = static_cast<int>(JobSystem::getWorkerCount() + 1) * 2;
+    usedLists_ = std::clamp((count + ITEMS_PER_LIST - 1) / ITEMS_PER_LIST, 1, maxLists);
+    if (static_cast<int>(lists_.size()) < usedLists_) {
+        lists_.resize(usedLists_);
+    }
+
+    // Capture limitée à deux pointeurs : le RangeJob reste dans le stockage interne de std::function
+    JobSystem::parallelFor(0, usedLists_, 1, [this, &recordItem](std::size_t begin, std::size_t end) {
+        for (std::size_t slice = begin; slice < end; ++slice) {
+            CommandList &list = lists_[slice];
+            list.reset(&FrameArena::forThread());
+            const int first = static_cast<int>(static_cast<long long>(recordCount_) * slice / usedLists_);
+            const int last = static_cast<int>(static_cast<long long>(recordCount_) * (slice + 1) / usedLists_);
+            for (int i = first; i < last; ++i) {
+                recordItem(list, i);
+            }
+        }
+    });
+
+    for (int i = 0; i < usedLists_; ++i) {
+        drawCount_ += lists_[i].getDrawCount();
+    }
+}
+
+void CommandListSet::execute(GLint modelMatrixLocation, const SamplerLayout &samplers, GLsizei instanceCount) const {
+    for (int i = 0; i < usedLists_; ++i) {
+        lists_[i].execute(modelMatrixLocation, samplers, instanceCount);
+    }
+}
+
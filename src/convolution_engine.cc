@@ -0,0 +1,404 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "convolution_engine.h"
+#include "program_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// ==================== NOYAUX PRÉDÉFINIS ====================
+ConvolutionKernel ConvolutionKernel::gaussian(int radius, float sigma) {
+    ConvolutionKernel kernel;
+    kernel.width = kernel.height = 2 * radius + 1;
+
+    std::vector<float> line(kernel.width);
+    float sum = 0.0f;
+    for (int i = -radius; i <= radius; ++i) {
+        line[i + radius] = std::exp(-static_cast<float>(i * i) / (2.0f * sigma * sigma));
+        sum += line[i + radius];
+    }
+
+    kernel.weights.resize(kernel.width * kernel.height);
+    for (int y = 0; y < kernel.height; ++y) {
+        for (int x = 0; x < kernel.width; ++x) {
+            kernel.weights[y * kernel.width + x] = line[y] * line[x] / (sum * sum);
+        }
+    }
+    return kernel;
+}
+
+ConvolutionKernel ConvolutionKernel::box(int radius) {
+    ConvolutionKernel kernel;
+    kernel.width = kernel.height = 2 * radius + 1;
+    kernel.weights.assign(kernel.width * kernel.height, 1.0f / static_cast<float>(kernel.width * kernel.height));
+    return kernel;
+}
+
+ConvolutionKernel ConvolutionKernel::disc(int radius) {
+    ConvolutionKernel kernel;
+    kernel.width = kernel.height = 2 * radius + 1;
+    kernel.weights.assign(kernel.width * kernel.height, 0.0f);
+
+    int count = 0;
+    for (int y = -radius; y <= radius; ++y) {
+        for (int x = -radius; x <= radius; ++x) {
+            if (x * x + y * y <= radius * radius) {
+                kernel.weights[(y + radius) * kernel.width + x + radius] = 1.0f;
+                count++;
+            }
+        }
+    }
+    for (float &weight : kernel.weights) {
+        weight /= static_cast<float>(count);
+    }
+    return kernel;
+}
+
+// ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
+ConvolutionEngine::ConvolutionEngine()
+    : program2D_(0),
+      programSeparable_(0),
+      scratchTex_(0),
+      scratchWidth_(0),
+      scratchHeight_(0),
+      radius2DLoc_(-1),
+      bias2DLoc_(-1),
+      clamp2DLoc_(-1),
+      axisLoc_(-1),
+      radiusLoc_(-1),
+      weightOffsetLoc_(-1),
+      biasLoc_(-1),
+      clampLoc_(-1) {
+}
+
+ConvolutionEngine::~ConvolutionEngine() {
+    cleanup();
+}
+
+// ==================== INITIALISATION ====================
+bool ConvolutionEngine::initialize() {
+    // Soumis ensemble pour que les deux compilations se recouvrent
+    program2D_ = submitComputeProgram(getConvolution2DShader());
+    programSeparable_ = submitComputeProgram(getSeparableShader());
+    program2D_ = ProgramCache::finalize(program2D_);
+    programSeparable_ = ProgramCache::finalize(programSeparable_);
+    if (!isInitialized()) {
+        return false;
+    }
+
+    glUseProgram(program2D_);
+    glUniform1i(glGetUniformLocation(program2D_, "uInput"), 0);
+    radius2DLoc_ = glGetUniformLocation(program2D_, "uRadius");
+    bias2DLoc_ = glGetUniformLocation(program2D_, "uBias");
+    clamp2DLoc_ = glGetUniformLocation(program2D_, "uClampResult");
+
+    glUseProgram(programSeparable_);
+    glUniform1i(glGetUniformLocation(programSeparable_, "uInput"), 0);
+    axisLoc_ = glGetUniformLocation(programSeparable_, "uAxis");
+    radiusLoc_ = glGetUniformLocation(programSeparable_, "uRadius");
+    weightOffsetLoc_ = glGetUniformLocation(programSeparable_, "uWeightOffset");
+    biasLoc_ = glGetUniformLocation(programSeparable_, "uBias");
+    clampLoc_ = glGetUniformLocation(programSeparable_, "uClampResult");
+    glUseProgram(0);
+
+    return true;
+}
+
+// ==================== NOYAUX ====================
+int ConvolutionEngine::createKernel(const ConvolutionKernel &kernel) {
+    KernelEntry entry{};
+    glGenBuffers(1, &entry.buffer);
+    if (!fillEntry(entry, kernel)) {
+        glDeleteBuffers(1, &entry.buffer);
+        return -1;
+    }
+    kernels_.push_back(entry);
+    return static_cast<int>(kernels_.size()) - 1;
+}
+
+bool ConvolutionEngine::updateKernel(int id, const ConvolutionKernel &kernel) {
+    if (id < 0 || id >= static_cast<int>(kernels_.size())) {
+        return false;
+    }
+    return fillEntry(kernels_[id], kernel);
+}
+
+bool ConvolutionEngine::isSeparable(int id) const {
+    return id >= 0 && id < static_cast<int>(kernels_.size()) && kernels_[id].separable;
+}
+
+bool ConvolutionEngine::decompose(const ConvolutionKernel &kernel, std::vector<float> &column, std::vector<float> &row) {
+    // Pivot = plus grand coefficient : sa ligne et sa colonne donnent les deux facteurs
+    int pivot = 0;
+    for (int i = 1; i < static_cast<int>(kernel.weights.size()); ++i) {
+        if (std::abs(kernel.weights[i]) > std::abs(kernel.weights[pivot])) {
+            pivot = i;
+        }
+    }
+    const float pivotValue = kernel.weights[pivot];
+    if (pivotValue == 0.0f) {
+        return false;
+    }
+    const int pivotX = pivot % kernel.width;
+    const int pivotY = pivot / kernel.width;
+
+    column.resize(kernel.height);
+    row.resize(kernel.width);
+    for (int y = 0; y < kernel.height; ++y) {
+        column[y] = kernel.weights[y * kernel.width + pivotX];
+    }
+    for (int x = 0; x < kernel.width; ++x) {
+        row[x] = kernel.weights[pivotY * kernel.width + x] / pivotValue;
+    }
+
+    const float epsilon = std::abs(pivotValue) * 1e-4f;
+    for (int y = 0; y < kernel.height; ++y) {
+        for (int x = 0; x < kernel.width; ++x) {
+            if (std::abs(kernel.weights[y * kernel.width + x] - column[y] * row[x]) > epsilon) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ConvolutionEngine::fillEntry(KernelEntry &entry, const ConvolutionKernel &kernel) const {
+    if (kernel.width % 2 == 0 || kernel.height % 2 == 0 ||
+        static_cast<int>(kernel.weights.size()) != kernel.width * kernel.height) {
+        std::cerr << "ERROR: Convolution kernel must have odd dimensions matching its weights" << std::endl;
+        return false;
+    }
+
+    const int radiusX = kernel.width / 2;
+    const int radiusY = kernel.height / 2;
+
+    std::vector<float> column, row;
+    const bool separable = decompose(kernel, column, row) &&
+                           std::max(radiusX, radiusY) <= MAX_RADIUS_SEPARABLE;
+    if (!separable && std::max(radiusX, radiusY) > MAX_RADIUS_2D) {
+        std::cerr << "ERROR: Non-separable convolution kernel radius exceeds " << MAX_RADIUS_2D << std::endl;
+        return false;
+    }
+
+    std::vector<float> data;
+    if (separable) {
+        data = row;
+        data.insert(data.end(), column.begin(), column.end());
+    } else {
+        data = kernel.weights;
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, entry.buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(data.size() * sizeof(float)), data.data(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    entry.radiusX = radiusX;
+    entry.radiusY = radiusY;
+    entry.separable = separable;
+    entry.bias = kernel.bias;
+    entry.clampResult = kernel.clampResult;
+    return true;
+}
+
+// ==================== RENDU ====================
+void ConvolutionEngine::apply(int id, GLuint input, GLuint output, int width, int height) {
+    if (!isInitialized() || id < 0 || id >= static_cast<int>(kernels_.size())) {
+        return;
+    }
+    const KernelEntry &entry = kernels_[id];
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, KERNEL_SSBO_BINDING, entry.buffer);
+
+    if (entry.separable) {
+        ensureScratch(width, height);
+        dispatchSeparable(entry, 0, input, scratchTex_, width, height, false);
+        dispatchSeparable(entry, 1, scratchTex_, output, width, height, true);
+    } else {
+        glUseProgram(program2D_);
+        glUniform2i(radius2DLoc_, entry.radiusX, entry.radiusY);
+        glUniform1f(bias2DLoc_, entry.bias);
+        glUniform1i(clamp2DLoc_, entry.clampResult ? 1 : 0);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, input);
+        glBindImageTexture(0, output, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glDispatchCompute((width + TILE_SIZE - 1) / TILE_SIZE, (height + TILE_SIZE - 1) / TILE_SIZE, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, KERNEL_SSBO_BINDING, 0);
+    glUseProgram(0);
+}
+
+void ConvolutionEngine::dispatchSeparable(const KernelEntry &entry, int axis, GLuint input, GLuint output,
+                                          int width, int height, bool finalPass) const {
+    glUseProgram(programSeparable_);
+    glUniform1i(axisLoc_, axis);
+    glUniform1i(radiusLoc_, axis == 0 ? entry.radiusX : entry.radiusY);
+    glUniform1i(weightOffsetLoc_, axis == 0 ? 0 : 2 * entry.radiusX + 1);
+    // Biais et saturation seulement à la sortie de la seconde passe
+    glUniform1f(biasLoc_, finalPass ? entry.bias : 0.0f);
+    glUniform1i(clampLoc_, finalPass && entry.clampResult ? 1 : 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, input);
+    glBindImageTexture(0, output, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    // Un groupe = LINE_SIZE texels consécutifs le long de l'axe, une ligne/colonne
+    const int along = axis == 0 ? width : height;
+    const int across = axis == 0 ? height : width;
+    glDispatchCompute((along + LINE_SIZE - 1) / LINE_SIZE, across, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+void ConvolutionEngine::ensureScratch(int width, int height) {
+    if (scratchTex_ != 0 && scratchWidth_ == width && scratchHeight_ == height) {
+        return;
+    }
+    if (scratchTex_) glDeleteTextures(1, &scratchTex_);
+
+    glGenTextures(1, &scratchTex_);
+    glBindTexture(GL_TEXTURE_2D, scratchTex_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    scratchWidth_ = width;
+    scratchHeight_ = height;
+}
+
+GLuint ConvolutionEngine::submitComputeProgram(const std::string &source) {
+    return ProgramCache::submitProgram({{GL_COMPUTE_SHADER, source}});
+}
+
+// ==================== NETTOYAGE ====================
+void ConvolutionEngine::cleanup() {
+    for (KernelEntry &entry : kernels_) {
+        if (entry.buffer) glDeleteBuffers(1, &entry.buffer);
+    }
+    kernels_.clear();
+
+    if (program2D_) glDeleteProgram(program2D_);
+    if (programSeparable_) glDeleteProgram(programSeparable_);
+    if (scratchTex_) glDeleteTextures(1, &scratchTex_);
+    program2D_ = programSeparable_ = scratchTex_ = 0;
+    scratchWidth_ = scratchHeight_ = 0;
+}
+
+// ==================== SHADERS ====================
+std::string ConvolutionEngine::getConvolution2DShader() {
+    return "#version 430 core\n"
+           "#define TILE_SIZE " + std::to_string(TILE_SIZE) + "\n"
+           "#define MAX_RADIUS " + std::to_string(MAX_RADIUS_2D) + "\n"
+           "#define KERNEL_BINDING " + std::to_string(KERNEL_SSBO_BINDING) + "\n" + R"(
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+uniform sampler2D uInput;
+layout(rgba16f, binding = 0) writeonly uniform image2D uOutput;
+layout(std430, binding = KERNEL_BINDING) readonly buffer KernelWeights {
+    float weights[];
+};
+
+uniform ivec2 uRadius;
+uniform float uBias;
+uniform bool uClampResult;
+
+const int APRON_SIZE = TILE_SIZE + 2 * MAX_RADIUS;
+shared vec4 tile[APRON_SIZE * APRON_SIZE];
+
+void main() {
+    ivec2 size = textureSize(uInput, 0);
+    ivec2 tileSize = ivec2(TILE_SIZE) + 2 * uRadius;
+    ivec2 origin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - uRadius;
+
+    // Chargement coopératif tuile + apron (bords répétés)
+    int count = tileSize.x * tileSize.y;
+    for (int i = int(gl_LocalInvocationIndex); i < count; i += TILE_SIZE * TILE_SIZE) {
+        ivec2 texel = clamp(origin + ivec2(i % tileSize.x, i / tileSize.x), ivec2(0), size - 1);
+        tile[i] = texelFetch(uInput, texel, 0);
+    }
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, size))) {
+        return;
+    }
+
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    int kernelWidth = 2 * uRadius.x + 1;
+    vec4 sum = vec4(0.0);
+    for (int y = 0; y <= 2 * uRadius.y; y++) {
+        for (int x = 0; x < kernelWidth; x++) {
+            sum += tile[(local.y + y) * tileSize.x + local.x + x] * weights[y * kernelWidth + x];
+        }
+    }
+
+    vec3 result = sum.rgb + uBias;
+    if (uClampResult) {
+        result = clamp(result, 0.0, 1.0);
+    }
+    imageStore(uOutput, pixel, vec4(result, 1.0));
+}
+)";
+}
+
+std::string ConvolutionEngine::getSeparableShader() {
+    return "#version 430 core\n"
+           "#define LINE_SIZE " + std::to_string(LINE_SIZE) + "\n"
+           "#define MAX_RADIUS " + std::to_string(MAX_RADIUS_SEPARABLE) + "\n"
+           "#define KERNEL_BINDING " + std::to_string(KERNEL_SSBO_BINDING) + "\n" + R"(
+layout(local_size_x = LINE_SIZE) in;
+
+uniform sampler2D uInput;
+layout(rgba16f, binding = 0) writeonly uniform image2D uOutput;
+layout(std430, binding = KERNEL_BINDING) readonly buffer KernelWeights {
+    float weights[];
+};
+
+uniform int uAxis;          // 0 = horizontal, 1 = vertical
+uniform int uRadius;
+uniform int uWeightOffset;
+uniform float uBias;
+uniform bool uClampResult;
+
+shared vec4 line[LINE_SIZE + 2 * MAX_RADIUS];
+
+ivec2 toTexel(int along, int across) {
+    return uAxis == 0 ? ivec2(along, across) : ivec2(across, along);
+}
+
+void main() {
+    ivec2 size = textureSize(uInput, 0);
+    int alongSize = uAxis == 0 ? size.x : size.y;
+    int across = int(gl_WorkGroupID.y);
+    int start = int(gl_WorkGroupID.x) * LINE_SIZE - uRadius;
+
+    for (int i = int(gl_LocalInvocationID.x); i < LINE_SIZE + 2 * uRadius; i += LINE_SIZE) {
+        int along = clamp(start + i, 0, alongSize - 1);
+        line[i] = texelFetch(uInput, toTexel(along, across), 0);
+    }
+    barrier();
+
+    int local = int(gl_LocalInvocationID.x);
+    int along = int(gl_WorkGroupID.x) * LINE_SIZE + local;
+    if (along >= alongSize) {
+        return;
+    }
+
+    vec4 sum = vec4(0.0);
+    for (int t = 0; t <= 2 * uRadius; t++) {
+        sum += line[local + t] * weights[uWeightOffset + t];
+    }
+
+    vec3 result = sum.rgb + uBias;
+    if (uClampResult) {
+        result = clamp(result, 0.0, 1.0);
+    }
+    imageStore(uOutput, toTexel(along, across), vec4(result, 1.0));
+}
+)";
+}
@@ -3,33 +3,20 @@
 //
 
 #include "deferred_renderer.h"
+#include "light_buffer.h"
+#include "program_cache.h"
 #include <iostream>
 #include <cstring>
 #include <cmath>
 
 // ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
 DeferredRenderer::DeferredRenderer()
-    : gBuffer_(0), gPosition_(0), gNormal_(0), gAlbedo_(0), gDepth_(0),
-      geometryShader_(0), lightingShader_(0),
+    : geometryShader_(0), lightingKey_(0), lighting_(nullptr),
       screenWidth_(800), screenHeight_(600), initialized_(false) {
     // Initialiser les locations à -1
     geomModelLoc_ = -1;
     geomViewLoc_ = -1;
     geomProjLoc_ = -1;
-    lightCamPosLoc_ = -1;
-    lightDirLoc_ = -1;
-    lightColorLoc_ = -1;
-    lightIntensityLoc_ = -1;
-    lightSpaceMatLoc_ = -1;
-    lightPointCountLoc_ = -1;
-    lightShadowMapLoc_ = -1;
-
-    for (int i = 0; i < MAX_POINT_LIGHTS; ++i) {
-        lightPointPosLoc_[i] = -1;
-        lightPointColorLoc_[i] = -1;
-        lightPointIntensityLoc_[i] = -1;
-        lightPointRadiusLoc_[i] = -1;
-    }
 }
 
 DeferredRenderer::~DeferredRenderer() {
@@ -40,7 +27,6 @@ DeferredRenderer::~DeferredRenderer() {
 void DeferredRenderer::initialize(int screenWidth, int screenHeight) {
     screenWidth_ = screenWidth;
     screenHeight_ = screenHeight;
-    createGBuffers();
     initialized_ = true;
 }
 
@@ -53,56 +39,60 @@ bool DeferredRenderer::loadShaders(const std::string &geomVS,
                                    const std::string &geomFS,
                                    const std::string &lightVS,
                                    const std::string &lightFS) {
+    if (geometryShader_ != 0) {
+        glDeleteProgram(geometryShader_);
+    }
+    lighting_ = nullptr;
+    ShaderPermutations::registerInclude("deferred/shadow_filtering.glsl", getShadowFilteringGLSL());
+    ShaderPermutations::registerInclude("deferred/light_buffers.glsl", getLightBuffersGLSL());
+
+    // Tous les programmes sont soumis avant toute attente : compilations parallèles.
+    // 8 variantes d'éclairage seulement : toutes précompilées, aucune construction en cours de rendu
+    geometryShader_ = ProgramCache::submitProgram({{GL_VERTEX_SHADER, geomVS},
+                                                   {GL_FRAGMENT_SHADER, geomFS}});
+    lightingVariants_.initialize({{GL_VERTEX_SHADER, lightVS}, {GL_FRAGMENT_SHADER, lightFS}},
+                                 {{"USE_SSAO", 1}, {"SHADOW_MODE", 2}});
+    lightingVariants_.setOnCreated(configureLightingVariant);
+    lightingVariants_.precompileAll();
+
+    geometryShader_ = ProgramCache::finalize(geometryShader_);
+
     // ===== GEOMETRY PROGRAM =====
-    GLuint gVS = compileShader(GL_VERTEX_SHADER, geomVS);
-    GLuint gFS = compileShader(GL_FRAGMENT_SHADER, geomFS);
-    if (!gVS || !gFS) return false;
-
-    geometryShader_ = glCreateProgram();
-    glAttachShader(geometryShader_, gVS);
-    glAttachShader(geometryShader_, gFS);
-    glLinkProgram(geometryShader_);
-
-    GLint ok = 0;
-    glGetProgramiv(geometryShader_, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        char log[2048];
-        glGetProgramInfoLog(geometryShader_, sizeof(log), nullptr, log);
-        std::cerr << "[Geometry LINK ERROR]\n" << log << std::endl;
+    if (!geometryShader_) {
+        std::cerr << "[Geometry LINK ERROR]" << std::endl;
         return false;
     }
+    initializeUniformLocations();
 
-    glDeleteShader(gVS);
-    glDeleteShader(gFS);
-
-    // ===== LIGHTING PROGRAM =====
-    GLuint lVS = compileShader(GL_VERTEX_SHADER, lightVS);
-    GLuint lFS = compileShader(GL_FRAGMENT_SHADER, lightFS);
-    if (!lVS || !lFS) return false;
-
-    lightingShader_ = glCreateProgram();
-    glAttachShader(lightingShader_, lVS);
-    glAttachShader(lightingShader_, lFS);
-    glLinkProgram(lightingShader_);
-    glGetProgramiv(lightingShader_, GL_LINK_STATUS, &ok);
-    std::cout << "[Lighting link status] = " << ok << std::endl;
-    glGetProgramiv(lightingShader_, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        char log[2048];
-        glGetProgramInfoLog(lightingShader_, sizeof(log), nullptr, log);
-        std::cerr << "[Lighting LINK ERROR]\n" << log << std::endl;
+    // ===== LIGHTING PROGRAM ===== (variante par défaut ; les autres sont finalisées à leur premier usage)
+    if (lightingVariants_.get(lightingVariants_.makeKey({0, 0})) == nullptr) {
+        std::cerr << "[Lighting LINK ERROR]" << std::endl;
         return false;
     }
 
-    glDeleteShader(lVS);
-    glDeleteShader(lFS);
-
     return true;
 }
 
 // ==================== RENDU ====================
-void DeferredRenderer::beginGeometryPass() const {
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer_);
+DeferredRenderer::GBufferTargets DeferredRenderer::createGBuffer(FrameGraph::Builder &builder) const {
+    FrameGraphTextureDesc desc;
+    desc.width = screenWidth_;
+    desc.height = screenHeight_;
+
+    // Ordre de création = ordre des attachements couleur (gPosition, gNormal, gAlbedo)
+    GBufferTargets targets;
+    desc.internalFormat = GL_RGB16F;
+    targets.position = builder.create("gPosition", desc);
+    targets.normal = builder.create("gNormal", desc);
+    desc.internalFormat = GL_RGBA8;
+    targets.albedo = builder.create("gAlbedo", desc);
+    // Lue par personne : libérée dès la fin de la passe géométrique
+    desc.internalFormat = GL_DEPTH_COMPONENT24;
+    targets.depth = builder.create("gDepth", desc);
+    return targets;
+}
+
+void DeferredRenderer::beginGeometryPass() {
     // IMPORTANT : état GL propre (ImGui peut laisser des trucs)
     glDisable(GL_SCISSOR_TEST);
     glDisable(GL_BLEND);
@@ -113,7 +103,7 @@ void DeferredRenderer::beginGeometryPass() const {
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
 
-    glViewport(0, 0, screenWidth_, screenHeight_);
+    // Textures du pool : le contenu d'une autre ressource aliasée peut y traîner
     glClearColor(0.f, 0.f, 0.f, 1.f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
@@ -122,7 +112,7 @@ void DeferredRenderer::endGeometryPass() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void DeferredRenderer::beginLightingPass() const {
+void DeferredRenderer::beginLightingPass(GLuint gPosition, GLuint gNormal, GLuint gAlbedo) const {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glDisable(GL_SCISSOR_TEST);
     glDisable(GL_DEPTH_TEST);
@@ -135,11 +125,11 @@ void DeferredRenderer::beginLightingPass() const {
     glClear(GL_COLOR_BUFFER_BIT);
 
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gPosition_);
+    glBindTexture(GL_TEXTURE_2D, gPosition);
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gNormal_);
+    glBindTexture(GL_TEXTURE_2D, gNormal);
     glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, gAlbedo_);
+    glBindTexture(GL_TEXTURE_2D, gAlbedo);
 }
 
 void DeferredRenderer::endLightingPass() {
@@ -150,32 +140,13 @@ void DeferredRenderer::bindGeometryShader() const {
     glUseProgram(geometryShader_);
 }
 
-void DeferredRenderer::bindLightingShader() const {
-    glUseProgram(lightingShader_);
-    if (lightingShader_ != 0) {
-        GLint loc;
-
-        loc = glGetUniformLocation(lightingShader_, "gPosition");
-        if (loc >= 0)
-            glUniform1i(loc, 0);
-
-        loc = glGetUniformLocation(lightingShader_, "gNormal");
-        if (loc >= 0)
-            glUniform1i(loc, 1);
-
-        loc = glGetUniformLocation(lightingShader_, "gAlbedo");
-        if (loc >= 0)
-            glUniform1i(loc, 2);
-
-        // SSAO unit 3 (main_scene bind la texture si activé)
-        loc = glGetUniformLocation(lightingShader_, "gSSAO");
-        if (loc >= 0)
-            glUniform1i(loc, 3);
+void DeferredRenderer::setLightingFeatures(bool useSSAO, int shadowMode) {
+    lightingKey_ = lightingVariants_.makeKey({useSSAO ? 1 : 0, shadowMode});
+}
 
-        loc = glGetUniformLocation(lightingShader_, "uUseSSAO");
-        if (loc >= 0)
-            glUniform1i(loc, 0);
-    }
+void DeferredRenderer::bindLightingShader() {
+    // Les unités des samplers sont fixées à la création de chaque variante
+    lighting_ = lightingVariants_.bind(lightingKey_);
 }
 
 void DeferredRenderer::unbindShader() {
@@ -202,250 +173,87 @@ void DeferredRenderer::setProjectionMatrix(const float *projMatrix) const {
 }
 
 void DeferredRenderer::setLightSpaceMatrix(const float *lightSpaceMatrix) const {
-    if (lightSpaceMatLoc_ >= 0 && lightSpaceMatrix != nullptr) {
-        glUniformMatrix4fv(lightSpaceMatLoc_, 1, GL_FALSE, lightSpaceMatrix);
+    if (lighting_ != nullptr && lightSpaceMatrix != nullptr) {
+        lighting_->setMat4("uLightSpaceMatrix", lightSpaceMatrix);
     }
 }
 
 // ==================== UNIFORMS DE LIGHTING ====================
+// Les setters s'adressent à la variante liée par bindLightingShader ; un uniform retiré
+// par la spécialisation (ex. ombres désactivées) est simplement ignoré
 void DeferredRenderer::setCameraPosition(const core::Vec3F &camPos) const {
-    if (lightCamPosLoc_ >= 0) {
-        glUniform3f(lightCamPosLoc_, camPos.x, camPos.y, camPos.z);
-    }
-}
-
-void DeferredRenderer::setPointLight(int index, const core::Vec3F &position,
-                                     const core::Vec3F &color, float intensity, float radius) {
-    if (index < 0 || index >= MAX_POINT_LIGHTS) {
-        return;
-    }
-
-    if (lightPointPosLoc_[index] >= 0) {
-        glUniform3f(lightPointPosLoc_[index], position.x, position.y, position.z);
-    }
-    if (lightPointColorLoc_[index] >= 0) {
-        glUniform3f(lightPointColorLoc_[index], color.x, color.y, color.z);
-    }
-    if (lightPointIntensityLoc_[index] >= 0) {
-        glUniform1f(lightPointIntensityLoc_[index], intensity);
-    }
-    if (lightPointRadiusLoc_[index] >= 0) {
-        glUniform1f(lightPointRadiusLoc_[index], radius);
+    if (lighting_ != nullptr) {
+        lighting_->setVec3("viewPos", camPos.x, camPos.y, camPos.z);
     }
 }
 
 void DeferredRenderer::setDirectionalLight(const core::Vec3F &direction,
                                            const core::Vec3F &color, float intensity) const {
-    if (lightDirLoc_ >= 0) {
-        glUniform3f(lightDirLoc_, direction.x, direction.y, direction.z);
-    }
-    if (lightColorLoc_ >= 0) {
-        glUniform3f(lightColorLoc_, color.x, color.y, color.z);
-    }
-    if (lightIntensityLoc_ >= 0) {
-        glUniform1f(lightIntensityLoc_, intensity);
+    if (lighting_ != nullptr) {
+        lighting_->setVec3("lightDirection", direction.x, direction.y, direction.z);
+        lighting_->setVec3("lightColor", color.x, color.y, color.z);
+        lighting_->setFloat("lightIntensity", intensity);
     }
 }
 
-void DeferredRenderer::bindShadowMap(GLuint shadowMap) const {
+void DeferredRenderer::bindSSAO(GLuint ssaoTexture) {
+    // L'occlusion n'est lue que par la variante USE_SSAO (setLightingFeatures)
     glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, ssaoTexture);
+}
+
+void DeferredRenderer::bindShadowMap(GLuint shadowMap) {
+    // Unité 4 : l'unité 3 est prise par gSSAO
+    glActiveTexture(GL_TEXTURE4);
     glBindTexture(GL_TEXTURE_2D, shadowMap);
-    if (lightShadowMapLoc_ >= 0) {
-        glUniform1i(lightShadowMapLoc_, 3);
-    }
 }
 
-void DeferredRenderer::setPointLightCount(int count) const {
-    if (lightPointCountLoc_ >= 0) {
-        glUniform1i(lightPointCountLoc_, count);
+void DeferredRenderer::bindShadowMoments(GLuint shadowMoments) {
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_2D, shadowMoments);
+}
+
+void DeferredRenderer::bindShadowAtlas(GLuint shadowAtlas) {
+    // Tuiles des point/spot lights, adressées par le tableau des faces d'ombre (binding 7)
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_2D, shadowAtlas);
+}
+
+void DeferredRenderer::setShadowFilter(float lightBleedingReduction,
+                                       float evsmPositiveExponent, float evsmNegativeExponent) const {
+    if (lighting_ != nullptr) {
+        lighting_->setFloat("uLightBleedingReduction", lightBleedingReduction);
+        lighting_->setVec2("uEVSMExponents", evsmPositiveExponent, evsmNegativeExponent);
     }
 }
 
 // ==================== NETTOYAGE ====================
 void DeferredRenderer::cleanup() {
-    if (gBuffer_ != 0) {
-        glDeleteFramebuffers(1, &gBuffer_);
-        gBuffer_ = 0;
-    }
-    if (gPosition_ != 0) {
-        glDeleteTextures(1, &gPosition_);
-        gPosition_ = 0;
-    }
-    if (gNormal_ != 0) {
-        glDeleteTextures(1, &gNormal_);
-        gNormal_ = 0;
-    }
-    if (gAlbedo_ != 0) {
-        glDeleteTextures(1, &gAlbedo_);
-        gAlbedo_ = 0;
-    }
-    if (gDepth_ != 0) {
-        glDeleteRenderbuffers(1, &gDepth_);
-        gDepth_ = 0;
-    }
     if (geometryShader_ != 0) {
         glDeleteProgram(geometryShader_);
         geometryShader_ = 0;
     }
-    if (lightingShader_ != 0) {
-        glDeleteProgram(lightingShader_);
-        lightingShader_ = 0;
-    }
+    lightingVariants_.cleanup();
+    lighting_ = nullptr;
 }
 
 // ==================== MÉTHODES PRIVÉES ====================
-void DeferredRenderer::createGBuffers() {
-    // Créer le framebuffer
-    glGenFramebuffers(1, &gBuffer_);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer_);
-
-    // Position buffer (RGB16F)
-    glGenTextures(1, &gPosition_);
-    glBindTexture(GL_TEXTURE_2D, gPosition_);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, screenWidth_, screenHeight_, 0,
-                 GL_RGB, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition_, 0);
-
-    // Normal buffer (RGB16F)
-    glGenTextures(1, &gNormal_);
-    glBindTexture(GL_TEXTURE_2D, gNormal_);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, screenWidth_, screenHeight_, 0,
-                 GL_RGB, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal_, 0);
-
-    // Albedo buffer (RGBA8)
-    glGenTextures(1, &gAlbedo_);
-    glBindTexture(GL_TEXTURE_2D, gAlbedo_);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, screenWidth_, screenHeight_, 0,
-                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo_, 0);
-
-    // Depth buffer (RBO)
-    glGenRenderbuffers(1, &gDepth_);
-    glBindRenderbuffer(GL_RENDERBUFFER, gDepth_);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, screenWidth_, screenHeight_);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, gDepth_);
-
-    // Spécifier les attachments de couleur
-    unsigned int attachments[3] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
-    glDrawBuffers(3, attachments);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "ERROR: G-Buffer framebuffer is not complete!" << std::endl;
-    }
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
-
-GLuint DeferredRenderer::compileShader(GLenum type, const std::string &source) {
-    GLuint shader = glCreateShader(type);
-    const char *src = source.c_str();
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
-
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        printShaderError(shader, type);
-        glDeleteShader(shader);
-        return 0;
-    }
-
-    return shader;
-}
-
-GLuint DeferredRenderer::createProgram(GLuint vs, GLuint fs) {
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        printProgramError(program);
-        glDeleteProgram(program);
-        return 0;
-    }
-
-    return program;
-}
-
 void DeferredRenderer::initializeUniformLocations() {
     // Géométrie
     geomModelLoc_ = glGetUniformLocation(geometryShader_, "uModel");
     geomViewLoc_ = glGetUniformLocation(geometryShader_, "uView");
     geomProjLoc_ = glGetUniformLocation(geometryShader_, "uProjection");
-
-    // Lighting
-    lightCamPosLoc_ = glGetUniformLocation(lightingShader_, "uCameraPos");
-    lightDirLoc_ = glGetUniformLocation(lightingShader_, "uDirLight.direction");
-    lightColorLoc_ = glGetUniformLocation(lightingShader_, "uDirLight.color");
-    lightIntensityLoc_ = glGetUniformLocation(lightingShader_, "uDirLight.intensity");
-    lightSpaceMatLoc_ = glGetUniformLocation(lightingShader_, "uLightSpaceMatrix");
-    lightPointCountLoc_ = glGetUniformLocation(lightingShader_, "uPointLightCount");
-    lightShadowMapLoc_ = glGetUniformLocation(lightingShader_, "uShadowMap");
-
-    // Point lights
-    for (int i = 0; i < MAX_POINT_LIGHTS; ++i) {
-        std::string base = "uPointLights[" + std::to_string(i) + "]";
-        lightPointPosLoc_[i] = glGetUniformLocation(lightingShader_, (base + ".position").c_str());
-        lightPointColorLoc_[i] = glGetUniformLocation(lightingShader_, (base + ".color").c_str());
-        lightPointIntensityLoc_[i] = glGetUniformLocation(lightingShader_, (base + ".intensity").c_str());
-        lightPointRadiusLoc_[i] = glGetUniformLocation(lightingShader_, (base + ".radius").c_str());
-    }
-
-    // Bind textures
-    GLint posLoc = glGetUniformLocation(lightingShader_, "gPosition");
-    GLint normLoc = glGetUniformLocation(lightingShader_, "gNormal");
-    GLint albLoc = glGetUniformLocation(lightingShader_, "gAlbedo");
-
-    glUseProgram(lightingShader_);
-    glUniform1i(posLoc, 0);
-    glUniform1i(normLoc, 1);
-    glUniform1i(albLoc, 2);
-    glUseProgram(0);
 }
 
-void DeferredRenderer::printShaderError(GLuint shader, GLenum type) {
-    GLint logLength = 0;
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-
-    if (logLength > 0) {
-        char *log = new char[logLength];
-        glGetShaderInfoLog(shader, logLength, nullptr, log);
-
-        const char *typeStr = (type == GL_VERTEX_SHADER)
-                                  ? "VERTEX"
-                                  : (type == GL_FRAGMENT_SHADER)
-                                        ? "FRAGMENT"
-                                        : "UNKNOWN";
-        std::cerr << "ERROR: " << typeStr << " shader compilation failed:" << std::endl;
-        std::cerr << log << std::endl;
-
-        delete[] log;
-    }
-}
-
-void DeferredRenderer::printProgramError(GLuint program) {
-    GLint logLength = 0;
-    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
-
-    if (logLength > 0) {
-        char *log = new char[logLength];
-        glGetProgramInfoLog(program, logLength, nullptr, log);
-
-        std::cerr << "ERROR: Program linking failed:" << std::endl;
-        std::cerr << log << std::endl;
-
-        delete[] log;
-    }
+void DeferredRenderer::configureLightingVariant(ShaderProgram &program) {
+    // Unités de textures fixes : G-Buffer 0-2, SSAO 3, shadow map 4, moments 5, atlas 6
+    program.setInt("gPosition", 0);
+    program.setInt("gNormal", 1);
+    program.setInt("gAlbedo", 2);
+    program.setInt("gSSAO", 3);
+    program.setInt("uShadowMap", 4);
+    program.setInt("uShadowMoments", 5);
+    program.setInt("uShadowAtlas", 6);
 }
 
 // ==================== SHADERS PAR DÉFAUT ====================
@@ -519,8 +327,11 @@ void main()
 }
 
 std::string DeferredRenderer::getDefaultLightingFS() {
+    // Spécialisé par USE_SSAO et SHADOW_MODE (voir setLightingFeatures) : aucune branche sur uniform.
+    // Point et spot lights : SSBO std430 de LightManager (bindLightBuffers), bouclés tels quels ;
+    // celles qui ont une tuile dans l'atlas sont ombrées quand SHADOW_MODE != 0
     return R"(
- #version 330 core
+ #version 430 core
     out vec4 FragColor;
 
     in vec2 vTexCoord;
@@ -529,38 +340,181 @@ std::string DeferredRenderer::getDefaultLightingFS() {
     uniform sampler2D gNormal;
     uniform sampler2D gAlbedo;  // FIX: name matches G-buffer attachment
 
-    // SSAO (optional)
+#if USE_SSAO
     uniform sampler2D gSSAO;
-    uniform int uUseSSAO;       // 0/1
+#endif
 
     uniform vec3 lightDirection;
     uniform vec3 lightColor;
     uniform float lightIntensity;
     uniform vec3 viewPos;
 
+    #include "deferred/light_buffers.glsl"
+#if SHADOW_MODE != 0
+    #include "deferred/shadow_filtering.glsl"
+#endif
+
+    // Diffus + spéculaire Blinn-Phong ; L pointe vers la lumière
+    vec3 blinnPhong(vec3 N, vec3 V, vec3 L, vec3 radiance, vec3 albedo) {
+        float diff = max(dot(N, L), 0.0);
+        float spec = pow(max(dot(N, normalize(L + V)), 0.0), 32.0);
+        return radiance * (diff * albedo + spec * 0.2);
+    }
+
+    // attenuation : (constant, linear, quadratic)
+    float distanceAttenuation(vec3 attenuation, float d) {
+        return 1.0 / (attenuation.x + attenuation.y * d + attenuation.z * d * d);
+    }
+
     void main() {
         vec3 FragPos = texture(gPosition, vTexCoord).rgb;
         vec3 Normal  = normalize(texture(gNormal, vTexCoord).rgb);
         vec3 Albedo  = texture(gAlbedo, vTexCoord).rgb;
 
+#if USE_SSAO
+        float ao = texture(gSSAO, vTexCoord).r;
+#else
         float ao = 1.0;
-        if (uUseSSAO == 1) {
-            ao = texture(gSSAO, vTexCoord).r;
-        }
+#endif
 
         vec3 ambient = 0.15 * Albedo * ao;
 
         vec3 lightDir = normalize(-lightDirection);
-        float diff = max(dot(Normal, lightDir), 0.0);
-        vec3 diffuse = diff * lightColor * lightIntensity * Albedo;
-
         vec3 viewDir = normalize(viewPos - FragPos);
-        vec3 halfDir = normalize(lightDir + viewDir);
-        float spec = pow(max(dot(Normal, halfDir), 0.0), 32.0);
-        vec3 specular = spec * lightColor * lightIntensity * 0.2;
+        vec3 direct = blinnPhong(Normal, viewDir, lightDir, lightColor * lightIntensity, Albedo);
+
+#if SHADOW_MODE != 0
+        float shadow = computeShadow(FragPos, Normal, lightDir);
+#else
+        float shadow = 1.0;
+#endif
+        vec3 lighting = ambient + shadow * direct;
+
+        for (uint i = 0u; i < uPointLightCount; ++i) {
+            PointLightData light = uPointLights[i];
+            vec3 toLight = light.position - FragPos;
+            float d = length(toLight);
+            if (light.enabled == 0u || d > light.radius) {
+                continue;
+            }
+            vec3 radiance = light.color * light.intensity * distanceAttenuation(light.attenuation, d);
+#if SHADOW_MODE != 0
+            if (light.shadowFace >= 0) {
+                radiance *= computeLocalShadow(light.shadowFace + cubeFace(-toLight), FragPos, Normal, toLight / d);
+            }
+#endif
+            lighting += blinnPhong(Normal, viewDir, toLight / d, radiance, Albedo);
+        }
+
+        for (uint i = 0u; i < uSpotLightCount; ++i) {
+            SpotLightData light = uSpotLights[i];
+            vec3 toLight = light.position - FragPos;
+            float d = length(toLight);
+            vec3 L = toLight / d;
+            // Transition douce entre le cône intérieur et le cône extérieur
+            float theta = dot(L, normalize(-light.direction));
+            float cone = clamp((theta - light.cosOuterCutOff) / max(light.cosCutOff - light.cosOuterCutOff, 1e-4),
+                               0.0, 1.0);
+            if (light.enabled == 0u || cone <= 0.0) {
+                continue;
+            }
+            vec3 radiance = light.color * light.intensity * cone * distanceAttenuation(light.attenuation, d);
+#if SHADOW_MODE != 0
+            if (light.shadowFace >= 0) {
+                radiance *= computeLocalShadow(light.shadowFace, FragPos, Normal, L);
+            }
+#endif
+            lighting += blinnPhong(Normal, viewDir, L, radiance, Albedo);
+        }
 
-        vec3 lighting = ambient + diffuse + specular;
         FragColor = vec4(lighting, 1.0);
     }
     )";
 }
+
+std::string DeferredRenderer::getShadowFilteringGLSL() {
+    // Ombres de la lumière principale ; SHADOW_MODE : 1 = hard, 2 = VSM, 3 = EVSM.
+    // Lumières locales : comparaison simple dans l'atlas, quel que soit le mode (après light_buffers.glsl)
+    return R"(
+    uniform mat4 uLightSpaceMatrix;
+#if SHADOW_MODE == 1
+    uniform sampler2D uShadowMap;      // profondeur brute
+#else
+    uniform sampler2D uShadowMoments;  // moments préfiltrés + mipmaps
+    uniform float uLightBleedingReduction;
+#endif
+#if SHADOW_MODE == 3
+    uniform vec2 uEVSMExponents;
+#endif
+
+#if SHADOW_MODE != 1
+    float linstep(float low, float high, float v) {
+        return clamp((v - low) / (high - low), 0.0, 1.0);
+    }
+
+    // Borne de Chebyshev ; la réduction de fuite coupe la queue de la distribution
+    float chebyshevUpperBound(vec2 moments, float t, float minVariance) {
+        float p = step(t, moments.x);
+        float variance = max(moments.y - moments.x * moments.x, minVariance);
+        float d = t - moments.x;
+        float pMax = linstep(uLightBleedingReduction, 1.0, variance / (variance + d * d));
+        return max(p, pMax);
+    }
+#endif
+
+    float computeShadow(vec3 fragPos, vec3 normal, vec3 lightDir) {
+        vec4 lightSpacePos = uLightSpaceMatrix * vec4(fragPos, 1.0);
+        vec3 coords = lightSpacePos.xyz / lightSpacePos.w * 0.5 + 0.5;
+        if (coords.z > 1.0 || any(lessThan(coords.xy, vec2(0.0))) || any(greaterThan(coords.xy, vec2(1.0)))) {
+            return 1.0;
+        }
+
+#if SHADOW_MODE == 1
+        float bias = max(0.005 * (1.0 - dot(normal, lightDir)), 0.0005);
+        return coords.z - bias > texture(uShadowMap, coords.xy).r ? 0.0 : 1.0;
+#else
+        // Un seul fetch filtré (trilinéaire) donne la pénombre
+        vec4 moments = texture(uShadowMoments, coords.xy);
+#if SHADOW_MODE == 2
+        return chebyshevUpperBound(moments.xy, coords.z, 0.00002);
+#else
+        float d = 2.0 * coords.z - 1.0;
+        float positive = exp(uEVSMExponents.x * d);
+        float negative = -exp(-uEVSMExponents.y * d);
+        vec2 depthScale = 0.0001 * uEVSMExponents * vec2(positive, -negative);
+        float positiveShadow = chebyshevUpperBound(moments.xy, positive, depthScale.x * depthScale.x);
+        float negativeShadow = chebyshevUpperBound(moments.zw, negative, depthScale.y * depthScale.y);
+        return min(positiveShadow, negativeShadow);
+#endif
+#endif
+    }
+
+    uniform sampler2D uShadowAtlas;
+
+    // Face de cube vue depuis la lumière dans la direction v, dans l'ordre de l'atlas : +X, -X, +Y, -Y, +Z, -Z
+    int cubeFace(vec3 v) {
+        vec3 a = abs(v);
+        if (a.x >= a.y && a.x >= a.z) {
+            return v.x > 0.0 ? 0 : 1;
+        }
+        if (a.y >= a.z) {
+            return v.y > 0.0 ? 2 : 3;
+        }
+        return v.z > 0.0 ? 4 : 5;
+    }
+
+    float computeLocalShadow(int face, vec3 fragPos, vec3 normal, vec3 lightDir) {
+        ShadowFaceData data = uShadowFaces[face];
+        vec4 lightSpacePos = data.viewProj * vec4(fragPos, 1.0);
+        vec3 coords = lightSpacePos.xyz / lightSpacePos.w * 0.5 + 0.5;
+        if (lightSpacePos.w <= 0.0 || any(lessThan(coords, vec3(0.0))) || any(greaterThan(coords, vec3(1.0)))) {
+            return 1.0;
+        }
+
+        // tileTransform : (échelle, décalage) de la tuile dans l'atlas ; profondeur perspective, biais plus fin
+        vec2 atlasUV = data.tileTransform.zw + coords.xy * data.tileTransform.xy;
+        float bias = max(0.0005 * (1.0 - dot(normal, lightDir)), 0.00005);
+        return coords.z - bias > texture(uShadowAtlas, atlasUV).r ? 0.0 : 1.0;
+    }
+)";
+}
@@ -0,0 +1,311 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/entity_store.h"
+#include "../include/job_system.h"
+#include "../include/model_loader.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// ==================== CONSTRUCTEURS ====================
+EntityStore::EntityStore()
+    : dirtyCount_(0),
+      linkedCount_(0),
+      staticHierarchyUpdates_(0) {
+}
+
+// ==================== ENTITÉS ====================
+EntityHandle EntityStore::create(Model *model, SlotHandle modelHandle,
+                                 const core::Vec3F &position,
+                                 const core::Vec3F &rotation,
+                                 const core::Vec3F &scale) {
+    const int index = size();
+
+    positions_.push_back(position);
+    rotations_.push_back(rotation);
+    scales_.push_back(scale);
+    worldMatrices_.emplace_back();
+    MatrixMath::identity(worldMatrices_.back().data());
+
+    Aabb local{};
+    if (model != nullptr) {
+        local = {{model->aabbMin.x, model->aabbMin.y, model->aabbMin.z},
+                 {model->aabbMax.x, model->aabbMax.y, model->aabbMax.z}};
+    }
+    localBounds_.push_back(local);
+    worldBounds_.push_back(local);
+    flags_.push_back(FLAG_VISIBLE | FLAG_STATIC);
+
+    models_.push_back(model);
+    modelHandles_.push_back(modelHandle);
+    nodes_.push_back(TransformHierarchy::INVALID_NODE);
+
+    chunkDirtyCounts_.resize((positions_.size() + CHUNK_SIZE - 1) / CHUNK_SIZE, 0);
+    markDirty(index);
+    return handles_.insert();
+}
+
+void EntityStore::remove(EntityHandle handle) {
+    const int index = handles_.erase(handle);
+    if (index < 0) {
+        return;
+    }
+    const int last = size() - 1;
+
+    // Ses enfants deviennent des racines
+    if (nodes_[index] != TransformHierarchy::INVALID_NODE) {
+        hierarchy_.removeNode(nodes_[index]);
+        nodeEntities_[nodes_[index]] = -1;
+        linkedCount_--;
+    }
+
+    // Compteurs de blocs : l'entité supprimée sort, la dernière change de bloc
+    if ((flags_[index] & FLAG_DIRTY) != 0) {
+        chunkDirtyCounts_[static_cast<std::size_t>(index) / CHUNK_SIZE]--;
+        dirtyCount_--;
+    }
+    if (last != index && (flags_[last] & FLAG_DIRTY) != 0) {
+        chunkDirtyCounts_[static_cast<std::size_t>(last) / CHUNK_SIZE]--;
+        chunkDirtyCounts_[static_cast<std::size_t>(index) / CHUNK_SIZE]++;
+    }
+    if (last != index && nodes_[last] != TransformHierarchy::INVALID_NODE) {
+        nodeEntities_[nodes_[last]] = index;
+    }
+
+    // Swap-and-pop sur chaque tableau
+    auto moveLast = [index, last](auto &values) {
+        if (last != index) {
+            values[index] = std::move(values[last]);
+        }
+        values.pop_back();
+    };
+    moveLast(positions_);
+    moveLast(rotations_);
+    moveLast(scales_);
+    moveLast(worldMatrices_);
+    moveLast(localBounds_);
+    moveLast(worldBounds_);
+    moveLast(flags_);
+    moveLast(models_);
+    moveLast(modelHandles_);
+    moveLast(nodes_);
+
+    chunkDirtyCounts_.resize((positions_.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+}
+
+void EntityStore::clear() {
+    positions_.clear();
+    rotations_.clear();
+    scales_.clear();
+    worldMatrices_.clear();
+    localBounds_.clear();
+    worldBounds_.clear();
+    flags_.clear();
+    models_.clear();
+    modelHandles_.clear();
+    handles_.clear();
+    chunkDirtyCounts_.clear();
+    dirtyCount_ = 0;
+    hierarchy_.clear();
+    nodes_.clear();
+    nodeEntities_.clear();
+    linkedCount_ = 0;
+    staticHierarchyUpdates_ = 0;
+}
+
+void EntityStore::reserve(std::size_t capacity) {
+    positions_.reserve(capacity);
+    rotations_.reserve(capacity);
+    scales_.reserve(capacity);
+    worldMatrices_.reserve(capacity);
+    localBounds_.reserve(capacity);
+    worldBounds_.reserve(capacity);
+    flags_.reserve(capacity);
+    models_.reserve(capacity);
+    modelHandles_.reserve(capacity);
+    handles_.reserve(capacity);
+    nodes_.reserve(capacity);
+}
+
+// ==================== TRANSFORMS ====================
+void EntityStore::setPosition(int index, const core::Vec3F &position) {
+    positions_[index] = position;
+    markDirty(index);
+}
+
+void EntityStore::setRotation(int index, const core::Vec3F &rotation) {
+    rotations_[index] = rotation;
+    markDirty(index);
+}
+
+void EntityStore::setScale(int index, const core::Vec3F &scale) {
+    scales_[index] = scale;
+    markDirty(index);
+}
+
+void EntityStore::markDirty(int index) {
+    if ((flags_[index] & FLAG_DIRTY) != 0) {
+        return;
+    }
+    flags_[index] |= FLAG_DIRTY;
+    chunkDirtyCounts_[static_cast<std::size_t>(index) / CHUNK_SIZE]++;
+    dirtyCount_++;
+}
+
+std::size_t EntityStore::updateTransforms() {
+    std::size_t updated = dirtyCount_;
+    staticHierarchyUpdates_ = 0;
+    if (updated == 0) {
+        // Un re-parentage ou une suppression peut suffire à salir la hiérarchie
+        return linkedCount_ > 0 && hierarchy_.isDirty() ? updateHierarchy() : 0;
+    }
+
+    const std::size_t chunkCount = chunkDirtyCounts_.size();
+    if (updated < PARALLEL_THRESHOLD) {
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            if (chunkDirtyCounts_[chunk] != 0) {
+                updateChunk(chunk);
+            }
+        }
+    } else {
+        // Chaque bloc est traité par un seul job : aucune écriture partagée
+        JobSystem::parallelFor(0, chunkCount, 1, [this](std::size_t begin, std::size_t end) {
+            for (std::size_t chunk = begin; chunk < end; ++chunk) {
+                if (chunkDirtyCounts_[chunk] != 0) {
+                    updateChunk(chunk);
+                }
+            }
+        });
+    }
+
+    dirtyCount_ = 0;
+    if (linkedCount_ > 0) {
+        updated += updateHierarchy();
+    }
+    return updated;
+}
+
+// ==================== HIÉRARCHIE ====================
+bool EntityStore::setParent(int index, int parent) {
+    if (!isValid(index) || parent == index) {
+        return false;
+    }
+    if (!isValid(parent)) {
+        // Détacher une entité hors hiérarchie ne change rien
+        if (nodes_[index] == TransformHierarchy::INVALID_NODE) {
+            return true;
+        }
+        hierarchy_.setParent(nodes_[index], TransformHierarchy::INVALID_NODE);
+        markDirty(index);
+        return true;
+    }
+
+    const int node = ensureNode(index);
+    if (!hierarchy_.setParent(node, ensureNode(parent))) {
+        return false;
+    }
+    markDirty(index);
+    return true;
+}
+
+int EntityStore::getParent(int index) const {
+    if (!isValid(index) || nodes_[index] == TransformHierarchy::INVALID_NODE) {
+        return -1;
+    }
+    const int parentNode = hierarchy_.getParent(nodes_[index]);
+    return parentNode != TransformHierarchy::INVALID_NODE ? nodeEntities_[parentNode] : -1;
+}
+
+// ==================== ÉTAT ====================
+void EntityStore::setVisible(int index, bool visible) {
+    if (visible) {
+        flags_[index] |= FLAG_VISIBLE;
+    } else {
+        flags_[index] &= ~FLAG_VISIBLE;
+    }
+}
+
+void EntityStore::setStatic(int index, bool isStatic) {
+    if (isStatic) {
+        flags_[index] |= FLAG_STATIC;
+    } else {
+        flags_[index] &= ~FLAG_STATIC;
+    }
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+void EntityStore::updateChunk(std::size_t chunk) {
+    const std::size_t begin = chunk * CHUNK_SIZE;
+    const std::size_t end = std::min(begin + CHUNK_SIZE, positions_.size());
+
+    std::size_t i = begin;
+    while (i < end) {
+        if ((flags_[i] & FLAG_DIRTY) == 0) {
+            ++i;
+            continue;
+        }
+
+        // Plage contiguë d'entités sales : matrices puis AABB en un seul lot
+        const std::size_t runBegin = i;
+        for (; i < end && (flags_[i] & FLAG_DIRTY) != 0; ++i) {
+            MatrixMath::composeTRS(worldMatrices_[i].data(), positions_[i], rotations_[i], scales_[i]);
+            flags_[i] &= ~FLAG_DIRTY;
+            // Entité liée : ce n'est qu'une matrice locale, la monde viendra de updateHierarchy()
+            if (nodes_[i] != TransformHierarchy::INVALID_NODE) {
+                flags_[i] |= FLAG_LOCAL_CHANGED;
+            }
+        }
+        MatrixMath::transformAabbs(&worldBounds_[runBegin], worldMatrices_[runBegin].data(),
+                                   &localBounds_[runBegin], i - runBegin);
+    }
+    chunkDirtyCounts_[chunk] = 0;
+}
+
+std::size_t EntityStore::updateHierarchy() {
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        if ((flags_[i] & FLAG_LOCAL_CHANGED) != 0) {
+            hierarchy_.setLocalMatrix(nodes_[i], worldMatrices_[i].data());
+        }
+    }
+
+    if (hierarchy_.update() == 0) {
+        return 0;
+    }
+
+    // Ne compte que les entités déplacées par un parent : les autres l'ont été par le passe TRS
+    std::size_t updated = 0;
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        const int node = nodes_[i];
+        if (node == TransformHierarchy::INVALID_NODE || !hierarchy_.wasUpdated(node)) {
+            continue;
+        }
+        std::memcpy(worldMatrices_[i].data(), hierarchy_.getWorldMatrix(node), sizeof(float) * 16);
+        MatrixMath::transformAabbs(&worldBounds_[i], worldMatrices_[i].data(), &localBounds_[i], 1);
+        if ((flags_[i] & FLAG_LOCAL_CHANGED) != 0) {
+            flags_[i] &= ~FLAG_LOCAL_CHANGED;
+            continue;
+        }
+        if ((flags_[i] & FLAG_STATIC) != 0) {
+            staticHierarchyUpdates_++;
+        }
+        updated++;
+    }
+    return updated;
+}
+
+int EntityStore::ensureNode(int index) {
+    if (nodes_[index] == TransformHierarchy::INVALID_NODE) {
+        const int node = hierarchy_.createNode();
+        if (node >= static_cast<int>(nodeEntities_.size())) {
+            nodeEntities_.resize(node + 1, -1);
+        }
+        nodeEntities_[node] = index;
+        nodes_[index] = node;
+        linkedCount_++;
+        // Le TRS courant devient la matrice locale du nœud
+        markDirty(index);
+    }
+    return nodes_[index];
+}
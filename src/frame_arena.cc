@@ -0,0 +1,219 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/frame_arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#ifdef FRAME_ALLOCATION_ASSERT
+#include <cassert>
+#endif
+
+namespace {
+#ifdef FRAME_ALLOCATION_ASSERT
+    std::atomic<std::uint64_t> g_heapAllocations{0};
+#endif
+
+    // Arènes de thread vivantes ; le verrou n'est pris qu'à leur création / destruction et au reset
+    std::mutex g_threadArenasMutex;
+    std::vector<FrameArena *> g_threadArenas;
+
+    struct ThreadArena {
+        FrameArena arena;
+
+        ThreadArena() {
+            std::lock_guard lock(g_threadArenasMutex);
+            g_threadArenas.push_back(&arena);
+        }
+
+        ~ThreadArena() {
+            std::lock_guard lock(g_threadArenasMutex);
+            std::erase(g_threadArenas, &arena);
+        }
+    };
+
+#ifdef FRAME_ALLOCATION_ASSERT
+    void *countedAllocate(std::size_t size) {
+        g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        size = std::max<std::size_t>(size, 1);
+        while (true) {
+            if (void *memory = std::malloc(size)) {
+                return memory;
+            }
+            const std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+#endif
+}
+
+#ifdef FRAME_ALLOCATION_ASSERT
+// ==================== TAS GLOBAL ====================
+// Remplacement de l'operator new global pour compter les allocations (FrameAllocationCheck).
+// Seulement avec COMPGRAPH_ALLOCATION_ASSERT : sinon l'allocateur du programme reste intact.
+// Les variantes nothrow et alignées gardent l'implémentation standard (nothrow repasse par celles-ci).
+void *operator new(std::size_t size) {
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return countedAllocate(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#endif
+
+// ==================== CONSTRUCTEURS ====================
+FrameArena::FrameArena(std::size_t initialCapacity)
+    : buffer_(new std::byte[std::max<std::size_t>(initialCapacity, 1)]),
+      capacity_(std::max<std::size_t>(initialCapacity, 1)),
+      offset_(0),
+      overflowBytes_(0),
+      peakBytes_(0),
+      growCount_(0) {
+    overflowBlocks_.reserve(16);
+}
+
+FrameArena::~FrameArena() {
+    for (const OverflowBlock &block : overflowBlocks_) {
+        releaseOverflow(block);
+    }
+}
+
+// ==================== FRAME ====================
+void FrameArena::reset() {
+    const std::size_t used = getUsedBytes();
+    peakBytes_ = std::max(peakBytes_, used);
+
+    if (!overflowBlocks_.empty()) {
+        for (const OverflowBlock &block : overflowBlocks_) {
+            releaseOverflow(block);
+        }
+        overflowBlocks_.clear();
+
+        // Un seul bloc pour tout le pic, avec de la marge : la frame suivante ne déborde plus
+        capacity_ = std::max(capacity_ * 2, used + used / 2);
+        buffer_.reset(new std::byte[capacity_]);
+        growCount_++;
+    }
+    offset_ = 0;
+    overflowBytes_ = 0;
+}
+
+std::string_view FrameArena::copyString(std::string_view text) {
+    auto *copy = static_cast<char *>(allocate(text.size() + 1, alignof(char)));
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return {copy, text.size()};
+}
+
+// ==================== ARÈNES PAR THREAD ====================
+FrameArena &FrameArena::forThread() {
+    thread_local ThreadArena threadArena;
+    return threadArena.arena;
+}
+
+void FrameArena::resetThreadArenas() {
+    std::lock_guard lock(g_threadArenasMutex);
+    for (FrameArena *arena : g_threadArenas) {
+        arena->reset();
+    }
+}
+
+// ==================== ALLOCATION ====================
+void *FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    const auto base = reinterpret_cast<std::uintptr_t>(buffer_.get());
+    const std::uintptr_t aligned = (base + offset_ + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    const std::size_t end = static_cast<std::size_t>(aligned - base) + bytes;
+    if (end <= capacity_) {
+        offset_ = end;
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    // Débordement : servi par le tas pour cette frame, absorbé par le prochain reset
+    void *memory = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                       ? ::operator new(bytes, std::align_val_t{alignment})
+                       : ::operator new(bytes);
+    overflowBlocks_.push_back({memory, bytes, alignment});
+    overflowBytes_ += bytes + alignment;
+    return memory;
+}
+
+void FrameArena::releaseOverflow(const OverflowBlock &block) {
+    if (block.alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        ::operator delete(block.memory, block.bytes, std::align_val_t{block.alignment});
+    } else {
+        ::operator delete(block.memory, block.bytes);
+    }
+}
+
+// ==================== CONTRÔLE DES ALLOCATIONS ====================
+FrameAllocationCheck::FrameAllocationCheck(int warmupFrames)
+    : warmupFrames_(std::max(warmupFrames, 0)),
+      framesSinceArm_(0),
+      frameStartCount_(getHeapAllocationCount()),
+      frameNumber_(0),
+      lastFrameAllocations_(0),
+      failedFrames_(0) {
+}
+
+std::uint64_t FrameAllocationCheck::nextFrame() {
+    if constexpr (!COUNTING_ENABLED) {
+        frameNumber_++;
+        return 0;
+    }
+
+    lastFrameAllocations_ = getHeapAllocationCount() - frameStartCount_;
+
+    if (isSteady() && lastFrameAllocations_ > 0) {
+        failedFrames_++;
+        if (failedFrames_ <= MAX_REPORTS) {
+            std::cerr << "ERROR: Frame " << frameNumber_ << " made " << lastFrameAllocations_
+                    << " heap allocations in steady state" << std::endl;
+        }
+#ifdef FRAME_ALLOCATION_ASSERT
+        assert(lastFrameAllocations_ == 0 && "steady-state frame allocated on the heap");
+#endif
+    }
+
+    if (framesSinceArm_ <= warmupFrames_) {
+        framesSinceArm_++;
+    }
+    frameNumber_++;
+    // Relu après le rapport : ce qu'il a pu allouer n'est pas compté à la frame suivante
+    frameStartCount_ = getHeapAllocationCount();
+    return lastFrameAllocations_;
+}
+
+void FrameAllocationCheck::rearm() {
+    framesSinceArm_ = 0;
+}
+
+std::uint64_t FrameAllocationCheck::getHeapAllocationCount() {
+#ifdef FRAME_ALLOCATION_ASSERT
+    return g_heapAllocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
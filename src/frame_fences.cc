@@ -0,0 +1,171 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/frame_fences.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // Délai d'une attente GPU avant de reboucler (ns)
+    constexpr GLuint64 FENCE_WAIT_STEP = 1'000'000;
+}
+
+// ==================== CONSTRUCTEURS ====================
+FrameFences::FrameFences(int framesInFlight)
+    : fences_{},
+      framesInFlight_(std::clamp(framesInFlight, 1, MAX_FRAMES_IN_FLIGHT)),
+      slot_(0),
+      frameNumber_(0),
+      lastWaitMs_(0.0),
+      stallCount_(0) {
+}
+
+FrameFences::~FrameFences() {
+    cleanup();
+}
+
+// ==================== FRAMES ====================
+int FrameFences::beginFrame() {
+    slot_ = static_cast<int>(frameNumber_ % static_cast<std::uint64_t>(framesInFlight_));
+    lastWaitMs_ = 0.0;
+
+    GLsync &fence = fences_[slot_];
+    if (fence == nullptr) {
+        return slot_;
+    }
+
+    // Sondage sans attente d'abord : le cas normal ne coûte qu'un appel
+    const GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        stallCount_++;
+        const auto start = std::chrono::steady_clock::now();
+        if (!waitFence(fence)) {
+            std::cerr << "ERROR: glClientWaitSync failed for frame slot " << slot_ << std::endl;
+        }
+        lastWaitMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+    return slot_;
+}
+
+void FrameFences::endFrame() {
+    if (fences_[slot_] != nullptr) {
+        glDeleteSync(fences_[slot_]);
+    }
+    fences_[slot_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameNumber_++;
+}
+
+void FrameFences::waitIdle() {
+    for (GLsync &fence : fences_) {
+        if (fence != nullptr) {
+            waitFence(fence);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+}
+
+void FrameFences::cleanup() {
+    waitIdle();
+}
+
+void FrameFences::setFramesInFlight(int count) {
+    count = std::clamp(count, 1, MAX_FRAMES_IN_FLIGHT);
+    if (count == framesInFlight_) {
+        return;
+    }
+    waitIdle();
+    framesInFlight_ = count;
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+bool FrameFences::waitFence(GLsync fence) {
+    // Le premier tour vide les commandes en attente, sinon la fence pourrait ne jamais partir
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        const GLenum status = glClientWaitSync(fence, flags, FENCE_WAIT_STEP);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            return true;
+        }
+        if (status == GL_WAIT_FAILED) {
+            return false;
+        }
+        flags = 0;
+    }
+}
+
+// ==================== FRAME RING BUFFER ====================
+FrameRingBuffer::FrameRingBuffer()
+    : buffer_(0),
+      target_(GL_ARRAY_BUFFER),
+      sliceStride_(0),
+      sliceCount_(0) {
+}
+
+FrameRingBuffer::~FrameRingBuffer() {
+    cleanup();
+}
+
+void FrameRingBuffer::initialize(GLenum target, std::size_t sliceSize, int sliceCount) {
+    cleanup();
+    target_ = target;
+    sliceCount_ = std::max(1, sliceCount);
+
+    // Les offsets de glBindBufferRange doivent respecter l'alignement du target
+    GLint alignment = 16;
+    if (target == GL_UNIFORM_BUFFER) {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    } else if (target == GL_SHADER_STORAGE_BUFFER) {
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    }
+    const auto align = static_cast<std::size_t>(std::max(alignment, 1));
+    sliceStride_ = (sliceSize + align - 1) / align * align;
+
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(target_, buffer_);
+    glBufferData(target_, static_cast<GLsizeiptr>(sliceStride_ * sliceCount_), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(target_, 0);
+}
+
+void FrameRingBuffer::cleanup() {
+    if (buffer_ != 0) {
+        glDeleteBuffers(1, &buffer_);
+        buffer_ = 0;
+    }
+    sliceStride_ = 0;
+    sliceCount_ = 0;
+}
+
+void FrameRingBuffer::write(int slot, const void *data, std::size_t size, std::size_t offset) const {
+    if (buffer_ == 0 || slot < 0 || slot >= sliceCount_ || offset + size > sliceStride_) {
+        std::cerr << "ERROR: FrameRingBuffer write out of range (slot " << slot << ", "
+                << offset + size << " / " << sliceStride_ << " bytes)" << std::endl;
+        return;
+    }
+
+    const auto start = static_cast<GLintptr>(getSliceOffset(slot) + offset);
+    glBindBuffer(target_, buffer_);
+    void *mapped = nullptr;
+    if (sliceCount_ > 1) {
+        // Tranche libérée par la fence de son slot : aucune synchronisation à demander au pilote
+        mapped = glMapBufferRange(target_, start, static_cast<GLsizeiptr>(size),
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+    if (mapped != nullptr) {
+        std::memcpy(mapped, data, size);
+        glUnmapBuffer(target_);
+    } else {
+        glBufferSubData(target_, start, static_cast<GLsizeiptr>(size), data);
+    }
+    glBindBuffer(target_, 0);
+}
+
+void FrameRingBuffer::bindRange(GLuint binding, int slot, std::size_t size) const {
+    glBindBufferRange(target_, binding, buffer_, static_cast<GLintptr>(getSliceOffset(slot)),
+                      static_cast<GLsizeiptr>(size));
+}
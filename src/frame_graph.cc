@@ -0,0 +1,512 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "frame_graph.h"
+#include <algorithm>
+#include <iostream>
+#include <queue>
+
+// ==================== BUILDER ====================
+FrameGraphResource FrameGraph::Builder::create(std::string_view name, const FrameGraphTextureDesc &desc) {
+    // Une ressource créée est écrite par la passe qui la déclare
+    FrameArena &arena = graph_.arena_;
+    graph_.resources_.push_back(ResourceNode{arena.copyString(name), desc, false, false, 0, -1, 0, -1, -1,
+                                             std::pmr::vector<int>(&arena)});
+    return write(static_cast<FrameGraphResource>(graph_.resources_.size() - 1));
+}
+
+FrameGraphResource FrameGraph::Builder::read(FrameGraphResource resource) {
+    if (resource != INVALID_FRAME_GRAPH_RESOURCE) {
+        graph_.passes_[passIndex_].reads.push_back(resource);
+    }
+    return resource;
+}
+
+FrameGraphResource FrameGraph::Builder::write(FrameGraphResource resource) {
+    if (resource != INVALID_FRAME_GRAPH_RESOURCE) {
+        graph_.passes_[passIndex_].writes.push_back(resource);
+        graph_.resources_[resource].writers.push_back(passIndex_);
+    }
+    return resource;
+}
+
+void FrameGraph::Builder::setSideEffect() {
+    graph_.passes_[passIndex_].sideEffect = true;
+}
+
+// ==================== RESSOURCES ====================
+GLuint FrameGraph::Resources::getTexture(FrameGraphResource resource) const {
+    if (resource == INVALID_FRAME_GRAPH_RESOURCE) {
+        return 0;
+    }
+    const ResourceNode &node = graph_.resources_[resource];
+    if (node.imported) {
+        return node.importedTexture;
+    }
+    return node.physical >= 0 ? graph_.pool_[node.physical].texture : 0;
+}
+
+const FrameGraphTextureDesc &FrameGraph::Resources::getDesc(FrameGraphResource resource) const {
+    return graph_.resources_[resource].desc;
+}
+
+// ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
+FrameGraph::FrameGraph()
+    : frameIndex_(0),
+      culledPassCount_(0),
+      compiled_(false) {
+}
+
+FrameGraph::~FrameGraph() {
+    cleanup();
+}
+
+// ==================== CONSTRUCTION ====================
+void FrameGraph::reset() {
+    // Les nœuds pointent dans l'arène : détruits avant qu'elle ne soit rendue
+    passes_.clear();
+    resources_.clear();
+    arena_.reset();
+    order_.clear();
+    culledPassCount_ = 0;
+    compiled_ = false;
+    ++frameIndex_;
+
+    // Avant l'attribution de la frame : les indices du pool ne sont pas encore utilisés
+    evictUnusedTextures();
+}
+
+FrameGraphResource FrameGraph::importTexture(std::string_view name, GLuint texture,
+                                             const FrameGraphTextureDesc &desc) {
+    resources_.push_back(ResourceNode{arena_.copyString(name), desc, true, false, texture, -1, 0, -1, -1,
+                                      std::pmr::vector<int>(&arena_)});
+    return static_cast<FrameGraphResource>(resources_.size() - 1);
+}
+
+FrameGraphResource FrameGraph::importBackbuffer(std::string_view name, int width, int height) {
+    FrameGraphTextureDesc desc;
+    desc.width = width;
+    desc.height = height;
+    resources_.push_back(ResourceNode{arena_.copyString(name), desc, true, true, 0, -1, 0, -1, -1,
+                                      std::pmr::vector<int>(&arena_)});
+    return static_cast<FrameGraphResource>(resources_.size() - 1);
+}
+
+// ==================== COMPILATION / EXÉCUTION ====================
+bool FrameGraph::compile() {
+    cullPasses();
+    if (!sortPasses()) {
+        return false;
+    }
+    computeLifetimes();
+    assignPhysicalTextures();
+    compiled_ = true;
+    return true;
+}
+
+void FrameGraph::execute() {
+    if (!compiled_) {
+        return;
+    }
+
+    Resources resources(*this);
+    for (int passIndex: order_) {
+        const PassNode &pass = passes_[passIndex];
+        bindPassTargets(pass);
+        if (pass.execute) {
+            pass.execute(resources);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// ==================== STATISTIQUES ====================
+int FrameGraph::getTransientResourceCount() const {
+    return static_cast<int>(std::count_if(resources_.begin(), resources_.end(), [](const ResourceNode &node) {
+        return !node.imported && node.physical >= 0;
+    }));
+}
+
+std::size_t FrameGraph::getPhysicalMemoryBytes() const {
+    std::size_t bytes = 0;
+    for (const auto &physical: pool_) {
+        bytes += static_cast<std::size_t>(physical.desc.width) * physical.desc.height *
+                bytesPerPixel(physical.desc.internalFormat);
+    }
+    return bytes;
+}
+
+std::size_t FrameGraph::getVirtualMemoryBytes() const {
+    std::size_t bytes = 0;
+    for (const auto &node: resources_) {
+        if (!node.imported && node.physical >= 0) {
+            bytes += static_cast<std::size_t>(node.desc.width) * node.desc.height *
+                    bytesPerPixel(node.desc.internalFormat);
+        }
+    }
+    return bytes;
+}
+
+// ==================== NETTOYAGE ====================
+void FrameGraph::cleanup() {
+    for (const auto &[attachments, framebuffer]: framebuffers_) {
+        glDeleteFramebuffers(1, &framebuffer);
+    }
+    framebuffers_.clear();
+
+    for (const auto &physical: pool_) {
+        glDeleteTextures(1, &physical.texture);
+    }
+    pool_.clear();
+
+    passes_.clear();
+    resources_.clear();
+    arena_.reset();
+    order_.clear();
+    compiled_ = false;
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+int FrameGraph::beginPass(std::string_view name) {
+    passes_.push_back(PassNode{arena_.copyString(name), ExecuteFunc(), std::pmr::vector<FrameGraphResource>(&arena_),
+                               std::pmr::vector<FrameGraphResource>(&arena_), false, false, 0});
+    return static_cast<int>(passes_.size() - 1);
+}
+
+void FrameGraph::cullPasses() {
+    for (auto &resource: resources_) {
+        resource.refCount = 0;
+    }
+    for (auto &pass: passes_) {
+        pass.refCount = static_cast<int>(pass.writes.size());
+        pass.culled = false;
+        for (FrameGraphResource read: pass.reads) {
+            ++resources_[read].refCount;
+        }
+    }
+
+    std::pmr::vector<FrameGraphResource> unreferenced(&arena_);
+    auto cull = [&](PassNode &pass) {
+        pass.culled = true;
+        ++culledPassCount_;
+        for (FrameGraphResource read: pass.reads) {
+            if (--resources_[read].refCount == 0) {
+                unreferenced.push_back(read);
+            }
+        }
+    };
+
+    // Passes sans sortie et sans effet de bord : rien ne peut les rendre utiles
+    culledPassCount_ = 0;
+    for (auto &pass: passes_) {
+        if (pass.writes.empty() && !pass.sideEffect) {
+            cull(pass);
+        }
+    }
+
+    // Le backbuffer est la seule racine implicite : tout le reste doit être lu
+    for (int i = 0; i < static_cast<int>(resources_.size()); ++i) {
+        if (resources_[i].refCount == 0 && !resources_[i].backbuffer) {
+            unreferenced.push_back(i);
+        }
+    }
+
+    while (!unreferenced.empty()) {
+        const FrameGraphResource resource = unreferenced.back();
+        unreferenced.pop_back();
+        if (resources_[resource].backbuffer) {
+            continue;
+        }
+
+        for (int writer: resources_[resource].writers) {
+            PassNode &pass = passes_[writer];
+            if (pass.culled || pass.sideEffect) {
+                continue;
+            }
+            if (--pass.refCount == 0) {
+                cull(pass);
+            }
+        }
+    }
+}
+
+bool FrameGraph::sortPasses() {
+    const int passCount = static_cast<int>(passes_.size());
+    std::pmr::vector<std::pmr::vector<int> > successors(passCount, &arena_);
+    std::pmr::vector<int> inDegree(passCount, 0, &arena_);
+
+    auto addEdge = [&](int from, int to) {
+        if (from != to && !passes_[from].culled) {
+            successors[from].push_back(to);
+            ++inDegree[to];
+        }
+    };
+
+    for (int p = 0; p < passCount; ++p) {
+        const PassNode &pass = passes_[p];
+        if (pass.culled) {
+            continue;
+        }
+
+        // Lecture après écriture
+        for (FrameGraphResource read: pass.reads) {
+            const ResourceNode &resource = resources_[read];
+            bool produced = resource.imported;
+            for (int writer: resource.writers) {
+                if (writer < p) {
+                    addEdge(writer, p);
+                    produced = produced || !passes_[writer].culled;
+                }
+            }
+            if (!produced) {
+                std::cerr << "ERROR: Frame graph pass '" << pass.name << "' reads '" << resource.name
+                        << "' before any pass writes it" << std::endl;
+                return false;
+            }
+        }
+
+        // Écriture après lecture / écriture : l'ordre déclaré est conservé
+        for (FrameGraphResource write: pass.writes) {
+            for (int q = 0; q < p; ++q) {
+                const PassNode &other = passes_[q];
+                const bool touches =
+                        std::find(other.reads.begin(), other.reads.end(), write) != other.reads.end() ||
+                        std::find(other.writes.begin(), other.writes.end(), write) != other.writes.end();
+                if (touches) {
+                    addEdge(q, p);
+                }
+            }
+        }
+    }
+
+    // Kahn, à égalité l'ordre de déclaration
+    std::priority_queue<int, std::pmr::vector<int>, std::greater<> > ready{std::greater<>(),
+                                                                           std::pmr::vector<int>(&arena_)};
+    int aliveCount = 0;
+    for (int p = 0; p < passCount; ++p) {
+        if (!passes_[p].culled) {
+            ++aliveCount;
+            if (inDegree[p] == 0) {
+                ready.push(p);
+            }
+        }
+    }
+
+    order_.clear();
+    while (!ready.empty()) {
+        const int p = ready.top();
+        ready.pop();
+        order_.push_back(p);
+        for (int next: successors[p]) {
+            if (--inDegree[next] == 0) {
+                ready.push(next);
+            }
+        }
+    }
+
+    if (static_cast<int>(order_.size()) != aliveCount) {
+        std::cerr << "ERROR: Frame graph has a dependency cycle" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void FrameGraph::computeLifetimes() {
+    for (auto &resource: resources_) {
+        resource.firstUse = -1;
+        resource.lastUse = -1;
+        resource.physical = -1;
+    }
+
+    for (int position = 0; position < static_cast<int>(order_.size()); ++position) {
+        const PassNode &pass = passes_[order_[position]];
+        auto touch = [&](FrameGraphResource handle) {
+            ResourceNode &resource = resources_[handle];
+            if (resource.firstUse < 0) {
+                resource.firstUse = position;
+            }
+            resource.lastUse = position;
+        };
+        std::for_each(pass.reads.begin(), pass.reads.end(), touch);
+        std::for_each(pass.writes.begin(), pass.writes.end(), touch);
+    }
+}
+
+void FrameGraph::assignPhysicalTextures() {
+    std::pmr::vector<bool> busy(pool_.size(), false, &arena_);
+
+    for (int position = 0; position < static_cast<int>(order_.size()); ++position) {
+        // Toutes les acquisitions de la passe avant les libérations : pas d'alias dans une même passe
+        for (auto &resource: resources_) {
+            if (!resource.imported && resource.firstUse == position) {
+                resource.physical = acquirePhysical(resource.desc, busy);
+            }
+        }
+        for (const auto &resource: resources_) {
+            if (!resource.imported && resource.lastUse == position && resource.physical >= 0) {
+                busy[resource.physical] = false;
+            }
+        }
+    }
+}
+
+void FrameGraph::evictUnusedTextures() {
+    for (std::size_t i = 0; i < pool_.size();) {
+        if (frameIndex_ - pool_[i].lastUsedFrame <= POOL_EVICTION_FRAMES) {
+            ++i;
+            continue;
+        }
+
+        // Les FBOs qui référencent la texture deviennent invalides
+        const GLuint texture = pool_[i].texture;
+        for (auto it = framebuffers_.begin(); it != framebuffers_.end();) {
+            if (std::find(it->first.begin(), it->first.end(), texture) != it->first.end()) {
+                glDeleteFramebuffers(1, &it->second);
+                it = framebuffers_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        glDeleteTextures(1, &texture);
+        pool_.erase(pool_.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+}
+
+int FrameGraph::acquirePhysical(const FrameGraphTextureDesc &desc, std::pmr::vector<bool> &busy) {
+    for (std::size_t i = 0; i < pool_.size(); ++i) {
+        if (!busy[i] && pool_[i].desc == desc) {
+            busy[i] = true;
+            pool_[i].lastUsedFrame = frameIndex_;
+            return static_cast<int>(i);
+        }
+    }
+
+    pool_.push_back(PhysicalTexture{desc, createTexture(desc), frameIndex_});
+    busy.push_back(true);
+    return static_cast<int>(pool_.size() - 1);
+}
+
+GLuint FrameGraph::getFramebuffer(const AttachmentKey &attachments, int colorCount) {
+    auto it = framebuffers_.find(attachments);
+    if (it != framebuffers_.end()) {
+        return it->second;
+    }
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    std::array<GLenum, MAX_COLOR_ATTACHMENTS> drawBuffers{};
+    for (int i = 0; i < colorCount; ++i) {
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, attachments[i], 0);
+    }
+    const GLuint depthAttachment = attachments[MAX_COLOR_ATTACHMENTS];
+    if (depthAttachment != 0) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthAttachment, 0);
+    }
+    if (colorCount == 0) {
+        glDrawBuffer(GL_NONE);
+    } else {
+        glDrawBuffers(colorCount, drawBuffers.data());
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Frame graph framebuffer is not complete!" << std::endl;
+    }
+
+    framebuffers_.emplace(attachments, framebuffer);
+    return framebuffer;
+}
+
+void FrameGraph::bindPassTargets(const PassNode &pass) {
+    AttachmentKey attachments{};
+    int colorCount = 0;
+    const FrameGraphTextureDesc *viewport = nullptr;
+
+    for (FrameGraphResource write: pass.writes) {
+        const ResourceNode &resource = resources_[write];
+        if (resource.backbuffer) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, resource.desc.width, resource.desc.height);
+            return;
+        }
+        if (resource.imported) {
+            continue;
+        }
+
+        const GLuint texture = pool_[resource.physical].texture;
+        if (isDepthFormat(resource.desc.internalFormat)) {
+            attachments[MAX_COLOR_ATTACHMENTS] = texture;
+        } else if (colorCount < MAX_COLOR_ATTACHMENTS) {
+            attachments[colorCount++] = texture;
+        } else {
+            std::cerr << "ERROR: Frame graph pass '" << pass.name << "' writes more than "
+                    << MAX_COLOR_ATTACHMENTS << " color targets" << std::endl;
+        }
+        if (viewport == nullptr) {
+            viewport = &resource.desc;
+        }
+    }
+
+    // Seulement des ressources importées : la passe lie le framebuffer de leur propriétaire
+    if (viewport == nullptr) {
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, getFramebuffer(attachments, colorCount));
+    glViewport(0, 0, viewport->width, viewport->height);
+}
+
+GLuint FrameGraph::createTexture(const FrameGraphTextureDesc &desc) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, desc.internalFormat, desc.width, desc.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(desc.filter));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(desc.filter));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+bool FrameGraph::isDepthFormat(GLenum internalFormat) {
+    return internalFormat == GL_DEPTH_COMPONENT16 || internalFormat == GL_DEPTH_COMPONENT24 ||
+           internalFormat == GL_DEPTH_COMPONENT32F || internalFormat == GL_DEPTH24_STENCIL8 ||
+           internalFormat == GL_DEPTH32F_STENCIL8;
+}
+
+std::size_t FrameGraph::bytesPerPixel(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_R8:
+            return 1;
+        case GL_R16F:
+        case GL_RG8:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGB8:
+        case GL_DEPTH_COMPONENT24:
+            return 3;
+        case GL_R32F:
+        case GL_RG16F:
+        case GL_RGBA8:
+        case GL_R11F_G11F_B10F:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+            return 4;
+        case GL_RGB16F:
+            return 6;
+        case GL_RG32F:
+        case GL_RGBA16F:
+        case GL_DEPTH32F_STENCIL8:
+            return 8;
+        case GL_RGB32F:
+            return 12;
+        case GL_RGBA32F:
+            return 16;
+        default:
+            return 4;
+    }
+}
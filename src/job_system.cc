@@ -0,0 +1,321 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/job_system.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct QueuedJob {
+        JobSystem::Job job;
+        JobCounter *counter;
+    };
+
+    // File circulaire qui garde sa capacité : une std::deque alloue et libère des blocs au fil
+    // des push / pop, même à taille constante. Ne grandit (par doublement) que si elle est pleine.
+    class JobRing {
+    public:
+        [[nodiscard]] bool empty() const { return size_ == 0; }
+
+        void push_back(QueuedJob &&job) {
+            if (size_ == slots_.size()) {
+                grow();
+            }
+            slots_[(head_ + size_) & (slots_.size() - 1)] = std::move(job);
+            size_++;
+        }
+
+        QueuedJob pop_back() {
+            size_--;
+            return std::move(slots_[(head_ + size_) & (slots_.size() - 1)]);
+        }
+
+        QueuedJob pop_front() {
+            QueuedJob job = std::move(slots_[head_]);
+            head_ = (head_ + 1) & (slots_.size() - 1);
+            size_--;
+            return job;
+        }
+
+    private:
+        std::vector<QueuedJob> slots_;  // taille puissance de deux
+        std::size_t head_ = 0;
+        std::size_t size_ = 0;
+
+        void grow() {
+            std::vector<QueuedJob> larger(std::max<std::size_t>(64, slots_.size() * 2));
+            for (std::size_t i = 0; i < size_; ++i) {
+                larger[i] = std::move(slots_[(head_ + i) & (slots_.size() - 1)]);
+            }
+            slots_ = std::move(larger);
+            head_ = 0;
+        }
+    };
+
+    // File d'un thread ; un mutex par file suffit, la contention reste locale aux voleurs
+    struct WorkQueue {
+        std::mutex mutex;
+        JobRing jobs;
+    };
+
+    // Découpage d'un parallelFor, sur la pile de l'appelant jusqu'à la fin du wait() :
+    // les jobs ne capturent que son adresse et leur début, ce qui tient dans le stockage
+    // interne de std::function (pas d'allocation par tranche)
+    struct RangeSlices {
+        const JobSystem::RangeJob *body;
+        std::size_t step;
+        std::size_t end;
+    };
+
+    // ==================== ÉTAT GLOBAL ====================
+    std::vector<std::unique_ptr<WorkQueue>> g_queues;     // 0 : thread principal
+    std::vector<std::thread> g_workers;
+    std::atomic<bool> g_running{false};
+    std::atomic<std::size_t> g_queuedCount{0};
+    std::atomic<unsigned> g_nextQueue{0};
+
+    // Sommeil des workers inoccupés
+    std::mutex g_sleepMutex;
+    std::condition_variable g_wakeUp;
+    std::atomic<unsigned> g_sleepingCount{0};
+
+    std::mutex g_mainMutex;
+    JobRing g_mainTasks;
+
+    thread_local int t_threadIndex = -1;
+
+    void wakeWorker() {
+        // Un worker qui s'endort incrémente g_sleepingCount avant de relire g_queuedCount :
+        // l'un des deux voit forcément l'autre (ordre séquentiel), aucun réveil n'est perdu
+        if (g_sleepingCount.load() > 0) {
+            { std::lock_guard lock(g_sleepMutex); }
+            g_wakeUp.notify_one();
+        }
+    }
+}
+
+// ==================== CYCLE DE VIE ====================
+void JobSystem::initialize(unsigned workerCount) {
+    if (g_running.load()) {
+        return;
+    }
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    g_queues.clear();
+    for (unsigned i = 0; i <= workerCount; ++i) {
+        g_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    t_threadIndex = 0;
+    g_running.store(true);
+
+    for (unsigned i = 1; i <= workerCount; ++i) {
+        g_workers.emplace_back(workerLoop, static_cast<int>(i));
+    }
+}
+
+void JobSystem::shutdown() {
+    if (!g_running.load()) {
+        return;
+    }
+
+    // Vider les files et les tâches du thread principal avant d'arrêter les workers
+    while (tryExecuteOne(t_threadIndex) || executeMainThreadTasks() > 0) {
+    }
+
+    {
+        std::lock_guard lock(g_sleepMutex);
+        g_running.store(false);
+    }
+    g_wakeUp.notify_all();
+    for (std::thread &worker : g_workers) {
+        worker.join();
+    }
+    g_workers.clear();
+    g_queues.clear();
+    g_queuedCount.store(0);
+    t_threadIndex = -1;
+}
+
+bool JobSystem::isInitialized() {
+    return g_running.load(std::memory_order_acquire);
+}
+
+unsigned JobSystem::getWorkerCount() {
+    return static_cast<unsigned>(g_workers.size());
+}
+
+int JobSystem::getThreadIndex() {
+    return t_threadIndex;
+}
+
+bool JobSystem::isMainThread() {
+    return t_threadIndex == 0 || !isInitialized();
+}
+
+// ==================== JOBS ====================
+void JobSystem::run(Job job, JobCounter *counter) {
+    if (counter != nullptr) {
+        counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!isInitialized()) {
+        job();
+        complete(counter);
+        return;
+    }
+
+    // Un thread hors système (ex. thread de simulation) répartit ses jobs entre les files
+    const std::size_t index = t_threadIndex >= 0
+                                  ? static_cast<std::size_t>(t_threadIndex)
+                                  : g_nextQueue.fetch_add(1, std::memory_order_relaxed) % g_queues.size();
+    // Compté avant d'être visible : un voleur ne peut pas le retirer avant l'incrément
+    g_queuedCount.fetch_add(1);
+    {
+        std::lock_guard lock(g_queues[index]->mutex);
+        g_queues[index]->jobs.push_back({std::move(job), counter});
+    }
+    wakeWorker();
+}
+
+void JobSystem::wait(const JobCounter &counter) {
+    while (!counter.isDone()) {
+        if (isMainThread() && executeMainThreadTasks() > 0) {
+            continue;
+        }
+        if (!tryExecuteOne(t_threadIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const RangeJob &body) {
+    if (end <= begin) {
+        return;
+    }
+    const std::size_t count = end - begin;
+    grainSize = std::max<std::size_t>(1, grainSize);
+    if (!isInitialized() || g_workers.empty() || count <= grainSize) {
+        body(begin, end);
+        return;
+    }
+
+    // Quelques tranches par thread : le vol rééquilibre les tranches inégales
+    const std::size_t maxTasks = (g_workers.size() + 1) * 4;
+    const std::size_t taskCount = std::min((count + grainSize - 1) / grainSize, maxTasks);
+    const std::size_t step = (count + taskCount - 1) / taskCount;
+
+    const RangeSlices slices{&body, step, end};
+    JobCounter counter;
+    for (std::size_t first = begin + step; first < end; first += step) {
+        run([&slices, first] { (*slices.body)(first, std::min(first + slices.step, slices.end)); }, &counter);
+    }
+    body(begin, std::min(begin + step, end));
+    wait(counter);
+}
+
+// ==================== THREAD PRINCIPAL ====================
+void JobSystem::runOnMainThread(Job job, JobCounter *counter) {
+    if (counter != nullptr) {
+        counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!isInitialized()) {
+        job();
+        complete(counter);
+        return;
+    }
+    std::lock_guard lock(g_mainMutex);
+    g_mainTasks.push_back({std::move(job), counter});
+}
+
+std::size_t JobSystem::executeMainThreadTasks() {
+    if (t_threadIndex != 0) {
+        return 0;
+    }
+
+    std::size_t executed = 0;
+    while (true) {
+        QueuedJob task;
+        {
+            std::lock_guard lock(g_mainMutex);
+            if (g_mainTasks.empty()) {
+                break;
+            }
+            task = g_mainTasks.pop_front();
+        }
+        task.job();
+        complete(task.counter);
+        executed++;
+    }
+    return executed;
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+bool JobSystem::tryExecuteOne(int threadIndex) {
+    if (g_queuedCount.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    QueuedJob job;
+    bool found = false;
+
+    // Sa propre file d'abord, par la fin
+    if (threadIndex >= 0) {
+        WorkQueue &own = *g_queues[threadIndex];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = own.jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // Puis vol chez les autres, par le début
+    const std::size_t queueCount = g_queues.size();
+    const std::size_t start = threadIndex >= 0 ? static_cast<std::size_t>(threadIndex) + 1 : 0;
+    for (std::size_t k = 0; !found && k < queueCount; ++k) {
+        const std::size_t victim = (start + k) % queueCount;
+        if (static_cast<int>(victim) == threadIndex) {
+            continue;
+        }
+        WorkQueue &queue = *g_queues[victim];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = queue.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+    g_queuedCount.fetch_sub(1);
+    job.job();
+    complete(job.counter);
+    return true;
+}
+
+void JobSystem::complete(JobCounter *counter) {
+    if (counter != nullptr) {
+        counter->pending_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void JobSystem::workerLoop(int threadIndex) {
+    t_threadIndex = threadIndex;
+    while (g_running.load(std::memory_order_acquire)) {
+        if (tryExecuteOne(threadIndex)) {
+            continue;
+        }
+
+        std::unique_lock lock(g_sleepMutex);
+        g_sleepingCount.fetch_add(1);
+        g_wakeUp.wait(lock, [] { return g_queuedCount.load() > 0 || !g_running.load(); });
+        g_sleepingCount.fetch_sub(1);
+    }
+}
@@ -0,0 +1,295 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "layered_shadow_renderer.h"
+#include "program_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
+LayeredShadowRenderer::LayeredShadowRenderer()
+    : framebuffer_(0),
+      depthTextureArray_(0),
+      width_(0),
+      height_(0),
+      modelProgram_(0),
+      boundProgram_(0),
+      modelMatrixLocation_(-1),
+      layerMatrices_{},
+      layerCount_(1),
+      vertexLayerSupported_(false) {
+}
+
+LayeredShadowRenderer::~LayeredShadowRenderer() {
+    cleanup();
+}
+
+// ==================== INITIALISATION ====================
+void LayeredShadowRenderer::initialize() {
+    vertexLayerSupported_ = hasExtension("GL_ARB_shader_viewport_layer_array") ||
+                            hasExtension("GL_AMD_vertex_shader_layer");
+    std::cout << "Layered shadows: "
+            << (vertexLayerSupported_ ? "gl_Layer from vertex shader" : "geometry shader fallback")
+            << std::endl;
+}
+
+bool LayeredShadowRenderer::createTarget(int width, int height, int layerCount) {
+    width_ = width;
+    height_ = height;
+    layerCount_ = std::clamp(layerCount, 1, MAX_LAYERS);
+
+    glGenTextures(1, &depthTextureArray_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthTextureArray_);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F, width_, height_, layerCount_);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Attache layered : gl_Layer choisit la couche écrite
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTextureArray_, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (!complete) {
+        std::cerr << "ERROR: Layered shadow framebuffer is not complete!" << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+// ==================== RENDU ====================
+void LayeredShadowRenderer::setLayerMatrices(const float *viewProjMatrices, int layerCount) {
+    layerCount_ = std::clamp(layerCount, 1, MAX_LAYERS);
+    std::memcpy(layerMatrices_.data(), viewProjMatrices, sizeof(float) * 16 * layerCount_);
+}
+
+void LayeredShadowRenderer::beginTargetPass(int viewportWidth, int viewportHeight) const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, std::min(viewportWidth, width_), std::min(viewportHeight, height_));
+    glClearDepth(1.0f);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void LayeredShadowRenderer::endTargetPass() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+int LayeredShadowRenderer::bindProgram(GLuint instanceLocation) {
+    LayeredProgram *layered = getProgram(instanceLocation);
+    if (layered == nullptr) {
+        return 0;
+    }
+
+    // Une seule mise à jour des matrices par soumission, pas par objet
+    glUseProgram(layered->program);
+    boundProgram_ = layered->program;
+    if (layered->layerViewProjLoc >= 0) {
+        glUniformMatrix4fv(layered->layerViewProjLoc, layerCount_, GL_FALSE, layerMatrices_.data());
+    }
+    if (layered->layerCountLoc >= 0) {
+        glUniform1i(layered->layerCountLoc, layerCount_);
+    }
+    return getInstanceMultiplier();
+}
+
+int LayeredShadowRenderer::bindModelProgram() {
+    const int multiplier = bindProgram(UNIFORM_MODEL);
+    const LayeredProgram *layered = multiplier > 0 ? getProgram(UNIFORM_MODEL) : nullptr;
+    modelProgram_ = layered != nullptr ? layered->program : 0;
+    modelMatrixLocation_ = layered != nullptr ? layered->modelLoc : -1;
+    return multiplier;
+}
+
+void LayeredShadowRenderer::drawInstanced(GLuint vao, GLsizei indexCount,
+                                          GLsizei instanceCount, GLuint instanceLocation) {
+    const int multiplier = bindProgram(instanceLocation);
+    if (multiplier == 0 || instanceCount == 0) {
+        return;
+    }
+
+    glBindVertexArray(vao);
+
+    // Mode vertex layer : chaque matrice d'instance est relue pour les N couches
+    if (multiplier > 1) {
+        for (int i = 0; i < 4; ++i) {
+            glVertexAttribDivisor(instanceLocation + i, multiplier);
+        }
+    }
+
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, instanceCount * multiplier);
+
+    if (multiplier > 1) {
+        for (int i = 0; i < 4; ++i) {
+            glVertexAttribDivisor(instanceLocation + i, 1);
+        }
+    }
+
+    glBindVertexArray(0);
+}
+
+// ==================== NETTOYAGE ====================
+void LayeredShadowRenderer::cleanup() {
+    for (const auto &layered: programs_) {
+        glDeleteProgram(layered.program);
+    }
+    programs_.clear();
+    modelProgram_ = 0;
+    boundProgram_ = 0;
+    modelMatrixLocation_ = -1;
+    if (framebuffer_ != 0) {
+        glDeleteFramebuffers(1, &framebuffer_);
+        framebuffer_ = 0;
+    }
+    if (depthTextureArray_ != 0) {
+        glDeleteTextures(1, &depthTextureArray_);
+        depthTextureArray_ = 0;
+    }
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+LayeredShadowRenderer::LayeredProgram *LayeredShadowRenderer::getProgram(GLuint instanceLocation) {
+    for (auto &layered: programs_) {
+        if (layered.instanceLocation == instanceLocation) {
+            return &layered;
+        }
+    }
+
+    // Un programme par location d'instances (les cubes et les modèles n'utilisent pas la même),
+    // plus un pour la matrice modèle en uniform
+    GLuint program = createProgram(instanceLocation);
+    if (program == 0) {
+        return nullptr;
+    }
+
+    programs_.push_back(LayeredProgram{
+        instanceLocation,
+        program,
+        glGetUniformLocation(program, "uLayerViewProj"),
+        glGetUniformLocation(program, "uLayerCount"),
+        glGetUniformLocation(program, "model")
+    });
+    return &programs_.back();
+}
+
+GLuint LayeredShadowRenderer::createProgram(GLuint instanceLocation) const {
+    const std::string header = "#version 430 core\n" +
+                               (instanceLocation == UNIFORM_MODEL
+                                    ? std::string("#define UNIFORM_MODEL\n")
+                                    : "#define INSTANCE_LOCATION " + std::to_string(instanceLocation) + "\n") +
+                               "#define MAX_LAYERS " + std::to_string(MAX_LAYERS) + "\n";
+
+    std::vector<ShaderStageSource> stages;
+    stages.push_back({GL_VERTEX_SHADER, header + (vertexLayerSupported_
+                                                      ? getVertexLayerShader()
+                                                      : getPassThroughVertexShader())});
+    if (!vertexLayerSupported_) {
+        stages.push_back({GL_GEOMETRY_SHADER, header + getLayerGeometryShader()});
+    }
+    stages.push_back({GL_FRAGMENT_SHADER, header + getFragmentShader()});
+    return ProgramCache::createProgram(stages);
+}
+
+bool LayeredShadowRenderer::hasExtension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension != nullptr && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ==================== SHADERS ====================
+std::string LayeredShadowRenderer::getVertexLayerShader() {
+    return R"(
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+
+layout(location = 0) in vec3 aPos;
+#ifdef UNIFORM_MODEL
+uniform mat4 model;
+#define CASTER_MODEL model
+#else
+layout(location = INSTANCE_LOCATION) in mat4 aInstanceModel;
+// Nœud du mesh dans le modèle (Model::DrawDepthInstanced) ; identité pour les autres casters
+uniform mat4 uNodeMatrix = mat4(1.0);
+#define CASTER_MODEL (aInstanceModel * uNodeMatrix)
+#endif
+
+uniform mat4 uLayerViewProj[MAX_LAYERS];
+uniform int uLayerCount;
+
+void main()
+{
+    // Instances = casters x couches ; le divisor = uLayerCount garde la même matrice pour les N couches
+    int layer = gl_InstanceID % uLayerCount;
+    gl_Layer = layer;
+    gl_Position = uLayerViewProj[layer] * CASTER_MODEL * vec4(aPos, 1.0);
+}
+    )";
+}
+
+std::string LayeredShadowRenderer::getPassThroughVertexShader() {
+    return R"(
+layout(location = 0) in vec3 aPos;
+#ifdef UNIFORM_MODEL
+uniform mat4 model;
+#define CASTER_MODEL model
+#else
+layout(location = INSTANCE_LOCATION) in mat4 aInstanceModel;
+uniform mat4 uNodeMatrix = mat4(1.0);
+#define CASTER_MODEL (aInstanceModel * uNodeMatrix)
+#endif
+
+void main()
+{
+    gl_Position = CASTER_MODEL * vec4(aPos, 1.0);
+}
+    )";
+}
+
+std::string LayeredShadowRenderer::getLayerGeometryShader() {
+    return R"(
+layout(triangles, invocations = MAX_LAYERS) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+uniform mat4 uLayerViewProj[MAX_LAYERS];
+uniform int uLayerCount;
+
+void main()
+{
+    if (gl_InvocationID >= uLayerCount) {
+        return;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        gl_Layer = gl_InvocationID;
+        gl_Position = uLayerViewProj[gl_InvocationID] * gl_in[i].gl_Position;
+        EmitVertex();
+    }
+    EndPrimitive();
+}
+    )";
+}
+
+std::string LayeredShadowRenderer::getFragmentShader() {
+    return R"(
+void main()
+{
+    // Profondeur seule
+}
+    )";
+}
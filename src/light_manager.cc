@@ -3,18 +3,81 @@
 //
 
 #include "../include/light_manager.h"
+#include "../include/frame_arena.h"
+#include "../include/matrix_math.h"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <iostream>
+namespace {
+    void copyVec3(float* out, const core::Vec3F& v) {
+        out[0] = v.x;
+        out[1] = v.y;
+        out[2] = v.z;
+    }
+
+    // ==================== CONVERSION VERS STD430 ====================
+    GpuDirectionalLight packDirectionalLight(const Light& light) {
+        GpuDirectionalLight gpu{};
+        copyVec3(gpu.direction, light.direction);
+        gpu.intensity = light.intensity;
+        copyVec3(gpu.color, light.color);
+        gpu.enabled = light.enabled ? 1u : 0u;
+        return gpu;
+    }
+
+    GpuPointLight packPointLight(const PointLight& light, int shadowFace) {
+        GpuPointLight gpu{};
+        copyVec3(gpu.position, light.position);
+        gpu.radius = light.radius;
+        copyVec3(gpu.color, light.color);
+        gpu.intensity = light.intensity;
+        gpu.attenuation[0] = light.constant;
+        gpu.attenuation[1] = light.linear;
+        gpu.attenuation[2] = light.quadratic;
+        gpu.enabled = light.enabled ? 1u : 0u;
+        gpu.shadowFace = shadowFace;
+        return gpu;
+    }
+
+    GpuSpotLight packSpotLight(const SpotLight& light, int shadowFace) {
+        constexpr float degToRad = 3.14159265358979f / 180.0f;
+        GpuSpotLight gpu{};
+        copyVec3(gpu.position, light.position);
+        gpu.cosCutOff = std::cos(light.cutOff * degToRad);
+        copyVec3(gpu.direction, light.direction);
+        gpu.cosOuterCutOff = std::cos(light.outerCutOff * degToRad);
+        copyVec3(gpu.color, light.color);
+        gpu.intensity = light.intensity;
+        gpu.attenuation[0] = light.constant;
+        gpu.attenuation[1] = light.linear;
+        gpu.attenuation[2] = light.quadratic;
+        gpu.enabled = light.enabled ? 1u : 0u;
+        gpu.shadowFace = shadowFace;
+        return gpu;
+    }
+}
+
 // ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
 LightManager::LightManager()
-    : mainLightIndex_(-1),
+    : shadowFaceBuffer_(0),
+      shadowFaceBufferBytes_(0),
+      shadowFacesDirty_(true),
       shadowFramebuffer_(0),
       shadowDepthTexture_(0),
       shadowMapWidth_(2048),
       shadowMapHeight_(2048),
       shadowViewDistance_(50.0f),
       shadowMappingEnabled_(true),
+      shadowFilterMode_(ShadowFilterMode::HARD),
+      shadowMomentsFramebuffer_(0),
+      shadowMomentsTexture_(0),
+      shadowBlurFramebuffer_(0),
+      shadowBlurTexture_(0),
+      lightBleedingReduction_(0.3f),
+      evsmPositiveExponent_(40.0f),
+      evsmNegativeExponent_(5.0f),
+      shadowBlurRadius_(2),
       screenWidth_(800),
       screenHeight_(600) {
     // Initialiser les matrices à l'identité
@@ -38,131 +101,192 @@ void LightManager::initializeShadowMapping(int shadowMapWidth, int shadowMapHeig
     shadowMapWidth_ = shadowMapWidth;
     shadowMapHeight_ = shadowMapHeight;
     createShadowResources();
+    if (shadowFilterMode_ != ShadowFilterMode::HARD) {
+        createMomentsResources();
+    }
 }
 
 // ==================== GESTION DES LUMIÈRES ====================
-int LightManager::addDirectionalLight(const DirectionalLight& light) {
-    auto newLight = std::make_unique<DirectionalLight>(light);
-    int index = lights_.size();
-    lights_.push_back(std::move(newLight));
+LightHandle LightManager::addDirectionalLight(const DirectionalLight& light) {
+    const SlotHandle packed = directionalBuffer_.insert(packDirectionalLight(light));
+    const LightHandle handle = lights_.insert({std::make_unique<DirectionalLight>(light), packed});
 
     // La première lumière directionnelle devient la lumière principale
-    if (mainLightIndex_ == -1) {
-        mainLightIndex_ = index;
+    if (!lights_.contains(mainLight_)) {
+        mainLight_ = handle;
     }
 
-    return index;
+    return handle;
 }
 
-int LightManager::addPointLight(const PointLight& light) {
-    auto newLight = std::make_unique<PointLight>(light);
-    int index = lights_.size();
-    lights_.push_back(std::move(newLight));
-    return index;
+LightHandle LightManager::addPointLight(const PointLight& light) {
+    const SlotHandle packed = pointBuffer_.insert(packPointLight(light, -1));
+    return lights_.insert({std::make_unique<PointLight>(light), packed});
 }
 
-int LightManager::addSpotLight(const SpotLight& light) {
-    auto newLight = std::make_unique<SpotLight>(light);
-    int index = lights_.size();
-    lights_.push_back(std::move(newLight));
-    return index;
+LightHandle LightManager::addSpotLight(const SpotLight& light) {
+    const SlotHandle packed = spotBuffer_.insert(packSpotLight(light, -1));
+    return lights_.insert({std::make_unique<SpotLight>(light), packed});
 }
 
-void LightManager::removeLight(int index) {
-    if (index < 0 || index >= static_cast<int>(lights_.size())) {
+void LightManager::removeLight(LightHandle handle) {
+    const LightRecord* record = lights_.get(handle);
+    if (record == nullptr) {
         return;
     }
 
-    lights_.erase(lights_.begin() + index);
+    shadowAtlas_.releaseLight(record->light.get());
+    switch (record->light->type) {
+        case LightType::DIRECTIONAL: directionalBuffer_.erase(record->packed); break;
+        case LightType::POINT: pointBuffer_.erase(record->packed); break;
+        case LightType::SPOT: spotBuffer_.erase(record->packed); break;
+    }
+    lights_.erase(handle);
 
-    // Ajuster l'index de la lumière principale
-    if (mainLightIndex_ == index) {
-        mainLightIndex_ = -1;
-    } else if (mainLightIndex_ > index) {
-        mainLightIndex_--;
+    if (mainLight_ == handle) {
+        mainLight_ = {};
     }
 }
 
-void LightManager::updateLight(int index, const Light& light) const {
-    if (index < 0 || index >= static_cast<int>(lights_.size())) {
+void LightManager::updateLight(LightHandle handle, const Light& light) {
+    const LightRecord* record = lights_.get(handle);
+    if (record == nullptr) {
         return;
     }
 
-    Light* targetLight = lights_[index].get();
+    Light* targetLight = record->light.get();
     targetLight->position = light.position;
     targetLight->direction = light.direction;
     targetLight->color = light.color;
     targetLight->intensity = light.intensity;
     targetLight->enabled = light.enabled;
+    repackLight(*record);
 }
 
-Light* LightManager::getLight(int index) {
-    if (index < 0 || index >= static_cast<int>(lights_.size())) {
-        return nullptr;
+void LightManager::markLightDirty(LightHandle handle) {
+    if (const LightRecord* record = lights_.get(handle)) {
+        repackLight(*record);
     }
-    return lights_[index].get();
 }
 
-const Light* LightManager::getLight(int index) const {
-    if (index < 0 || index >= static_cast<int>(lights_.size())) {
-        return nullptr;
+Light* LightManager::getLight(LightHandle handle) {
+    LightRecord* record = lights_.get(handle);
+    return record != nullptr ? record->light.get() : nullptr;
+}
+
+const Light* LightManager::getLight(LightHandle handle) const {
+    const LightRecord* record = lights_.get(handle);
+    return record != nullptr ? record->light.get() : nullptr;
+}
+
+// ==================== GESTION PAR LOTS ====================
+void LightManager::addPointLights(const PointLight* lights, std::size_t count, LightHandle* outHandles) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const LightHandle handle = addPointLight(lights[i]);
+        if (outHandles != nullptr) {
+            outHandles[i] = handle;
+        }
+    }
+}
+
+void LightManager::addSpotLights(const SpotLight* lights, std::size_t count, LightHandle* outHandles) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const LightHandle handle = addSpotLight(lights[i]);
+        if (outHandles != nullptr) {
+            outHandles[i] = handle;
+        }
+    }
+}
+
+void LightManager::updatePointLights(const LightHandle* handles, const PointLight* lights, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const LightRecord* record = lights_.get(handles[i]);
+        if (record == nullptr || record->light->type != LightType::POINT) {
+            continue;
+        }
+        *static_cast<PointLight*>(record->light.get()) = lights[i];
+        pointBuffer_.update(record->packed, packPointLight(lights[i], record->shadowFace));
     }
-    return lights_[index].get();
+}
+
+void LightManager::updateSpotLights(const LightHandle* handles, const SpotLight* lights, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const LightRecord* record = lights_.get(handles[i]);
+        if (record == nullptr || record->light->type != LightType::SPOT) {
+            continue;
+        }
+        *static_cast<SpotLight*>(record->light.get()) = lights[i];
+        spotBuffer_.update(record->packed, packSpotLight(lights[i], record->shadowFace));
+    }
+}
+
+void LightManager::reserveLights(std::size_t pointCount, std::size_t spotCount) {
+    lights_.reserve(static_cast<std::size_t>(lights_.size()) + pointCount + spotCount);
+    pointBuffer_.reserve(static_cast<std::size_t>(pointBuffer_.size()) + pointCount);
+    spotBuffer_.reserve(static_cast<std::size_t>(spotBuffer_.size()) + spotCount);
+}
+
+// ==================== BUFFERS GPU (STD430) ====================
+void LightManager::uploadLightBuffers() {
+    directionalBuffer_.upload();
+    pointBuffer_.upload();
+    spotBuffer_.upload();
+    uploadShadowFaces();
+}
+
+void LightManager::bindLightBuffers() const {
+    directionalBuffer_.bind();
+    pointBuffer_.bind();
+    spotBuffer_.bind();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GpuShadowFace::BINDING, shadowFaceBuffer_);
 }
 
 // ==================== LUMIÈRE DIRECTIONNELLE PRINCIPALE ====================
-void LightManager::setMainDirectionalLight(int index) {
-    if (index < 0 || index >= static_cast<int>(lights_.size())) {
+void LightManager::setMainDirectionalLight(LightHandle handle) {
+    const Light* light = getLight(handle);
+    if (light == nullptr) {
         return;
     }
 
-    if (lights_[index]->type == LightType::DIRECTIONAL) {
-        mainLightIndex_ = index;
+    if (light->type == LightType::DIRECTIONAL) {
+        mainLight_ = handle;
     }
 }
 
 Light* LightManager::getMainDirectionalLight() {
-    if (mainLightIndex_ < 0 || mainLightIndex_ >= static_cast<int>(lights_.size())) {
-        return nullptr;
-    }
-    return lights_[mainLightIndex_].get();
+    return getLight(mainLight_);
 }
 
 const Light* LightManager::getMainDirectionalLight() const {
-    if (mainLightIndex_ < 0 || mainLightIndex_ >= static_cast<int>(lights_.size())) {
-        return nullptr;
-    }
-    return lights_[mainLightIndex_].get();
+    return getLight(mainLight_);
 }
 
 // ==================== MATRICES DE LUMIÈRE ====================
 void LightManager::calculateLightMatrices(const core::Vec3F& sceneCenter,
                                          float sceneRadius,
-                                         int lightIndex) {
-    int useIndex = (lightIndex >= 0) ? lightIndex : mainLightIndex_;
-    if (useIndex < 0 || useIndex >= static_cast<int>(lights_.size())) {
+                                         LightHandle handle) {
+    const Light* light = getLight(handle.isNull() ? mainLight_ : handle);
+    if (light == nullptr) {
         return;
     }
 
-    const Light* light = lights_[useIndex].get();
-
     // Position de la caméra de lumière
     core::Vec3F lightPos = sceneCenter - (light->direction * sceneRadius);
 
     // Créer la matrice de vue de la lumière
-    lookAtMatrix(lightViewMatrix_.data(), lightPos, sceneCenter, {0.0f, 1.0f, 0.0f});
+    MatrixMath::lookAt(lightViewMatrix_.data(), lightPos, sceneCenter, {0.0f, 1.0f, 0.0f});
 
     // Créer la matrice de projection orthographique
     float distance = shadowViewDistance_;
-    orthographicMatrix(lightProjectionMatrix_.data(),
-                       -distance, distance,
-                       -distance, distance,
-                       0.1f, distance * 2.0f);
+    MatrixMath::orthographic(lightProjectionMatrix_.data(),
+                             -distance, distance,
+                             -distance, distance,
+                             0.1f, distance * 2.0f);
 
     // Multiplier pour obtenir la matrice d'espace de lumière
-    multiplyMat4(lightSpaceMatrix_.data(),
-                lightProjectionMatrix_.data(),
-                lightViewMatrix_.data());
+    MatrixMath::multiply(lightSpaceMatrix_.data(),
+                         lightProjectionMatrix_.data(),
+                         lightViewMatrix_.data());
 }
 
 void LightManager::getLightProjectionMatrix(float* out) const {
@@ -190,13 +314,58 @@ const core::Vec3F& LightManager::getMainLightDirection() const {
 }
 
 // ==================== SHADOW MAPPING ====================
-void LightManager::bindShadowFramebuffer() const {
+void LightManager::bindShadowFramebuffer(bool clear) const {
     if (shadowFramebuffer_ == 0) {
         return;
     }
     glBindFramebuffer(GL_FRAMEBUFFER, shadowFramebuffer_);
     glViewport(0, 0, shadowMapWidth_, shadowMapHeight_);
-    glClear(GL_DEPTH_BUFFER_BIT);
+    if (clear) {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+}
+
+// ==================== FILTRAGE DES OMBRES (VSM / EVSM) ====================
+void LightManager::setShadowFilterMode(ShadowFilterMode mode) {
+    if (mode == shadowFilterMode_ && (mode == ShadowFilterMode::HARD || shadowMomentsTexture_ != 0)) {
+        return;
+    }
+    shadowFilterMode_ = mode;
+
+    // Le format des moments dépend du mode (2 canaux VSM, 4 canaux EVSM)
+    deleteMomentsResources();
+    if (mode != ShadowFilterMode::HARD && shadowFramebuffer_ != 0) {
+        createMomentsResources();
+    }
+}
+
+void LightManager::bindShadowMomentsFramebuffer() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowMomentsFramebuffer_);
+    glViewport(0, 0, shadowMapWidth_, shadowMapHeight_);
+}
+
+void LightManager::bindShadowBlurFramebuffer() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowBlurFramebuffer_);
+    glViewport(0, 0, shadowMapWidth_, shadowMapHeight_);
+}
+
+// ==================== ATLAS D'OMBRES (POINT / SPOT) ====================
+void LightManager::initializeShadowAtlas(int atlasSize, int minTileSize, int maxTileSize) {
+    shadowAtlas_.initialize(atlasSize, minTileSize, maxTileSize);
+}
+
+void LightManager::updateShadowAtlas(const core::Vec3F& cameraPosition, float cameraFovY,
+                                     int screenHeight, std::uint64_t sceneVersion) {
+    // Les adresses des lumières sont stables (unique_ptr) : elles servent d'identité dans l'atlas
+    std::pmr::vector<const Light*> shadowLights(&FrameArena::forThread());
+    for (const LightRecord& record : lights_) {
+        const Light* light = record.light.get();
+        if (light->enabled && (light->type == LightType::POINT || light->type == LightType::SPOT)) {
+            shadowLights.push_back(light);
+        }
+    }
+    shadowAtlas_.update(shadowLights, cameraPosition, cameraFovY, screenHeight, sceneVersion);
+    updateShadowFaces();
 }
 
 void LightManager::unbindShadowFramebuffer() const {
@@ -213,7 +382,23 @@ void LightManager::cleanup() {
         glDeleteTextures(1, &shadowDepthTexture_);
         shadowDepthTexture_ = 0;
     }
+    shadowAtlas_.cleanup();
+    deleteMomentsResources();
     lights_.clear();
+    mainLight_ = {};
+    directionalBuffer_.clear();
+    pointBuffer_.clear();
+    spotBuffer_.clear();
+    directionalBuffer_.cleanup();
+    pointBuffer_.cleanup();
+    spotBuffer_.cleanup();
+    shadowFaces_.clear();
+    if (shadowFaceBuffer_ != 0) {
+        glDeleteBuffers(1, &shadowFaceBuffer_);
+        shadowFaceBuffer_ = 0;
+    }
+    shadowFaceBufferBytes_ = 0;
+    shadowFacesDirty_ = true;
 }
 
 // ==================== MÉTHODES PRIVÉES ====================
@@ -221,7 +406,8 @@ void LightManager::createShadowResources() {
     // Créer la texture de profondeur
     glGenTextures(1, &shadowDepthTexture_);
     glBindTexture(GL_TEXTURE_2D, shadowDepthTexture_);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
+    // Format explicite : la couche statique du ShadowCache est copiée dedans
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F,
                 shadowMapWidth_, shadowMapHeight_, 0,
                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -246,65 +432,162 @@ void LightManager::createShadowResources() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void LightManager::multiplyMat4(float* out, const float* a, const float* b) {
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            out[i * 4 + j] = 0.0f;
-            for (int k = 0; k < 4; ++k) {
-                out[i * 4 + j] += a[i * 4 + k] * b[k * 4 + j];
-            }
-        }
+void LightManager::createMomentsResources() {
+    const GLenum format = shadowFilterMode_ == ShadowFilterMode::EVSM ? GL_RGBA32F : GL_RG32F;
+    int levels = 1;
+    while ((std::max(shadowMapWidth_, shadowMapHeight_) >> levels) > 0) {
+        levels++;
+    }
+
+    // Moments filtrables : trilinéaire + mipmaps, la pénombre vient d'un seul fetch matériel
+    glGenTextures(1, &shadowMomentsTexture_);
+    glBindTexture(GL_TEXTURE_2D, shadowMomentsTexture_);
+    glTexStorage2D(GL_TEXTURE_2D, levels, format, shadowMapWidth_, shadowMapHeight_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Cible intermédiaire du flou séparable (passe horizontale)
+    glGenTextures(1, &shadowBlurTexture_);
+    glBindTexture(GL_TEXTURE_2D, shadowBlurTexture_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, format, shadowMapWidth_, shadowMapHeight_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &shadowMomentsFramebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowMomentsFramebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                          GL_TEXTURE_2D, shadowMomentsTexture_, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Shadow moments framebuffer is not complete!" << std::endl;
+    }
+
+    glGenFramebuffers(1, &shadowBlurFramebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowBlurFramebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                          GL_TEXTURE_2D, shadowBlurTexture_, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Shadow blur framebuffer is not complete!" << std::endl;
     }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void LightManager::orthographicMatrix(float* out,
-                                     float left, float right,
-                                     float bottom, float top,
-                                     float near, float far) {
-    // Initialiser à zéro
-    for (int i = 0; i < 16; ++i) {
-        out[i] = 0.0f;
+void LightManager::deleteMomentsResources() {
+    if (shadowMomentsFramebuffer_ != 0) {
+        glDeleteFramebuffers(1, &shadowMomentsFramebuffer_);
+        shadowMomentsFramebuffer_ = 0;
+    }
+    if (shadowBlurFramebuffer_ != 0) {
+        glDeleteFramebuffers(1, &shadowBlurFramebuffer_);
+        shadowBlurFramebuffer_ = 0;
+    }
+    if (shadowMomentsTexture_ != 0) {
+        glDeleteTextures(1, &shadowMomentsTexture_);
+        shadowMomentsTexture_ = 0;
+    }
+    if (shadowBlurTexture_ != 0) {
+        glDeleteTextures(1, &shadowBlurTexture_);
+        shadowBlurTexture_ = 0;
+    }
+}
+
+void LightManager::repackLight(const LightRecord& record) {
+    const Light& light = *record.light;
+    switch (light.type) {
+        case LightType::DIRECTIONAL:
+            directionalBuffer_.update(record.packed, packDirectionalLight(light));
+            break;
+        case LightType::POINT:
+            pointBuffer_.update(record.packed, packPointLight(static_cast<const PointLight&>(light), record.shadowFace));
+            break;
+        case LightType::SPOT:
+            spotBuffer_.update(record.packed, packSpotLight(static_cast<const SpotLight&>(light), record.shadowFace));
+            break;
+    }
+}
+
+void LightManager::updateShadowFaces() {
+    const std::vector<ShadowAtlasEntry>& entries = shadowAtlas_.getEntries();
+    std::pmr::vector<int> firstFaces(entries.size(), -1, &FrameArena::forThread());
+
+    // Faces des entrées qui ont une tuile, dans l'ordre de l'atlas
+    std::size_t faceCount = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].hasShadow()) {
+            firstFaces[i] = static_cast<int>(faceCount);
+            faceCount += static_cast<std::size_t>(entries[i].faceCount);
+        }
+    }
+    if (faceCount != shadowFaces_.size()) {
+        shadowFaces_.resize(faceCount);
+        shadowFacesDirty_ = true;
+    }
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const ShadowAtlasEntry& entry = entries[i];
+        for (int face = 0; firstFaces[i] >= 0 && face < entry.faceCount; ++face) {
+            GpuShadowFace gpu{};
+            std::memcpy(gpu.viewProj, entry.viewProjMatrices[face].data(), sizeof(gpu.viewProj));
+            shadowAtlas_.getTileUVTransform(entry.tiles[face], gpu.tileTransform);
+
+            GpuShadowFace& current = shadowFaces_[firstFaces[i] + face];
+            if (std::memcmp(&current, &gpu, sizeof(gpu)) != 0) {
+                current = gpu;
+                shadowFacesDirty_ = true;
+            }
+        }
     }
 
-    float width = right - left;
-    float height = top - bottom;
-    float depth = far - near;
+    // Une lumière n'est re-empaquetée que si sa première face change
+    bool lightsChanged = false;
+    for (LightRecord& record : lights_) {
+        if (record.light->type == LightType::DIRECTIONAL) {
+            continue;
+        }
+        const ShadowAtlasEntry* entry = shadowAtlas_.getEntry(record.light.get());
+        const int shadowFace = entry != nullptr ? firstFaces[entry - entries.data()] : -1;
+        if (shadowFace != record.shadowFace) {
+            record.shadowFace = shadowFace;
+            repackLight(record);
+            lightsChanged = true;
+        }
+    }
 
-    out[0] = 2.0f / width;
-    out[5] = 2.0f / height;
-    out[10] = -2.0f / depth;
-    out[12] = -(right + left) / width;
-    out[13] = -(top + bottom) / height;
-    out[14] = -(far + near) / depth;
-    out[15] = 1.0f;
+    // L'éclairage de cette frame lit déjà les nouvelles tuiles
+    if (lightsChanged) {
+        pointBuffer_.upload();
+        spotBuffer_.upload();
+    }
+    uploadShadowFaces();
 }
 
-void LightManager::lookAtMatrix(float* out,
-                               const core::Vec3F& eye,
-                               const core::Vec3F& center,
-                               const core::Vec3F& up) {
-    // Calculer les vecteurs de la base
-    core::Vec3F f = (center - eye).Normalize();
-    core::Vec3F s = f.Cross(up).Normalize();
-    core::Vec3F u = s.Cross(f).Normalize();
+void LightManager::uploadShadowFaces() {
+    if (!shadowFacesDirty_) {
+        return;
+    }
+    if (shadowFaceBuffer_ == 0) {
+        glGenBuffers(1, &shadowFaceBuffer_);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, shadowFaceBuffer_);
+
+    // Même disposition que les tableaux de lumières : le nombre, puis les faces à l'offset 16
+    const std::size_t bytes = sizeof(GpuLightHeader) + shadowFaces_.size() * sizeof(GpuShadowFace);
+    if (bytes > shadowFaceBufferBytes_) {
+        shadowFaceBufferBytes_ = std::max(bytes, shadowFaceBufferBytes_ * 2);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(shadowFaceBufferBytes_), nullptr, GL_DYNAMIC_DRAW);
+    }
 
-    // Initialiser la matrice
-    for (int i = 0; i < 16; ++i) {
-        out[i] = 0.0f;
-    }
-
-    out[0] = s.x;
-    out[4] = s.y;
-    out[8] = s.z;
-    out[1] = u.x;
-    out[5] = u.y;
-    out[9] = u.z;
-    out[2] = -f.x;
-    out[6] = -f.y;
-    out[10] = -f.z;
-    out[15] = 1.0f;
-
-    out[12] = -(s.x * eye.x + s.y * eye.y + s.z * eye.z);
-    out[13] = -(u.x * eye.x + u.y * eye.y + u.z * eye.z);
-    out[14] = f.x * eye.x + f.y * eye.y + f.z * eye.z;
+    const GpuLightHeader header{static_cast<std::uint32_t>(shadowFaces_.size()), {0, 0, 0}};
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), &header);
+    if (!shadowFaces_.empty()) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(header),
+                        static_cast<GLsizeiptr>(shadowFaces_.size() * sizeof(GpuShadowFace)), shadowFaces_.data());
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    shadowFacesDirty_ = false;
 }
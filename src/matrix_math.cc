@@ -0,0 +1,657 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/matrix_math.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MATRIX_MATH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC autorise les intrinsèques AVX2 sans option de compilation
+#define MATRIX_MATH_AVX2
+#else
+#define MATRIX_MATH_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define MATRIX_MATH_X86 0
+#endif
+
+namespace {
+    // ==================== NOYAUX SCALAIRES ====================
+    // Référence et repli hors x86 : même résultat que les anciennes boucles, sans la boucle interne
+
+    void multiplyScalar(float *out, const float *a, const float *b) {
+        float result[16];
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                result[c * 4 + r] = a[r] * b[c * 4] +
+                                    a[4 + r] * b[c * 4 + 1] +
+                                    a[8 + r] * b[c * 4 + 2] +
+                                    a[12 + r] * b[c * 4 + 3];
+            }
+        }
+        std::memcpy(out, result, sizeof(result));
+    }
+
+    void transposeScalar(float *out, const float *m) {
+        float result[16];
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                result[r * 4 + c] = m[c * 4 + r];
+            }
+        }
+        std::memcpy(out, result, sizeof(result));
+    }
+
+    bool inverseScalar(float *out, const float *m) {
+        // Cofacteurs développés (la transposée de la comatrice, directement en column-major)
+        float inv[16];
+        inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] +
+                 m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+        inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] -
+                 m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+        inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] +
+                 m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+        inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] -
+                  m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+        inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] -
+                 m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+        inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] +
+                 m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+        inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] -
+                 m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+        inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] +
+                  m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+        inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] +
+                 m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+        inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] -
+                 m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+        inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] +
+                  m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+        inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] -
+                  m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+        inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] -
+                 m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+        inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] +
+                 m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+        inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] -
+                  m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+        inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] +
+                  m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+        const float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+        if (det == 0.0f) {
+            MatrixMath::identity(out);
+            return false;
+        }
+
+        const float invDet = 1.0f / det;
+        for (int i = 0; i < 16; ++i) {
+            out[i] = inv[i] * invDet;
+        }
+        return true;
+    }
+
+    void multiplyBatchScalar(float *out, const float *m, const float *in, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            multiplyScalar(out + i * 16, m, in + i * 16);
+        }
+    }
+
+    void transformPointsScalar(float *out, const float *m, const float *in, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const float x = in[i * 3];
+            const float y = in[i * 3 + 1];
+            const float z = in[i * 3 + 2];
+            for (int r = 0; r < 3; ++r) {
+                out[i * 3 + r] = m[r] * x + m[4 + r] * y + m[8 + r] * z + m[12 + r];
+            }
+        }
+    }
+
+    void transformAabbsScalar(Aabb *outBounds, const float *matrices, const Aabb *localBounds,
+                              std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *m = matrices + i * 16;
+            const Aabb &local = localBounds[i];
+            float c[3], e[3];
+            for (int k = 0; k < 3; ++k) {
+                c[k] = (local.min[k] + local.max[k]) * 0.5f;
+                e[k] = (local.max[k] - local.min[k]) * 0.5f;
+            }
+            // Centre transformé, demi-extents projetés par |M|
+            for (int r = 0; r < 3; ++r) {
+                const float center = m[r] * c[0] + m[4 + r] * c[1] + m[8 + r] * c[2] + m[12 + r];
+                const float extent = std::abs(m[r]) * e[0] + std::abs(m[4 + r]) * e[1] + std::abs(m[8 + r]) * e[2];
+                outBounds[i].min[r] = center - extent;
+                outBounds[i].max[r] = center + extent;
+            }
+        }
+    }
+
+#if MATRIX_MATH_X86
+    // ==================== NOYAUX SSE ====================
+    // SSE2 fait partie de x86-64 : toujours disponible sur cette architecture
+
+    __m128 load3(const float *p) {
+        return _mm_setr_ps(p[0], p[1], p[2], 0.0f);
+    }
+
+    // Écrit xyz sans toucher au float suivant (le tableau peut être transformé sur place)
+    void store3(float *p, __m128 v) {
+        _mm_storel_pi(reinterpret_cast<__m64 *>(p), v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+
+    __m128 abs4(__m128 v) {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+    }
+
+    // a0..a3 : colonnes de a ; b : une colonne de b
+    __m128 linearCombination(__m128 a0, __m128 a1, __m128 a2, __m128 a3, __m128 b) {
+        __m128 result = _mm_mul_ps(a0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+        result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+        result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+        result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+        return result;
+    }
+
+    void multiplySSE(float *out, const float *a, const float *b) {
+        const __m128 a0 = _mm_loadu_ps(a);
+        const __m128 a1 = _mm_loadu_ps(a + 4);
+        const __m128 a2 = _mm_loadu_ps(a + 8);
+        const __m128 a3 = _mm_loadu_ps(a + 12);
+        const __m128 b0 = _mm_loadu_ps(b);
+        const __m128 b1 = _mm_loadu_ps(b + 4);
+        const __m128 b2 = _mm_loadu_ps(b + 8);
+        const __m128 b3 = _mm_loadu_ps(b + 12);
+        // Toutes les lectures avant les écritures : out peut désigner a ou b
+        _mm_storeu_ps(out, linearCombination(a0, a1, a2, a3, b0));
+        _mm_storeu_ps(out + 4, linearCombination(a0, a1, a2, a3, b1));
+        _mm_storeu_ps(out + 8, linearCombination(a0, a1, a2, a3, b2));
+        _mm_storeu_ps(out + 12, linearCombination(a0, a1, a2, a3, b3));
+    }
+
+    void transposeSSE(float *out, const float *m) {
+        __m128 c0 = _mm_loadu_ps(m);
+        __m128 c1 = _mm_loadu_ps(m + 4);
+        __m128 c2 = _mm_loadu_ps(m + 8);
+        __m128 c3 = _mm_loadu_ps(m + 12);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        _mm_storeu_ps(out, c0);
+        _mm_storeu_ps(out + 4, c1);
+        _mm_storeu_ps(out + 8, c2);
+        _mm_storeu_ps(out + 12, c3);
+    }
+
+    // Produits de matrices 2x2 rangées (x y / z w) dans un registre
+    __m128 mat2Mul(__m128 a, __m128 b) {
+        return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+
+    // adj(a) * b
+    __m128 mat2AdjMul(__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    // a * adj(b)
+    __m128 mat2MulAdj(__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+
+    bool inverseSSE(float *out, const float *m) {
+        // Inversion par blocs 2x2 : M = |A B| -> déterminants et adjointes des sous-blocs.
+        //                                |C D|
+        // Les colonnes sont traitées comme des lignes : on inverse M^T, dont les lignes
+        // sont les colonnes de M^-1, ce qui donne directement le résultat en column-major.
+        const __m128 c0 = _mm_loadu_ps(m);
+        const __m128 c1 = _mm_loadu_ps(m + 4);
+        const __m128 c2 = _mm_loadu_ps(m + 8);
+        const __m128 c3 = _mm_loadu_ps(m + 12);
+
+        const __m128 A = _mm_movelh_ps(c0, c1);
+        const __m128 B = _mm_movehl_ps(c1, c0);
+        const __m128 C = _mm_movelh_ps(c2, c3);
+        const __m128 D = _mm_movehl_ps(c3, c2);
+
+        // (|A| |B| |C| |D|)
+        const __m128 detSub = _mm_sub_ps(
+            _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+            _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+        const __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+        const __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+        const __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+        const __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+        const __m128 dc = mat2AdjMul(D, C);
+        const __m128 ab = mat2AdjMul(A, B);
+        __m128 x = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, dc));
+        __m128 w = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, ab));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, ab));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, dc));
+
+        // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 trace = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+        trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+        trace = _mm_add_ss(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 1, 1, 1)));
+        const float det = _mm_cvtss_f32(detA) * _mm_cvtss_f32(detD) +
+                          _mm_cvtss_f32(detB) * _mm_cvtss_f32(detC) - _mm_cvtss_f32(trace);
+        if (det == 0.0f) {
+            MatrixMath::identity(out);
+            return false;
+        }
+
+        const __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), _mm_set1_ps(det));
+        x = _mm_mul_ps(x, invDet);
+        y = _mm_mul_ps(y, invDet);
+        z = _mm_mul_ps(z, invDet);
+        w = _mm_mul_ps(w, invDet);
+
+        // Adjointe des blocs et remise en place fusionnées dans les shuffles
+        _mm_storeu_ps(out, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+        _mm_storeu_ps(out + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+        return true;
+    }
+
+    void multiplyBatchSSE(float *out, const float *m, const float *in, std::size_t count) {
+        const __m128 m0 = _mm_loadu_ps(m);
+        const __m128 m1 = _mm_loadu_ps(m + 4);
+        const __m128 m2 = _mm_loadu_ps(m + 8);
+        const __m128 m3 = _mm_loadu_ps(m + 12);
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *b = in + i * 16;
+            float *o = out + i * 16;
+            const __m128 b0 = _mm_loadu_ps(b);
+            const __m128 b1 = _mm_loadu_ps(b + 4);
+            const __m128 b2 = _mm_loadu_ps(b + 8);
+            const __m128 b3 = _mm_loadu_ps(b + 12);
+            _mm_storeu_ps(o, linearCombination(m0, m1, m2, m3, b0));
+            _mm_storeu_ps(o + 4, linearCombination(m0, m1, m2, m3, b1));
+            _mm_storeu_ps(o + 8, linearCombination(m0, m1, m2, m3, b2));
+            _mm_storeu_ps(o + 12, linearCombination(m0, m1, m2, m3, b3));
+        }
+    }
+
+    void transformPointsSSE(float *out, const float *m, const float *in, std::size_t count) {
+        const __m128 m0 = _mm_loadu_ps(m);
+        const __m128 m1 = _mm_loadu_ps(m + 4);
+        const __m128 m2 = _mm_loadu_ps(m + 8);
+        const __m128 m3 = _mm_loadu_ps(m + 12);
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *p = in + i * 3;
+            __m128 result = _mm_add_ps(m3, _mm_mul_ps(m0, _mm_set1_ps(p[0])));
+            result = _mm_add_ps(result, _mm_mul_ps(m1, _mm_set1_ps(p[1])));
+            result = _mm_add_ps(result, _mm_mul_ps(m2, _mm_set1_ps(p[2])));
+            store3(out + i * 3, result);
+        }
+    }
+
+    void transformAabbsSSE(Aabb *outBounds, const float *matrices, const Aabb *localBounds,
+                           std::size_t count) {
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 unitW = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *m = matrices + i * 16;
+            const __m128 m0 = _mm_loadu_ps(m);
+            const __m128 m1 = _mm_loadu_ps(m + 4);
+            const __m128 m2 = _mm_loadu_ps(m + 8);
+            const __m128 m3 = _mm_loadu_ps(m + 12);
+
+            const __m128 lo = load3(localBounds[i].min);
+            const __m128 hi = load3(localBounds[i].max);
+            const __m128 c = _mm_mul_ps(_mm_add_ps(lo, hi), half);
+            const __m128 e = _mm_mul_ps(_mm_sub_ps(hi, lo), half);
+
+            // w = 1 : le centre est un point, la translation s'applique
+            const __m128 center = linearCombination(m0, m1, m2, m3, _mm_add_ps(c, unitW));
+            __m128 extent = _mm_mul_ps(abs4(m0), _mm_shuffle_ps(e, e, _MM_SHUFFLE(0, 0, 0, 0)));
+            extent = _mm_add_ps(extent, _mm_mul_ps(abs4(m1), _mm_shuffle_ps(e, e, _MM_SHUFFLE(1, 1, 1, 1))));
+            extent = _mm_add_ps(extent, _mm_mul_ps(abs4(m2), _mm_shuffle_ps(e, e, _MM_SHUFFLE(2, 2, 2, 2))));
+
+            store3(outBounds[i].min, _mm_sub_ps(center, extent));
+            store3(outBounds[i].max, _mm_add_ps(center, extent));
+        }
+    }
+
+    // ==================== NOYAUX AVX2 ====================
+    // Deux colonnes (ou deux éléments d'un lot) par registre 256 bits, une moitié chacun
+
+    MATRIX_MATH_AVX2 __m256 broadcastColumn(const float *p) {
+        return _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(p));
+    }
+
+    // Deux colonnes de sortie : a0..a3 dupliquées dans les deux moitiés, b = deux colonnes de b
+    MATRIX_MATH_AVX2 __m256 linearCombination2(__m256 a0, __m256 a1, __m256 a2, __m256 a3, __m256 b) {
+        __m256 result = _mm256_mul_ps(a0, _mm256_permute_ps(b, _MM_SHUFFLE(0, 0, 0, 0)));
+        result = _mm256_fmadd_ps(a1, _mm256_permute_ps(b, _MM_SHUFFLE(1, 1, 1, 1)), result);
+        result = _mm256_fmadd_ps(a2, _mm256_permute_ps(b, _MM_SHUFFLE(2, 2, 2, 2)), result);
+        result = _mm256_fmadd_ps(a3, _mm256_permute_ps(b, _MM_SHUFFLE(3, 3, 3, 3)), result);
+        return result;
+    }
+
+    MATRIX_MATH_AVX2 void multiplyAVX2(float *out, const float *a, const float *b) {
+        const __m256 a0 = broadcastColumn(a);
+        const __m256 a1 = broadcastColumn(a + 4);
+        const __m256 a2 = broadcastColumn(a + 8);
+        const __m256 a3 = broadcastColumn(a + 12);
+        const __m256 b01 = _mm256_loadu_ps(b);
+        const __m256 b23 = _mm256_loadu_ps(b + 8);
+        _mm256_storeu_ps(out, linearCombination2(a0, a1, a2, a3, b01));
+        _mm256_storeu_ps(out + 8, linearCombination2(a0, a1, a2, a3, b23));
+    }
+
+    MATRIX_MATH_AVX2 void multiplyBatchAVX2(float *out, const float *m, const float *in, std::size_t count) {
+        const __m256 m0 = broadcastColumn(m);
+        const __m256 m1 = broadcastColumn(m + 4);
+        const __m256 m2 = broadcastColumn(m + 8);
+        const __m256 m3 = broadcastColumn(m + 12);
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *b = in + i * 16;
+            float *o = out + i * 16;
+            const __m256 b01 = _mm256_loadu_ps(b);
+            const __m256 b23 = _mm256_loadu_ps(b + 8);
+            _mm256_storeu_ps(o, linearCombination2(m0, m1, m2, m3, b01));
+            _mm256_storeu_ps(o + 8, linearCombination2(m0, m1, m2, m3, b23));
+        }
+    }
+
+    MATRIX_MATH_AVX2 __m256 broadcastPair(float low, float high) {
+        return _mm256_set_m128(_mm_set1_ps(high), _mm_set1_ps(low));
+    }
+
+    MATRIX_MATH_AVX2 void transformPointsAVX2(float *out, const float *m, const float *in, std::size_t count) {
+        const __m256 m0 = broadcastColumn(m);
+        const __m256 m1 = broadcastColumn(m + 4);
+        const __m256 m2 = broadcastColumn(m + 8);
+        const __m256 m3 = broadcastColumn(m + 12);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const float *p = in + i * 3;
+            __m256 result = _mm256_fmadd_ps(m0, broadcastPair(p[0], p[3]), m3);
+            result = _mm256_fmadd_ps(m1, broadcastPair(p[1], p[4]), result);
+            result = _mm256_fmadd_ps(m2, broadcastPair(p[2], p[5]), result);
+            store3(out + i * 3, _mm256_castps256_ps128(result));
+            store3(out + i * 3 + 3, _mm256_extractf128_ps(result, 1));
+        }
+        if (i < count) {
+            transformPointsSSE(out + i * 3, m, in + i * 3, count - i);
+        }
+    }
+
+    MATRIX_MATH_AVX2 __m256 loadColumnPair(const float *low, const float *high) {
+        return _mm256_loadu2_m128(high, low);
+    }
+
+    MATRIX_MATH_AVX2 void transformAabbsAVX2(Aabb *outBounds, const float *matrices, const Aabb *localBounds,
+                                             std::size_t count) {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const float *ma = matrices + i * 16;
+            const float *mb = ma + 16;
+            const __m256 m0 = loadColumnPair(ma, mb);
+            const __m256 m1 = loadColumnPair(ma + 4, mb + 4);
+            const __m256 m2 = loadColumnPair(ma + 8, mb + 8);
+            const __m256 m3 = loadColumnPair(ma + 12, mb + 12);
+
+            const Aabb &a = localBounds[i];
+            const Aabb &b = localBounds[i + 1];
+            const __m256 lo = _mm256_setr_ps(a.min[0], a.min[1], a.min[2], 0.0f, b.min[0], b.min[1], b.min[2], 0.0f);
+            const __m256 hi = _mm256_setr_ps(a.max[0], a.max[1], a.max[2], 0.0f, b.max[0], b.max[1], b.max[2], 0.0f);
+            const __m256 c = _mm256_mul_ps(_mm256_add_ps(lo, hi), half);
+            const __m256 e = _mm256_mul_ps(_mm256_sub_ps(hi, lo), half);
+
+            __m256 center = _mm256_fmadd_ps(m0, _mm256_permute_ps(c, _MM_SHUFFLE(0, 0, 0, 0)), m3);
+            center = _mm256_fmadd_ps(m1, _mm256_permute_ps(c, _MM_SHUFFLE(1, 1, 1, 1)), center);
+            center = _mm256_fmadd_ps(m2, _mm256_permute_ps(c, _MM_SHUFFLE(2, 2, 2, 2)), center);
+            __m256 extent = _mm256_mul_ps(_mm256_andnot_ps(signMask, m0), _mm256_permute_ps(e, _MM_SHUFFLE(0, 0, 0, 0)));
+            extent = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, m1), _mm256_permute_ps(e, _MM_SHUFFLE(1, 1, 1, 1)), extent);
+            extent = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, m2), _mm256_permute_ps(e, _MM_SHUFFLE(2, 2, 2, 2)), extent);
+
+            const __m256 outMin = _mm256_sub_ps(center, extent);
+            const __m256 outMax = _mm256_add_ps(center, extent);
+            store3(outBounds[i].min, _mm256_castps256_ps128(outMin));
+            store3(outBounds[i].max, _mm256_castps256_ps128(outMax));
+            store3(outBounds[i + 1].min, _mm256_extractf128_ps(outMin, 1));
+            store3(outBounds[i + 1].max, _mm256_extractf128_ps(outMax, 1));
+        }
+        if (i < count) {
+            transformAabbsSSE(outBounds + i, matrices + i * 16, localBounds + i, count - i);
+        }
+    }
+
+    bool cpuSupportsAVX2() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool fma = (info[2] & (1 << 12)) != 0;
+        if (!osxsave || !fma) return false;
+        // Registres YMM sauvegardés par le système
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+#endif
+
+    // ==================== DISPATCH ====================
+    struct Kernels {
+        MatrixMath::InstructionSet set;
+        void (*multiply)(float *, const float *, const float *);
+        void (*transpose)(float *, const float *);
+        bool (*inverse)(float *, const float *);
+        void (*multiplyBatch)(float *, const float *, const float *, std::size_t);
+        void (*transformPoints)(float *, const float *, const float *, std::size_t);
+        void (*transformAabbs)(Aabb *, const float *, const Aabb *, std::size_t);
+    };
+
+    Kernels makeKernels(MatrixMath::InstructionSet set) {
+#if MATRIX_MATH_X86
+        if (set == MatrixMath::InstructionSet::AVX2) {
+            // L'inversion par blocs n'utilise que des registres 128 bits : pas de variante AVX2
+            return {set, multiplyAVX2, transposeSSE, inverseSSE, multiplyBatchAVX2, transformPointsAVX2,
+                    transformAabbsAVX2};
+        }
+        if (set == MatrixMath::InstructionSet::SSE) {
+            return {set, multiplySSE, transposeSSE, inverseSSE, multiplyBatchSSE, transformPointsSSE,
+                    transformAabbsSSE};
+        }
+#endif
+        return {MatrixMath::InstructionSet::Scalar, multiplyScalar, transposeScalar, inverseScalar,
+                multiplyBatchScalar, transformPointsScalar, transformAabbsScalar};
+    }
+
+    Kernels &activeKernels() {
+        // Détection une seule fois, au premier appel
+        static Kernels kernels = makeKernels(MatrixMath::getSupportedInstructionSet());
+        return kernels;
+    }
+}
+
+// ==================== DISPATCH ====================
+MatrixMath::InstructionSet MatrixMath::getInstructionSet() {
+    return activeKernels().set;
+}
+
+MatrixMath::InstructionSet MatrixMath::getSupportedInstructionSet() {
+#if MATRIX_MATH_X86
+    static const InstructionSet supported = cpuSupportsAVX2() ? InstructionSet::AVX2 : InstructionSet::SSE;
+    return supported;
+#else
+    return InstructionSet::Scalar;
+#endif
+}
+
+void MatrixMath::setInstructionSet(InstructionSet set) {
+    const InstructionSet supported = getSupportedInstructionSet();
+    activeKernels() = makeKernels(static_cast<int>(set) > static_cast<int>(supported) ? supported : set);
+}
+
+const char *MatrixMath::getInstructionSetName(InstructionSet set) {
+    switch (set) {
+        case InstructionSet::AVX2:
+            return "AVX2";
+        case InstructionSet::SSE:
+            return "SSE";
+        default:
+            return "Scalar";
+    }
+}
+
+// ==================== CONSTRUCTION ====================
+void MatrixMath::identity(float *out) {
+    for (int i = 0; i < 16; ++i) {
+        out[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+}
+
+void MatrixMath::translation(float *out, float x, float y, float z) {
+    identity(out);
+    out[12] = x;
+    out[13] = y;
+    out[14] = z;
+}
+
+void MatrixMath::scaling(float *out, float x, float y, float z) {
+    identity(out);
+    out[0] = x;
+    out[5] = y;
+    out[10] = z;
+}
+
+void MatrixMath::composeTRS(float *out, const core::Vec3F &position, const core::Vec3F &rotation,
+                            const core::Vec3F &scale) {
+    const float cx = std::cos(rotation.x), sx = std::sin(rotation.x);
+    const float cy = std::cos(rotation.y), sy = std::sin(rotation.y);
+    const float cz = std::cos(rotation.z), sz = std::sin(rotation.z);
+
+    // Colonnes de Rz * Ry * Rx, chacune multipliée par l'échelle de son axe
+    out[0] = cz * cy * scale.x;
+    out[1] = sz * cy * scale.x;
+    out[2] = -sy * scale.x;
+    out[3] = 0.0f;
+
+    out[4] = (cz * sy * sx - sz * cx) * scale.y;
+    out[5] = (sz * sy * sx + cz * cx) * scale.y;
+    out[6] = cy * sx * scale.y;
+    out[7] = 0.0f;
+
+    out[8] = (cz * sy * cx + sz * sx) * scale.z;
+    out[9] = (sz * sy * cx - cz * sx) * scale.z;
+    out[10] = cy * cx * scale.z;
+    out[11] = 0.0f;
+
+    out[12] = position.x;
+    out[13] = position.y;
+    out[14] = position.z;
+    out[15] = 1.0f;
+}
+
+// ==================== CAMÉRA ====================
+void MatrixMath::lookAt(float *out, const core::Vec3F &eye, const core::Vec3F &center, const core::Vec3F &up) {
+    // Base orthonormée de la caméra
+    const core::Vec3F f = (center - eye).Normalize();
+    const core::Vec3F s = f.Cross(up).Normalize();
+    const core::Vec3F u = s.Cross(f);
+
+    out[0] = s.x;
+    out[1] = u.x;
+    out[2] = -f.x;
+    out[3] = 0.0f;
+    out[4] = s.y;
+    out[5] = u.y;
+    out[6] = -f.y;
+    out[7] = 0.0f;
+    out[8] = s.z;
+    out[9] = u.z;
+    out[10] = -f.z;
+    out[11] = 0.0f;
+    out[12] = -(s.x * eye.x + s.y * eye.y + s.z * eye.z);
+    out[13] = -(u.x * eye.x + u.y * eye.y + u.z * eye.z);
+    out[14] = f.x * eye.x + f.y * eye.y + f.z * eye.z;
+    out[15] = 1.0f;
+}
+
+void MatrixMath::perspective(float *out, float fov, float aspect, float near, float far) {
+    const float f = 1.0f / std::tan(fov * 3.14159265358979f / 360.0f);
+    const float nf = 1.0f / (near - far);
+
+    for (int i = 0; i < 16; ++i) {
+        out[i] = 0.0f;
+    }
+    out[0] = f / aspect;
+    out[5] = f;
+    out[10] = (far + near) * nf;
+    out[11] = -1.0f;
+    out[14] = 2.0f * far * near * nf;
+}
+
+void MatrixMath::orthographic(float *out, float left, float right, float bottom, float top, float near,
+                              float far) {
+    const float width = right - left;
+    const float height = top - bottom;
+    const float depth = far - near;
+
+    for (int i = 0; i < 16; ++i) {
+        out[i] = 0.0f;
+    }
+    out[0] = 2.0f / width;
+    out[5] = 2.0f / height;
+    out[10] = -2.0f / depth;
+    out[12] = -(right + left) / width;
+    out[13] = -(top + bottom) / height;
+    out[14] = -(far + near) / depth;
+    out[15] = 1.0f;
+}
+
+// ==================== OPÉRATIONS ====================
+void MatrixMath::multiply(float *out, const float *a, const float *b) {
+    activeKernels().multiply(out, a, b);
+}
+
+void MatrixMath::transpose(float *out, const float *m) {
+    activeKernels().transpose(out, m);
+}
+
+bool MatrixMath::inverse(float *out, const float *m) {
+    return activeKernels().inverse(out, m);
+}
+
+bool MatrixMath::inverseTranspose(float *out, const float *m) {
+    const Kernels &kernels = activeKernels();
+    if (!kernels.inverse(out, m)) {
+        return false;
+    }
+    kernels.transpose(out, out);
+    return true;
+}
+
+// ==================== LOTS ====================
+void MatrixMath::multiplyBatch(float *out, const float *m, const float *in, std::size_t count) {
+    activeKernels().multiplyBatch(out, m, in, count);
+}
+
+void MatrixMath::transformPoints(float *out, const float *m, const float *in, std::size_t count) {
+    activeKernels().transformPoints(out, m, in, count);
+}
+
+void MatrixMath::transformAabbs(Aabb *outBounds, const float *matrices, const Aabb *localBounds,
+                                std::size_t count) {
+    activeKernels().transformAabbs(outBounds, matrices, localBounds, count);
+}
@@ -40,20 +40,16 @@ void Mesh::setupMesh() {
                          (void*)offsetof(Vertex, texCoords));
 
     glBindVertexArray(0);
-}
 
-void Mesh::Draw(GLuint shaderProgram) {
+    // Même numérotation que Draw (texture_diffuse1, texture_diffuse2, ...), calculée une fois
     unsigned int diffuseNr = 1;
     unsigned int specularNr = 1;
     unsigned int normalNr = 1;
     unsigned int heightNr = 1;
-
-    for (unsigned int i = 0; i < textures.size(); i++) {
-        glActiveTexture(GL_TEXTURE0 + i);
-
+    material.textureCount = static_cast<std::uint8_t>(std::min<std::size_t>(textures.size(), DrawMaterial::MAX_TEXTURES));
+    for (unsigned int i = 0; i < material.textureCount; i++) {
+        const std::string& name = textures[i].type;
         std::string number;
-        std::string name = textures[i].type;
-
         if (name == "texture_diffuse")
             number = std::to_string(diffuseNr++);
         else if (name == "texture_specular")
@@ -63,18 +59,33 @@ void Mesh::Draw(GLuint shaderProgram) {
         else if (name == "texture_height")
             number = std::to_string(heightNr++);
 
+        material.textures[i] = textures[i].id;
+        material.samplerSlots[i] = DrawMaterial::findSamplerSlot(name + number);
+    }
+}
+
+void Mesh::BindMaterial(const SamplerLayout& samplers) const {
+    for (std::uint8_t i = 0; i < material.textureCount; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+
         // Set the sampler to the correct texture unit
-        glUniform1i(glGetUniformLocation(shaderProgram,
-                    (name + number).c_str()), i);
+        const std::uint8_t slot = material.samplerSlots[i];
+        if (slot != DrawMaterial::NO_SAMPLER && samplers.locations[slot] >= 0) {
+            glUniform1i(samplers.locations[slot], i);
+        }
 
         // And finally bind the texture
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        glBindTexture(GL_TEXTURE_2D, material.textures[i]);
     }
     for (int u = 2; u < 8; ++u) {
         glActiveTexture(GL_TEXTURE0+u);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
     glActiveTexture(GL_TEXTURE0);
+}
+
+void Mesh::Draw(const SamplerLayout& samplers) {
+    BindMaterial(samplers);
     // Draw mesh
     glBindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
@@ -105,51 +116,88 @@ void Mesh::AttachInstancBuffer(GLuint instanceVBO) {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void Mesh::DrawInstanced(GLuint shaderProgram, int instanceCount) {
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
-    unsigned int normalNr = 1;
-    unsigned int heightNr = 1;
-
-    for (unsigned int i = 0; i < textures.size(); i++) {
-        glActiveTexture(GL_TEXTURE0 + i);
+void Mesh::DrawInstanced(const SamplerLayout& samplers, int instanceCount, GLuint baseInstance) {
+    BindMaterial(samplers);
+    // Draw mesh
+    glBindVertexArray(VAO);
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, instanceCount, baseInstance);
+    glBindVertexArray(0);
 
-        std::string number;
-        std::string name = textures[i].type;
+    // Set everything back to defaults
+    glActiveTexture(GL_TEXTURE0);
+}
 
-        if (name == "texture_diffuse")
-            number = std::to_string(diffuseNr++);
-        else if (name == "texture_specular")
-            number = std::to_string(specularNr++);
-        else if (name == "texture_normal")
-            number = std::to_string(normalNr++);
-        else if (name == "texture_height")
-            number = std::to_string(heightNr++);
+void Mesh::DrawDepthInstanced(int instanceCount, GLuint instanceDivisor, GLuint baseInstance) {
+    glBindVertexArray(VAO);
+    if (instanceDivisor != 1) {
+        for (int i = 0; i < 4; ++i) {
+            glVertexAttribDivisor(5 + i, instanceDivisor);
+        }
+    }
 
-        // Set the sampler to the correct texture unit
-        glUniform1i(glGetUniformLocation(shaderProgram,
-                    (name + number).c_str()), i);
+    // baseInstance n'est pas divisé : l'instance lue reste baseInstance + gl_InstanceID / divisor
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, instanceCount, baseInstance);
 
-        // And finally bind the texture
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
-    }
-    for (int u = 2; u < 8; ++u) {
-        glActiveTexture(GL_TEXTURE0+u);
-        glBindTexture(GL_TEXTURE_2D, 0);
+    if (instanceDivisor != 1) {
+        for (int i = 0; i < 4; ++i) {
+            glVertexAttribDivisor(5 + i, 1);
+        }
     }
-    glActiveTexture(GL_TEXTURE0);
-    // Draw mesh
-    glBindVertexArray(VAO);
-    glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0,instanceCount);
     glBindVertexArray(0);
+}
 
-    // Set everything back to defaults
-    glActiveTexture(GL_TEXTURE0);
+template<typename DrawMesh>
+void Model::DrawByNode(GLuint shaderProgram, DrawMesh&& drawMesh) {
+    // Les meshes d'un même nœud sont consécutifs : un envoi par nœud
+    const GLint nodeMatrixLoc = GetNodeMatrixLocation(shaderProgram);
+    int currentNode = TransformHierarchy::INVALID_NODE;
+    for (unsigned int i = 0; i < meshes.size(); i++) {
+        if (nodeMatrixLoc >= 0 && meshNodes_[i] != currentNode) {
+            currentNode = meshNodes_[i];
+            glUniformMatrix4fv(nodeMatrixLoc, 1, GL_FALSE, nodes_.getWorldMatrix(currentNode));
+        }
+        drawMesh(meshes[i]);
+    }
 }
 
 void Model::Draw(GLuint shaderProgram) {
+    Draw(GetSamplerLayout(shaderProgram));
+}
+
+void Model::Draw(const SamplerLayout& samplers) {
+    DrawByNode(samplers.program, [&samplers](Mesh& mesh) { mesh.Draw(samplers); });
+}
+
+void Model::DrawNodes(GLuint shaderProgram, const float* modelMatrix,
+                      const std::function<void(const float*)>& setModelMatrix) {
+    const SamplerLayout& samplers = GetSamplerLayout(shaderProgram);
+    // Les meshes d'un même nœud sont consécutifs : un produit et un envoi par nœud
+    int currentNode = TransformHierarchy::INVALID_NODE;
     for (unsigned int i = 0; i < meshes.size(); i++) {
-        meshes[i].Draw(shaderProgram);
+        if (meshNodes_[i] != currentNode) {
+            currentNode = meshNodes_[i];
+            float nodeModel[16];
+            MatrixMath::multiply(nodeModel, modelMatrix, nodes_.getWorldMatrix(currentNode));
+            setModelMatrix(nodeModel);
+        }
+        meshes[i].Draw(samplers);
+    }
+}
+
+void Model::RecordNodes(CommandList& list, GLuint shaderProgram, const float* modelMatrix,
+                        bool withMaterials) const {
+    int currentNode = TransformHierarchy::INVALID_NODE;
+    std::uint32_t matrixOffset = 0;
+    for (unsigned int i = 0; i < meshes.size(); i++) {
+        if (meshNodes_[i] != currentNode) {
+            currentNode = meshNodes_[i];
+            float nodeModel[16];
+            MatrixMath::multiply(nodeModel, modelMatrix, nodes_.getWorldMatrix(currentNode));
+            matrixOffset = list.addMatrix(nodeModel);
+        }
+        const Mesh& mesh = meshes[i];
+        list.draw(shaderProgram, mesh.VAO, static_cast<GLsizei>(mesh.indices.size()), 0, matrixOffset,
+                  withMaterials ? &mesh.material : nullptr);
     }
 }
 
@@ -159,10 +207,40 @@ void Model::AttachInstanceBuffer(GLuint instanceVBO) {
     }
 }
 
-void Model::DrawInstanced(GLuint shaderProgram, int instanceCount) {
-    for (auto& m : meshes) {
-        m.DrawInstanced(shaderProgram, instanceCount);
+void Model::DrawInstanced(GLuint shaderProgram, int instanceCount, GLuint baseInstance) {
+    DrawInstanced(GetSamplerLayout(shaderProgram), instanceCount, baseInstance);
+}
+
+void Model::DrawInstanced(const SamplerLayout& samplers, int instanceCount, GLuint baseInstance) {
+    DrawByNode(samplers.program, [&](Mesh& mesh) { mesh.DrawInstanced(samplers, instanceCount, baseInstance); });
+}
+
+const SamplerLayout& Model::GetSamplerLayout(GLuint shaderProgram) {
+    if (samplers_.program != shaderProgram) {
+        samplers_ = SamplerLayout::resolve(shaderProgram);
     }
+    return samplers_;
+}
+
+GLint Model::GetNodeMatrixLocation(GLuint shaderProgram) {
+    if (shaderProgram == 0) {
+        return -1;
+    }
+    for (const NodeMatrixBinding& binding : nodeMatrixBindings_) {
+        if (binding.program == shaderProgram) {
+            return binding.location;
+        }
+    }
+    NodeMatrixBinding& binding = nodeMatrixBindings_[nextNodeMatrixBinding_];
+    nextNodeMatrixBinding_ = (nextNodeMatrixBinding_ + 1) % nodeMatrixBindings_.size();
+    binding.program = shaderProgram;
+    binding.location = glGetUniformLocation(shaderProgram, NODE_MATRIX_UNIFORM);
+    return binding.location;
+}
+
+void Model::DrawDepthInstanced(GLuint shaderProgram, int instanceCount, GLuint instanceDivisor,
+                               GLuint baseInstance) {
+    DrawByNode(shaderProgram, [&](Mesh& mesh) { mesh.DrawDepthInstanced(instanceCount, instanceDivisor, baseInstance); });
 }
 
 core::Vec3F Model::GetCenter() const {
@@ -174,6 +252,42 @@ float Model::GetBoundingRadius() const {
     return 0.5f * size.magnitude();
 }
 
+int Model::FindNode(const std::string& name) const {
+    for (size_t i = 0; i < nodeNames_.size(); ++i) {
+        if (nodeNames_[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return TransformHierarchy::INVALID_NODE;
+}
+
+void Model::SetNodeLocalMatrix(int node, const float* localMatrix) {
+    nodes_.setLocalMatrix(node, localMatrix);
+}
+
+bool Model::UpdateNodes() {
+    if (nodes_.update() == 0) {
+        return false;
+    }
+    updateBounds();
+    return true;
+}
+
+void Model::updateBounds() {
+    aabbMin = core::Vec3F( FLT_MAX, FLT_MAX, FLT_MAX);
+    aabbMax = core::Vec3F( -FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < meshBounds_.size(); ++i) {
+        Aabb bounds{};
+        MatrixMath::transformAabbs(&bounds, nodes_.getWorldMatrix(meshNodes_[i]), &meshBounds_[i], 1);
+        aabbMin.x = std::min(aabbMin.x, bounds.min[0]);
+        aabbMin.y = std::min(aabbMin.y, bounds.min[1]);
+        aabbMin.z = std::min(aabbMin.z, bounds.min[2]);
+        aabbMax.x = std::max(aabbMax.x, bounds.max[0]);
+        aabbMax.y = std::max(aabbMax.y, bounds.max[1]);
+        aabbMax.z = std::max(aabbMax.z, bounds.max[2]);
+    }
+}
+
 void Model::loadModel(const std::string& path) {
     Assimp::Importer importer;
     aabbMin = core::Vec3F( FLT_MAX, FLT_MAX, FLT_MAX);
@@ -190,26 +304,48 @@ void Model::loadModel(const std::string& path) {
     }
 
     directory = path.substr(0, path.find_last_of('/'));
-    processNode(scene->mRootNode, scene);
+
+    // Parcours en largeur : l'ordre des nœuds est déjà celui de la hiérarchie aplatie
+    std::vector<std::pair<aiNode*, int>> pending{{scene->mRootNode, TransformHierarchy::INVALID_NODE}};
+    for (size_t head = 0; head < pending.size(); ++head) {
+        aiNode* node = pending[head].first;
+        const int nodeId = processNode(node, scene, pending[head].second);
+        for (unsigned int i = 0; i < node->mNumChildren; i++) {
+            pending.emplace_back(node->mChildren[i], nodeId);
+        }
+    }
+
+    nodes_.update();
+    updateBounds();
 }
 
-void Model::processNode(aiNode* node, const aiScene* scene) {
+int Model::processNode(aiNode* node, const aiScene* scene, int parentNode) {
+    // aiMatrix4x4 est rangée par lignes : sa transposée donne le column-major OpenGL
+    const aiMatrix4x4& t = node->mTransformation;
+    const float localMatrix[16] = {
+        t.a1, t.b1, t.c1, t.d1,
+        t.a2, t.b2, t.c2, t.d2,
+        t.a3, t.b3, t.c3, t.d3,
+        t.a4, t.b4, t.c4, t.d4
+    };
+    const int nodeId = nodes_.createNode(parentNode, localMatrix);
+    nodeNames_.resize(nodeId + 1);
+    nodeNames_[nodeId] = node->mName.C_Str();
+
     // Process all the node's meshes
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
         meshes.push_back(processMesh(mesh, scene));
+        meshNodes_.push_back(nodeId);
     }
-
-    // Then do the same for each of its children
-    for (unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene);
-    }
+    return nodeId;
 }
 
 Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
     std::vector<Texture> textures;
+    Aabb bounds{{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
 
     // Process vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -220,13 +356,10 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         vertex.position[1] = mesh->mVertices[i].y;
         vertex.position[2] = mesh->mVertices[i].z;
 
-        aabbMin.x = std::min(aabbMin.x, vertex.position[0]);
-        aabbMin.y = std::min(aabbMin.y, vertex.position[1]);
-        aabbMin.z = std::min(aabbMin.z, vertex.position[2]);
-
-        aabbMax.x = std::max(aabbMax.x, vertex.position[0]);
-        aabbMax.y = std::max(aabbMax.y, vertex.position[1]);
-        aabbMax.z = std::max(aabbMax.z, vertex.position[2]);
+        for (int k = 0; k < 3; ++k) {
+            bounds.min[k] = std::min(bounds.min[k], vertex.position[k]);
+            bounds.max[k] = std::max(bounds.max[k], vertex.position[k]);
+        }
 
         // Normals
         if (mesh->HasNormals()) {
@@ -285,6 +418,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
     resultMesh.indices = indices;
     resultMesh.textures = textures;
     resultMesh.setupMesh();
+    meshBounds_.push_back(bounds);
 
     return resultMesh;
 }
@@ -0,0 +1,527 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "post_process_chain.h"
+#include "program_cache.h"
+#include <algorithm>
+#include <iostream>
+
+// ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
+PostProcessChain::PostProcessChain()
+    : fullscreenVAO_(0),
+      fallbackProgram_(0),
+      intermediateFBO_{0, 0},
+      intermediateTex_{0, 0},
+      convolvedTex_(0),
+      gaussianKernel_(-1),
+      customKernel_(-1),
+      width_(0),
+      height_(0),
+      bloomEnabled_(false),
+      bloomIntensity_(0.8f),
+      lastPassCount_(0) {
+}
+
+PostProcessChain::~PostProcessChain() {
+    cleanup();
+}
+
+// ==================== INITIALISATION ====================
+bool PostProcessChain::initialize(int width, int height) {
+    width_ = width;
+    height_ = height;
+
+    // Triangle plein écran généré depuis gl_VertexID : aucun VBO
+    glGenVertexArrays(1, &fullscreenVAO_);
+
+    // Copie simple affichée tant que le programme d'une nouvelle combinaison compile
+    fallbackProgram_ = ProgramCache::finalize(submitProgram(getPassthroughFS()));
+    if (fallbackProgram_ != 0) {
+        glUseProgram(fallbackProgram_);
+        glUniform1i(glGetUniformLocation(fallbackProgram_, "uSource"), 0);
+        glUseProgram(0);
+    }
+
+    const bool complete = bloom_.initialize(width_, height_) && fallbackProgram_ != 0;
+
+    // Noyaux compute : gaussien 5x5 par défaut, noyau utilisateur identité
+    if (convolution_.initialize()) {
+        gaussianKernel_ = convolution_.createKernel(ConvolutionKernel::gaussian(2, 1.0f));
+        customKernel_ = convolution_.createKernel(ConvolutionKernel{});
+    } else {
+        std::cerr << "ERROR: Convolution engine unavailable, kernel effects are skipped" << std::endl;
+    }
+
+    return complete;
+}
+
+// ==================== CONFIGURATION ====================
+void PostProcessChain::setEffects(const std::vector<PostChainEffect> &effects) {
+    if (effects == effects_) {
+        return;
+    }
+    effects_ = effects;
+    rebuildStages();
+}
+
+void PostProcessChain::setBloom(bool enabled, float threshold, float knee, float intensity) {
+    bloom_.setThreshold(threshold, knee);
+    bloomIntensity_ = intensity;
+    if (enabled != bloomEnabled_) {
+        bloomEnabled_ = enabled;
+        rebuildStages();
+    }
+}
+
+void PostProcessChain::setGaussianRadius(int radius) {
+    radius = std::clamp(radius, 1, ConvolutionEngine::MAX_RADIUS_SEPARABLE);
+    convolution_.updateKernel(gaussianKernel_, ConvolutionKernel::gaussian(radius, 0.5f * static_cast<float>(radius)));
+}
+
+bool PostProcessChain::setCustomKernel(const ConvolutionKernel &kernel) {
+    return convolution_.updateKernel(customKernel_, kernel);
+}
+
+bool PostProcessChain::usesConvolutionEngine(PostChainEffect effect) {
+    return effect == PostChainEffect::GaussianBlur || effect == PostChainEffect::CustomKernel;
+}
+
+bool PostProcessChain::needsNeighbourhood(PostChainEffect effect) {
+    switch (effect) {
+        case PostChainEffect::Invert:
+        case PostChainEffect::Grayscale:
+        case PostChainEffect::Sepia:
+        case PostChainEffect::NightVision:
+            return false;
+        default:
+            return true;
+    }
+}
+
+void PostProcessChain::rebuildStages() {
+    stages_.clear();
+
+    for (PostChainEffect effect : effects_) {
+        // Un effet de voisinage lit ses voisins dans la source de l'étape :
+        // il ne peut pas suivre un autre effet dans le même shader
+        if (stages_.empty() ||
+            (needsNeighbourhood(effect) && (!stages_.back().effects.empty() || stages_.back().kernel >= 0)) ||
+            stages_.back().effects.size() == MAX_STAGE_EFFECTS) {
+            stages_.push_back(Stage{stages_.empty() && bloomEnabled_, -1, {}, 0, nullptr});
+        }
+        if (usesConvolutionEngine(effect)) {
+            stages_.back().kernel = effect == PostChainEffect::GaussianBlur ? gaussianKernel_ : customKernel_;
+        } else {
+            stages_.back().effects.push_back(effect);
+        }
+    }
+
+    if (stages_.empty() && bloomEnabled_) {
+        stages_.push_back(Stage{true, -1, {}, 0, nullptr});
+    }
+
+    // Soumet tout de suite les programmes manquants : ils compilent en parallèle et la chaîne
+    // affiche le repli jusqu'à ce qu'ils soient prêts, sans bloquer l'image
+    for (Stage &stage : stages_) {
+        stage.key = getStageKey(stage);
+        if (fullscreenVAO_ != 0) {
+            stage.program = getStageProgram(stage);
+        }
+    }
+}
+
+// ==================== RENDU ====================
+void PostProcessChain::apply(GLuint sceneTexture, GLuint targetFramebuffer) {
+    lastPassCount_ = 0;
+    if (stages_.empty() || fullscreenVAO_ == 0) {
+        return;
+    }
+    if (stages_.size() > 1 && !ensureIntermediateTargets()) {
+        return;
+    }
+
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(fullscreenVAO_);
+
+    if (bloomEnabled_) {
+        bloom_.render(sceneTexture);
+        lastPassCount_ += bloom_.getPassCount();
+        glBindVertexArray(fullscreenVAO_);
+    }
+
+    GLuint source = sceneTexture;
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        const bool last = i + 1 == stages_.size();
+        // Résolu par rebuildStages() ; seulement après une réinitialisation sinon
+        if (stages_[i].program == nullptr) {
+            stages_[i].program = getStageProgram(stages_[i]);
+        }
+        StageProgram *stageProgram = stages_[i].program;
+        const bool ready = prepareStageProgram(*stageProgram);
+        if (!ready && fallbackProgram_ == 0) {
+            break;
+        }
+
+        // Convolution compute avant le shader de l'étape (le bloom éventuel s'ajoute après)
+        if (stages_[i].kernel >= 0 && convolution_.isInitialized()) {
+            ensureConvolvedTarget();
+            convolution_.apply(stages_[i].kernel, source, convolvedTex_, width_, height_);
+            source = convolvedTex_;
+            ++lastPassCount_;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, last ? targetFramebuffer : intermediateFBO_[i % 2]);
+        glViewport(0, 0, width_, height_);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source);
+        if (!ready) {
+            glUseProgram(fallbackProgram_);
+        } else {
+            glUseProgram(stageProgram->program);
+            glUniform2f(stageProgram->texelSizeLoc, 1.0f / static_cast<float>(width_),
+                        1.0f / static_cast<float>(height_));
+        }
+        if (ready && stages_[i].bloomInput) {
+            glUniform1f(stageProgram->bloomIntensityLoc, bloomIntensity_);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, bloom_.getTexture());
+        }
+
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        ++lastPassCount_;
+
+        source = intermediateTex_[i % 2];
+    }
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
+
+PostProcessChain::StageProgram *PostProcessChain::getStageProgram(const Stage &stage) {
+    auto it = programs_.find(stage.key);
+    if (it != programs_.end()) {
+        return &it->second;
+    }
+
+    // Soumis sans attendre : prepareStageProgram() le récupère quand le pilote a terminé
+    StageProgram stageProgram{submitProgram(generateStageShader(stage)), -1, -1, false};
+    return &programs_.emplace(stage.key, stageProgram).first->second;
+}
+
+bool PostProcessChain::prepareStageProgram(StageProgram &stageProgram) {
+    if (stageProgram.ready) {
+        return true;
+    }
+    // Encore en compilation, ou échec (program remis à 0, erreur déjà affichée)
+    if (ProgramCache::resolve(stageProgram.program, 0) == 0) {
+        return false;
+    }
+
+    const GLuint program = stageProgram.program;
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uSource"), 0);
+    glUniform1i(glGetUniformLocation(program, "uBloom"), 1);
+    stageProgram.texelSizeLoc = glGetUniformLocation(program, "uTexelSize");
+    stageProgram.bloomIntensityLoc = glGetUniformLocation(program, "uBloomIntensity");
+    stageProgram.ready = true;
+    return true;
+}
+
+bool PostProcessChain::ensureIntermediateTargets() {
+    if (intermediateFBO_[0] != 0) {
+        return true;
+    }
+    bool complete = true;
+    for (int i = 0; i < 2; ++i) {
+        complete &= createColorTarget(intermediateFBO_[i], intermediateTex_[i], width_, height_);
+    }
+    return complete;
+}
+
+void PostProcessChain::ensureConvolvedTarget() {
+    if (convolvedTex_ != 0) {
+        return;
+    }
+    // Stockage immuable : écrit comme image par le compute, lu comme texture par l'étape
+    glGenTextures(1, &convolvedTex_);
+    glBindTexture(GL_TEXTURE_2D, convolvedTex_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width_, height_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// ==================== GÉNÉRATION DES SHADERS ====================
+std::uint64_t PostProcessChain::getStageKey(const Stage &stage) {
+    static_assert(1 + MAX_STAGE_EFFECTS * STAGE_KEY_EFFECT_BITS <= 64);
+    static_assert(static_cast<int>(PostChainEffect::CustomKernel) + 1 < (1 << STAGE_KEY_EFFECT_BITS));
+    std::uint64_t key = stage.bloomInput ? 1u : 0u;
+    int shift = 1;
+    for (PostChainEffect effect : stage.effects) {
+        key |= static_cast<std::uint64_t>(static_cast<int>(effect) + 1) << shift;
+        shift += STAGE_KEY_EFFECT_BITS;
+    }
+    return key;
+}
+
+std::string PostProcessChain::generateStageShader(const Stage &stage) {
+    std::string source = "#version 430 core\n";
+    if (stage.bloomInput) {
+        source += "#define BLOOM_INPUT\n";
+    }
+    source += R"(
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uTexelSize;
+#ifdef BLOOM_INPUT
+uniform sampler2D uBloom;
+uniform float uBloomIntensity;
+#endif
+
+float luminance(vec3 color) {
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+// Lecture de la source de l'étape ; le bloom est ajouté ici plutôt que dans une passe de combinaison
+vec3 fetch(vec2 offset) {
+    vec2 uv = vUV + offset * uTexelSize;
+    vec3 color = texture(uSource, uv).rgb;
+#ifdef BLOOM_INPUT
+    color += texture(uBloom, uv).rgb * uBloomIntensity;
+#endif
+    return color;
+}
+)";
+
+    // Une seule définition par effet, même s'il apparaît plusieurs fois dans l'étape
+    std::vector<PostChainEffect> defined;
+    for (PostChainEffect effect : stage.effects) {
+        if (std::find(defined.begin(), defined.end(), effect) == defined.end()) {
+            defined.push_back(effect);
+            source += getEffectFunction(effect);
+        }
+    }
+
+    source += "\nvoid main() {\n";
+    std::size_t first = 0;
+    if (!stage.effects.empty() && needsNeighbourhood(stage.effects[0])) {
+        source += "    vec3 color = " + getEffectName(stage.effects[0]) + "();\n";
+        first = 1;
+    } else {
+        source += "    vec3 color = fetch(vec2(0.0));\n";
+    }
+    for (std::size_t i = first; i < stage.effects.size(); ++i) {
+        source += "    color = " + getEffectName(stage.effects[i]) + "(color);\n";
+    }
+    source += "    FragColor = vec4(color, 1.0);\n}\n";
+    return source;
+}
+
+std::string PostProcessChain::getEffectName(PostChainEffect effect) {
+    switch (effect) {
+        case PostChainEffect::Invert: return "invertColor";
+        case PostChainEffect::Grayscale: return "grayscale";
+        case PostChainEffect::Sepia: return "sepia";
+        case PostChainEffect::NightVision: return "nightVision";
+        case PostChainEffect::EdgeDetection: return "edgeDetection";
+        case PostChainEffect::Blur: return "blur";
+        case PostChainEffect::Sharpen: return "sharpen";
+        case PostChainEffect::Emboss: return "emboss";
+        case PostChainEffect::Sobel: return "sobel";
+        case PostChainEffect::GaussianBlur:
+        case PostChainEffect::CustomKernel:
+            break;
+    }
+    return "";
+}
+
+// Effets par pixel : vec3 f(vec3), effets de voisinage : vec3 f() via fetch()
+std::string PostProcessChain::getEffectFunction(PostChainEffect effect) {
+    switch (effect) {
+        case PostChainEffect::Invert:
+            return R"(
+vec3 invertColor(vec3 color) {
+    return vec3(1.0) - color;
+}
+)";
+        case PostChainEffect::Grayscale:
+            return R"(
+vec3 grayscale(vec3 color) {
+    return vec3(luminance(color));
+}
+)";
+        case PostChainEffect::Sepia:
+            return R"(
+vec3 sepia(vec3 color) {
+    return luminance(color) * vec3(1.2, 1.0, 0.8);
+}
+)";
+        case PostChainEffect::NightVision:
+            return R"(
+vec3 nightVision(vec3 color) {
+    vec3 result = vec3(0.1, 0.8, 0.1) * luminance(color);
+    // Bruit + scanlines
+    result += fract(sin(dot(vUV, vec2(12.9898, 78.233))) * 43758.5453) * 0.05;
+    if (mod(gl_FragCoord.y, 3.0) < 1.0) {
+        result *= 0.9;
+    }
+    return result;
+}
+)";
+        case PostChainEffect::EdgeDetection:
+            return R"(
+vec3 edgeDetection() {
+    vec3 sum = fetch(vec2(0.0)) * 9.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            sum -= fetch(vec2(x, y));
+        }
+    }
+    return clamp(sum, 0.0, 1.0);
+}
+)";
+        case PostChainEffect::Blur:
+            return R"(
+vec3 blur() {
+    const float kernel[9] = float[](1.0, 2.0, 1.0, 2.0, 4.0, 2.0, 1.0, 2.0, 1.0);
+    vec3 sum = vec3(0.0);
+    for (int i = 0; i < 9; i++) {
+        sum += fetch(vec2(i % 3 - 1, i / 3 - 1)) * kernel[i];
+    }
+    return sum / 16.0;
+}
+)";
+        case PostChainEffect::Sharpen:
+            return R"(
+vec3 sharpen() {
+    vec3 result = fetch(vec2(0.0)) * 5.0
+                - fetch(vec2(-1.0, 0.0)) - fetch(vec2(1.0, 0.0))
+                - fetch(vec2(0.0, -1.0)) - fetch(vec2(0.0, 1.0));
+    return clamp(result, 0.0, 1.0);
+}
+)";
+        case PostChainEffect::Emboss:
+            return R"(
+vec3 emboss() {
+    return vec3(0.5) + fetch(vec2(0.0)) - fetch(vec2(-1.0));
+}
+)";
+        case PostChainEffect::Sobel:
+            return R"(
+vec3 sobel() {
+    const float sobelX[9] = float[](-1.0, 0.0, 1.0, -2.0, 0.0, 2.0, -1.0, 0.0, 1.0);
+    const float sobelY[9] = float[](-1.0, -2.0, -1.0, 0.0, 0.0, 0.0, 1.0, 2.0, 1.0);
+    vec3 gx = vec3(0.0);
+    vec3 gy = vec3(0.0);
+    for (int i = 0; i < 9; i++) {
+        vec3 color = fetch(vec2(i % 3 - 1, i / 3 - 1));
+        gx += color * sobelX[i];
+        gy += color * sobelY[i];
+    }
+    return clamp(sqrt(gx * gx + gy * gy), 0.0, 1.0);
+}
+)";
+        case PostChainEffect::GaussianBlur:
+        case PostChainEffect::CustomKernel:
+            // Exécutés par le ConvolutionEngine avant le shader de l'étape
+            break;
+    }
+    return "";
+}
+
+// ==================== UTILITAIRES OPENGL ====================
+bool PostProcessChain::createColorTarget(GLuint &framebuffer, GLuint &texture, int width, int height) {
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (!complete) {
+        std::cerr << "ERROR: Post-process framebuffer is not complete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+GLuint PostProcessChain::submitProgram(const std::string &fragmentSource) {
+    return ProgramCache::submitProgram({{GL_VERTEX_SHADER, getFullscreenVS()},
+                                        {GL_FRAGMENT_SHADER, fragmentSource}});
+}
+
+// ==================== NETTOYAGE ====================
+void PostProcessChain::cleanup() {
+    for (auto &[key, stageProgram] : programs_) {
+        ProgramCache::discard(stageProgram.program);
+        if (stageProgram.program) glDeleteProgram(stageProgram.program);
+    }
+    programs_.clear();
+    for (Stage &stage : stages_) {
+        stage.program = nullptr;
+    }
+    if (fallbackProgram_) glDeleteProgram(fallbackProgram_);
+    fallbackProgram_ = 0;
+
+    for (int i = 0; i < 2; ++i) {
+        if (intermediateFBO_[i]) glDeleteFramebuffers(1, &intermediateFBO_[i]);
+        if (intermediateTex_[i]) glDeleteTextures(1, &intermediateTex_[i]);
+        intermediateFBO_[i] = intermediateTex_[i] = 0;
+    }
+
+    convolution_.cleanup();
+    gaussianKernel_ = customKernel_ = -1;
+    if (convolvedTex_) glDeleteTextures(1, &convolvedTex_);
+    convolvedTex_ = 0;
+
+    bloom_.cleanup();
+    if (fullscreenVAO_) glDeleteVertexArrays(1, &fullscreenVAO_);
+    fullscreenVAO_ = 0;
+}
+
+// ==================== SHADERS ====================
+std::string PostProcessChain::getFullscreenVS() {
+    return R"(
+#version 430 core
+out vec2 vUV;
+
+void main() {
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vUV = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+}
+
+std::string PostProcessChain::getPassthroughFS() {
+    return R"(
+#version 430 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+
+void main() {
+    FragColor = texture(uSource, vUV);
+}
+)";
+}
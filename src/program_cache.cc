@@ -0,0 +1,333 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/program_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+std::string ProgramCache::directory_ = "shader_cache";
+int ProgramCache::hitCount_ = 0;
+int ProgramCache::missCount_ = 0;
+std::unordered_map<GLuint, ProgramCache::PendingProgram> ProgramCache::pending_;
+
+namespace {
+    constexpr char BINARY_MAGIC[4] = {'P', 'G', 'B', '1'};
+
+    // FNV-1a 64 bits : suffisant pour distinguer des sources, pas un hash cryptographique
+    constexpr std::uint64_t FNV_OFFSET = 1469598103934665603ull;
+    constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+    void hashBytes(std::uint64_t &hash, const void *data, size_t size) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+    }
+
+    void hashString(std::uint64_t &hash, const std::string &value) {
+        // La longueur sépare les champs ("ab"+"c" != "a"+"bc")
+        const std::uint64_t length = value.size();
+        hashBytes(hash, &length, sizeof(length));
+        hashBytes(hash, value.data(), value.size());
+    }
+
+    std::string getGLString(GLenum name) {
+        const auto *value = reinterpret_cast<const char *>(glGetString(name));
+        return value ? value : "";
+    }
+}
+
+// ==================== CONFIGURATION ====================
+void ProgramCache::setDirectory(const std::string &directory) {
+    directory_ = directory;
+}
+
+// ==================== CRÉATION ====================
+GLuint ProgramCache::createProgram(const std::vector<ShaderStageSource> &stages, const std::string &defines) {
+    return finalize(submitProgram(stages, defines));
+}
+
+std::string ProgramCache::injectDefines(const std::string &source, const std::string &defines) {
+    if (defines.empty()) return source;
+
+    // #version doit rester la première directive : on insère juste après sa ligne
+    const size_t version = source.find("#version");
+    if (version == std::string::npos) return defines + "\n" + source;
+
+    const size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) return source + "\n" + defines + "\n";
+    return source.substr(0, lineEnd + 1) + defines + "\n" + source.substr(lineEnd + 1);
+}
+
+// ==================== CONSTRUCTION ASYNCHRONE ====================
+GLuint ProgramCache::submitProgram(const std::vector<ShaderStageSource> &stages, const std::string &defines) {
+    // Active les threads de compilation du pilote avant la première soumission
+    hasParallelCompile();
+
+    GLuint program = glCreateProgram();
+    PendingProgram pending{stages, defines, {}, 0, !directory_.empty() && isSupported(), false};
+
+    if (pending.useCache) {
+        pending.key = computeKey(stages, defines);
+        pending.fromBinary = loadBinary(program, pending.key);
+        if (pending.fromBinary) {
+            ++hitCount_;
+        } else {
+            ++missCount_;
+        }
+    }
+    if (!pending.fromBinary) {
+        attachAndLink(program, pending);
+    }
+
+    pending_.emplace(program, std::move(pending));
+    return program;
+}
+
+bool ProgramCache::isReady(GLuint program) {
+    if (!pending_.contains(program) || !hasParallelCompile()) return true;
+
+    GLint completed = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
+
+GLuint ProgramCache::finalize(GLuint program) {
+    auto it = pending_.find(program);
+    if (it == pending_.end()) return program;
+    PendingProgram &pending = it->second;
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success && pending.fromBinary) {
+        // Pilote mis à jour sans changer de chaîne de version, format retiré... : on recompile
+        // dans le même programme, son nom est déjà détenu par l'appelant
+        std::error_code error;
+        std::filesystem::remove(getBinaryPath(pending.key), error);
+        --hitCount_;
+        ++missCount_;
+        pending.fromBinary = false;
+        attachAndLink(program, pending);
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+    }
+
+    if (!success) {
+        printErrors(program, pending);
+        releaseShaders(program, pending);
+        pending_.erase(it);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    if (pending.useCache && !pending.fromBinary) {
+        storeBinary(program, pending.key);
+    }
+    releaseShaders(program, pending);
+    pending_.erase(it);
+    return program;
+}
+
+void ProgramCache::finalizeAll() {
+    std::vector<GLuint> programs;
+    programs.reserve(pending_.size());
+    for (const auto &[program, pending] : pending_) {
+        programs.push_back(program);
+    }
+    for (GLuint program : programs) {
+        finalize(program);
+    }
+}
+
+GLuint ProgramCache::resolve(GLuint &program, GLuint fallback) {
+    if (program == 0 || !isReady(program)) return fallback;
+
+    program = finalize(program);
+    return program != 0 ? program : fallback;
+}
+
+void ProgramCache::discard(GLuint program) {
+    auto it = pending_.find(program);
+    if (it == pending_.end()) return;
+    releaseShaders(program, it->second);
+    pending_.erase(it);
+}
+
+bool ProgramCache::hasParallelCompile() {
+    static const bool supported = [] {
+        bool khr = false;
+        bool arb = false;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            const auto *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension == nullptr) continue;
+            khr = khr || std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0;
+            arb = arb || std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0;
+        }
+
+        // 0xFFFFFFFF : le pilote choisit le nombre de threads
+        if (khr) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        } else if (arb) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        }
+        return khr || arb;
+    }();
+    return supported;
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+bool ProgramCache::isSupported() {
+    static const bool supported = [] {
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        return formatCount > 0;
+    }();
+    return supported;
+}
+
+const std::string &ProgramCache::getDriverString() {
+    // Un binaire n'est valable que pour le pilote qui l'a produit
+    static const std::string driver = getGLString(GL_VENDOR) + "|" + getGLString(GL_RENDERER) + "|" +
+                                      getGLString(GL_VERSION);
+    return driver;
+}
+
+std::uint64_t ProgramCache::computeKey(const std::vector<ShaderStageSource> &stages, const std::string &defines) {
+    std::uint64_t hash = FNV_OFFSET;
+    hashString(hash, getDriverString());
+    hashString(hash, defines);
+    for (const ShaderStageSource &stage : stages) {
+        const std::uint32_t type = stage.type;
+        hashBytes(hash, &type, sizeof(type));
+        hashString(hash, stage.source);
+    }
+    return hash;
+}
+
+std::string ProgramCache::getBinaryPath(std::uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+bool ProgramCache::loadBinary(GLuint program, std::uint64_t key) {
+    const std::string path = getBinaryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    BinaryHeader header{};
+    std::vector<char> binary;
+    bool valid = file.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+                 std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 &&
+                 header.key == key && header.length > 0;
+    if (valid) {
+        binary.resize(header.length);
+        valid = static_cast<bool>(file.read(binary.data(), header.length));
+    }
+    file.close();
+
+    if (!valid) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return false;
+    }
+
+    // Le statut est lu par finalize() : un binaire refusé y est recompilé
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(header.length));
+    return true;
+}
+
+void ProgramCache::storeBinary(GLuint program, std::uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.key = key;
+
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+    header.binaryFormat = binaryFormat;
+    header.length = static_cast<std::uint32_t>(length);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        std::cerr << "ERROR: Cannot create shader cache directory " << directory_ << ": " << error.message() << std::endl;
+        return;
+    }
+
+    // Écriture dans un fichier temporaire puis renommage : un arrêt en cours d'écriture
+    // ne laisse jamais de binaire tronqué sous le nom final
+    const std::string path = getBinaryPath(key);
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) return;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file) return;
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) std::filesystem::remove(temporaryPath, error);
+}
+
+void ProgramCache::attachAndLink(GLuint program, PendingProgram &pending) {
+    if (pending.useCache) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // Aucune lecture de statut ici : le pilote enchaîne compilation et linkage de son côté
+    for (const ShaderStageSource &stage : pending.stages) {
+        const std::string source = injectDefines(stage.source, pending.defines);
+        const char *src = source.c_str();
+        GLuint shader = glCreateShader(stage.type);
+        glShaderSource(shader, 1, &src, nullptr);
+        glCompileShader(shader);
+        glAttachShader(program, shader);
+        pending.shaders.push_back(shader);
+    }
+    glLinkProgram(program);
+}
+
+void ProgramCache::printErrors(GLuint program, const PendingProgram &pending) {
+    bool compileFailed = false;
+    for (size_t i = 0; i < pending.shaders.size(); ++i) {
+        GLint success;
+        glGetShaderiv(pending.shaders[i], GL_COMPILE_STATUS, &success);
+        if (success) continue;
+
+        char infoLog[1024];
+        glGetShaderInfoLog(pending.shaders[i], 1024, nullptr, infoLog);
+        const GLenum type = pending.stages[i].type;
+        const char *stageName = type == GL_VERTEX_SHADER     ? "VERTEX"
+                                : type == GL_FRAGMENT_SHADER ? "FRAGMENT"
+                                : type == GL_GEOMETRY_SHADER ? "GEOMETRY"
+                                : type == GL_COMPUTE_SHADER  ? "COMPUTE"
+                                                             : "UNKNOWN";
+        std::cerr << "ERROR: " << stageName << " shader compilation failed:\n" << infoLog << std::endl;
+        compileFailed = true;
+    }
+
+    if (!compileFailed) {
+        char infoLog[1024];
+        glGetProgramInfoLog(program, 1024, nullptr, infoLog);
+        std::cerr << "ERROR: Shader program linking failed:\n" << infoLog << std::endl;
+    }
+}
+
+void ProgramCache::releaseShaders(GLuint program, PendingProgram &pending) {
+    for (GLuint shader : pending.shaders) {
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+    }
+    pending.shaders.clear();
+}
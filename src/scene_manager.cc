@@ -3,13 +3,10 @@
 //
 
 #include "../include/scene_manager.h"
+#include "../include/matrix_math.h"
 
+#include <cstring>
 #include <iostream>
-// ==================== ModelInstance ====================
-void ModelInstance::updateModelMatrix() {
-    SceneManager::createTransformMatrix(position, rotation, scale, modelMatrix.data());
-}
-
 // ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
 SceneManager::SceneManager() = default;
 
@@ -18,209 +15,275 @@ SceneManager::~SceneManager() {
 }
 
 // ==================== GESTION DES MODÈLES ====================
-int SceneManager::loadModel(const std::string& path) {
+ModelHandle SceneManager::loadModel(const std::string& path) {
     try {
-        auto newModel = std::make_unique<Model>(path);
-        int index = models_.size();
-        models_.push_back(std::move(newModel));
-        return index;
+        return models_.insert(std::make_unique<Model>(path));
     } catch (const std::exception& e) {
         std::cerr << "ERROR: Failed to load model: " << path << std::endl;
         std::cerr << "Details: " << e.what() << std::endl;
-        return -1;
+        return {};
     }
 }
 
-Model* SceneManager::getModel(int modelIndex) {
-    if (modelIndex < 0 || modelIndex >= static_cast<int>(models_.size())) {
-        return nullptr;
+bool SceneManager::removeModel(ModelHandle model) {
+    if (!models_.contains(model)) {
+        return false;
     }
-    return models_[modelIndex].get();
+    for (int i = 0; i < entities_.size(); ++i) {
+        if (entities_.getModelHandle(i) == model) {
+            std::cerr << "ERROR: Cannot remove model " << model.index << ": still used by instances" << std::endl;
+            return false;
+        }
+    }
+    return models_.erase(model);
 }
 
-const Model* SceneManager::getModel(int modelIndex) const {
-    if (modelIndex < 0 || modelIndex >= static_cast<int>(models_.size())) {
-        return nullptr;
-    }
-    return models_[modelIndex].get();
+Model* SceneManager::getModel(ModelHandle model) {
+    std::unique_ptr<Model>* entry = models_.get(model);
+    return entry != nullptr ? entry->get() : nullptr;
 }
 
-// ==================== GESTION DES INSTANCES ====================
-int SceneManager::addModelInstance(int modelIndex,
-                                  const core::Vec3F& position,
-                                  const core::Vec3F& rotation,
-                                  const core::Vec3F& scale) {
-    if (modelIndex < 0 || modelIndex >= static_cast<int>(models_.size())) {
-        std::cerr << "ERROR: Invalid model index: " << modelIndex << std::endl;
-        return -1;
-    }
-
-    ModelInstance instance;
-    instance.model = models_[modelIndex].get();
-    instance.position = position;
-    instance.rotation = rotation;
-    instance.scale = scale;
-    instance.modelIndex = modelIndex;
-    instance.updateModelMatrix();
-
-    int index = instances_.size();
-    instances_.push_back(instance);
-    return index;
-}
-
-void SceneManager::removeModelInstance(int instanceIndex) {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
-        return;
-    }
-    instances_.erase(instances_.begin() + instanceIndex);
+const Model* SceneManager::getModel(ModelHandle model) const {
+    const std::unique_ptr<Model>* entry = models_.get(model);
+    return entry != nullptr ? entry->get() : nullptr;
 }
 
-ModelInstance* SceneManager::getInstance(int instanceIndex) {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
-        return nullptr;
+// ==================== GESTION DES INSTANCES ====================
+InstanceHandle SceneManager::addModelInstance(ModelHandle model,
+                                              const core::Vec3F& position,
+                                              const core::Vec3F& rotation,
+                                              const core::Vec3F& scale) {
+    Model* modelPtr = getModel(model);
+    if (modelPtr == nullptr) {
+        std::cerr << "ERROR: Invalid model handle: " << model.index << std::endl;
+        return {};
     }
-    return &instances_[instanceIndex];
+
+    const InstanceHandle instance = entities_.create(modelPtr, model, position, rotation, scale);
+    markStaticDirty(entities_.indexOf(instance));
+    return instance;
 }
 
-const ModelInstance* SceneManager::getInstance(int instanceIndex) const {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
-        return nullptr;
+void SceneManager::removeModelInstance(InstanceHandle instance) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
+        return;
     }
-    return &instances_[instanceIndex];
+    markStaticDirty(instanceIndex);
+    entities_.remove(instance);
 }
 
 int SceneManager::getVisibleInstanceCount() const {
     int count = 0;
-    for (const auto& instance : instances_) {
-        if (instance.visible) {
+    for (int i = 0; i < entities_.size(); ++i) {
+        if (entities_.isVisible(i)) {
             count++;
         }
     }
     return count;
 }
 
+Model* SceneManager::getInstanceModel(InstanceHandle instance) const {
+    const int instanceIndex = entities_.indexOf(instance);
+    return entities_.isValid(instanceIndex) ? entities_.getModel(instanceIndex) : nullptr;
+}
+
+bool SceneManager::isInstanceVisible(InstanceHandle instance) const {
+    const int instanceIndex = entities_.indexOf(instance);
+    return entities_.isValid(instanceIndex) && entities_.isVisible(instanceIndex);
+}
+
+bool SceneManager::isInstanceStatic(InstanceHandle instance) const {
+    const int instanceIndex = entities_.indexOf(instance);
+    return entities_.isValid(instanceIndex) && entities_.isStatic(instanceIndex);
+}
+
 // ==================== TRANSFORMATION DES INSTANCES ====================
-void SceneManager::setInstancePosition(int instanceIndex, const core::Vec3F& position) {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+void SceneManager::setInstancePosition(InstanceHandle instance, const core::Vec3F& position) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
         return;
     }
-    instances_[instanceIndex].position = position;
-    instances_[instanceIndex].updateModelMatrix();
+    entities_.setPosition(instanceIndex, position);
+    markStaticDirty(instanceIndex);
 }
 
-const core::Vec3F& SceneManager::getInstancePosition(int instanceIndex) const {
+const core::Vec3F& SceneManager::getInstancePosition(InstanceHandle instance) const {
     static constexpr core::Vec3F defaultPos{0.0f, 0.0f, 0.0f};
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
         return defaultPos;
     }
-    return instances_[instanceIndex].position;
+    return entities_.getPosition(instanceIndex);
 }
 
-void SceneManager::setInstanceRotation(int instanceIndex, const core::Vec3F& rotation) {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+void SceneManager::setInstanceRotation(InstanceHandle instance, const core::Vec3F& rotation) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
         return;
     }
-    instances_[instanceIndex].rotation = rotation;
-    instances_[instanceIndex].updateModelMatrix();
+    entities_.setRotation(instanceIndex, rotation);
+    markStaticDirty(instanceIndex);
 }
 
-void SceneManager::setInstanceScale(int instanceIndex, const core::Vec3F& scale) {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+void SceneManager::setInstanceScale(InstanceHandle instance, const core::Vec3F& scale) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
         return;
     }
-    instances_[instanceIndex].scale = scale;
-    instances_[instanceIndex].updateModelMatrix();
+    entities_.setScale(instanceIndex, scale);
+    markStaticDirty(instanceIndex);
 }
 
-void SceneManager::setInstanceVisible(int instanceIndex, bool visible) {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+void SceneManager::setInstanceVisible(InstanceHandle instance, bool visible) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
         return;
     }
-    instances_[instanceIndex].visible = visible;
+    entities_.setVisible(instanceIndex, visible);
+    markStaticDirty(instanceIndex);
+}
+
+void SceneManager::setInstanceStatic(InstanceHandle instance, bool isStatic) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
+        return;
+    }
+    if (entities_.isStatic(instanceIndex) != isStatic) {
+        entities_.setStatic(instanceIndex, isStatic);
+        // L'instance entre ou sort de la couche en cache
+        staticGeometryVersion_++;
+    }
+}
+
+bool SceneManager::setInstanceParent(InstanceHandle instance, InstanceHandle parent) {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
+        return false;
+    }
+    // Handle nul : détache
+    if (!entities_.setParent(instanceIndex, entities_.indexOf(parent))) {
+        std::cerr << "ERROR: Cannot parent instance " << instance.index
+                  << " to " << parent.index << " (cycle)" << std::endl;
+        return false;
+    }
+    markStaticDirty(instanceIndex);
+    return true;
+}
+
+InstanceHandle SceneManager::getInstanceParent(InstanceHandle instance) const {
+    return entities_.handleAt(entities_.getParent(entities_.indexOf(instance)));
 }
 
 // ==================== MATRICES DE TRANSFORMATION ====================
-void SceneManager::getInstanceModelMatrix(int instanceIndex, float* outMatrix) const {
+void SceneManager::getInstanceModelMatrix(InstanceHandle instance, float* outMatrix) const {
     if (outMatrix == nullptr) {
         return;
     }
 
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+    const int instanceIndex = entities_.indexOf(instance);
+
+    if (!entities_.isValid(instanceIndex)) {
         // Retourner la matrice identité en cas d'erreur
-        identityMatrix(outMatrix);
+        MatrixMath::identity(outMatrix);
         return;
     }
 
-    std::memcpy(outMatrix, instances_[instanceIndex].modelMatrix.data(), sizeof(float) * 16);
+    std::memcpy(outMatrix, entities_.getWorldMatrix(instanceIndex), sizeof(float) * 16);
 }
 
-void SceneManager::updateAllMatrices() {
-    for (auto& instance : instances_) {
-        instance.updateModelMatrix();
+std::size_t SceneManager::updateAllMatrices() {
+    const std::size_t updated = entities_.updateTransforms();
+    // Un parent dynamique peut déplacer des enfants statiques sans les toucher
+    if (entities_.getStaticHierarchyUpdates() > 0) {
+        staticGeometryVersion_++;
     }
+    return updated;
 }
 
 // ==================== RENDU ====================
-void SceneManager::drawInstance(int instanceIndex, GLuint shaderProgram) const {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+void SceneManager::drawInstance(InstanceHandle instance, GLuint shaderProgram) const {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
         return;
     }
 
-    const ModelInstance& instance = instances_[instanceIndex];
-    if (!instance.visible || instance.model == nullptr) {
+    Model* model = entities_.getModel(instanceIndex);
+    if (!entities_.isVisible(instanceIndex) || model == nullptr) {
         return;
     }
 
-    instance.model->Draw(shaderProgram);
+    model->Draw(shaderProgram);
 }
 
-void SceneManager::drawAllInstances(GLuint shaderProgram) const {
-    for (int i = 0; i < static_cast<int>(instances_.size()); ++i) {
-        drawInstance(i, shaderProgram);
+void SceneManager::drawInstance(InstanceHandle instance, GLuint shaderProgram,
+                                const std::function<void(const float*)>& setModelMatrix) const {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
+        return;
+    }
+
+    Model* model = entities_.getModel(instanceIndex);
+    if (!entities_.isVisible(instanceIndex) || model == nullptr) {
+        return;
     }
+
+    model->DrawNodes(shaderProgram, entities_.getWorldMatrix(instanceIndex), setModelMatrix);
 }
 
-void SceneManager::drawInstanceRaw(int instanceIndex, GLuint shaderProgram) const {
-    if (instanceIndex < 0 || instanceIndex >= static_cast<int>(instances_.size())) {
+void SceneManager::recordInstance(InstanceHandle instance, GLuint shaderProgram, CommandList& list,
+                                  bool withMaterials) const {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex)) {
         return;
     }
 
-    const ModelInstance& instance = instances_[instanceIndex];
-    if (!instance.visible || instance.model == nullptr) {
+    const Model* model = entities_.getModel(instanceIndex);
+    if (!entities_.isVisible(instanceIndex) || model == nullptr) {
         return;
     }
 
-    instance.model->Draw(shaderProgram);
+    model->RecordNodes(list, shaderProgram, entities_.getWorldMatrix(instanceIndex), withMaterials);
+}
+
+void SceneManager::drawAllInstances(GLuint shaderProgram) const {
+    for (int i = 0; i < entities_.size(); ++i) {
+        drawInstance(entities_.handleAt(i), shaderProgram);
+    }
+}
+
+void SceneManager::drawInstanceRaw(InstanceHandle instance, GLuint shaderProgram) const {
+    drawInstance(instance, shaderProgram);
 }
 
 // ==================== BOUNDS ====================
 core::Vec3F SceneManager::getSceneCenter() const {
     core::Vec3F center{0.0f, 0.0f, 0.0f};
-    if (instances_.empty()) {
+    if (entities_.size() == 0) {
         return center;
     }
 
-    for (const auto& instance : instances_) {
-        center = center + instance.position;
+    for (int i = 0; i < entities_.size(); ++i) {
+        center = center + entities_.getPosition(i);
     }
 
-    center = center / static_cast<float>(instances_.size());
+    center = center / static_cast<float>(entities_.size());
     return center;
 }
 
 float SceneManager::getSceneRadius() const {
-    if (instances_.empty()) {
+    if (entities_.size() == 0) {
         return 1.0f;
     }
 
     core::Vec3F center = getSceneCenter();
     float maxDist = 0.0f;
 
-    for (const auto& instance : instances_) {
-        core::Vec3F diff = instance.position - center;
+    for (int i = 0; i < entities_.size(); ++i) {
+        core::Vec3F diff = entities_.getPosition(i) - center;
         float dist = std::sqrt(diff.x * diff.x + diff.y * diff.y + diff.z * diff.z);
-        if (instance.model != nullptr) {
-            dist += instance.model->GetBoundingRadius();
+        if (const Model* model = entities_.getModel(i)) {
+            dist += model->GetBoundingRadius();
         }
         maxDist = std::max(maxDist, dist);
     }
@@ -232,117 +295,44 @@ void SceneManager::getSceneBounds(core::Vec3F& outMin, core::Vec3F& outMax) cons
     outMin = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
     outMax = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
 
-    for (const auto& instance : instances_) {
-        if (instance.model != nullptr) {
-            core::Vec3F min = instance.model->aabbMin;
-            core::Vec3F max = instance.model->aabbMax;
-
-            // Appliquer la transformation
-            min = min * instance.scale + instance.position;
-            max = max * instance.scale + instance.position;
-
-            outMin.x = std::min(outMin.x, min.x);
-            outMin.y = std::min(outMin.y, min.y);
-            outMin.z = std::min(outMin.z, min.z);
-
-            outMax.x = std::max(outMax.x, max.x);
-            outMax.y = std::max(outMax.y, max.y);
-            outMax.z = std::max(outMax.z, max.z);
+    for (int i = 0; i < entities_.size(); ++i) {
+        if (entities_.getModel(i) == nullptr) {
+            continue;
         }
-    }
-}
-
-void SceneManager::cleanup() {
-    instances_.clear();
-    models_.clear();
-}
-
-// ==================== MÉTHODES PUBLIQUES STATIQUES ====================
-void SceneManager::createTransformMatrix(const core::Vec3F& position,
-                                        const core::Vec3F& rotation,
-                                        const core::Vec3F& scale,
-                                        float* outMatrix) {
-    float translationMat[16], rotXMat[16], rotYMat[16], rotZMat[16], scaleMat[16];
-    float tempMat[16];
+        // AABB monde à jour depuis updateAllMatrices()
+        const Aabb& bounds = entities_.getWorldBounds(i);
 
-    // Créer les matrices individuelles
-    translationMatrix(translationMat, position.x, position.y, position.z);
-    rotationMatrixX(rotXMat, rotation.x);
-    rotationMatrixY(rotYMat, rotation.y);
-    rotationMatrixZ(rotZMat, rotation.z);
-    scaleMatrix(scaleMat, scale.x, scale.y, scale.z);
+        outMin.x = std::min(outMin.x, bounds.min[0]);
+        outMin.y = std::min(outMin.y, bounds.min[1]);
+        outMin.z = std::min(outMin.z, bounds.min[2]);
 
-    // Combiner les rotations (Z * Y * X)
-    multiplyMat4(tempMat, rotYMat, rotXMat);
-    float rotCombined[16];
-    multiplyMat4(rotCombined, rotZMat, tempMat);
-
-    // Appliquer l'échelle
-    multiplyMat4(tempMat, rotCombined, scaleMat);
-
-    // Appliquer la translation
-    multiplyMat4(outMatrix, translationMat, tempMat);
-}
-
-// ==================== MÉTHODES PRIVÉES ====================
-void SceneManager::multiplyMat4(float* out, const float* a, const float* b) {
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            out[i * 4 + j] = 0.0f;
-            for (int k = 0; k < 4; ++k) {
-                out[i * 4 + j] += a[i * 4 + k] * b[k * 4 + j];
-            }
-        }
+        outMax.x = std::max(outMax.x, bounds.max[0]);
+        outMax.y = std::max(outMax.y, bounds.max[1]);
+        outMax.z = std::max(outMax.z, bounds.max[2]);
     }
 }
 
-void SceneManager::translationMatrix(float* out, float x, float y, float z) {
-    identityMatrix(out);
-    out[12] = x;
-    out[13] = y;
-    out[14] = z;
-}
-
-void SceneManager::rotationMatrixX(float* out, float angle) {
-    identityMatrix(out);
-    float c = std::cos(angle);
-    float s = std::sin(angle);
-    out[5] = c;
-    out[6] = s;
-    out[9] = -s;
-    out[10] = c;
-}
-
-void SceneManager::rotationMatrixY(float* out, float angle) {
-    identityMatrix(out);
-    float c = std::cos(angle);
-    float s = std::sin(angle);
-    out[0] = c;
-    out[2] = -s;
-    out[8] = s;
-    out[10] = c;
-}
+bool SceneManager::getInstanceWorldBounds(InstanceHandle instance, core::Vec3F& outMin, core::Vec3F& outMax) const {
+    const int instanceIndex = entities_.indexOf(instance);
+    if (!entities_.isValid(instanceIndex) || entities_.getModel(instanceIndex) == nullptr) {
+        return false;
+    }
 
-void SceneManager::rotationMatrixZ(float* out, float angle) {
-    identityMatrix(out);
-    float c = std::cos(angle);
-    float s = std::sin(angle);
-    out[0] = c;
-    out[1] = s;
-    out[4] = -s;
-    out[5] = c;
+    const Aabb& bounds = entities_.getWorldBounds(instanceIndex);
+    outMin = {bounds.min[0], bounds.min[1], bounds.min[2]};
+    outMax = {bounds.max[0], bounds.max[1], bounds.max[2]};
+    return true;
 }
 
-void SceneManager::scaleMatrix(float* out, float x, float y, float z) {
-    identityMatrix(out);
-    out[0] = x;
-    out[5] = y;
-    out[10] = z;
+void SceneManager::cleanup() {
+    entities_.clear();
+    models_.clear();
+    staticGeometryVersion_++;
 }
 
-void SceneManager::identityMatrix(float* out) {
-    for (int i = 0; i < 16; ++i) {
-        out[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+// ==================== MÉTHODES PRIVÉES ====================
+void SceneManager::markStaticDirty(int instanceIndex) {
+    if (entities_.isStatic(instanceIndex)) {
+        staticGeometryVersion_++;
     }
 }
-
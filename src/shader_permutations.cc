@@ -0,0 +1,184 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/shader_permutations.h"
+#include <iostream>
+#include <sstream>
+
+std::unordered_map<std::string, std::string> ShaderPermutations::includes_;
+
+namespace {
+    // Garde-fou contre les inclusions cycliques
+    constexpr int MAX_INCLUDE_DEPTH = 8;
+}
+
+// ==================== CONSTRUCTEURS ====================
+ShaderPermutations::ShaderPermutations() = default;
+
+ShaderPermutations::~ShaderPermutations() {
+    cleanup();
+}
+
+// ==================== CONFIGURATION ====================
+void ShaderPermutations::initialize(const std::vector<ShaderStageSource> &stages,
+                                    const std::vector<PermutationFeature> &features,
+                                    const std::string &baseDefines) {
+    cleanup();
+    features_ = features;
+    baseDefines_ = baseDefines;
+
+    // Includes résolus une fois : les variantes ne diffèrent plus que par leurs defines
+    stages_.clear();
+    for (const ShaderStageSource &stage : stages) {
+        stages_.push_back({stage.type, preprocess(stage.source)});
+    }
+
+    if (getKeyBits() > 32) {
+        std::cerr << "ERROR: Shader permutation key needs " << getKeyBits() << " bits (max 32)" << std::endl;
+    }
+}
+
+void ShaderPermutations::setOnCreated(std::function<void(ShaderProgram &)> callback) {
+    onCreated_ = std::move(callback);
+}
+
+// ==================== CLÉS ====================
+ShaderPermutations::Key ShaderPermutations::makeKey(std::initializer_list<int> values) const {
+    Key key = 0;
+    int shift = 0;
+    size_t index = 0;
+    for (int value : values) {
+        if (index >= features_.size()) break;
+        const int bits = features_[index].bits;
+        const Key mask = (Key{1} << bits) - 1;
+        key |= (static_cast<Key>(value) & mask) << shift;
+        shift += bits;
+        ++index;
+    }
+    return key;
+}
+
+std::string ShaderPermutations::getDefines(Key key) const {
+    std::string defines = baseDefines_;
+    int shift = 0;
+    for (const PermutationFeature &feature : features_) {
+        const Key mask = (Key{1} << feature.bits) - 1;
+        const Key value = (key >> shift) & mask;
+        // Toujours défini (0 compris) : les shaders testent avec #if
+        defines += "\n#define " + feature.define + " " + std::to_string(value);
+        shift += feature.bits;
+    }
+    return defines;
+}
+
+int ShaderPermutations::getKeyBits() const {
+    int bits = 0;
+    for (const PermutationFeature &feature : features_) {
+        bits += feature.bits;
+    }
+    return bits;
+}
+
+// ==================== VARIANTES ====================
+void ShaderPermutations::precompile(Key key) {
+    if (!variants_.contains(key)) {
+        submit(key);
+    }
+}
+
+void ShaderPermutations::precompileAll() {
+    // Réservé aux petits ensembles : 2^bits variantes
+    const Key count = Key{1} << getKeyBits();
+    for (Key key = 0; key < count; ++key) {
+        precompile(key);
+    }
+}
+
+ShaderPermutations::Variant &ShaderPermutations::submit(Key key) {
+    Variant &variant = variants_[key];
+    variant.program = ProgramCache::submitProgram(stages_, getDefines(key));
+    variant.ready = false;
+    return variant;
+}
+
+ShaderProgram *ShaderPermutations::get(Key key) {
+    auto it = variants_.find(key);
+    Variant &variant = it != variants_.end() ? it->second : submit(key);
+
+    if (!variant.ready) {
+        // Première utilisation : c'est ici seulement qu'on attend le pilote
+        variant.program = ProgramCache::finalize(variant.program);
+        variant.ready = true;
+        if (variant.program == 0) {
+            std::cerr << "ERROR: Shader permutation build failed:" << getDefines(key) << std::endl;
+        } else {
+            variant.uniforms.reflect(variant.program);
+            if (onCreated_) {
+                onCreated_(variant.uniforms);
+            }
+        }
+    }
+    return variant.program != 0 ? &variant.uniforms : nullptr;
+}
+
+ShaderProgram *ShaderPermutations::bind(Key key) {
+    ShaderProgram *program = get(key);
+    glUseProgram(program != nullptr ? program->getId() : 0);
+    return program;
+}
+
+// ==================== NETTOYAGE ====================
+void ShaderPermutations::cleanup() {
+    for (auto &[key, variant] : variants_) {
+        if (variant.program == 0) continue;
+        if (!variant.ready) {
+            ProgramCache::discard(variant.program);
+        }
+        glDeleteProgram(variant.program);
+    }
+    variants_.clear();
+}
+
+// ==================== INCLUDES ====================
+void ShaderPermutations::registerInclude(const std::string &name, const std::string &source) {
+    includes_[name] = source;
+}
+
+std::string ShaderPermutations::preprocess(const std::string &source) {
+    return expandIncludes(source, 0);
+}
+
+std::string ShaderPermutations::expandIncludes(const std::string &source, int depth) {
+    if (source.find("#include") == std::string::npos) return source;
+    if (depth >= MAX_INCLUDE_DEPTH) {
+        std::cerr << "ERROR: Shader #include depth exceeds " << MAX_INCLUDE_DEPTH << " (cycle?)" << std::endl;
+        return source;
+    }
+
+    std::istringstream input(source);
+    std::string result;
+    std::string line;
+    while (std::getline(input, line)) {
+        const size_t directive = line.find("#include");
+        const size_t open = line.find('"', directive);
+        const size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+        // Seules les directives en début de ligne sont traitées (pas dans un commentaire)
+        const bool isDirective = directive != std::string::npos &&
+                                 line.find_first_not_of(" \t") == directive &&
+                                 close != std::string::npos;
+        if (!isDirective) {
+            result += line + "\n";
+            continue;
+        }
+
+        const std::string name = line.substr(open + 1, close - open - 1);
+        auto it = includes_.find(name);
+        if (it == includes_.end()) {
+            std::cerr << "ERROR: Unknown shader include \"" << name << "\"" << std::endl;
+            continue;
+        }
+        result += expandIncludes(it->second, depth + 1) + "\n";
+    }
+    return result;
+}
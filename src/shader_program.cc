@@ -0,0 +1,264 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/shader_program.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// ==================== CONSTRUCTEURS ====================
+ShaderProgram::ShaderProgram()
+    : program_(0),
+      skippedUploads_(0) {
+}
+
+// ==================== RÉFLEXION ====================
+void ShaderProgram::reflect(GLuint program) {
+    program_ = program;
+    uniforms_.clear();
+    blocks_.clear();
+    values_.clear();
+    skippedUploads_ = 0;
+    if (program_ == 0) {
+        return;
+    }
+
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramInterfaceiv(program_, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+    glGetProgramInterfaceiv(program_, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength);
+
+    std::string name(static_cast<size_t>(std::max(maxNameLength, 1)), '\0');
+    const GLenum properties[] = {GL_BLOCK_INDEX, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE};
+    for (GLint i = 0; i < count; ++i) {
+        GLint values[4];
+        glGetProgramResourceiv(program_, GL_UNIFORM, i, 4, properties, 4, nullptr, values);
+        // Membres de blocs : pas de location, ils sont adressés via le bloc
+        if (values[0] != -1 || values[1] < 0) {
+            continue;
+        }
+
+        GLsizei length = 0;
+        glGetProgramResourceName(program_, GL_UNIFORM, i, maxNameLength, &length, name.data());
+        const std::string_view uniformName(name.data(), length);
+        const GLint location = values[1];
+        const auto type = static_cast<GLenum>(values[2]);
+        const GLint arraySize = values[3];
+
+        addUniform(uniformName, location, type);
+
+        // Tableau : "tab[0]" est seul énuméré ; "tab" et "tab[i]" pointent vers des locations consécutives
+        if (uniformName.ends_with("[0]")) {
+            const std::string_view base = uniformName.substr(0, uniformName.size() - 3);
+            addUniform(base, location, type);
+            for (GLint element = 1; element < arraySize; ++element) {
+                addUniform(std::string(base) + "[" + std::to_string(element) + "]", location + element, type);
+            }
+        }
+    }
+
+    reflectBlocks(GL_UNIFORM_BLOCK);
+    reflectBlocks(GL_SHADER_STORAGE_BLOCK);
+
+    std::ranges::sort(uniforms_, {}, &Uniform::hash);
+    std::ranges::sort(blocks_, {}, &Block::hash);
+
+    const auto sameHash = [](const auto &a, const auto &b) { return a.hash == b.hash; };
+    if (std::ranges::adjacent_find(uniforms_, sameHash) != uniforms_.end() ||
+        std::ranges::adjacent_find(blocks_, sameHash) != blocks_.end()) {
+        std::cerr << "ERROR: Uniform name hash collision in program " << program_ << std::endl;
+    }
+}
+
+void ShaderProgram::invalidateCache() {
+    for (CachedValue &value : values_) {
+        value.cached = false;
+    }
+}
+
+void ShaderProgram::use() const {
+    glUseProgram(program_);
+}
+
+// ==================== REQUÊTES ====================
+GLint ShaderProgram::getLocation(UniformName name) const {
+    const Uniform *uniform = find(name);
+    return uniform != nullptr ? uniform->location : -1;
+}
+
+bool ShaderProgram::isSampler(UniformName name) const {
+    const Uniform *uniform = find(name);
+    return uniform != nullptr && isSamplerType(uniform->type);
+}
+
+GLuint ShaderProgram::getBlockIndex(UniformName name) const {
+    const auto it = std::ranges::lower_bound(blocks_, name.hash, {}, &Block::hash);
+    return it != blocks_.end() && it->hash == name.hash ? it->index : GL_INVALID_INDEX;
+}
+
+GLint ShaderProgram::getBlockDataSize(UniformName name) const {
+    const auto it = std::ranges::lower_bound(blocks_, name.hash, {}, &Block::hash);
+    return it != blocks_.end() && it->hash == name.hash ? it->dataSize : 0;
+}
+
+void ShaderProgram::setBlockBinding(UniformName name, GLuint binding) const {
+    const auto it = std::ranges::lower_bound(blocks_, name.hash, {}, &Block::hash);
+    if (it == blocks_.end() || it->hash != name.hash) {
+        return;
+    }
+    if (it->interface == GL_UNIFORM_BLOCK) {
+        glUniformBlockBinding(program_, it->index, binding);
+    } else {
+        glShaderStorageBlockBinding(program_, it->index, binding);
+    }
+}
+
+// ==================== ENVOIS ====================
+void ShaderProgram::setInt(UniformName name, int value) {
+    Uniform *uniform = findForUpload(name);
+    if (uniform != nullptr && changed(*uniform, &value, 1)) {
+        glProgramUniform1i(program_, uniform->location, value);
+    }
+}
+
+void ShaderProgram::setFloat(UniformName name, float value) {
+    Uniform *uniform = findForUpload(name);
+    if (uniform != nullptr && changed(*uniform, &value, 1)) {
+        glProgramUniform1f(program_, uniform->location, value);
+    }
+}
+
+void ShaderProgram::setVec2(UniformName name, float x, float y) {
+    const float value[2] = {x, y};
+    Uniform *uniform = findForUpload(name);
+    if (uniform != nullptr && changed(*uniform, value, 2)) {
+        glProgramUniform2fv(program_, uniform->location, 1, value);
+    }
+}
+
+void ShaderProgram::setVec3(UniformName name, float x, float y, float z) {
+    const float value[3] = {x, y, z};
+    setVec3(name, value);
+}
+
+void ShaderProgram::setVec3(UniformName name, const float *value) {
+    Uniform *uniform = findForUpload(name);
+    if (uniform != nullptr && changed(*uniform, value, 3)) {
+        glProgramUniform3fv(program_, uniform->location, 1, value);
+    }
+}
+
+void ShaderProgram::setVec4(UniformName name, float x, float y, float z, float w) {
+    const float value[4] = {x, y, z, w};
+    Uniform *uniform = findForUpload(name);
+    if (uniform != nullptr && changed(*uniform, value, 4)) {
+        glProgramUniform4fv(program_, uniform->location, 1, value);
+    }
+}
+
+void ShaderProgram::setMat4(UniformName name, const float *value) {
+    Uniform *uniform = findForUpload(name);
+    if (uniform != nullptr && changed(*uniform, value, 16)) {
+        glProgramUniformMatrix4fv(program_, uniform->location, 1, GL_FALSE, value);
+    }
+}
+
+void ShaderProgram::setFloatArray(UniformName name, const float *values, int count) {
+    const GLint location = getLocation(name);
+    if (location >= 0) {
+        invalidateLocations(location, count);
+        glProgramUniform1fv(program_, location, count, values);
+    }
+}
+
+void ShaderProgram::setVec3Array(UniformName name, const float *values, int count) {
+    const GLint location = getLocation(name);
+    if (location >= 0) {
+        invalidateLocations(location, count);
+        glProgramUniform3fv(program_, location, count, values);
+    }
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+const ShaderProgram::Uniform *ShaderProgram::find(UniformName name) const {
+    const auto it = std::ranges::lower_bound(uniforms_, name.hash, {}, &Uniform::hash);
+    return it != uniforms_.end() && it->hash == name.hash ? &*it : nullptr;
+}
+
+ShaderProgram::Uniform *ShaderProgram::findForUpload(UniformName name) {
+    // Un uniform absent (optimisé par le compilateur GLSL) est ignoré comme avec location = -1
+    return const_cast<Uniform *>(find(name));
+}
+
+bool ShaderProgram::changed(const Uniform &uniform, const void *value, int components) {
+    CachedValue &cache = values_[uniform.valueIndex];
+    const size_t size = static_cast<size_t>(components) * sizeof(std::uint32_t);
+    if (cache.cached && std::memcmp(cache.value.data(), value, size) == 0) {
+        ++skippedUploads_;
+        return false;
+    }
+    std::memcpy(cache.value.data(), value, size);
+    cache.cached = true;
+    return true;
+}
+
+void ShaderProgram::invalidateLocations(GLint location, int count) {
+    for (CachedValue &value : values_) {
+        if (value.location >= location && value.location < location + count) {
+            value.cached = false;
+        }
+    }
+}
+
+void ShaderProgram::addUniform(std::string_view name, GLint location, GLenum type) {
+    // Les alias d'un tableau ("tab" et "tab[0]") partagent la valeur mémorisée de leur location
+    auto it = std::ranges::find(values_, location, &CachedValue::location);
+    if (it == values_.end()) {
+        values_.push_back(CachedValue{location, false, {}});
+        it = values_.end() - 1;
+    }
+    const auto valueIndex = static_cast<std::uint32_t>(it - values_.begin());
+    uniforms_.push_back(Uniform{UniformName::runtime(name).hash, location, type, valueIndex});
+}
+
+void ShaderProgram::reflectBlocks(GLenum interface) {
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramInterfaceiv(program_, interface, GL_ACTIVE_RESOURCES, &count);
+    glGetProgramInterfaceiv(program_, interface, GL_MAX_NAME_LENGTH, &maxNameLength);
+
+    std::string name(static_cast<size_t>(std::max(maxNameLength, 1)), '\0');
+    const GLenum property = GL_BUFFER_DATA_SIZE;
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        glGetProgramResourceName(program_, interface, i, maxNameLength, &length, name.data());
+        GLint dataSize = 0;
+        glGetProgramResourceiv(program_, interface, i, 1, &property, 1, nullptr, &dataSize);
+        blocks_.push_back(Block{
+            UniformName::runtime(std::string_view(name.data(), length)).hash,
+            interface,
+            static_cast<GLuint>(i),
+            dataSize
+        });
+    }
+}
+
+bool ShaderProgram::isSamplerType(GLenum type) {
+    switch (type) {
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D:
+        case GL_UNSIGNED_INT_SAMPLER_2D:
+            return true;
+        default:
+            return false;
+    }
+}
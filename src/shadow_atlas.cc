@@ -0,0 +1,474 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "shadow_atlas.h"
+#include "frame_arena.h"
+#include "light_manager.h"
+#include "matrix_math.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+    constexpr float kPi = 3.14159265358979f;
+
+    // Directions et vecteurs "up" des 6 faces d'un cube map (convention OpenGL)
+    const core::Vec3F kCubeFaceDirections[6] = {
+        {1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}
+    };
+    const core::Vec3F kCubeFaceUps[6] = {
+        {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f},
+        {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}
+    };
+}
+
+// ==================== ALLOCATEUR QUADTREE ====================
+void ShadowAtlasAllocator::reset(int atlasSize, int minTileSize) {
+    nodes_.clear();
+    freeChildBlocks_.clear();
+    minTileSize_ = minTileSize;
+    usedArea_ = 0;
+    nodes_.push_back(Node{0, 0, atlasSize, -1, -1, false});
+}
+
+ShadowAtlasTile ShadowAtlasAllocator::allocate(int size) {
+    if (nodes_.empty() || size <= 0) {
+        return {};
+    }
+
+    int nodeIndex = allocateInNode(0, size);
+    if (nodeIndex < 0) {
+        return {};
+    }
+
+    const Node &node = nodes_[nodeIndex];
+    usedArea_ += node.size * node.size;
+    return ShadowAtlasTile{node.x, node.y, node.size, nodeIndex};
+}
+
+void ShadowAtlasAllocator::release(const ShadowAtlasTile &tile) {
+    if (!tile.isValid() || tile.node >= static_cast<int>(nodes_.size())) {
+        return;
+    }
+
+    Node &node = nodes_[tile.node];
+    if (!node.occupied) {
+        return;
+    }
+    node.occupied = false;
+    usedArea_ -= node.size * node.size;
+
+    // Refusionner tant que les 4 frères sont des feuilles libres
+    int parent = node.parent;
+    while (parent >= 0) {
+        int first = nodes_[parent].firstChild;
+        bool allFree = true;
+        for (int i = 0; i < 4; ++i) {
+            if (!isFreeLeaf(first + i)) {
+                allFree = false;
+                break;
+            }
+        }
+        if (!allFree) {
+            break;
+        }
+
+        freeChildBlocks_.push_back(first);
+        nodes_[parent].firstChild = -1;
+        parent = nodes_[parent].parent;
+    }
+}
+
+int ShadowAtlasAllocator::allocateInNode(int nodeIndex, int size) {
+    const Node node = nodes_[nodeIndex];
+    if (node.occupied || node.size < size) {
+        return -1;
+    }
+
+    if (node.firstChild < 0) {
+        if (node.size == size) {
+            nodes_[nodeIndex].occupied = true;
+            return nodeIndex;
+        }
+        if (node.size / 2 < minTileSize_) {
+            return -1;
+        }
+        split(nodeIndex);
+    } else if (node.size == size) {
+        // Noeud déjà partiellement utilisé
+        return -1;
+    }
+
+    int first = nodes_[nodeIndex].firstChild;
+    for (int i = 0; i < 4; ++i) {
+        int result = allocateInNode(first + i, size);
+        if (result >= 0) {
+            return result;
+        }
+    }
+    return -1;
+}
+
+void ShadowAtlasAllocator::split(int nodeIndex) {
+    int first;
+    if (!freeChildBlocks_.empty()) {
+        first = freeChildBlocks_.back();
+        freeChildBlocks_.pop_back();
+    } else {
+        first = static_cast<int>(nodes_.size());
+        nodes_.resize(nodes_.size() + 4);
+    }
+
+    const Node parent = nodes_[nodeIndex];
+    int half = parent.size / 2;
+    for (int i = 0; i < 4; ++i) {
+        nodes_[first + i] = Node{
+            parent.x + (i % 2) * half,
+            parent.y + (i / 2) * half,
+            half, nodeIndex, -1, false
+        };
+    }
+    nodes_[nodeIndex].firstChild = first;
+}
+
+bool ShadowAtlasAllocator::isFreeLeaf(int nodeIndex) const {
+    return !nodes_[nodeIndex].occupied && nodes_[nodeIndex].firstChild < 0;
+}
+
+// ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
+ShadowAtlas::ShadowAtlas()
+    : atlasDepthTexture_(0),
+      atlasSize_(0),
+      minTileSize_(128),
+      maxTileSize_(1024),
+      sceneVersion_(0) {
+}
+
+ShadowAtlas::~ShadowAtlas() {
+    cleanup();
+}
+
+// ==================== INITIALISATION ====================
+void ShadowAtlas::initialize(int atlasSize, int minTileSize, int maxTileSize) {
+    cleanup();
+    atlasSize_ = atlasSize;
+    minTileSize_ = minTileSize;
+    maxTileSize_ = std::min(maxTileSize, atlasSize);
+    allocator_.reset(atlasSize_, minTileSize_);
+
+    glGenTextures(1, &atlasDepthTexture_);
+    glBindTexture(GL_TEXTURE_2D, atlasDepthTexture_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, atlasSize_, atlasSize_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// ==================== MISE À JOUR ====================
+void ShadowAtlas::update(std::span<const Light *const> lights,
+                         const core::Vec3F &cameraPosition,
+                         float cameraFovY,
+                         int screenHeight,
+                         std::uint64_t sceneVersion) {
+    if (!isInitialized()) {
+        return;
+    }
+
+    const bool sceneChanged = sceneVersion != sceneVersion_;
+    sceneVersion_ = sceneVersion;
+
+    // 1. Retirer les lumières qui ne demandent plus d'ombre
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (std::find(lights.begin(), lights.end(), it->light) == lights.end()) {
+            releaseEntry(*it);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // 2. Priorité (taille projetée à l'écran) et contenu de chaque lumière
+    for (const Light *light: lights) {
+        if (light == nullptr || (light->type != LightType::POINT && light->type != LightType::SPOT)) {
+            continue;
+        }
+
+        auto it = std::find_if(entries_.begin(), entries_.end(),
+                               [light](const ShadowAtlasEntry &e) { return e.light == light; });
+        if (it == entries_.end()) {
+            ShadowAtlasEntry entry;
+            entry.light = light;
+            entry.faceCount = light->type == LightType::POINT ? 6 : 1;
+            entries_.push_back(entry);
+            it = entries_.end() - 1;
+        }
+
+        const float range = computeRange(*light);
+        it->range = range;
+        it->priority = computeScreenSize(light->position, range, cameraPosition, cameraFovY, screenHeight);
+
+        const std::uint64_t hash = hashLight(*light);
+        if (hash != it->contentHash || it->resolution == 0) {
+            it->contentHash = hash;
+            computeMatrices(*it, range);
+            it->needsRender = true;
+        }
+        if (sceneChanged) {
+            it->needsRender = true;
+        }
+    }
+
+    // 3. Budget : les lumières les plus visibles servent d'abord, on divise la résolution si l'atlas est plein
+    // Temporaires de la frame : arène du thread, pas de tas
+    FrameArena &arena = FrameArena::forThread();
+    std::pmr::vector<int> order(entries_.size(), &arena);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return entries_[a].priority > entries_[b].priority;
+    });
+
+    std::pmr::vector<int> budgeted(entries_.size(), 0, &arena);
+    long long remainingArea = static_cast<long long>(atlasSize_) * atlasSize_;
+    for (int index: order) {
+        const ShadowAtlasEntry &entry = entries_[index];
+        int resolution = resolutionForScreenSize(entry.priority);
+        auto cost = [&entry](int res) { return static_cast<long long>(res) * res * entry.faceCount; };
+        while (resolution > minTileSize_ && cost(resolution) > remainingArea) {
+            resolution /= 2;
+        }
+        if (cost(resolution) > remainingArea) {
+            resolution = 0;
+        }
+        remainingArea -= cost(resolution);
+        budgeted[index] = resolution;
+    }
+
+    // 4. Réutiliser les tuiles dont la résolution ne change pas, libérer les autres
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].resolution != budgeted[i]) {
+            releaseEntry(entries_[i]);
+        }
+    }
+
+    // 5. Allouer les nouvelles tuiles, plus grandes d'abord (pas de fragmentation dans un quadtree)
+    std::sort(order.begin(), order.end(), [&budgeted](int a, int b) {
+        return budgeted[a] > budgeted[b];
+    });
+
+    bool fragmented = false;
+    for (int index: order) {
+        if (budgeted[index] > 0 && entries_[index].resolution == 0 &&
+            !allocateEntry(entries_[index], budgeted[index])) {
+            fragmented = true;
+            break;
+        }
+    }
+
+    // Les tuiles conservées ont fragmenté l'atlas : tout ré-allouer
+    if (fragmented) {
+        allocator_.reset(atlasSize_, minTileSize_);
+        for (auto &entry: entries_) {
+            entry.tiles = {};
+            entry.resolution = 0;
+        }
+        for (int index: order) {
+            if (budgeted[index] > 0) {
+                allocateEntry(entries_[index], budgeted[index]);
+            }
+        }
+    }
+}
+
+void ShadowAtlas::releaseLight(const Light *light) {
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [light](const ShadowAtlasEntry &e) { return e.light == light; });
+    if (it != entries_.end()) {
+        releaseEntry(*it);
+        entries_.erase(it);
+    }
+}
+
+// ==================== RENDU ====================
+void ShadowAtlas::copyFromLayers(const ShadowAtlasEntry &entry, GLuint depthTextureArray) const {
+    // Copie GPU à GPU, même format (DEPTH_COMPONENT32F) : les autres tuiles gardent leur contenu
+    for (int face = 0; face < entry.faceCount; ++face) {
+        const ShadowAtlasTile &tile = entry.tiles[face];
+        glCopyImageSubData(depthTextureArray, GL_TEXTURE_2D_ARRAY, 0, 0, 0, face,
+                           atlasDepthTexture_, GL_TEXTURE_2D, 0, tile.x, tile.y, 0,
+                           tile.size, tile.size, 1);
+    }
+}
+
+void ShadowAtlas::invalidateBounds(const core::Vec3F &boundsMin, const core::Vec3F &boundsMax) {
+    for (auto &entry: entries_) {
+        if (entry.hasShadow() && sphereIntersectsBounds(entry.light->position, entry.range, boundsMin, boundsMax)) {
+            entry.needsRender = true;
+        }
+    }
+}
+
+void ShadowAtlas::markRendered() {
+    for (auto &entry: entries_) {
+        entry.needsRender = false;
+    }
+}
+
+// ==================== GETTERS ====================
+const ShadowAtlasEntry *ShadowAtlas::getEntry(const Light *light) const {
+    for (const auto &entry: entries_) {
+        if (entry.light == light) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool ShadowAtlas::hasPendingTiles() const {
+    return std::any_of(entries_.begin(), entries_.end(), [](const ShadowAtlasEntry &e) {
+        return e.needsRender && e.hasShadow();
+    });
+}
+
+bool ShadowAtlas::sphereIntersectsBounds(const core::Vec3F &center, float radius,
+                                         const core::Vec3F &boundsMin, const core::Vec3F &boundsMax) {
+    const float dx = std::max({boundsMin.x - center.x, 0.0f, center.x - boundsMax.x});
+    const float dy = std::max({boundsMin.y - center.y, 0.0f, center.y - boundsMax.y});
+    const float dz = std::max({boundsMin.z - center.z, 0.0f, center.z - boundsMax.z});
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+void ShadowAtlas::getTileUVTransform(const ShadowAtlasTile &tile, float *out) const {
+    const float invSize = atlasSize_ > 0 ? 1.0f / static_cast<float>(atlasSize_) : 0.0f;
+    out[0] = tile.size * invSize;
+    out[1] = tile.size * invSize;
+    out[2] = tile.x * invSize;
+    out[3] = tile.y * invSize;
+}
+
+// ==================== NETTOYAGE ====================
+void ShadowAtlas::cleanup() {
+    if (atlasDepthTexture_ != 0) {
+        glDeleteTextures(1, &atlasDepthTexture_);
+        atlasDepthTexture_ = 0;
+    }
+    entries_.clear();
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+int ShadowAtlas::resolutionForScreenSize(float screenSize) const {
+    int resolution = minTileSize_;
+    while (resolution < screenSize && resolution < maxTileSize_) {
+        resolution *= 2;
+    }
+    return resolution;
+}
+
+float ShadowAtlas::computeScreenSize(const core::Vec3F &lightPosition, float range,
+                                     const core::Vec3F &cameraPosition,
+                                     float cameraFovY, int screenHeight) {
+    const float distance = (lightPosition - cameraPosition).magnitude();
+    if (distance <= range) {
+        // Caméra dans le volume de la lumière : couverture maximale
+        return static_cast<float>(screenHeight);
+    }
+
+    // Diamètre angulaire de la sphère d'influence rapporté au champ de vision vertical
+    const float angularRadius = std::asin(range / distance);
+    const float halfFov = cameraFovY * kPi / 360.0f;
+    return std::tan(angularRadius) / std::tan(halfFov) * static_cast<float>(screenHeight);
+}
+
+bool ShadowAtlas::allocateEntry(ShadowAtlasEntry &entry, int resolution) {
+    for (int face = 0; face < entry.faceCount; ++face) {
+        entry.tiles[face] = allocator_.allocate(resolution);
+        if (!entry.tiles[face].isValid()) {
+            releaseEntry(entry);
+            return false;
+        }
+    }
+    entry.resolution = resolution;
+    entry.needsRender = true;
+    return true;
+}
+
+void ShadowAtlas::releaseEntry(ShadowAtlasEntry &entry) {
+    for (auto &tile: entry.tiles) {
+        allocator_.release(tile);
+        tile = {};
+    }
+    entry.resolution = 0;
+}
+
+void ShadowAtlas::computeMatrices(ShadowAtlasEntry &entry, float range) {
+    const Light &light = *entry.light;
+    const float nearPlane = 0.1f;
+
+    if (light.type == LightType::SPOT) {
+        const auto &spot = static_cast<const SpotLight &>(light);
+        core::Vec3F dir = light.direction.Normalize();
+        // Éviter un "up" colinéaire à la direction
+        core::Vec3F up = std::abs(dir.y) > 0.99f ? core::Vec3F{1.0f, 0.0f, 0.0f} : core::Vec3F{0.0f, 1.0f, 0.0f};
+
+        MatrixMath::lookAt(entry.viewMatrices[0].data(), light.position, light.position + dir, up);
+        MatrixMath::perspective(entry.projMatrices[0].data(), 2.0f * spot.outerCutOff, 1.0f, nearPlane, range);
+        MatrixMath::multiply(entry.viewProjMatrices[0].data(), entry.projMatrices[0].data(), entry.viewMatrices[0].data());
+        return;
+    }
+
+    for (int face = 0; face < 6; ++face) {
+        MatrixMath::lookAt(entry.viewMatrices[face].data(), light.position,
+                           light.position + kCubeFaceDirections[face], kCubeFaceUps[face]);
+        MatrixMath::perspective(entry.projMatrices[face].data(), 90.0f, 1.0f, nearPlane, range);
+        MatrixMath::multiply(entry.viewProjMatrices[face].data(),
+                             entry.projMatrices[face].data(), entry.viewMatrices[face].data());
+    }
+}
+
+float ShadowAtlas::computeRange(const Light &light) {
+    if (light.type == LightType::POINT) {
+        return static_cast<const PointLight &>(light).radius;
+    }
+
+    // Spot : distance où l'atténuation passe sous 1/256 de l'intensité
+    const auto &spot = static_cast<const SpotLight &>(light);
+    const float threshold = 256.0f * light.intensity;
+    if (spot.quadratic <= 0.0f) {
+        return spot.linear > 0.0f ? (threshold - spot.constant) / spot.linear : 100.0f;
+    }
+    const float delta = spot.linear * spot.linear - 4.0f * spot.quadratic * (spot.constant - threshold);
+    return (-spot.linear + std::sqrt(delta)) / (2.0f * spot.quadratic);
+}
+
+std::uint64_t ShadowAtlas::hashLight(const Light &light) {
+    // FNV-1a sur les paramètres qui influencent la shadow map
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    mix(&light.position, sizeof(light.position));
+    mix(&light.type, sizeof(light.type));
+    if (light.type == LightType::SPOT) {
+        const auto &spot = static_cast<const SpotLight &>(light);
+        mix(&light.direction, sizeof(light.direction));
+        mix(&spot.outerCutOff, sizeof(spot.outerCutOff));
+        mix(&spot.linear, sizeof(spot.linear));
+        mix(&spot.quadratic, sizeof(spot.quadratic));
+        mix(&light.intensity, sizeof(light.intensity));
+    } else {
+        const auto &point = static_cast<const PointLight &>(light);
+        mix(&point.radius, sizeof(point.radius));
+    }
+    return hash;
+}
@@ -0,0 +1,137 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "shadow_cache.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// ==================== FRUSTUM ====================
+void ShadowFrustum::extract(const float *viewProj) {
+    // Matrice column-major : la ligne r est (m[r], m[4 + r], m[8 + r], m[12 + r])
+    auto row = [viewProj](int r, int c) { return viewProj[c * 4 + r]; };
+
+    for (int i = 0; i < 3; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            planes[i * 2][c] = row(3, c) + row(i, c);     // gauche, bas, proche
+            planes[i * 2 + 1][c] = row(3, c) - row(i, c); // droite, haut, lointain
+        }
+    }
+
+    for (auto &plane: planes) {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (float &v: plane) {
+                v /= length;
+            }
+        }
+    }
+}
+
+bool ShadowFrustum::intersectsAABB(const core::Vec3F &min, const core::Vec3F &max) const {
+    for (const auto &plane: planes) {
+        // Coin "positif" : le plus loin dans la direction de la normale
+        float px = plane[0] >= 0.0f ? max.x : min.x;
+        float py = plane[1] >= 0.0f ? max.y : min.y;
+        float pz = plane[2] >= 0.0f ? max.z : min.z;
+
+        if (plane[0] * px + plane[1] * py + plane[2] * pz + plane[3] < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
+ShadowCache::ShadowCache()
+    : cacheFramebuffer_(0),
+      cacheDepthTexture_(0),
+      width_(0),
+      height_(0),
+      cachedLightSpaceMatrix_{},
+      cachedStaticVersion_(0),
+      valid_(false),
+      rebuildCount_(0) {
+}
+
+ShadowCache::~ShadowCache() {
+    cleanup();
+}
+
+// ==================== INITIALISATION ====================
+void ShadowCache::initialize(int width, int height, GLenum internalFormat) {
+    cleanup();
+    width_ = width;
+    height_ = height;
+
+    // Même format que la shadow map : glCopyImageSubData exige des formats compatibles
+    glGenTextures(1, &cacheDepthTexture_);
+    glBindTexture(GL_TEXTURE_2D, cacheDepthTexture_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width_, height_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &cacheFramebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, cacheFramebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                           GL_TEXTURE_2D, cacheDepthTexture_, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Shadow cache framebuffer is not complete!" << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    valid_ = false;
+}
+
+// ==================== CACHE ====================
+bool ShadowCache::isValid(const float *lightSpaceMatrix, std::uint64_t staticVersion) const {
+    if (!valid_ || lightSpaceMatrix == nullptr) {
+        return false;
+    }
+    return staticVersion == cachedStaticVersion_ &&
+           std::memcmp(lightSpaceMatrix, cachedLightSpaceMatrix_.data(), sizeof(float) * 16) == 0;
+}
+
+void ShadowCache::beginStaticLayer() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, cacheFramebuffer_);
+    glViewport(0, 0, width_, height_);
+    glClearDepth(1.0f);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void ShadowCache::endStaticLayer(const float *lightSpaceMatrix, std::uint64_t staticVersion) {
+    std::memcpy(cachedLightSpaceMatrix_.data(), lightSpaceMatrix, sizeof(float) * 16);
+    cachedStaticVersion_ = staticVersion;
+    valid_ = true;
+    rebuildCount_++;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool ShadowCache::copyInto(GLuint shadowDepthTexture) const {
+    if (!valid_ || shadowDepthTexture == 0) {
+        return false;
+    }
+    // Copie GPU -> GPU, remplace le clear de la shadow map
+    glCopyImageSubData(cacheDepthTexture_, GL_TEXTURE_2D, 0, 0, 0, 0,
+                       shadowDepthTexture, GL_TEXTURE_2D, 0, 0, 0, 0,
+                       width_, height_, 1);
+    return true;
+}
+
+// ==================== NETTOYAGE ====================
+void ShadowCache::cleanup() {
+    if (cacheFramebuffer_ != 0) {
+        glDeleteFramebuffers(1, &cacheFramebuffer_);
+        cacheFramebuffer_ = 0;
+    }
+    if (cacheDepthTexture_ != 0) {
+        glDeleteTextures(1, &cacheDepthTexture_);
+        cacheDepthTexture_ = 0;
+    }
+    valid_ = false;
+}
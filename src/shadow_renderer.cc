@@ -3,6 +3,7 @@
 //
 
 #include "shadow_renderer.h"
+#include "program_cache.h"
 #include <iostream>
 #include <cstring>
 // ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
@@ -12,6 +13,15 @@ ShadowRenderer::ShadowRenderer()
       projMatrixLoc_(-1),
       viewMatrixLoc_(-1),
       lightSpaceMatrixLoc_(-1),
+      momentsProgram_(0),
+      momentsBlurProgram_(0),
+      fullscreenVAO_(0),
+      momentsDepthLoc_(-1),
+      momentsRadiusLoc_(-1),
+      momentsModeLoc_(-1),
+      momentsExponentsLoc_(-1),
+      blurMomentsLoc_(-1),
+      blurRadiusLoc_(-1),
       lightManager_(nullptr),
       initialized_(false) {
 }
@@ -23,6 +33,7 @@ ShadowRenderer::~ShadowRenderer() {
 // ==================== INITIALISATION ====================
 void ShadowRenderer::initialize(LightManager& lightManager) {
     lightManager_ = &lightManager;
+    staticCache_.initialize(lightManager.getShadowMapWidth(), lightManager.getShadowMapHeight());
     initialized_ = true;
 }
 
@@ -33,21 +44,7 @@ bool ShadowRenderer::loadShaders(const std::string& vertexShaderSource,
         return false;
     }
 
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    if (vertexShader == 0) {
-        return false;
-    }
-
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    if (fragmentShader == 0) {
-        glDeleteShader(vertexShader);
-        return false;
-    }
-
-    shaderProgram_ = createProgram(vertexShader, fragmentShader);
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    shaderProgram_ = ProgramCache::finalize(submitProgram(vertexShaderSource, fragmentShaderSource));
 
     if (shaderProgram_ == 0) {
         return false;
@@ -68,7 +65,10 @@ void ShadowRenderer::beginShadowPass() {
         return;
     }
 
-    lightManager_->bindShadowFramebuffer();
+    // La couche statique en cache remplace le clear : seuls les casters dynamiques restent à dessiner.
+    // Cache absent ou invalidé (pas encore reconstruit) : rien n'est copié, la shadow map est vidée
+    const bool copied = staticCache_.copyInto(lightManager_->getShadowDepthTexture());
+    lightManager_->bindShadowFramebuffer(!copied);
 
     // Configuration OpenGL pour le rendu des ombres
     glEnable(GL_DEPTH_TEST);
@@ -87,6 +87,70 @@ void ShadowRenderer::endShadowPass() {
     lightManager_->unbindShadowFramebuffer();
 }
 
+void ShadowRenderer::prefilterMoments() {
+    if (lightManager_ == nullptr || lightManager_->getShadowFilterMode() == ShadowFilterMode::HARD ||
+        lightManager_->getShadowMomentsTexture() == 0) {
+        return;
+    }
+    if (momentsProgram_ == 0 && !loadMomentsShaders()) {
+        return;
+    }
+
+    const bool evsm = lightManager_->getShadowFilterMode() == ShadowFilterMode::EVSM;
+    const int radius = lightManager_->getShadowBlurRadius();
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glBindVertexArray(fullscreenVAO_);
+    glActiveTexture(GL_TEXTURE0);
+
+    // 1. Profondeur -> moments, flou horizontal
+    lightManager_->bindShadowBlurFramebuffer();
+    glUseProgram(momentsProgram_);
+    glBindTexture(GL_TEXTURE_2D, lightManager_->getShadowDepthTexture());
+    glUniform1i(momentsDepthLoc_, 0);
+    glUniform1i(momentsRadiusLoc_, radius);
+    glUniform1i(momentsModeLoc_, evsm ? 2 : 1);
+    glUniform2f(momentsExponentsLoc_,
+                lightManager_->getEVSMPositiveExponent(), lightManager_->getEVSMNegativeExponent());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // 2. Flou vertical -> niveau 0 des moments
+    lightManager_->bindShadowMomentsFramebuffer();
+    glUseProgram(momentsBlurProgram_);
+    glBindTexture(GL_TEXTURE_2D, lightManager_->getShadowBlurTexture());
+    glUniform1i(blurMomentsLoc_, 0);
+    glUniform1i(blurRadiusLoc_, radius);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // 3. Mipmaps : le filtrage trilinéaire remplace les taps PCF
+    glBindTexture(GL_TEXTURE_2D, lightManager_->getShadowMomentsTexture());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    lightManager_->unbindShadowFramebuffer();
+    glEnable(GL_DEPTH_TEST);
+}
+
+// ==================== CACHE DES CASTERS STATIQUES ====================
+bool ShadowRenderer::beginStaticCasterPass(const float* lightSpaceMatrix, std::uint64_t staticVersion) {
+    if (!staticCache_.isInitialized() || staticCache_.isValid(lightSpaceMatrix, staticVersion)) {
+        return false;
+    }
+
+    staticCache_.beginStaticLayer();
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+    return true;
+}
+
+void ShadowRenderer::endStaticCasterPass(const float* lightSpaceMatrix, std::uint64_t staticVersion) {
+    staticCache_.endStaticLayer(lightSpaceMatrix, staticVersion);
+}
+
 void ShadowRenderer::bindShader() const {
     glUseProgram(shaderProgram_);
 }
@@ -120,47 +184,29 @@ void ShadowRenderer::setLightSpaceMatrix(const float* lightSpaceMatrix) const {
 }
 
 void ShadowRenderer::cleanup() {
+    staticCache_.cleanup();
     if (shaderProgram_ != 0) {
         glDeleteProgram(shaderProgram_);
         shaderProgram_ = 0;
     }
-}
-
-// ==================== MÉTHODES PRIVÉES ====================
-GLuint ShadowRenderer::compileShader(GLenum type, const std::string& source) {
-    GLuint shader = glCreateShader(type);
-    const char* src = source.c_str();
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
-
-    // Vérifier les erreurs de compilation
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        printShaderError(shader, type);
-        glDeleteShader(shader);
-        return 0;
+    if (momentsProgram_ != 0) {
+        glDeleteProgram(momentsProgram_);
+        momentsProgram_ = 0;
     }
-
-    return shader;
-}
-
-GLuint ShadowRenderer::createProgram(GLuint vertexShader, GLuint fragmentShader) {
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-
-    // Vérifier les erreurs de liaison
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        printProgramError(program);
-        glDeleteProgram(program);
-        return 0;
+    if (momentsBlurProgram_ != 0) {
+        glDeleteProgram(momentsBlurProgram_);
+        momentsBlurProgram_ = 0;
+    }
+    if (fullscreenVAO_ != 0) {
+        glDeleteVertexArrays(1, &fullscreenVAO_);
+        fullscreenVAO_ = 0;
     }
+}
 
-    return program;
+// ==================== MÉTHODES PRIVÉES ====================
+GLuint ShadowRenderer::submitProgram(const std::string& vertexSource, const std::string& fragmentSource) {
+    return ProgramCache::submitProgram({{GL_VERTEX_SHADER, vertexSource},
+                                        {GL_FRAGMENT_SHADER, fragmentSource}});
 }
 
 void ShadowRenderer::initializeUniformLocations() {
@@ -174,36 +220,27 @@ void ShadowRenderer::initializeUniformLocations() {
     lightSpaceMatrixLoc_ = glGetUniformLocation(shaderProgram_, "uLightSpaceMatrix");
 }
 
-void ShadowRenderer::printShaderError(GLuint shader, GLenum type) {
-    GLint logLength = 0;
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-
-    if (logLength > 0) {
-        char* log = new char[logLength];
-        glGetShaderInfoLog(shader, logLength, nullptr, log);
+bool ShadowRenderer::loadMomentsShaders() {
+    // Soumis ensemble pour que les deux compilations se recouvrent
+    momentsProgram_ = submitProgram(getFullscreenVertexShader(), getMomentsFragmentShader());
+    momentsBlurProgram_ = submitProgram(getFullscreenVertexShader(), getMomentsBlurFragmentShader());
+    momentsProgram_ = ProgramCache::finalize(momentsProgram_);
+    momentsBlurProgram_ = ProgramCache::finalize(momentsBlurProgram_);
 
-        const char* typeStr = (type == GL_VERTEX_SHADER) ? "VERTEX" :
-                             (type == GL_FRAGMENT_SHADER) ? "FRAGMENT" : "UNKNOWN";
-        std::cerr << "ERROR: " << typeStr << " shader compilation failed:" << std::endl;
-        std::cerr << log << std::endl;
-
-        delete[] log;
+    if (momentsProgram_ == 0 || momentsBlurProgram_ == 0) {
+        return false;
     }
-}
-
-void ShadowRenderer::printProgramError(GLuint program) {
-    GLint logLength = 0;
-    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
-
-    if (logLength > 0) {
-        char* log = new char[logLength];
-        glGetProgramInfoLog(program, logLength, nullptr, log);
 
-        std::cerr << "ERROR: Program linking failed:" << std::endl;
-        std::cerr << log << std::endl;
+    momentsDepthLoc_ = glGetUniformLocation(momentsProgram_, "uDepth");
+    momentsRadiusLoc_ = glGetUniformLocation(momentsProgram_, "uRadius");
+    momentsModeLoc_ = glGetUniformLocation(momentsProgram_, "uMode");
+    momentsExponentsLoc_ = glGetUniformLocation(momentsProgram_, "uExponents");
+    blurMomentsLoc_ = glGetUniformLocation(momentsBlurProgram_, "uMoments");
+    blurRadiusLoc_ = glGetUniformLocation(momentsBlurProgram_, "uRadius");
 
-        delete[] log;
-    }
+    // Triangle plein écran généré depuis gl_VertexID : VAO vide
+    glGenVertexArrays(1, &fullscreenVAO_);
+    return true;
 }
 
 // ==================== SHADERS PAR DÉFAUT ====================
@@ -240,3 +277,77 @@ void main()
 }
     )";
 }
+
+std::string ShadowRenderer::getFullscreenVertexShader() {
+    return R"(
+#version 430 core
+
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+    )";
+}
+
+std::string ShadowRenderer::getMomentsFragmentShader() {
+    return R"(
+#version 430 core
+
+layout(location = 0) out vec4 FragMoments;
+
+uniform sampler2D uDepth;
+uniform int uRadius;
+uniform int uMode;       // 1 = VSM, 2 = EVSM
+uniform vec2 uExponents; // EVSM : exposants positif / négatif
+
+vec4 computeMoments(float depth)
+{
+    if (uMode == 2) {
+        float d = 2.0 * depth - 1.0;
+        float positive = exp(uExponents.x * d);
+        float negative = -exp(-uExponents.y * d);
+        return vec4(positive, positive * positive, negative, negative * negative);
+    }
+    return vec4(depth, depth * depth, 0.0, 0.0);
+}
+
+void main()
+{
+    ivec2 size = textureSize(uDepth, 0);
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+
+    // Flou horizontal (box) des moments, pas de la profondeur
+    vec4 sum = vec4(0.0);
+    for (int i = -uRadius; i <= uRadius; ++i) {
+        int x = clamp(coord.x + i, 0, size.x - 1);
+        sum += computeMoments(texelFetch(uDepth, ivec2(x, coord.y), 0).r);
+    }
+    FragMoments = sum / float(2 * uRadius + 1);
+}
+    )";
+}
+
+std::string ShadowRenderer::getMomentsBlurFragmentShader() {
+    return R"(
+#version 430 core
+
+layout(location = 0) out vec4 FragMoments;
+
+uniform sampler2D uMoments;
+uniform int uRadius;
+
+void main()
+{
+    ivec2 size = textureSize(uMoments, 0);
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+
+    vec4 sum = vec4(0.0);
+    for (int i = -uRadius; i <= uRadius; ++i) {
+        int y = clamp(coord.y + i, 0, size.y - 1);
+        sum += texelFetch(uMoments, ivec2(coord.x, y), 0);
+    }
+    FragMoments = sum / float(2 * uRadius + 1);
+}
+    )";
+}
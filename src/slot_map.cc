@@ -0,0 +1,101 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/slot_map.h"
+#include <limits>
+
+namespace {
+    constexpr std::uint32_t MAX_GENERATION = std::numeric_limits<std::uint32_t>::max();
+}
+
+// ==================== CONSTRUCTEURS ====================
+SlotIndex::SlotIndex()
+    : freeHead_(SlotHandle::INVALID_INDEX) {
+}
+
+// ==================== ÉLÉMENTS ====================
+SlotHandle SlotIndex::insert() {
+    const auto denseIndex = static_cast<std::uint32_t>(denseToSlot_.size());
+
+    std::uint32_t slot;
+    if (freeHead_ != SlotHandle::INVALID_INDEX) {
+        slot = freeHead_;
+        freeHead_ = slots_[slot].denseIndex;
+    } else {
+        slot = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back({0, 0});
+    }
+
+    slots_[slot].denseIndex = denseIndex;
+    denseToSlot_.push_back(slot);
+    return {slot, slots_[slot].generation};
+}
+
+int SlotIndex::erase(SlotHandle handle) {
+    const int index = indexOf(handle);
+    if (index < 0) {
+        return -1;
+    }
+
+    // Le dernier élément dense prend la place libérée
+    const std::uint32_t lastSlot = denseToSlot_.back();
+    denseToSlot_[index] = lastSlot;
+    slots_[lastSlot].denseIndex = static_cast<std::uint32_t>(index);
+    denseToSlot_.pop_back();
+
+    // Génération incrémentée : les handles encore en circulation deviennent obsolètes.
+    // Un emplacement arrivé au bout de ses générations est retiré plutôt que recyclé.
+    Slot& slot = slots_[handle.index];
+    if (slot.generation != MAX_GENERATION) {
+        slot.generation++;
+        slot.denseIndex = freeHead_;
+        freeHead_ = handle.index;
+    } else {
+        slot.denseIndex = SlotHandle::INVALID_INDEX;
+    }
+    return index;
+}
+
+void SlotIndex::clear() {
+    // Les emplacements restent, générations incrémentées : aucun ancien handle ne revit
+    freeHead_ = SlotHandle::INVALID_INDEX;
+    for (std::uint32_t i = static_cast<std::uint32_t>(slots_.size()); i-- > 0;) {
+        Slot& slot = slots_[i];
+        if (slot.generation == MAX_GENERATION) {
+            slot.denseIndex = SlotHandle::INVALID_INDEX;
+            continue;
+        }
+        slot.generation++;
+        slot.denseIndex = freeHead_;
+        freeHead_ = i;
+    }
+    denseToSlot_.clear();
+}
+
+void SlotIndex::reserve(std::size_t capacity) {
+    slots_.reserve(capacity);
+    denseToSlot_.reserve(capacity);
+}
+
+// ==================== ACCÈS ====================
+int SlotIndex::indexOf(SlotHandle handle) const {
+    if (handle.index >= slots_.size()) {
+        return -1;
+    }
+    const Slot& slot = slots_[handle.index];
+    // Un emplacement libre a déjà une génération d'avance sur ses anciens handles
+    if (slot.generation != handle.generation || slot.denseIndex >= denseToSlot_.size() ||
+        denseToSlot_[slot.denseIndex] != handle.index) {
+        return -1;
+    }
+    return static_cast<int>(slot.denseIndex);
+}
+
+SlotHandle SlotIndex::handleAt(int index) const {
+    if (index < 0 || index >= size()) {
+        return {};
+    }
+    const std::uint32_t slot = denseToSlot_[index];
+    return {slot, slots_[slot].generation};
+}
@@ -3,25 +3,44 @@
 //
 
 #include "../include/ssao_renderer.h"
+#include "../include/program_cache.h"
 #include <iostream>
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <random>
 
 // ==================== CONSTRUCTEUR/DESTRUCTEUR ====================
 SSAORenderer::SSAORenderer()
-    : ssaoFBO_(0), ssaoColorBuffer_(0), blurFBO_(0), ssaoBlur_(0),
-      noiseTex_(0), ssaoShader_(0), blurShader_(0),
+    : noiseTex_(0), kernelUBO_(0), fullscreenVAO_(0),
+      historyFBO_{0, 0}, historyAO_{0, 0}, historyNormal_{0, 0},
+      ssaoShader_(0), blurShader_(0), upsampleShader_(0), temporalShader_(0),
       screenWidth_(800), screenHeight_(600),
+      resolutionDivisor_(2), lowResWidth_(400), lowResHeight_(300),
       kernelSize_(64), radius_(0.5f), bias_(0.025f),
-      initialized_(false) {
+      initialized_(false),
+      temporalEnabled_(false), temporalSampleCount_(12),
+      historyIndex_(0), historyValid_(false), frameIndex_(0),
+      viewProj_{}, prevViewProj_{}, projection_{} {
 
     ssaoProjLoc_ = -1;
     ssaoRadiusLoc_ = -1;
     ssaoBiasLoc_ = -1;
     ssaoKernelSizeLoc_ = -1;
     ssaoNoiseLoc_ = -1;
+    ssaoNoiseScaleLoc_ = -1;
+    ssaoSampleCountLoc_ = -1;
+    ssaoSampleStrideLoc_ = -1;
+    ssaoSampleOffsetLoc_ = -1;
+    ssaoFrameRotationLoc_ = -1;
     blurTexLoc_ = -1;
+    blurDirectionLoc_ = -1;
+    blurSigmaLoc_ = -1;
+    upsampleSigmaLoc_ = -1;
+    temporalPrevViewProjLoc_ = -1;
+    temporalHistoryValidLoc_ = -1;
+    temporalMaxHistoryLoc_ = -1;
+    temporalRejectDistanceLoc_ = -1;
 }
 
 SSAORenderer::~SSAORenderer() {
@@ -30,16 +49,22 @@ SSAORenderer::~SSAORenderer() {
 
 // ==================== INITIALISATION ====================
 void SSAORenderer::initialize(int screenWidth, int screenHeight,
-                             int kernelSize, float radius, float bias) {
+                             int kernelSize, float radius, float bias,
+                             int resolutionDivisor) {
     screenWidth_ = screenWidth;
     screenHeight_ = screenHeight;
-    kernelSize_ = kernelSize;
+    kernelSize_ = std::clamp(kernelSize, 1, MAX_KERNEL_SIZE);
     radius_ = radius;
     bias_ = bias;
+    resolutionDivisor_ = (resolutionDivisor == 1 || resolutionDivisor == 4) ? resolutionDivisor : 2;
 
     generateSSAOKernel();
+    uploadKernel();
     generateNoiseTexture();
-    createFramebuffers();
+    createHistoryTargets();
+
+    // Triangle plein écran généré depuis gl_VertexID : VAO vide créé une seule fois
+    glGenVertexArrays(1, &fullscreenVAO_);
 
     initialized_ = true;
 }
@@ -58,37 +83,19 @@ bool SSAORenderer::loadShaders(const std::string& ssaoVS,
         return false;
     }
 
-    // Compiler shader SSAO
-    GLuint sVS = compileShader(GL_VERTEX_SHADER, ssaoVS);
-    GLuint sFS = compileShader(GL_FRAGMENT_SHADER, ssaoFS);
-    if (sVS == 0 || sFS == 0) {
-        glDeleteShader(sVS);
-        glDeleteShader(sFS);
-        return false;
-    }
-
-    ssaoShader_ = createProgram(sVS, sFS);
-    glDeleteShader(sVS);
-    glDeleteShader(sFS);
-
-    if (ssaoShader_ == 0) {
-        return false;
-    }
+    // Les quatre programmes sont soumis ensemble, le pilote peut les compiler en parallèle
+    ssaoShader_ = submitProgram(ssaoVS, ssaoFS);
+    blurShader_ = submitProgram(blurVS, blurFS);
+    // Upsample bilatéral et accumulation temporelle (même vertex shader que le flou)
+    upsampleShader_ = submitProgram(blurVS, getDefaultUpsampleFS());
+    temporalShader_ = submitProgram(blurVS, getDefaultTemporalFS());
 
-    // Compiler shader blur
-    GLuint bVS = compileShader(GL_VERTEX_SHADER, blurVS);
-    GLuint bFS = compileShader(GL_FRAGMENT_SHADER, blurFS);
-    if (bVS == 0 || bFS == 0) {
-        glDeleteShader(bVS);
-        glDeleteShader(bFS);
-        return false;
+    bool success = true;
+    for (GLuint* program : {&ssaoShader_, &blurShader_, &upsampleShader_, &temporalShader_}) {
+        *program = ProgramCache::finalize(*program);
+        success = success && *program != 0;
     }
-
-    blurShader_ = createProgram(bVS, bFS);
-    glDeleteShader(bVS);
-    glDeleteShader(bFS);
-
-    if (blurShader_ == 0) {
+    if (!success) {
         return false;
     }
 
@@ -97,33 +104,127 @@ bool SSAORenderer::loadShaders(const std::string& ssaoVS,
 }
 
 // ==================== RENDU ====================
-void SSAORenderer::compute(GLuint gPositionTex, GLuint gNormalTex, const float* projMatrix, GLuint quadVAO,GLuint quadVBO) {
-    if (!initialized_ || ssaoShader_ == 0) {
-        return;
-    }
+void SSAORenderer::setViewProjection(const float* viewProjMatrix) {
+    std::memcpy(viewProj_, viewProjMatrix, sizeof(viewProj_));
+}
+
+FrameGraphResource SSAORenderer::addToFrameGraph(FrameGraph& graph, FrameGraphResource gPosition,
+                                                 FrameGraphResource gNormal, const float* projMatrix) {
+    if (!initialized_ || ssaoShader_ == 0 || blurShader_ == 0 || upsampleShader_ == 0) {
+        return INVALID_FRAME_GRAPH_RESOURCE;
+    }
+
+    std::memcpy(projection_, projMatrix, sizeof(projection_));
+
+    FrameGraphTextureDesc lowRes;
+    lowRes.width = lowResWidth_;
+    lowRes.height = lowResHeight_;
+    lowRes.internalFormat = GL_R16F;
+
+    FrameGraphTextureDesc fullRes = lowRes;
+    fullRes.width = screenWidth_;
+    fullRes.height = screenHeight_;
+
+    const bool upsample = resolutionDivisor_ > 1;
+
+    // 1. Occlusion brute en basse résolution
+    FrameGraphResource raw = INVALID_FRAME_GRAPH_RESOURCE;
+    graph.addPass("SSAO",
+                  [&](FrameGraph::Builder& builder) {
+                      builder.read(gPosition);
+                      builder.read(gNormal);
+                      raw = builder.create("SSAO raw", lowRes);
+                      return [=, this](const FrameGraph::Resources& resources) {
+                          renderOcclusion(resources.getTexture(gPosition), resources.getTexture(gNormal));
+                      };
+                  });
+
+    // 2. Accumulation temporelle dans l'historique (persistant, importé)
+    FrameGraphResource occlusion = raw;
+    if (temporalEnabled_ && temporalShader_ != 0) {
+        const int current = 1 - historyIndex_;
+        FrameGraphTextureDesc historyDesc = lowRes;
+        historyDesc.internalFormat = GL_RGBA32F;
+        const FrameGraphResource history = graph.importTexture("SSAO history", historyAO_[current], historyDesc);
+
+        graph.addPass("SSAO temporal",
+                      [&](FrameGraph::Builder& builder) {
+                          builder.read(raw);
+                          builder.read(gPosition);
+                          builder.read(gNormal);
+                          occlusion = builder.write(history);
+                          return [=, this](const FrameGraph::Resources& resources) {
+                              accumulateTemporal(resources.getTexture(raw), resources.getTexture(gPosition),
+                                                 resources.getTexture(gNormal));
+                          };
+                      });
+    }
+
+    // 3. Flou séparable sensible à la géométrie
+    FrameGraphResource blurTemp = INVALID_FRAME_GRAPH_RESOURCE;
+    graph.addPass("SSAO blur H",
+                  [&](FrameGraph::Builder& builder) {
+                      builder.read(occlusion);
+                      builder.read(gPosition);
+                      builder.read(gNormal);
+                      blurTemp = builder.create("SSAO blur temp", lowRes);
+                      return [=, this](const FrameGraph::Resources& resources) {
+                          blurPass(resources.getTexture(occlusion), resources.getTexture(gPosition),
+                                   resources.getTexture(gNormal), 1.0f, 0.0f);
+                      };
+                  });
+
+    FrameGraphResource blurred = INVALID_FRAME_GRAPH_RESOURCE;
+    graph.addPass("SSAO blur V",
+                  [&](FrameGraph::Builder& builder) {
+                      builder.read(blurTemp);
+                      builder.read(gPosition);
+                      builder.read(gNormal);
+                      // Pleine résolution : sortie directe ; sinon le graphe réutilise une cible basse résolution morte
+                      blurred = builder.create(upsample ? "SSAO blurred" : "SSAO", upsample ? lowRes : fullRes);
+                      return [=, this](const FrameGraph::Resources& resources) {
+                          blurPass(resources.getTexture(blurTemp), resources.getTexture(gPosition),
+                                   resources.getTexture(gNormal), 0.0f, 1.0f);
+                      };
+                  });
+
+    if (!upsample) {
+        return blurred;
+    }
+
+    // 4. Upsample bilatéral vers la pleine résolution
+    FrameGraphResource output = INVALID_FRAME_GRAPH_RESOURCE;
+    graph.addPass("SSAO upsample",
+                  [&](FrameGraph::Builder& builder) {
+                      builder.read(blurred);
+                      builder.read(gPosition);
+                      builder.read(gNormal);
+                      output = builder.create("SSAO", fullRes);
+                      return [=, this](const FrameGraph::Resources& resources) {
+                          upsamplePass(resources.getTexture(blurred), resources.getTexture(gPosition),
+                                       resources.getTexture(gNormal));
+                      };
+                  });
+    return output;
+}
 
-    // Binder le framebuffer SSAO
-    glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO_);
-    glClear(GL_COLOR_BUFFER_BIT);
+void SSAORenderer::renderOcclusion(GLuint gPositionTex, GLuint gNormalTex) {
+    // Framebuffer et viewport (basse résolution) liés par le graphe
+    glDisable(GL_DEPTH_TEST);
 
     glUseProgram(ssaoShader_);
 
-    // Binder les G-Buffers
+    // Binder les G-Buffers (unités fixées dans initializeUniformLocations)
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, gPositionTex);
-    glUniform1i(glGetUniformLocation(ssaoShader_, "gPosition"), 0);
-
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormalTex);
-    glUniform1i(glGetUniformLocation(ssaoShader_, "gNormal"), 1);
-
     glActiveTexture(GL_TEXTURE2);
     glBindTexture(GL_TEXTURE_2D, noiseTex_);
-    glUniform1i(glGetUniformLocation(ssaoShader_, "noiseTexture"), 2);
 
     // Envoyer les uniforms
     if (ssaoProjLoc_ >= 0) {
-        glUniformMatrix4fv(ssaoProjLoc_, 1, GL_FALSE, projMatrix);
+        glUniformMatrix4fv(ssaoProjLoc_, 1, GL_FALSE, projection_);
     }
     if (ssaoRadiusLoc_ >= 0) {
         glUniform1f(ssaoRadiusLoc_, radius_);
@@ -134,106 +235,74 @@ void SSAORenderer::compute(GLuint gPositionTex, GLuint gNormalTex, const float*
     if (ssaoKernelSizeLoc_ >= 0) {
         glUniform1i(ssaoKernelSizeLoc_, kernelSize_);
     }
-
-    // Envoyer le kernel SSAO
-    GLint kernelLoc = glGetUniformLocation(ssaoShader_, "samples");
-    for (int i = 0; i < kernelSize_; ++i) {
-        std::string uniform = "samples[" + std::to_string(i) + "]";
-        GLint loc = glGetUniformLocation(ssaoShader_, uniform.c_str());
-        if (loc >= 0) {
-            glUniform3f(loc, ssaoKernel_[i].x, ssaoKernel_[i].y, ssaoKernel_[i].z);
-        }
-    }
-
-    // Dessiner un quad plein écran
-    glDisable(GL_DEPTH_TEST);
-    glViewport(0, 0, screenWidth_, screenHeight_);
-
-    // Créer et dessiner un quad simple
-
-    if (quadVAO == 0) {
-        float quadVertices[] = {
-            -1.0f,  1.0f,  0.0f, 1.0f,
-            -1.0f, -1.0f,  0.0f, 0.0f,
-             1.0f,  1.0f,  1.0f, 1.0f,
-             1.0f, -1.0f,  1.0f, 0.0f,
-        };
-
-
-        glGenVertexArrays(1, &quadVAO);
-        glGenBuffers(1, &quadVBO);
-
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-
-        glBindVertexArray(0);
-    }
-
-    glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 6);
+    if (ssaoNoiseScaleLoc_ >= 0) {
+        // Une rotation par texel basse résolution, motif 4x4 absorbé par le flou
+        glUniform2f(ssaoNoiseScaleLoc_, static_cast<float>(lowResWidth_) / 4.0f,
+                    static_cast<float>(lowResHeight_) / 4.0f);
+    }
+
+    // Mode temporel : sous-ensemble entrelacé du kernel + rotation différente à chaque frame,
+    // l'historique couvre le kernel complet en kernelSize / sampleCount frames
+    const int sampleCount = temporalEnabled_ ? std::min(temporalSampleCount_, kernelSize_) : kernelSize_;
+    const int sampleStride = std::max(1, kernelSize_ / sampleCount);
+    const int sampleOffset = temporalEnabled_ ? static_cast<int>(frameIndex_ % sampleStride) : 0;
+    const float frameRotation = temporalEnabled_
+                                    ? std::fmod(static_cast<float>(frameIndex_) * 2.39996323f, 6.28318531f)
+                                    : 0.0f;
+    glUniform1i(ssaoSampleCountLoc_, sampleCount);
+    glUniform1i(ssaoSampleStrideLoc_, sampleStride);
+    glUniform1i(ssaoSampleOffsetLoc_, sampleOffset);
+    glUniform1f(ssaoFrameRotationLoc_, frameRotation);
+
+    // Le kernel vit dans le UBO (envoyé une fois), seul le binding est refait
+    glBindBufferBase(GL_UNIFORM_BUFFER, KERNEL_UBO_BINDING, kernelUBO_);
+
+    glBindVertexArray(fullscreenVAO_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
     glBindVertexArray(0);
+    ++frameIndex_;
 
     glEnable(GL_DEPTH_TEST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void SSAORenderer::blur(GLuint quadVAO,GLuint quadVBO) const {
-    if (!initialized_ || blurShader_ == 0) {
-        return;
-    }
-
-    // Binder le framebuffer blur
-    glBindFramebuffer(GL_FRAMEBUFFER, blurFBO_);
-    glClear(GL_COLOR_BUFFER_BIT);
-
+void SSAORenderer::blurPass(GLuint input, GLuint gPositionTex, GLuint gNormalTex,
+                            float directionX, float directionY) const {
+    glDisable(GL_DEPTH_TEST);
     glUseProgram(blurShader_);
 
-    // Binder la texture SSAO
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, gPositionTex);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, gNormalTex);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer_);
-    glUniform1i(glGetUniformLocation(blurShader_, "ssaoInput"), 0);
+    glBindTexture(GL_TEXTURE_2D, input);
 
-    // Dessiner le quad
-    glDisable(GL_DEPTH_TEST);
-    glViewport(0, 0, screenWidth_, screenHeight_);
-
-
-    if (quadVAO == 0) {
-        float quadVertices[] = {
-            -1.0f,  1.0f,  0.0f, 1.0f,
-            -1.0f, -1.0f,  0.0f, 0.0f,
-             1.0f,  1.0f,  1.0f, 1.0f,
-             1.0f, -1.0f,  1.0f, 0.0f,
-        };
+    glUniform1f(blurSigmaLoc_, radius_);
+    glUniform2f(blurDirectionLoc_, directionX, directionY);
 
+    glBindVertexArray(fullscreenVAO_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
 
-        glGenVertexArrays(1, &quadVAO);
-        glGenBuffers(1, &quadVBO);
-
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+void SSAORenderer::upsamplePass(GLuint input, GLuint gPositionTex, GLuint gNormalTex) const {
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(upsampleShader_);
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, gPositionTex);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, gNormalTex);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, input);
 
-        glBindVertexArray(0);
-    }
+    glUniform1f(upsampleSigmaLoc_, radius_);
 
-    glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(fullscreenVAO_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
     glBindVertexArray(0);
-
     glEnable(GL_DEPTH_TEST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 // ==================== PARAMÈTRES ====================
@@ -261,25 +330,46 @@ void SSAORenderer::setKernelSize(int size) {
     }
     kernelSize_ = size;
     generateSSAOKernel();
+    uploadKernel();
+    historyValid_ = false;
 }
 
-// ==================== NETTOYAGE ====================
-void SSAORenderer::cleanup() {
-    if (ssaoFBO_ != 0) {
-        glDeleteFramebuffers(1, &ssaoFBO_);
-        ssaoFBO_ = 0;
+void SSAORenderer::setResolutionDivisor(int divisor) {
+    if (divisor != 1 && divisor != 2 && divisor != 4) {
+        return; // Diviseur invalide
     }
-    if (ssaoColorBuffer_ != 0) {
-        glDeleteTextures(1, &ssaoColorBuffer_);
-        ssaoColorBuffer_ = 0;
+    if (divisor == resolutionDivisor_) {
+        return;
+    }
+    resolutionDivisor_ = divisor;
+
+    if (initialized_) {
+        deleteHistoryTargets();
+        createHistoryTargets();
+    }
+}
+
+void SSAORenderer::setTemporalEnabled(bool enabled) {
+    if (enabled != temporalEnabled_) {
+        temporalEnabled_ = enabled;
+        historyValid_ = false;
     }
-    if (blurFBO_ != 0) {
-        glDeleteFramebuffers(1, &blurFBO_);
-        blurFBO_ = 0;
+}
+
+void SSAORenderer::setTemporalSampleCount(int count) {
+    temporalSampleCount_ = std::clamp(count, 4, MAX_KERNEL_SIZE);
+}
+
+// ==================== NETTOYAGE ====================
+void SSAORenderer::cleanup() {
+    deleteHistoryTargets();
+    if (kernelUBO_ != 0) {
+        glDeleteBuffers(1, &kernelUBO_);
+        kernelUBO_ = 0;
     }
-    if (ssaoBlur_ != 0) {
-        glDeleteTextures(1, &ssaoBlur_);
-        ssaoBlur_ = 0;
+    if (fullscreenVAO_ != 0) {
+        glDeleteVertexArrays(1, &fullscreenVAO_);
+        fullscreenVAO_ = 0;
     }
     if (noiseTex_ != 0) {
         glDeleteTextures(1, &noiseTex_);
@@ -293,6 +383,15 @@ void SSAORenderer::cleanup() {
         glDeleteProgram(blurShader_);
         blurShader_ = 0;
     }
+    if (upsampleShader_ != 0) {
+        glDeleteProgram(upsampleShader_);
+        upsampleShader_ = 0;
+    }
+    if (temporalShader_ != 0) {
+        glDeleteProgram(temporalShader_);
+        temporalShader_ = 0;
+    }
+    initialized_ = false;
 }
 
 // ==================== MÉTHODES PRIVÉES ====================
@@ -320,6 +419,28 @@ void SSAORenderer::generateSSAOKernel() {
     }
 }
 
+void SSAORenderer::uploadKernel() {
+    // std140 : un vec3 occupe un vec4, taille fixe pour ne jamais réallouer
+    std::vector<float> data(MAX_KERNEL_SIZE * 4, 0.0f);
+    for (int i = 0; i < kernelSize_; ++i) {
+        data[i * 4 + 0] = ssaoKernel_[i].x;
+        data[i * 4 + 1] = ssaoKernel_[i].y;
+        data[i * 4 + 2] = ssaoKernel_[i].z;
+    }
+
+    if (kernelUBO_ == 0) {
+        glGenBuffers(1, &kernelUBO_);
+        glBindBuffer(GL_UNIFORM_BUFFER, kernelUBO_);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(data.size() * sizeof(float)),
+                     data.data(), GL_STATIC_DRAW);
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, kernelUBO_);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(data.size() * sizeof(float)),
+                        data.data());
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 void SSAORenderer::generateNoiseTexture() {
     std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f);
     std::mt19937 generator(std::random_device{}());
@@ -347,76 +468,107 @@ void SSAORenderer::generateNoiseTexture() {
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-void SSAORenderer::createFramebuffers() {
-    // SSAO FBO
-    glGenFramebuffers(1, &ssaoFBO_);
-    glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO_);
-
-    glGenTextures(1, &ssaoColorBuffer_);
-    glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer_);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, screenWidth_, screenHeight_, 0,
-                 GL_RED, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                          GL_TEXTURE_2D, ssaoColorBuffer_, 0);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "ERROR: SSAO FBO is not complete!" << std::endl;
+void SSAORenderer::createHistoryTargets() {
+    // Les cibles transitoires viennent du frame graph ; seul l'historique persiste d'une frame à l'autre
+    lowResWidth_ = std::max(1, screenWidth_ / resolutionDivisor_);
+    lowResHeight_ = std::max(1, screenHeight_ / resolutionDivisor_);
+
+    // Deux historiques en ping-pong, à la résolution du SSAO
+    for (int i = 0; i < 2; ++i) {
+        glGenFramebuffers(1, &historyFBO_[i]);
+        glBindFramebuffer(GL_FRAMEBUFFER, historyFBO_[i]);
+
+        glGenTextures(1, &historyAO_[i]);
+        glBindTexture(GL_TEXTURE_2D, historyAO_[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, lowResWidth_, lowResHeight_, 0,
+                     GL_RGBA, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyAO_[i], 0);
+
+        glGenTextures(1, &historyNormal_[i]);
+        glBindTexture(GL_TEXTURE_2D, historyNormal_[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, lowResWidth_, lowResHeight_, 0,
+                     GL_RGBA, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, historyNormal_[i], 0);
+
+        GLenum attachments[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        glDrawBuffers(2, attachments);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "ERROR: SSAO history FBO is not complete!" << std::endl;
+        }
     }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    // Blur FBO
-    glGenFramebuffers(1, &blurFBO_);
-    glBindFramebuffer(GL_FRAMEBUFFER, blurFBO_);
+    historyIndex_ = 0;
+    historyValid_ = false;
+}
 
-    glGenTextures(1, &ssaoBlur_);
-    glBindTexture(GL_TEXTURE_2D, ssaoBlur_);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, screenWidth_, screenHeight_, 0,
-                 GL_RED, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                          GL_TEXTURE_2D, ssaoBlur_, 0);
+void SSAORenderer::accumulateTemporal(GLuint rawOcclusion, GLuint gPositionTex, GLuint gNormalTex) {
+    const int previous = historyIndex_;
+    const int current = 1 - historyIndex_;
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "ERROR: Blur FBO is not complete!" << std::endl;
-    }
+    // Cible importée : le graphe ne lie rien, l'historique garde son propre FBO (MRT)
+    glBindFramebuffer(GL_FRAMEBUFFER, historyFBO_[current]);
+    glViewport(0, 0, lowResWidth_, lowResHeight_);
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(temporalShader_);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, rawOcclusion);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, gPositionTex);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, gNormalTex);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, historyAO_[previous]);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D, historyNormal_[previous]);
+    glActiveTexture(GL_TEXTURE0);
 
-GLuint SSAORenderer::compileShader(GLenum type, const std::string& source) {
-    GLuint shader = glCreateShader(type);
-    const char* src = source.c_str();
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
+    glUniformMatrix4fv(temporalPrevViewProjLoc_, 1, GL_FALSE, prevViewProj_);
+    glUniform1i(temporalHistoryValidLoc_, historyValid_ ? 1 : 0);
+    glUniform1f(temporalMaxHistoryLoc_, static_cast<float>(MAX_HISTORY_FRAMES));
+    // Au-delà de cet écart la position reprojetée est une autre surface (désocclusion)
+    glUniform1f(temporalRejectDistanceLoc_, std::max(radius_ * 0.5f, 0.01f));
 
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        printShaderError(shader, type);
-        glDeleteShader(shader);
-        return 0;
-    }
+    glBindVertexArray(fullscreenVAO_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
 
-    return shader;
+    historyIndex_ = current;
+    historyValid_ = true;
+    std::memcpy(prevViewProj_, viewProj_, sizeof(prevViewProj_));
 }
 
-GLuint SSAORenderer::createProgram(GLuint vs, GLuint fs) {
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        printProgramError(program);
-        glDeleteProgram(program);
-        return 0;
+void SSAORenderer::deleteHistoryTargets() {
+    for (int i = 0; i < 2; ++i) {
+        if (historyFBO_[i] != 0) {
+            glDeleteFramebuffers(1, &historyFBO_[i]);
+            historyFBO_[i] = 0;
+        }
+        if (historyAO_[i] != 0) {
+            glDeleteTextures(1, &historyAO_[i]);
+            historyAO_[i] = 0;
+        }
+        if (historyNormal_[i] != 0) {
+            glDeleteTextures(1, &historyNormal_[i]);
+            historyNormal_[i] = 0;
+        }
     }
+}
 
-    return program;
+GLuint SSAORenderer::submitProgram(const std::string& vs, const std::string& fs) {
+    return ProgramCache::submitProgram({{GL_VERTEX_SHADER, vs}, {GL_FRAGMENT_SHADER, fs}});
 }
 
 void SSAORenderer::initializeUniformLocations() {
@@ -425,40 +577,42 @@ void SSAORenderer::initializeUniformLocations() {
     ssaoBiasLoc_ = glGetUniformLocation(ssaoShader_, "bias");
     ssaoKernelSizeLoc_ = glGetUniformLocation(ssaoShader_, "kernelSize");
     ssaoNoiseLoc_ = glGetUniformLocation(ssaoShader_, "noiseTexture");
+    ssaoNoiseScaleLoc_ = glGetUniformLocation(ssaoShader_, "noiseScale");
+    ssaoSampleCountLoc_ = glGetUniformLocation(ssaoShader_, "sampleCount");
+    ssaoSampleStrideLoc_ = glGetUniformLocation(ssaoShader_, "sampleStride");
+    ssaoSampleOffsetLoc_ = glGetUniformLocation(ssaoShader_, "sampleOffset");
+    ssaoFrameRotationLoc_ = glGetUniformLocation(ssaoShader_, "frameRotation");
 
     blurTexLoc_ = glGetUniformLocation(blurShader_, "ssaoInput");
-}
-
-void SSAORenderer::printShaderError(GLuint shader, GLenum type) {
-    GLint logLength = 0;
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-
-    if (logLength > 0) {
-        char* log = new char[logLength];
-        glGetShaderInfoLog(shader, logLength, nullptr, log);
-
-        const char* typeStr = (type == GL_VERTEX_SHADER) ? "VERTEX" :
-                             (type == GL_FRAGMENT_SHADER) ? "FRAGMENT" : "UNKNOWN";
-        std::cerr << "ERROR: " << typeStr << " shader compilation failed:" << std::endl;
-        std::cerr << log << std::endl;
+    blurDirectionLoc_ = glGetUniformLocation(blurShader_, "uDirection");
+    blurSigmaLoc_ = glGetUniformLocation(blurShader_, "uPositionSigma");
 
-        delete[] log;
-    }
-}
-
-void SSAORenderer::printProgramError(GLuint program) {
-    GLint logLength = 0;
-    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+    upsampleSigmaLoc_ = glGetUniformLocation(upsampleShader_, "uPositionSigma");
 
-    if (logLength > 0) {
-        char* log = new char[logLength];
-        glGetProgramInfoLog(program, logLength, nullptr, log);
+    temporalPrevViewProjLoc_ = glGetUniformLocation(temporalShader_, "uPrevViewProj");
+    temporalHistoryValidLoc_ = glGetUniformLocation(temporalShader_, "uHistoryValid");
+    temporalMaxHistoryLoc_ = glGetUniformLocation(temporalShader_, "uMaxHistory");
+    temporalRejectDistanceLoc_ = glGetUniformLocation(temporalShader_, "uRejectDistance");
 
-        std::cerr << "ERROR: Program linking failed:" << std::endl;
-        std::cerr << log << std::endl;
-
-        delete[] log;
-    }
+    // Les unités de texture ne changent jamais : fixées une seule fois
+    glUseProgram(ssaoShader_);
+    glUniform1i(glGetUniformLocation(ssaoShader_, "gPosition"), 0);
+    glUniform1i(glGetUniformLocation(ssaoShader_, "gNormal"), 1);
+    glUniform1i(ssaoNoiseLoc_, 2);
+
+    for (GLuint program : {blurShader_, upsampleShader_}) {
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "ssaoInput"), 0);
+        glUniform1i(glGetUniformLocation(program, "gPosition"), 1);
+        glUniform1i(glGetUniformLocation(program, "gNormal"), 2);
+    }
+    glUseProgram(temporalShader_);
+    glUniform1i(glGetUniformLocation(temporalShader_, "ssaoInput"), 0);
+    glUniform1i(glGetUniformLocation(temporalShader_, "gPosition"), 1);
+    glUniform1i(glGetUniformLocation(temporalShader_, "gNormal"), 2);
+    glUniform1i(glGetUniformLocation(temporalShader_, "historyAO"), 3);
+    glUniform1i(glGetUniformLocation(temporalShader_, "historyNormal"), 4);
+    glUseProgram(0);
 }
 
 // ==================== SHADERS PAR DÉFAUT ====================
@@ -466,17 +620,16 @@ std::string SSAORenderer::getDefaultSSAOVS() {
     return R"(
 #version 430 core
 
-layout(location = 0) in vec2 aPosition;
-layout(location = 1) in vec2 aTexCoord;
-
 out VS_OUT {
     vec2 TexCoord;
 } vs_out;
 
 void main()
 {
-    vs_out.TexCoord = aTexCoord;
-    gl_Position = vec4(aPosition, 0.0, 1.0);
+    // Triangle plein écran depuis gl_VertexID (aucun VBO)
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vs_out.TexCoord = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
 }
     )";
 }
@@ -497,8 +650,18 @@ uniform mat4 projection;
 uniform float radius;
 uniform float bias;
 uniform int kernelSize;
+uniform vec2 noiseScale;
 
-uniform vec3 samples[128];
+// Sous-ensemble du kernel : échantillons i * sampleStride + sampleOffset
+uniform int sampleCount;
+uniform int sampleStride;
+uniform int sampleOffset;
+uniform float frameRotation;
+
+// Kernel envoyé une seule fois (std140 : xyz utilisés)
+layout(std140, binding = 1) uniform SSAOKernel {
+    vec4 samples[128];
+};
 
 out float FragColor;
 
@@ -506,7 +669,12 @@ void main()
 {
     vec3 fragPos = texture(gPosition, fs_in.TexCoord).xyz;
     vec3 normal = normalize(texture(gNormal, fs_in.TexCoord).xyz);
-    vec3 randomVec = normalize(texture(noiseTexture, fs_in.TexCoord * 50.0).xyz);
+    vec3 randomVec = normalize(texture(noiseTexture, fs_in.TexCoord * noiseScale).xyz);
+
+    // Rotation propre à la frame : le bruit 4x4 varie dans le temps
+    float c = cos(frameRotation);
+    float s = sin(frameRotation);
+    randomVec.xy = mat2(c, s, -s, c) * randomVec.xy;
 
     // Créer une matrice TBN
     vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
@@ -514,10 +682,11 @@ void main()
     mat3 TBN = mat3(tangent, bitangent, normal);
 
     float occlusion = 0.0;
-    for(int i = 0; i < kernelSize; ++i)
+    for(int i = 0; i < sampleCount; ++i)
     {
         // Obtenir position d'échantillon
-        vec3 samplePos = fragPos + TBN * samples[i] * radius;
+        int k = min(i * sampleStride + sampleOffset, kernelSize - 1);
+        vec3 samplePos = fragPos + TBN * samples[k].xyz * radius;
 
         // Projeter dans l'espace écran
         vec4 offset = vec4(samplePos, 1.0);
@@ -533,58 +702,186 @@ void main()
         occlusion += rangeCheck * step(sampleDepth, samplePos.z - bias);
     }
 
-    occlusion = 1.0 - (occlusion / kernelSize);
+    occlusion = 1.0 - (occlusion / float(sampleCount));
     FragColor = occlusion;
 }
     )";
 }
 
 std::string SSAORenderer::getDefaultBlurVS() {
+    return getDefaultSSAOVS();
+}
+
+std::string SSAORenderer::getDefaultBlurFS() {
     return R"(
 #version 430 core
 
-layout(location = 0) in vec2 aPosition;
-layout(location = 1) in vec2 aTexCoord;
-
-out VS_OUT {
+in VS_OUT {
     vec2 TexCoord;
-} vs_out;
+} fs_in;
+
+uniform sampler2D ssaoInput;
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+
+uniform vec2 uDirection;       // (1,0) puis (0,1)
+uniform float uPositionSigma;  // ~ rayon SSAO
+
+out float FragColor;
+
+const float weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
 
 void main()
 {
-    vs_out.TexCoord = aTexCoord;
-    gl_Position = vec4(aPosition, 0.0, 1.0);
+    vec2 texelSize = 1.0 / vec2(textureSize(ssaoInput, 0));
+    vec3 centerPos = texture(gPosition, fs_in.TexCoord).xyz;
+    vec3 centerNormal = normalize(texture(gNormal, fs_in.TexCoord).xyz);
+    float invSigma2 = 1.0 / max(uPositionSigma * uPositionSigma, 1e-4);
+
+    float result = texture(ssaoInput, fs_in.TexCoord).r * weights[0];
+    float totalWeight = weights[0];
+
+    // Gaussienne 9 taps, pondérée par la distance et l'orientation : pas de fuite entre surfaces
+    for(int i = 1; i < 5; ++i)
+    {
+        for(int side = -1; side <= 1; side += 2)
+        {
+            vec2 uv = fs_in.TexCoord + uDirection * texelSize * float(i * side);
+            vec3 delta = texture(gPosition, uv).xyz - centerPos;
+            vec3 n = normalize(texture(gNormal, uv).xyz);
+
+            float w = weights[i]
+                    * exp(-dot(delta, delta) * invSigma2)
+                    * pow(max(dot(n, centerNormal), 0.0), 8.0);
+            result += texture(ssaoInput, uv).r * w;
+            totalWeight += w;
+        }
+    }
+
+    FragColor = result / totalWeight;
 }
     )";
 }
 
-std::string SSAORenderer::getDefaultBlurFS() {
+std::string SSAORenderer::getDefaultUpsampleFS() {
     return R"(
 #version 430 core
 
-in VS_OUT {
-    vec2 TexCoord;
-} fs_in;
+uniform sampler2D ssaoInput;   // basse résolution
+uniform sampler2D gPosition;   // pleine résolution
+uniform sampler2D gNormal;
 
-uniform sampler2D ssaoInput;
+uniform float uPositionSigma;
 
 out float FragColor;
 
 void main()
 {
-    vec2 texelSize = 1.0 / vec2(textureSize(ssaoInput, 0));
-    float result = 0.0;
+    ivec2 fullSize = textureSize(gPosition, 0);
+    ivec2 lowSize = textureSize(ssaoInput, 0);
+    ivec2 fullCoord = ivec2(gl_FragCoord.xy);
+
+    vec3 centerPos = texelFetch(gPosition, fullCoord, 0).xyz;
+    vec3 centerNormal = normalize(texelFetch(gNormal, fullCoord, 0).xyz);
+    float invSigma2 = 1.0 / max(uPositionSigma * uPositionSigma, 1e-4);
 
-    for(int x = -2; x < 2; ++x)
+    // Les 4 texels basse résolution voisins, poids bilinéaires
+    vec2 lowPos = (vec2(fullCoord) + 0.5) * vec2(lowSize) / vec2(fullSize) - 0.5;
+    ivec2 base = ivec2(floor(lowPos));
+    vec2 f = fract(lowPos);
+
+    float result = 0.0;
+    float totalWeight = 0.0;
+    for(int y = 0; y < 2; ++y)
     {
-        for(int y = -2; y < 2; ++y)
+        for(int x = 0; x < 2; ++x)
         {
-            vec2 offset = vec2(float(x), float(y)) * texelSize;
-            result += texture(ssaoInput, fs_in.TexCoord + offset).r;
+            ivec2 lowCoord = clamp(base + ivec2(x, y), ivec2(0), lowSize - 1);
+
+            // Texel plein écran lu par la passe SSAO pour ce texel basse résolution
+            ivec2 sourceCoord = ivec2((vec2(lowCoord) + 0.5) / vec2(lowSize) * vec2(fullSize));
+            vec3 delta = texelFetch(gPosition, sourceCoord, 0).xyz - centerPos;
+            vec3 n = normalize(texelFetch(gNormal, sourceCoord, 0).xyz);
+
+            float bilinear = (x == 0 ? 1.0 - f.x : f.x) * (y == 0 ? 1.0 - f.y : f.y);
+            float w = bilinear
+                    * exp(-dot(delta, delta) * invSigma2)
+                    * pow(max(dot(n, centerNormal), 0.0), 8.0)
+                    + 1e-4;
+            result += texelFetch(ssaoInput, lowCoord, 0).r * w;
+            totalWeight += w;
+        }
+    }
+
+    FragColor = result / totalWeight;
+}
+    )";
+}
+
+std::string SSAORenderer::getDefaultTemporalFS() {
+    return R"(
+#version 430 core
+
+in VS_OUT {
+    vec2 TexCoord;
+} fs_in;
+
+uniform sampler2D ssaoInput;      // AO brut de la frame
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D historyAO;      // r = AO accumulé, gba = position monde
+uniform sampler2D historyNormal;  // xyz = normale, w = frames accumulées
+
+uniform mat4 uPrevViewProj;
+uniform int uHistoryValid;
+uniform float uMaxHistory;
+uniform float uRejectDistance;
+
+layout(location = 0) out vec4 outAO;
+layout(location = 1) out vec4 outNormal;
+
+void main()
+{
+    float current = texture(ssaoInput, fs_in.TexCoord).r;
+    vec3 position = texture(gPosition, fs_in.TexCoord).xyz;
+    vec3 rawNormal = texture(gNormal, fs_in.TexCoord).xyz;
+
+    // Fond : rien à accumuler
+    if (dot(rawNormal, rawNormal) < 1e-6) {
+        outAO = vec4(1.0, position);
+        outNormal = vec4(0.0);
+        return;
+    }
+    vec3 normal = normalize(rawNormal);
+
+    float history = current;
+    float historyLength = 0.0;
+
+    // Reprojection : position monde -> UV de la frame précédente
+    if (uHistoryValid != 0) {
+        vec4 prevClip = uPrevViewProj * vec4(position, 1.0);
+        if (prevClip.w > 0.0) {
+            vec2 prevUV = prevClip.xy / prevClip.w * 0.5 + 0.5;
+            if (all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)))) {
+                vec4 prevAO = texture(historyAO, prevUV);
+                vec4 prevNormal = texture(historyNormal, prevUV);
+
+                // Rejet : autre surface (position) ou autre orientation (normale)
+                vec3 delta = prevAO.gba - position;
+                bool samePlace = dot(delta, delta) < uRejectDistance * uRejectDistance;
+                bool sameOrientation = dot(prevNormal.xyz, normal) > 0.9;
+                if (samePlace && sameOrientation) {
+                    history = prevAO.r;
+                    historyLength = prevNormal.w;
+                }
+            }
         }
     }
 
-    FragColor = result / 16.0;
+    // Moyenne cumulative jusqu'à uMaxHistory frames, puis moyenne glissante exponentielle
+    float frames = min(historyLength + 1.0, uMaxHistory);
+    outAO = vec4(mix(history, current, 1.0 / frames), position);
+    outNormal = vec4(normal, frames);
 }
     )";
 }
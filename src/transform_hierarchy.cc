@@ -0,0 +1,254 @@
+//
+// Created by forna on 18.10.2026.
+//
+
+#include "../include/transform_hierarchy.h"
+#include "../include/matrix_math.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+    constexpr std::size_t NO_DIRTY = std::numeric_limits<std::size_t>::max();
+}
+
+// ==================== CONSTRUCTEURS ====================
+TransformHierarchy::TransformHierarchy()
+    : firstDirty_(NO_DIRTY),
+      sweep_(0),
+      aliveCount_(0),
+      orderDirty_(false) {
+}
+
+// ==================== NŒUDS ====================
+int TransformHierarchy::createNode(int parent, const float *localMatrix) {
+    int id;
+    if (!freeIds_.empty()) {
+        id = freeIds_.back();
+        freeIds_.pop_back();
+    } else {
+        id = static_cast<int>(positions_.size());
+        positions_.push_back(-1);
+    }
+
+    // Ajout en fin : le parent existant est forcément placé avant
+    const auto position = static_cast<int>(parents_.size());
+    positions_[id] = position;
+    parents_.push_back(isValid(parent) ? positions_[parent] : -1);
+    ids_.push_back(id);
+    localMatrices_.emplace_back();
+    worldMatrices_.emplace_back();
+    if (localMatrix != nullptr) {
+        std::memcpy(localMatrices_.back().data(), localMatrix, sizeof(float) * 16);
+    } else {
+        MatrixMath::identity(localMatrices_.back().data());
+    }
+    dirty_.push_back(0);
+    updatedSweeps_.push_back(0);
+    aliveCount_++;
+
+    markDirty(position);
+    return id;
+}
+
+void TransformHierarchy::removeNode(int node) {
+    if (!isValid(node)) {
+        return;
+    }
+
+    const int position = positions_[node];
+    for (std::size_t i = 0; i < parents_.size(); ++i) {
+        if (parents_[i] == position) {
+            parents_[i] = -1;
+            markDirty(i);
+        }
+    }
+
+    // Le trou est refermé au prochain update()
+    ids_[position] = -1;
+    positions_[node] = -1;
+    freeIds_.push_back(node);
+    aliveCount_--;
+    orderDirty_ = true;
+}
+
+bool TransformHierarchy::setParent(int node, int parent) {
+    if (!isValid(node)) {
+        return false;
+    }
+
+    const int position = positions_[node];
+    const int parentPosition = isValid(parent) ? positions_[parent] : -1;
+    // Cycle : le nouveau parent descend du nœud
+    for (int p = parentPosition; p >= 0; p = parents_[p]) {
+        if (p == position) {
+            return false;
+        }
+    }
+
+    parents_[position] = parentPosition;
+    if (parentPosition > position) {
+        orderDirty_ = true;
+    }
+    markDirty(position);
+    return true;
+}
+
+void TransformHierarchy::clear() {
+    parents_.clear();
+    ids_.clear();
+    localMatrices_.clear();
+    worldMatrices_.clear();
+    dirty_.clear();
+    updatedSweeps_.clear();
+    positions_.clear();
+    freeIds_.clear();
+    firstDirty_ = NO_DIRTY;
+    aliveCount_ = 0;
+    orderDirty_ = false;
+}
+
+bool TransformHierarchy::isValid(int node) const {
+    return node >= 0 && node < static_cast<int>(positions_.size()) && positions_[node] >= 0;
+}
+
+int TransformHierarchy::getParent(int node) const {
+    if (!isValid(node)) {
+        return INVALID_NODE;
+    }
+    const int parentPosition = parents_[positions_[node]];
+    return parentPosition >= 0 ? ids_[parentPosition] : INVALID_NODE;
+}
+
+// ==================== MATRICES ====================
+void TransformHierarchy::setLocalMatrix(int node, const float *localMatrix) {
+    if (!isValid(node) || localMatrix == nullptr) {
+        return;
+    }
+    const int position = positions_[node];
+    std::memcpy(localMatrices_[position].data(), localMatrix, sizeof(float) * 16);
+    markDirty(position);
+}
+
+const float *TransformHierarchy::getLocalMatrix(int node) const {
+    return isValid(node) ? localMatrices_[positions_[node]].data() : nullptr;
+}
+
+const float *TransformHierarchy::getWorldMatrix(int node) const {
+    return isValid(node) ? worldMatrices_[positions_[node]].data() : nullptr;
+}
+
+std::size_t TransformHierarchy::update() {
+    if (orderDirty_) {
+        rebuildOrder();
+    }
+    ++sweep_;
+    if (firstDirty_ == NO_DIRTY) {
+        return 0;
+    }
+
+    // Tout ce qui précède le premier nœud sale est intact ; un nœud est recalculé s'il est
+    // sale ou si son parent (déjà traité) vient de l'être
+    std::size_t updated = 0;
+    const std::size_t count = parents_.size();
+    for (std::size_t i = firstDirty_; i < count; ++i) {
+        const int parent = parents_[i];
+        const bool parentUpdated = parent >= 0 && updatedSweeps_[parent] == sweep_;
+        if (dirty_[i] == 0 && !parentUpdated) {
+            continue;
+        }
+
+        if (parent >= 0) {
+            MatrixMath::multiply(worldMatrices_[i].data(), worldMatrices_[parent].data(), localMatrices_[i].data());
+        } else {
+            worldMatrices_[i] = localMatrices_[i];
+        }
+        dirty_[i] = 0;
+        updatedSweeps_[i] = sweep_;
+        updated++;
+    }
+
+    firstDirty_ = NO_DIRTY;
+    return updated;
+}
+
+bool TransformHierarchy::wasUpdated(int node) const {
+    return isValid(node) && updatedSweeps_[positions_[node]] == sweep_;
+}
+
+// ==================== MÉTHODES PRIVÉES ====================
+void TransformHierarchy::markDirty(std::size_t position) {
+    dirty_[position] = 1;
+    firstDirty_ = std::min(firstDirty_, position);
+}
+
+void TransformHierarchy::rebuildOrder() {
+    const std::size_t count = parents_.size();
+
+    // Enfants de chaque position, regroupés (tri par comptage)
+    std::vector<int> childStart(count + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (ids_[i] >= 0 && parents_[i] >= 0) {
+            childStart[parents_[i] + 1]++;
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        childStart[i + 1] += childStart[i];
+    }
+    std::vector<int> children(childStart[count]);
+    std::vector<int> fill(childStart.begin(), childStart.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (ids_[i] >= 0 && parents_[i] >= 0) {
+            children[fill[parents_[i]]++] = static_cast<int>(i);
+        }
+    }
+
+    // Parcours en largeur depuis les racines, dans leur ordre actuel
+    std::vector<int> order;
+    order.reserve(aliveCount_);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (ids_[i] >= 0 && parents_[i] < 0) {
+            order.push_back(static_cast<int>(i));
+        }
+    }
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        const int position = order[head];
+        for (int c = childStart[position]; c < childStart[position + 1]; ++c) {
+            order.push_back(children[c]);
+        }
+    }
+
+    std::vector<int> newPositions(count, -1);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        newPositions[order[i]] = static_cast<int>(i);
+    }
+
+    std::vector<int> parents(order.size());
+    std::vector<int> ids(order.size());
+    std::vector<std::array<float, 16>> localMatrices(order.size());
+    std::vector<std::array<float, 16>> worldMatrices(order.size());
+    std::vector<std::uint8_t> dirty(order.size());
+    std::vector<std::uint32_t> updatedSweeps(order.size());
+    firstDirty_ = NO_DIRTY;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const int old = order[i];
+        parents[i] = parents_[old] >= 0 ? newPositions[parents_[old]] : -1;
+        ids[i] = ids_[old];
+        localMatrices[i] = localMatrices_[old];
+        worldMatrices[i] = worldMatrices_[old];
+        dirty[i] = dirty_[old];
+        updatedSweeps[i] = updatedSweeps_[old];
+        positions_[ids[i]] = static_cast<int>(i);
+        if (dirty[i] != 0 && firstDirty_ == NO_DIRTY) {
+            firstDirty_ = i;
+        }
+    }
+
+    parents_ = std::move(parents);
+    ids_ = std::move(ids);
+    localMatrices_ = std::move(localMatrices);
+    worldMatrices_ = std::move(worldMatrices);
+    dirty_ = std::move(dirty);
+    updatedSweeps_ = std::move(updatedSweeps);
+    orderDirty_ = false;
+}